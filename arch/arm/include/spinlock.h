@@ -65,6 +65,7 @@
 #ifdef CONFIG_ARM_HAVE_WFE_SEV
 #define SP_WFE() __asm__ __volatile__ ("wfe" : : : "memory")
 #define SP_SEV() __asm__ __volatile__ ("sev" : : : "memory")
+#define SP_RELAX() __asm__ __volatile__ ("yield" : : : "memory")
 #endif
 
 /****************************************************************************
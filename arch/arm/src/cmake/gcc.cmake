@@ -147,6 +147,11 @@ if(CONFIG_MM_KASAN_ALL)
   add_compile_options(-fsanitize=kernel-address)
 endif()
 
+if(CONFIG_MM_KASAN_INLINE)
+  add_compile_options(-fasan-shadow-offset=${CONFIG_MM_KASAN_SHADOW_OFFSET})
+  add_compile_options(--param=asan-instrumentation-with-call-threshold=10000)
+endif()
+
 if(CONFIG_MM_KASAN_GLOBAL)
   add_compile_options(--param=asan-globals=1)
 endif()
@@ -64,6 +64,7 @@
 
 #define SP_WFE() __asm__ __volatile__ ("wfe" : : : "memory")
 #define SP_SEV() __asm__ __volatile__ ("sev" : : : "memory")
+#define SP_RELAX() __asm__ __volatile__ ("yield" : : : "memory")
 
 #ifndef __ASSEMBLY__
 
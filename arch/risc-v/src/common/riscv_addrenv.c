@@ -36,6 +36,8 @@
  *   up_addrenv_select   - Instantiate an address environment
  *   up_addrenv_clone    - Copy an address environment from one location to
  *                        another.
+ *   up_addrenv_fork     - Share an address environment copy-on-write with
+ *                         a child process.
  *
  * Higher-level interfaces used by the tasking logic.  These interfaces are
  * used by the functions in sched/ and all operate on the thread which whose
@@ -65,11 +67,14 @@
 #include <nuttx/compiler.h>
 #include <nuttx/irq.h>
 #include <nuttx/pgalloc.h>
+#include <nuttx/spinlock.h>
 
 #include <arch/barriers.h>
 
+#include "sched/sched.h"
 #include "addrenv.h"
 #include "pgalloc.h"
+#include "riscv_internal.h"
 #include "riscv_mmu.h"
 
 /****************************************************************************
@@ -97,6 +102,16 @@ static_assert((ARCH_ADDRENV_VBASE & RV_MMU_SECTION_ALIGN) == 0,
 
 extern uintptr_t            g_kernel_mappings;
 
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifdef CONFIG_ARCH_ADDRENV_COW
+/* Serializes the updates of copy-on-write page table entries */
+
+static spinlock_t g_cow_lock = SP_UNLOCKED;
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -339,6 +354,88 @@ static inline bool vaddr_is_shm(uintptr_t vaddr)
 #endif
 }
 
+/****************************************************************************
+ * Name: cow_flush_tlbs
+ *
+ * Description:
+ *   Drop the TLB entries that still allow writes to pages which have just
+ *   been made copy-on-write.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_ARCH_ADDRENV_COW
+static int cow_flush_tlbs(void *arg)
+{
+  UNUSED(arg);
+  mmu_invalidate_tlbs();
+  return OK;
+}
+
+/****************************************************************************
+ * Name: cow_share_pgtable
+ *
+ * Description:
+ *   Map the pages of a final level page table of the parent into the
+ *   child.  Writable pages lose their write access in both and are marked
+ *   copy-on-write; every page gains a reference for the child's mapping.
+ *
+ * Input Parameters:
+ *   dest  - The child's address environment
+ *   ptsrc - The parent's final level page table
+ *   vaddr - The virtual address the page table starts at
+ *
+ * Returned value:
+ *   OK on success; a negated errno value on failure
+ *
+ ****************************************************************************/
+
+static int cow_share_pgtable(arch_addrenv_t *dest, uintptr_t *ptsrc,
+                             uintptr_t vaddr)
+{
+  uintptr_t *ptdest;
+  uintptr_t  ptprev;
+  uintptr_t  paddr;
+  irqstate_t flags;
+  int        i;
+
+  paddr = mm_pgalloc(1);
+  if (!paddr)
+    {
+      return -ENOMEM;
+    }
+
+  riscv_pgwipe(paddr);
+
+  /* Link the child's page table to its static page tables */
+
+  map_spgtables(dest, vaddr);
+  ptprev = riscv_pgvaddr(dest->spgtables[ARCH_SPGTS - 1]);
+  mmu_ln_setentry(ARCH_SPGTS, ptprev, paddr, vaddr, MMU_UPGT_FLAGS);
+
+  ptdest = (uintptr_t *)riscv_pgvaddr(paddr);
+
+  flags = spin_lock_irqsave(&g_cow_lock);
+
+  for (i = 0; i < ENTRIES_PER_PGT; i++)
+    {
+      paddr = mmu_pte_to_paddr(ptsrc[i]);
+      if (paddr)
+        {
+          if (ptsrc[i] & PTE_W)
+            {
+              ptsrc[i] = (ptsrc[i] & ~PTE_W) | PTE_COW;
+            }
+
+          mm_pgget(paddr);
+          ptdest[i] = ptsrc[i];
+        }
+    }
+
+  spin_unlock_irqrestore(&g_cow_lock, flags);
+  return OK;
+}
+#endif /* CONFIG_ARCH_ADDRENV_COW */
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -556,7 +653,13 @@ int up_addrenv_destroy(arch_addrenv_t *addrenv)
                       paddr = mmu_pte_to_paddr(ptlast[j]);
                       if (paddr)
                         {
+#ifdef CONFIG_ARCH_ADDRENV_COW
+                          /* The page may still be shared with a relative */
+
+                          mm_pgput(paddr);
+#else
                           mm_pgfree(paddr, 1);
+#endif
                         }
                     }
                 }
@@ -771,6 +874,234 @@ int up_addrenv_clone(const arch_addrenv_t *src,
   return OK;
 }
 
+/****************************************************************************
+ * Name: up_addrenv_fork
+ *
+ * Description:
+ *   Create the address environment of a child process created by fork().
+ *   The user memory of src is shared with dest copy-on-write: writable
+ *   pages become read-only in both and are copied by riscv_cowfault() on
+ *   the first write by either of them.  Shared memory attachments are not
+ *   inherited.
+ *
+ * Input Parameters:
+ *   src  - The address environment of the parent.
+ *   dest - The location to receive the child's address environment.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_ARCH_ADDRENV_COW
+int up_addrenv_fork(arch_addrenv_t *src, arch_addrenv_t *dest)
+{
+  uintptr_t *ptprev;
+  uintptr_t *ptlast;
+  uintptr_t  vaddr;
+  size_t     pgsize;
+  int        ret;
+  int        i;
+
+  DEBUGASSERT(src && dest);
+
+  memset(dest, 0, sizeof(arch_addrenv_t));
+
+  ret = create_spgtables(dest);
+  if (ret < 0)
+    {
+      serr("ERROR: Failed to create static page tables\n");
+      goto errout;
+    }
+
+  ret = copy_kernel_mappings(dest);
+  if (ret < 0)
+    {
+      serr("ERROR: Failed to copy kernel mappings to new environment");
+      goto errout;
+    }
+
+  /* Walk the parent's user space, like up_addrenv_destroy() */
+
+  vaddr  = ARCH_ADDRENV_VBASE;
+  pgsize = mmu_get_region_size(ARCH_SPGTS);
+  ptprev = (uintptr_t *)riscv_pgvaddr(src->spgtables[ARCH_SPGTS - 1]);
+
+  i = (ARCH_SPGTS < 2) ? vaddr / pgsize : 0;
+  for (; i < ENTRIES_PER_PGT; i++, vaddr += pgsize)
+    {
+      ptlast = (uintptr_t *)riscv_pgvaddr(mmu_pte_to_paddr(ptprev[i]));
+      if (ptlast && !vaddr_is_shm(vaddr))
+        {
+          ret = cow_share_pgtable(dest, ptlast, vaddr);
+          if (ret < 0)
+            {
+              break;
+            }
+        }
+    }
+
+  /* Whatever happened, some of the parent's pages may have lost their
+   * write access, so the TLBs of all CPUs running its threads must forget
+   * them.
+   */
+
+  __ISB();
+  __DMB();
+
+#ifdef CONFIG_SMP
+  nxsched_smp_call((1 << CONFIG_SMP_NCPUS) - 1, cow_flush_tlbs, NULL);
+#else
+  cow_flush_tlbs(NULL);
+#endif
+
+  if (ret < 0)
+    {
+      serr("ERROR: Failed to share the parent's pages: %d\n", ret);
+      goto errout;
+    }
+
+  dest->textvbase = src->textvbase;
+  dest->datavbase = src->datavbase;
+  dest->heapvbase = src->heapvbase;
+  dest->heapsize  = src->heapsize;
+
+  /* Provide the satp value for context switch */
+
+  dest->satp = mmu_satp_reg(dest->spgtables[0], 0);
+  return OK;
+
+errout:
+  up_addrenv_destroy(dest);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: riscv_cowfault
+ *
+ * Description:
+ *   Store page fault handler.  A write to a copy-on-write page of the
+ *   current address environment gives the writer a private copy of the
+ *   page, or just its write access back if nobody else maps the page any
+ *   more.  All other faults go to the default handler.
+ *
+ * Input Parameters:
+ *   mcause - The machine cause of the exception.
+ *   regs   - A pointer to the register state at the time of the exception.
+ *   args   - A pointer to any additional arguments.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int riscv_cowfault(int mcause, void *regs, void *args)
+{
+  struct tcb_s   *tcb = this_task();
+  arch_addrenv_t *addrenv;
+  uintptr_t       vaddr = MM_PGALIGNDOWN(READ_CSR(CSR_TVAL));
+  uintptr_t       newpage = 0;
+  uintptr_t       oldpage = 0;
+  uintptr_t       ptprev;
+  uintptr_t       ptlast;
+  uintptr_t       paddr;
+  uintptr_t       entry;
+  irqstate_t      flags;
+
+  if (tcb->addrenv_curr == NULL || !riscv_uservaddr(vaddr) ||
+      vaddr_is_shm(vaddr))
+    {
+      goto fallback;
+    }
+
+  addrenv = &tcb->addrenv_curr->addrenv;
+  ptprev  = riscv_pgvaddr(addrenv->spgtables[ARCH_SPGTS - 1]);
+  entry   = mmu_ln_getentry(ARCH_SPGTS, ptprev, vaddr);
+  ptlast  = riscv_pgvaddr(mmu_pte_to_paddr(entry));
+  if (!ptlast)
+    {
+      goto fallback;
+    }
+
+  entry = mmu_ln_getentry(ARCH_SPGTS + 1, ptlast, vaddr);
+  if ((entry & (PTE_VALID | PTE_W)) == (PTE_VALID | PTE_W))
+    {
+      /* Resolved by another thread, this CPU had a stale TLB entry */
+
+      mmu_invalidate_tlb_by_vaddr(vaddr);
+      return OK;
+    }
+
+  if ((entry & (PTE_VALID | PTE_COW)) != (PTE_VALID | PTE_COW))
+    {
+      goto fallback;
+    }
+
+  /* The copy is allocated before taking the lock.  Should the page be
+   * shared again in between, the write simply faults once more.
+   */
+
+  if (mm_pgrefs(mmu_pte_to_paddr(entry)) > 1)
+    {
+      newpage = mm_pgalloc(1);
+      if (!newpage)
+        {
+          goto fallback;
+        }
+    }
+
+  flags = spin_lock_irqsave(&g_cow_lock);
+
+  entry = mmu_ln_getentry(ARCH_SPGTS + 1, ptlast, vaddr);
+  if (entry & PTE_COW)
+    {
+      paddr = mmu_pte_to_paddr(entry);
+      if (mm_pgrefs(paddr) == 1)
+        {
+          /* The last mapping of the page, just make it writable */
+
+          entry = (entry & ~PTE_COW) | PTE_W;
+          mmu_ln_restore(ARCH_SPGTS + 1, ptlast, vaddr, entry);
+        }
+      else if (newpage)
+        {
+          memcpy((void *)riscv_pgvaddr(newpage),
+                 (void *)riscv_pgvaddr(paddr), MM_PGSIZE);
+
+          entry &= ~(RV_MMU_PTE_PPN_MASK | PTE_COW);
+          entry |= (newpage >> RV_MMU_PTE_PPN_SHIFT) | PTE_W;
+          mmu_ln_restore(ARCH_SPGTS + 1, ptlast, vaddr, entry);
+
+          oldpage = paddr;
+          newpage = 0;
+        }
+    }
+
+  spin_unlock_irqrestore(&g_cow_lock, flags);
+
+  mmu_invalidate_tlb_by_vaddr(vaddr);
+
+  if (oldpage)
+    {
+      mm_pgput(oldpage);
+    }
+
+  if (newpage)
+    {
+      mm_pgfree(newpage, 1);
+    }
+
+  return OK;
+
+fallback:
+#ifdef CONFIG_PAGING
+  return riscv_fillpage(mcause, regs, args);
+#else
+  return riscv_exception(mcause, regs, args);
+#endif
+}
+#endif /* CONFIG_ARCH_ADDRENV_COW */
+
 /****************************************************************************
  * Name: up_addrenv_attach
  *
@@ -289,9 +289,15 @@ void riscv_exception_attach(void)
 
 #ifdef CONFIG_PAGING
   irq_attach(RISCV_IRQ_LOADPF, riscv_fillpage, NULL);
-  irq_attach(RISCV_IRQ_STOREPF, riscv_fillpage, NULL);
 #else
   irq_attach(RISCV_IRQ_LOADPF, riscv_exception, NULL);
+#endif
+
+#if defined(CONFIG_ARCH_ADDRENV_COW)
+  irq_attach(RISCV_IRQ_STOREPF, riscv_cowfault, NULL);
+#elif defined(CONFIG_PAGING)
+  irq_attach(RISCV_IRQ_STOREPF, riscv_fillpage, NULL);
+#else
   irq_attach(RISCV_IRQ_STOREPF, riscv_exception, NULL);
 #endif
 
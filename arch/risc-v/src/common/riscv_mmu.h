@@ -46,6 +46,10 @@
 #define PTE_A                   (1 << 6) /* Page has been accessed */
 #define PTE_D                   (1 << 7) /* Page is dirty */
 
+/* Software PTE bits (RSW), ignored by the MMU */
+
+#define PTE_COW                 (1 << 8) /* Page is shared copy-on-write */
+
 /* T-Head MMU needs Text and Data to be Shareable, Bufferable, Cacheable */
 
 #ifdef CONFIG_ARCH_MMU_EXT_THEAD
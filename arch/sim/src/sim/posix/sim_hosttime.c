@@ -62,6 +62,28 @@ uint64_t host_gettime(bool rtc)
   return current - start;
 }
 
+/****************************************************************************
+ * Name: host_cycles
+ *
+ * Description:
+ *   Return a free running cycle count of the host CPU.  This is the time
+ *   stamp counter on x86 hosts; other hosts fall back to nanoseconds of the
+ *   monotonic clock.
+ *
+ ****************************************************************************/
+
+uint64_t host_cycles(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+  return __builtin_ia32_rdtsc();
+#else
+  struct timespec tp;
+
+  clock_gettime(CLOCK_MONOTONIC, &tp);
+  return 1000000000ull * tp.tv_sec + tp.tv_nsec;
+#endif
+}
+
 /****************************************************************************
  * Name: host_sleep
  ****************************************************************************/
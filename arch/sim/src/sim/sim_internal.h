@@ -238,6 +238,7 @@ int host_unlinkshmem(const char *name);
 /* sim_hosttime.c ***********************************************************/
 
 uint64_t host_gettime(bool rtc);
+uint64_t host_cycles(void);
 void host_sleep(uint64_t nsec);
 void host_sleepuntil(uint64_t nsec);
 int host_timerirq(void);
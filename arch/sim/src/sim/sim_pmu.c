@@ -0,0 +1,166 @@
+/****************************************************************************
+ * arch/sim/src/sim/sim_pmu.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <errno.h>
+
+#include <nuttx/perf.h>
+#include <perf/pmu.h>
+
+#include "sim_internal.h"
+
+/* The simulated PMU counts host CPU cycles (the TSC on x86 hosts) while the
+ * measured task runs.  The host can not deliver counter overflow
+ * interrupts to the simulation, so only counting events are supported;
+ * use the cpu-clock software event for sampling.
+ */
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int sim_pmu_event_init(struct perf_event_s *event);
+static int sim_pmu_event_add(struct perf_event_s *event, int flags);
+static void sim_pmu_event_del(struct perf_event_s *event, int flags);
+static int sim_pmu_event_start(struct perf_event_s *event, int flags);
+static int sim_pmu_event_stop(struct perf_event_s *event, int flags);
+static int sim_pmu_event_read(struct perf_event_s *event);
+static int sim_pmu_event_match(struct perf_event_s *event);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct pmu_ops_s g_sim_pmu_ops =
+{
+  .event_init  = sim_pmu_event_init,
+  .event_add   = sim_pmu_event_add,
+  .event_del   = sim_pmu_event_del,
+  .event_start = sim_pmu_event_start,
+  .event_stop  = sim_pmu_event_stop,
+  .event_read  = sim_pmu_event_read,
+  .event_match = sim_pmu_event_match,
+};
+
+static struct pmu_s g_sim_pmu =
+{
+  .ops         = &g_sim_pmu_ops,
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static int sim_pmu_event_init(struct perf_event_s *event)
+{
+  if (event->attr.type != PERF_TYPE_HARDWARE ||
+      sim_pmu_event_match(event) != 0)
+    {
+      return -ENOENT;
+    }
+
+  if (event->attr.sample_period != 0)
+    {
+      return -EOPNOTSUPP;
+    }
+
+  event->hw.idx   = -1;
+  event->hw.state = PERF_HES_STOPPED;
+  return 0;
+}
+
+static int sim_pmu_event_add(struct perf_event_s *event, int flags)
+{
+  return 0;
+}
+
+static void sim_pmu_event_del(struct perf_event_s *event, int flags)
+{
+}
+
+static int sim_pmu_event_start(struct perf_event_s *event, int flags)
+{
+  event->hw.prev_count = host_cycles();
+  event->hw.state      = 0;
+  return 0;
+}
+
+static int sim_pmu_event_stop(struct perf_event_s *event, int flags)
+{
+  if ((event->hw.state & PERF_HES_STOPPED) == 0 &&
+      (flags & PERF_EF_UPDATE) != 0)
+    {
+      sim_pmu_event_read(event);
+    }
+
+  event->hw.state |= PERF_HES_STOPPED | PERF_HES_UPTODATE;
+  return 0;
+}
+
+static int sim_pmu_event_read(struct perf_event_s *event)
+{
+  uint64_t now = host_cycles();
+
+  event->count        += now - event->hw.prev_count;
+  event->hw.prev_count = now;
+  return 0;
+}
+
+static int sim_pmu_event_match(struct perf_event_s *event)
+{
+  /* Instruction, branch and cache counters are not accessible from a
+   * user-mode process, only the host cycle counter is.
+   */
+
+  switch (event->attr.config)
+    {
+      case PERF_COUNT_HW_CPU_CYCLES:
+      case PERF_COUNT_HW_REF_CPU_CYCLES:
+      case PERF_COUNT_HW_BUS_CYCLES:
+        return 0;
+
+      default:
+        return -ENOENT;
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: pmu_initialize
+ *
+ * Description:
+ *   Register the simulated PMU with the perf events framework.
+ *
+ ****************************************************************************/
+
+int pmu_initialize(void)
+{
+  return perf_pmu_register(&g_sim_pmu, "cpu", PERF_TYPE_HARDWARE);
+}
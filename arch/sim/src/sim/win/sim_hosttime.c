@@ -25,6 +25,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <windows.h>
+#include <intrin.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -81,6 +82,19 @@ uint64_t host_gettime(bool rtc)
   return current - start;
 }
 
+/****************************************************************************
+ * Name: host_cycles
+ *
+ * Description:
+ *   Return a free running cycle count of the host CPU.
+ *
+ ****************************************************************************/
+
+uint64_t host_cycles(void)
+{
+  return __rdtsc();
+}
+
 /****************************************************************************
  * Name: host_sleep
  ****************************************************************************/
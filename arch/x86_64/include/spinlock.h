@@ -57,6 +57,7 @@
 
 #define SP_DSB() __asm__ __volatile__ ("mfence")
 #define SP_DMB() __asm__ __volatile__ ("mfence")
+#define SP_RELAX() __asm__ __volatile__ ("pause" : : : "memory")
 
 /****************************************************************************
  * Public Types
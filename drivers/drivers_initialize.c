@@ -204,7 +204,7 @@ void drivers_initialize(void)
   ptmx_register();
 #endif
 
-#ifdef CONFIG_SCHED_PERF_EVENTS
+#if defined(CONFIG_SCHED_PERF_EVENTS) && defined(CONFIG_ARCH_HAVE_PMU)
   pmu_initialize();
 #endif
 
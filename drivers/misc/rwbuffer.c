@@ -56,12 +56,13 @@
 #  error "Worker thread support is required (CONFIG_SCHED_WORKQUEUE)"
 #endif
 
-/****************************************************************************
- * Private Function Prototypes
- ****************************************************************************/
+/* Statistics ***************************************************************/
 
-static ssize_t rwb_read_(FAR struct rwbuffer_s *rwb, off_t startblock,
-                         size_t nblocks, FAR uint8_t *rdbuffer);
+#ifdef CONFIG_DRVR_RWBUFFER_STATS
+#  define rwb_stats_add(rwb, field, n) ((rwb)->stats.field += (n))
+#else
+#  define rwb_stats_add(rwb, field, n)
+#endif
 
 /****************************************************************************
  * Private Functions
@@ -124,6 +125,33 @@ static inline void rwb_resetwrbuffer(FAR struct rwbuffer_s *rwb)
 }
 #endif
 
+/****************************************************************************
+ * Name: rwb_wrfill
+ *
+ * Description:
+ *   Read blocks from the media into the write buffer to pad it to the
+ *   write alignment or to fill a hole between buffered writes.  This goes
+ *   straight to the driver so that the read-ahead state and the read
+ *   statistics only reflect user reads.
+ *
+ * Assumptions:
+ *   The caller holds the wrlock mutex.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_DRVR_WRITEBUFFER
+static ssize_t rwb_wrfill(FAR struct rwbuffer_s *rwb, off_t startblock,
+                          size_t nblocks, FAR uint8_t *buffer)
+{
+  if (nblocks == 0)
+    {
+      return 0;
+    }
+
+  return rwb->rhreload(rwb->dev, buffer, startblock, nblocks);
+}
+#endif
+
 /****************************************************************************
  * Name: rwb_wrflush
  *
@@ -150,8 +178,8 @@ static void rwb_wrflush(FAR struct rwbuffer_s *rwb)
       if (padblocks)
         {
           padblocks = rwb->wralignblocks - padblocks;
-          rwb_read_(rwb, rwb->wrblockstart + rwb->wrnblocks, padblocks,
-                    &rwb->wrbuffer[rwb->wrnblocks * rwb->blocksize]);
+          rwb_wrfill(rwb, rwb->wrblockstart + rwb->wrnblocks, padblocks,
+                     &rwb->wrbuffer[rwb->wrnblocks * rwb->blocksize]);
           rwb->wrnblocks += padblocks;
         }
 
@@ -167,6 +195,8 @@ static void rwb_wrflush(FAR struct rwbuffer_s *rwb)
           ferr("ERROR: Error flushing write buffer: %d\n", ret);
         }
 
+      rwb_stats_add(rwb, wrflushes, 1);
+      rwb_stats_add(rwb, wrflushblocks, rwb->wrnblocks);
       rwb_resetwrbuffer(rwb);
     }
 }
@@ -250,14 +280,35 @@ static ssize_t rwb_writebuffer(FAR struct rwbuffer_s *rwb,
       off_t wrbend;
       off_t newend;
 
+      wrbend = rwb->wrblockstart + rwb->wrnblocks;
+      newend = startblock + nblocks;
+
+      /* If the new data starts beyond the end of the buffered data but
+       * still fits in the current write window, fill the hole from the
+       * media instead of flushing.  Small scattered writes to the same
+       * page are then combined into a single program operation.
+       */
+
+      if (startblock > wrbend &&
+          newend <= rwb->wrblockstart + rwb->wrmaxblocks)
+        {
+          ssize_t ret;
+
+          ret = rwb_wrfill(rwb, wrbend, startblock - wrbend,
+                           rwb->wrbuffer + rwb->wrnblocks * rwb->blocksize);
+          if (ret >= 0)
+            {
+              rwb_stats_add(rwb, wrholes, startblock - wrbend);
+              rwb->wrnblocks = startblock - rwb->wrblockstart;
+              wrbend         = startblock;
+            }
+        }
+
       /* Now there are five cases:
        *
        * 1. We update the non-overlapping region
        */
 
-      wrbend = rwb->wrblockstart + rwb->wrnblocks;
-      newend = startblock + nblocks;
-
       if (wrbend < startblock || rwb->wrblockstart > newend)
         {
           /* Nothing to do */;
@@ -287,6 +338,7 @@ static ssize_t rwb_writebuffer(FAR struct rwbuffer_s *rwb,
           dest   = rwb->wrbuffer + offset * rwb->blocksize;
           memcpy(dest, wrbuffer, nblocks * rwb->blocksize);
 
+          rwb_stats_add(rwb, wrmerged, nblocks);
           nblocks = 0;
         }
 
@@ -312,6 +364,7 @@ static ssize_t rwb_writebuffer(FAR struct rwbuffer_s *rwb,
           dest = rwb->wrbuffer + offset * rwb->blocksize;
           memcpy(dest, wrbuffer, ncopy * rwb->blocksize);
 
+          rwb_stats_add(rwb, wrmerged, ncopy);
           rwb->wrnblocks = offset + ncopy;
           wrbuffer      += ncopy * rwb->blocksize;
           startblock    += ncopy;
@@ -335,6 +388,7 @@ static ssize_t rwb_writebuffer(FAR struct rwbuffer_s *rwb,
           return ret;
         }
 
+      rwb_stats_add(rwb, wrbypass, nblocks);
       nblocks = 0;
     }
 
@@ -355,7 +409,7 @@ static ssize_t rwb_writebuffer(FAR struct rwbuffer_s *rwb,
       padblocks = startblock % rwb->wralignblocks;
       rwb->wrblockstart = startblock - padblocks;
       rwb->wrnblocks = padblocks;
-      rwb_read_(rwb, rwb->wrblockstart, padblocks, rwb->wrbuffer);
+      rwb_wrfill(rwb, rwb->wrblockstart, padblocks, rwb->wrbuffer);
 
       if (remain > rwb->wrmaxblocks - padblocks)
         {
@@ -440,10 +494,10 @@ rwb_bufferread(FAR struct rwbuffer_s *rwb,  off_t startblock,
  ****************************************************************************/
 
 #ifdef CONFIG_DRVR_READAHEAD
-static int rwb_rhreload(FAR struct rwbuffer_s *rwb, off_t startblock)
+static int rwb_rhreload(FAR struct rwbuffer_s *rwb, off_t startblock,
+                        size_t nblocks)
 {
   off_t  endblock;
-  size_t nblocks;
   int    ret;
 
   /* Check for attempts to read beyond the end of the media */
@@ -453,11 +507,11 @@ static int rwb_rhreload(FAR struct rwbuffer_s *rwb, off_t startblock)
       return -ESPIPE;
     }
 
-  /* Get the block number +1 of the last block that will fit in the
+  /* Get the block number +1 of the last block to load into the
    * read-ahead buffer
    */
 
-  endblock = startblock + rwb->rhmaxblocks;
+  endblock = startblock + nblocks;
 
   /* Make sure that we don't read past the end of the device */
 
@@ -482,6 +536,9 @@ static int rwb_rhreload(FAR struct rwbuffer_s *rwb, off_t startblock)
       rwb->rhnblocks    = nblocks;
       rwb->rhblockstart = startblock;
 
+      rwb_stats_add(rwb, rhreloads, 1);
+      rwb_stats_add(rwb, rhblocks, nblocks);
+
       /* The return value is not the number of blocks we asked to be
        * loaded.
        */
@@ -493,6 +550,55 @@ static int rwb_rhreload(FAR struct rwbuffer_s *rwb, off_t startblock)
 }
 #endif
 
+/****************************************************************************
+ * Name: rwb_rhwindow
+ *
+ * Description:
+ *   Return the number of blocks to load into the read-ahead buffer for a
+ *   miss at 'startblock' with 'remaining' blocks still to be read.  The
+ *   window doubles each time a reader continues where it left off and
+ *   falls back to rhminblocks on random access, so that sequential
+ *   streams get long reads while random reads do not waste bandwidth.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_DRVR_READAHEAD
+static size_t rwb_rhwindow(FAR struct rwbuffer_s *rwb, bool sequential,
+                           size_t remaining)
+{
+  size_t window;
+
+  if (rwb->rhminblocks == 0)
+    {
+      return rwb->rhmaxblocks;
+    }
+
+  if (!sequential)
+    {
+      window = rwb->rhminblocks;
+    }
+  else if (rwb->rhwindow < rwb->rhmaxblocks / 2)
+    {
+      window = rwb->rhwindow * 2;
+    }
+  else
+    {
+      window = rwb->rhmaxblocks;
+    }
+
+  rwb->rhwindow = window;
+
+  /* Never split one request into more reloads than needed */
+
+  if (window < remaining)
+    {
+      window = remaining < rwb->rhmaxblocks ? remaining : rwb->rhmaxblocks;
+    }
+
+  return window;
+}
+#endif
+
 /****************************************************************************
  * Name: rwb_invalidate_writebuffer
  *
@@ -835,6 +941,14 @@ int rwb_initialize(FAR struct rwbuffer_s *rwb)
 
       rwb_resetrhbuffer(rwb);
 
+      if (rwb->rhminblocks > rwb->rhmaxblocks)
+        {
+          rwb->rhminblocks = rwb->rhmaxblocks;
+        }
+
+      rwb->rhwindow    = rwb->rhminblocks;
+      rwb->rhnextblock = -1;
+
       /* Allocate the read-ahead buffer */
 
       allocsize     = rwb->rhmaxblocks * rwb->blocksize;
@@ -910,6 +1024,8 @@ static ssize_t rwb_read_(FAR struct rwbuffer_s *rwb, off_t startblock,
   if (rwb->rhmaxblocks > 0)
     {
       size_t remaining;
+      bool sequential;
+      bool reloaded = false;
 
       ret = rwb_lock(&rwb->rhlock);
       if (ret < 0)
@@ -917,6 +1033,11 @@ static ssize_t rwb_read_(FAR struct rwbuffer_s *rwb, off_t startblock,
           return ret;
         }
 
+      /* Does this request continue the previous one? */
+
+      sequential       = startblock == rwb->rhnextblock;
+      rwb->rhnextblock = startblock + nblocks;
+
       /* Loop until we have read all of the requested blocks */
 
       for (remaining = nblocks; remaining > 0; )
@@ -943,6 +1064,15 @@ static ssize_t rwb_read_(FAR struct rwbuffer_s *rwb, off_t startblock,
                   rwb_bufferread(rwb, startblock, rdblocks, &rdbuffer);
                   startblock += rdblocks;
                   remaining  -= rdblocks;
+
+                  if (reloaded)
+                    {
+                      rwb_stats_add(rwb, rdmisses, rdblocks);
+                    }
+                  else
+                    {
+                      rwb_stats_add(rwb, rdhits, rdblocks);
+                    }
                 }
             }
 
@@ -952,7 +1082,10 @@ static ssize_t rwb_read_(FAR struct rwbuffer_s *rwb, off_t startblock,
 
           if (remaining > 0)
             {
-              ret = rwb_rhreload(rwb, startblock);
+              ret = rwb_rhreload(rwb, startblock,
+                                 rwb_rhwindow(rwb, sequential, remaining));
+              reloaded   = true;
+              sequential = true;
               if (ret < 0)
                 {
                   ferr("ERROR: Failed to fill the read-ahead buffer: %d\n",
@@ -1047,6 +1180,7 @@ ssize_t rwb_read(FAR struct rwbuffer_s *rwb, off_t startblock,
                     (rwb->wrnblocks - wrnpass) : nblocks;
           memcpy(rdbuffer, &rwb->wrbuffer[wrnpass * rwb->blocksize],
                 rdblocks * rwb->blocksize);
+          rwb_stats_add(rwb, wrhits, rdblocks);
 
           startblock += rdblocks;
           nblocks    -= rdblocks;
@@ -1277,4 +1411,80 @@ int rwb_flush(FAR struct rwbuffer_s *rwb)
 }
 #endif
 
+/****************************************************************************
+ * Name: rwb_getstats
+ *
+ * Description:
+ *   Return the buffer statistics in 'stats' (if not NULL) and optionally
+ *   reset them.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_DRVR_RWBUFFER_STATS
+int rwb_getstats(FAR struct rwbuffer_s *rwb, FAR struct rwb_stats_s *stats,
+                 bool reset)
+{
+  int ret;
+
+  /* Each counter is updated under the lock of the buffer it describes,
+   * hold both to take a consistent snapshot.
+   */
+
+#ifdef CONFIG_DRVR_WRITEBUFFER
+  if (rwb->wrmaxblocks > 0)
+    {
+      ret = rwb_lock(&rwb->wrlock);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+#endif
+
+#ifdef CONFIG_DRVR_READAHEAD
+  if (rwb->rhmaxblocks > 0)
+    {
+      ret = rwb_lock(&rwb->rhlock);
+      if (ret < 0)
+        {
+#ifdef CONFIG_DRVR_WRITEBUFFER
+          if (rwb->wrmaxblocks > 0)
+            {
+              rwb_unlock(&rwb->wrlock);
+            }
+#endif
+
+          return ret;
+        }
+    }
+#endif
+
+  if (stats != NULL)
+    {
+      memcpy(stats, &rwb->stats, sizeof(struct rwb_stats_s));
+    }
+
+  if (reset)
+    {
+      memset(&rwb->stats, 0, sizeof(struct rwb_stats_s));
+    }
+
+#ifdef CONFIG_DRVR_READAHEAD
+  if (rwb->rhmaxblocks > 0)
+    {
+      rwb_unlock(&rwb->rhlock);
+    }
+#endif
+
+#ifdef CONFIG_DRVR_WRITEBUFFER
+  if (rwb->wrmaxblocks > 0)
+    {
+      rwb_unlock(&rwb->wrlock);
+    }
+#endif
+
+  return OK;
+}
+#endif
+
 #endif /* CONFIG_DRVR_WRITEBUFFER || CONFIG_DRVR_READAHEAD */
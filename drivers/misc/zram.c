@@ -0,0 +1,719 @@
+/****************************************************************************
+ * drivers/misc/zram.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* Compressed RAM disk.  Every sector is compressed with LZF on write and
+ * stored in its own block of a multiple mempool whose block sizes are
+ * sixteen evenly spaced size classes up to the sector size.  Memory is
+ * only consumed for sectors that have been written with non-zero data.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <assert.h>
+#include <debug.h>
+#include <errno.h>
+#include <lzf.h>
+
+#include <nuttx/nuttx.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/mutex.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/ioctl.h>
+#include <nuttx/mm/mempool.h>
+#include <nuttx/drivers/ramdisk.h>
+
+#ifdef CONFIG_DRVR_ZRAM
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Number of size classes in the pool */
+
+#define ZRAM_NCLASSES          16
+
+/* Compressed sectors larger than this are stored raw; they would land in
+ * (nearly) the same size class and reading them back would cost a
+ * decompression for nothing.
+ */
+
+#define ZRAM_MAXCOMPR(d)       ((d)->zr_sectsize - ((d)->zr_sectsize >> 3))
+
+/* lzf_compress() writes its header in front of the input (uncompressed)
+ * or output (compressed) data, so both work buffers have room for it.
+ */
+
+#define ZRAM_IN(d)             ((d)->zr_inbuf + LZF_TYPE0_HDR_SIZE)
+#define ZRAM_OUT(d)            ((d)->zr_outbuf + LZF_TYPE1_HDR_SIZE)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct zram_struct_s
+{
+  mutex_t      zr_lock;           /* Serializes access to the device */
+  uint32_t     zr_nsectors;       /* Number of sectors on device */
+  uint16_t     zr_sectsize;       /* The size of one sector */
+#ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
+  uint8_t      zr_crefs;          /* Open reference count */
+  bool         zr_unlinked;       /* The driver has been unlinked */
+#endif
+  FAR uint8_t **zr_slot;          /* Stored data per sector, NULL if zero */
+  FAR uint16_t *zr_len;           /* Stored length, 1 if NULL slot written */
+  FAR struct mempool_multiple_s *zr_pool;
+  FAR uint8_t *zr_inbuf;          /* Compression input, see ZRAM_IN() */
+  FAR uint8_t *zr_outbuf;         /* Compression output, see ZRAM_OUT() */
+  FAR lzf_hslot_t *zr_htab;       /* Compression hash table */
+
+  struct zram_stats_s zr_stats;
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+#ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
+static int     zram_open(FAR struct inode *inode);
+static int     zram_close(FAR struct inode *inode);
+#endif
+static ssize_t zram_read(FAR struct inode *inode, FAR unsigned char *buffer,
+                         blkcnt_t start_sector, unsigned int nsectors);
+static ssize_t zram_write(FAR struct inode *inode,
+                          FAR const unsigned char *buffer,
+                          blkcnt_t start_sector, unsigned int nsectors);
+static int     zram_geometry(FAR struct inode *inode,
+                             FAR struct geometry *geometry);
+static int     zram_ioctl(FAR struct inode *inode, int cmd,
+                          unsigned long arg);
+#ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
+static int     zram_unlink(FAR struct inode *inode);
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct block_operations g_zram_bops =
+{
+#ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
+  zram_open,     /* open     */
+  zram_close,    /* close    */
+#else
+  NULL,          /* open     */
+  NULL,          /* close    */
+#endif
+  zram_read,     /* read     */
+  zram_write,    /* write    */
+  zram_geometry, /* geometry */
+  zram_ioctl     /* ioctl    */
+#ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
+  , zram_unlink  /* unlink   */
+#endif
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: zram_pool_alloc, zram_pool_size and zram_pool_free
+ *
+ * Description:
+ *   Backing memory of the size-classed pool comes from the kernel heap.
+ *
+ ****************************************************************************/
+
+static FAR void *zram_pool_alloc(FAR void *arg, size_t alignment,
+                                 size_t size)
+{
+  return kmm_memalign(alignment, size);
+}
+
+static size_t zram_pool_size(FAR void *arg, FAR void *ptr)
+{
+  return kmm_malloc_size(ptr);
+}
+
+static void zram_pool_free(FAR void *arg, FAR void *ptr)
+{
+  kmm_free(ptr);
+}
+
+/****************************************************************************
+ * Name: zram_iszero
+ *
+ * Description:
+ *   Return true if the sector contains only zeros.
+ *
+ ****************************************************************************/
+
+static bool zram_iszero(FAR const uint8_t *buffer, size_t len)
+{
+  FAR const uintptr_t *word = (FAR const uintptr_t *)buffer;
+
+  if (((uintptr_t)buffer & (sizeof(uintptr_t) - 1)) == 0)
+    {
+      for (; len >= sizeof(uintptr_t); len -= sizeof(uintptr_t))
+        {
+          if (*word++ != 0)
+            {
+              return false;
+            }
+        }
+
+      buffer = (FAR const uint8_t *)word;
+    }
+
+  while (len-- > 0)
+    {
+      if (*buffer++ != 0)
+        {
+          return false;
+        }
+    }
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: zram_release
+ *
+ * Description:
+ *   Free the storage of one sector and update the statistics.
+ *
+ ****************************************************************************/
+
+static void zram_release(FAR struct zram_struct_s *dev, uint32_t sector)
+{
+  FAR struct zram_stats_s *stats = &dev->zr_stats;
+  FAR uint8_t *slot = dev->zr_slot[sector];
+  uint16_t len = dev->zr_len[sector];
+
+  if (slot != NULL)
+    {
+      stats->memused   -= mempool_multiple_alloc_size(dev->zr_pool, slot);
+      stats->origsize  -= dev->zr_sectsize;
+      stats->comprsize -= len;
+      if (len == dev->zr_sectsize)
+        {
+          stats->rawsectors--;
+        }
+      else
+        {
+          stats->lzfsectors--;
+        }
+
+      mempool_multiple_free(dev->zr_pool, slot);
+      dev->zr_slot[sector] = NULL;
+    }
+  else if (len != 0)
+    {
+      /* A non-zero length without data marks a sector written with
+       * zeros, as opposed to one that has never been written.
+       */
+
+      stats->zerosectors--;
+    }
+
+  dev->zr_len[sector] = 0;
+}
+
+/****************************************************************************
+ * Name: zram_store
+ *
+ * Description:
+ *   Compress and store one sector.
+ *
+ ****************************************************************************/
+
+static int zram_store(FAR struct zram_struct_s *dev, uint32_t sector,
+                      FAR const uint8_t *buffer)
+{
+  FAR struct zram_stats_s *stats = &dev->zr_stats;
+  FAR struct lzf_header_s *header;
+  FAR const uint8_t *data;
+  FAR uint8_t *slot;
+  size_t len;
+
+  if (zram_iszero(buffer, dev->zr_sectsize))
+    {
+      zram_release(dev, sector);
+      dev->zr_len[sector] = 1;
+      stats->zerosectors++;
+      return OK;
+    }
+
+  /* Compress from a private copy, in the failure case lzf_compress()
+   * writes its header in front of the input data.
+   */
+
+  memcpy(ZRAM_IN(dev), buffer, dev->zr_sectsize);
+  len = lzf_compress(ZRAM_IN(dev), dev->zr_sectsize, ZRAM_OUT(dev),
+                     ZRAM_MAXCOMPR(dev), dev->zr_htab, &header);
+  if (len > 0 && header->lzf_type == LZF_TYPE1_HDR)
+    {
+      data = ZRAM_OUT(dev);
+      len -= LZF_TYPE1_HDR_SIZE;
+    }
+  else
+    {
+      data = buffer;
+      len  = dev->zr_sectsize;
+    }
+
+  slot = mempool_multiple_alloc(dev->zr_pool, len);
+  if (slot == NULL)
+    {
+      return -ENOSPC;
+    }
+
+  memcpy(slot, data, len);
+  zram_release(dev, sector);
+
+  dev->zr_slot[sector] = slot;
+  dev->zr_len[sector]  = len;
+
+  stats->memused   += mempool_multiple_alloc_size(dev->zr_pool, slot);
+  stats->origsize  += dev->zr_sectsize;
+  stats->comprsize += len;
+  if (len == dev->zr_sectsize)
+    {
+      stats->rawsectors++;
+    }
+  else
+    {
+      stats->lzfsectors++;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: zram_load
+ *
+ * Description:
+ *   Decompress one sector.
+ *
+ ****************************************************************************/
+
+static int zram_load(FAR struct zram_struct_s *dev, uint32_t sector,
+                     FAR uint8_t *buffer)
+{
+  FAR uint8_t *slot = dev->zr_slot[sector];
+  uint16_t len = dev->zr_len[sector];
+
+  if (slot == NULL)
+    {
+      memset(buffer, 0, dev->zr_sectsize);
+    }
+  else if (len == dev->zr_sectsize)
+    {
+      memcpy(buffer, slot, len);
+    }
+  else if (lzf_decompress(slot, len, buffer, dev->zr_sectsize) !=
+           dev->zr_sectsize)
+    {
+      ferr("ERROR: Sector %" PRIu32 " is corrupted\n", sector);
+      return -EIO;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: zram_destroy
+ *
+ * Description:
+ *   Free all resources used by the compressed RAM disk
+ *
+ ****************************************************************************/
+
+static void zram_destroy(FAR struct zram_struct_s *dev)
+{
+  finfo("Destroying compressed RAM disk\n");
+
+  if (dev->zr_pool != NULL)
+    {
+      mempool_multiple_deinit(dev->zr_pool);
+    }
+
+  kmm_free(dev->zr_htab);
+  kmm_free(dev->zr_outbuf);
+  kmm_free(dev->zr_inbuf);
+  kmm_free(dev->zr_len);
+  kmm_free(dev->zr_slot);
+  nxmutex_destroy(&dev->zr_lock);
+  kmm_free(dev);
+}
+
+/****************************************************************************
+ * Name: zram_open
+ *
+ * Description: Open the block device
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
+static int zram_open(FAR struct inode *inode)
+{
+  FAR struct zram_struct_s *dev;
+
+  DEBUGASSERT(inode->i_private);
+  dev = inode->i_private;
+
+  nxmutex_lock(&dev->zr_lock);
+  dev->zr_crefs++;
+  DEBUGASSERT(dev->zr_crefs > 0);
+  nxmutex_unlock(&dev->zr_lock);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: zram_close
+ *
+ * Description: close the block device
+ *
+ ****************************************************************************/
+
+static int zram_close(FAR struct inode *inode)
+{
+  FAR struct zram_struct_s *dev;
+  bool destroy;
+
+  DEBUGASSERT(inode->i_private);
+  dev = inode->i_private;
+
+  nxmutex_lock(&dev->zr_lock);
+  DEBUGASSERT(dev->zr_crefs > 0);
+  dev->zr_crefs--;
+  destroy = dev->zr_crefs == 0 && dev->zr_unlinked;
+  nxmutex_unlock(&dev->zr_lock);
+
+  if (destroy)
+    {
+      zram_destroy(dev);
+    }
+
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: zram_read
+ *
+ * Description:  Read the specified number of sectors
+ *
+ ****************************************************************************/
+
+static ssize_t zram_read(FAR struct inode *inode, FAR unsigned char *buffer,
+                         blkcnt_t start_sector, unsigned int nsectors)
+{
+  FAR struct zram_struct_s *dev;
+  unsigned int i;
+  int ret;
+
+  DEBUGASSERT(inode->i_private);
+  dev = inode->i_private;
+
+  finfo("sector: %" PRIuOFF " nsectors: %u\n", start_sector, nsectors);
+
+  if (start_sector >= dev->zr_nsectors ||
+      start_sector + nsectors > dev->zr_nsectors)
+    {
+      return -EINVAL;
+    }
+
+  ret = nxmutex_lock(&dev->zr_lock);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  for (i = 0; i < nsectors; i++)
+    {
+      ret = zram_load(dev, start_sector + i,
+                      &buffer[i * dev->zr_sectsize]);
+      if (ret < 0)
+        {
+          break;
+        }
+    }
+
+  nxmutex_unlock(&dev->zr_lock);
+  return i > 0 ? i : ret;
+}
+
+/****************************************************************************
+ * Name: zram_write
+ *
+ * Description: Write the specified number of sectors
+ *
+ ****************************************************************************/
+
+static ssize_t zram_write(FAR struct inode *inode,
+                          FAR const unsigned char *buffer,
+                          blkcnt_t start_sector, unsigned int nsectors)
+{
+  FAR struct zram_struct_s *dev;
+  unsigned int i;
+  int ret;
+
+  DEBUGASSERT(inode->i_private);
+  dev = inode->i_private;
+
+  finfo("sector: %" PRIuOFF " nsectors: %u\n", start_sector, nsectors);
+
+  if (start_sector >= dev->zr_nsectors ||
+      start_sector + nsectors > dev->zr_nsectors)
+    {
+      return -EFBIG;
+    }
+
+  ret = nxmutex_lock(&dev->zr_lock);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  for (i = 0; i < nsectors; i++)
+    {
+      ret = zram_store(dev, start_sector + i,
+                       &buffer[i * dev->zr_sectsize]);
+      if (ret < 0)
+        {
+          ferr("ERROR: Failed to store sector %" PRIuOFF ": %d\n",
+               start_sector + i, ret);
+          break;
+        }
+    }
+
+  nxmutex_unlock(&dev->zr_lock);
+  return i > 0 ? i : ret;
+}
+
+/****************************************************************************
+ * Name: zram_geometry
+ *
+ * Description: Return device geometry
+ *
+ ****************************************************************************/
+
+static int zram_geometry(FAR struct inode *inode,
+                         FAR struct geometry *geometry)
+{
+  FAR struct zram_struct_s *dev;
+
+  if (geometry)
+    {
+      dev = inode->i_private;
+
+      memset(geometry, 0, sizeof(*geometry));
+
+      geometry->geo_available     = true;
+      geometry->geo_mediachanged  = false;
+      geometry->geo_writeenabled  = true;
+      geometry->geo_nsectors      = dev->zr_nsectors;
+      geometry->geo_sectorsize    = dev->zr_sectsize;
+      return OK;
+    }
+
+  return -EINVAL;
+}
+
+/****************************************************************************
+ * Name: zram_ioctl
+ *
+ * Description:
+ *   Return compression statistics
+ *
+ ****************************************************************************/
+
+static int zram_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
+{
+  FAR struct zram_struct_s *dev;
+  FAR struct zram_stats_s *stats;
+  int ret;
+
+  DEBUGASSERT(inode->i_private);
+  dev = inode->i_private;
+
+  if (cmd != BIOC_ZRAMSTATS)
+    {
+      return -ENOTTY;
+    }
+
+  stats = (FAR struct zram_stats_s *)((uintptr_t)arg);
+  if (stats == NULL)
+    {
+      return -EINVAL;
+    }
+
+  ret = nxmutex_lock(&dev->zr_lock);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  memcpy(stats, &dev->zr_stats, sizeof(*stats));
+  stats->ratio = stats->memused ?
+                 stats->origsize * 100 / stats->memused : 0;
+
+  nxmutex_unlock(&dev->zr_lock);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: zram_unlink
+ *
+ * Description:
+ *   The block driver has been unlinked.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
+static int zram_unlink(FAR struct inode *inode)
+{
+  FAR struct zram_struct_s *dev;
+  bool destroy;
+
+  DEBUGASSERT(inode->i_private);
+  dev = inode->i_private;
+
+  nxmutex_lock(&dev->zr_lock);
+  dev->zr_unlinked = true;
+  destroy = dev->zr_crefs == 0;
+  nxmutex_unlock(&dev->zr_lock);
+
+  if (destroy)
+    {
+      zram_destroy(dev);
+    }
+
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: zram_register
+ *
+ * Description:
+ *   Register a compressed RAM disk as /dev/zramN
+ *
+ ****************************************************************************/
+
+int zram_register(int minor, uint32_t nsectors, uint16_t sectsize)
+{
+  FAR struct zram_struct_s *dev;
+  size_t poolsize[ZRAM_NCLASSES];
+  size_t expandsize;
+  size_t step;
+  char devname[16];
+  int ret = -ENOMEM;
+  int i;
+
+  finfo("nsectors: %" PRIu32 " sectsize: %" PRIu16 "\n",
+        nsectors, sectsize);
+
+  /* Sanity check */
+
+  if (minor < 0 || minor > 255 || nsectors == 0 ||
+      sectsize < ZRAM_NCLASSES * sizeof(uintptr_t))
+    {
+      return -EINVAL;
+    }
+
+  dev = kmm_zalloc(sizeof(struct zram_struct_s));
+  if (dev == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  nxmutex_init(&dev->zr_lock);
+  dev->zr_nsectors = nsectors;
+  dev->zr_sectsize = sectsize;
+  dev->zr_stats.nsectors = nsectors;
+
+  dev->zr_slot = kmm_zalloc(nsectors * sizeof(FAR uint8_t *));
+  dev->zr_len  = kmm_zalloc(nsectors * sizeof(uint16_t));
+  dev->zr_inbuf  = kmm_malloc(LZF_TYPE0_HDR_SIZE + sectsize);
+  dev->zr_outbuf = kmm_malloc(LZF_TYPE1_HDR_SIZE + sectsize);
+  dev->zr_htab   = kmm_malloc(sizeof(lzf_state_t));
+  if (dev->zr_slot == NULL || dev->zr_len == NULL ||
+      dev->zr_inbuf == NULL || dev->zr_outbuf == NULL ||
+      dev->zr_htab == NULL)
+    {
+      goto errout;
+    }
+
+  /* Evenly spaced size classes up to the sector size.  The pools grow by
+   * a few sectors worth of memory at a time.
+   */
+
+  step = ALIGN_UP(sectsize / ZRAM_NCLASSES, sizeof(uintptr_t));
+  for (i = 0; i < ZRAM_NCLASSES; i++)
+    {
+      poolsize[i] = step * (i + 1);
+    }
+
+  expandsize = 1 << fls(4 * sectsize - 1);
+  dev->zr_pool = mempool_multiple_init("zram", poolsize, ZRAM_NCLASSES,
+                                       zram_pool_alloc, zram_pool_size,
+                                       zram_pool_free, dev, 0, expandsize,
+                                       expandsize);
+  if (dev->zr_pool == NULL)
+    {
+      goto errout;
+    }
+
+  snprintf(devname, sizeof(devname), "/dev/zram%d", minor);
+
+  ret = register_blockdriver(devname, &g_zram_bops, 0, dev);
+  if (ret < 0)
+    {
+      ferr("ERROR: register_blockdriver failed: %d\n", ret);
+      goto errout;
+    }
+
+  return OK;
+
+errout:
+  zram_destroy(dev);
+  return ret;
+}
+
+#endif /* CONFIG_DRVR_ZRAM */
@@ -31,6 +31,7 @@
 #include <nuttx/nuttx.h>
 #include <nuttx/kmalloc.h>
 #include <nuttx/mtd/mtd.h>
+#include <nuttx/mtd/mtd_gc.h>
 #include <nuttx/lib/lib.h>
 
 #include <dhara/map.h>
@@ -75,6 +76,10 @@ struct dhara_dev_s
 
   struct dq_queue_s readcache;
   dhara_pagecache_t readpage[CONFIG_DHARA_READ_NCACHES];
+
+#ifdef CONFIG_MTD_GC
+  struct mtd_gc_s gc;             /* Garbage collection scheduler */
+#endif
 };
 
 typedef struct dhara_dev_s dhara_dev_t;
@@ -101,6 +106,10 @@ static int     dhara_ioctl(FAR struct inode *inode,
 #ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
 static int     dhara_unlink(FAR struct inode *inode);
 #endif
+#ifdef CONFIG_MTD_GC
+static uint32_t dhara_gc_avail(FAR void *priv);
+static int     dhara_gc_collect(FAR void *priv, bool idle);
+#endif
 
 /****************************************************************************
  * Private Data
@@ -119,6 +128,14 @@ static const struct block_operations g_dhara_bops =
 #endif
 };
 
+#ifdef CONFIG_MTD_GC
+static const struct mtd_gc_ops_s g_dhara_gcops =
+{
+  dhara_gc_avail,   /* avail */
+  dhara_gc_collect  /* collect */
+};
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -325,6 +342,9 @@ static int dhara_close(FAR struct inode *inode)
 
   if (dev->refs == 0 && dev->unlinked)
     {
+#ifdef CONFIG_MTD_GC
+      mtd_gc_uninitialize(&dev->gc);
+#endif
       nxmutex_destroy(&dev->lock);
       dhara_deinit_readcache(dev);
       kmm_free(dev->pagebuf);
@@ -401,6 +421,16 @@ static ssize_t dhara_write(FAR struct inode *inode,
   while (nsectors-- > 0)
     {
       dhara_error_t err;
+
+#ifdef CONFIG_MTD_GC
+      /* Make room for this sector ahead of dhara_map_write(), which would
+       * otherwise collect a full CONFIG_DHARA_GC_RATIO round itself.  If
+       * nothing can be reclaimed here, dhara still gets to try.
+       */
+
+      mtd_gc_reserve(&dev->gc, 1);
+#endif
+
       ret = dhara_map_write(&dev->map,
                             start_sector,
                             buffer,
@@ -418,6 +448,9 @@ static ssize_t dhara_write(FAR struct inode *inode,
       buffer += dev->geo.blocksize;
     }
 
+#ifdef CONFIG_MTD_GC
+  mtd_gc_kick(&dev->gc);
+#endif
   nxmutex_unlock(&dev->lock);
   return nwrite ? nwrite : ret;
 }
@@ -470,6 +503,20 @@ static int dhara_ioctl(FAR struct inode *inode,
   DEBUGASSERT(inode->i_private);
   dev = inode->i_private;
 
+#ifdef CONFIG_MTD_GC
+  if (cmd == BIOC_GCSTATS || cmd == BIOC_GCRESET)
+    {
+      /* Get and/or reset the garbage collection statistics */
+
+      nxmutex_lock(&dev->lock);
+      mtd_gc_getstats(&dev->gc, cmd == BIOC_GCSTATS ?
+                      (FAR struct mtd_gc_stats_s *)((uintptr_t)arg) : NULL,
+                      cmd == BIOC_GCRESET);
+      nxmutex_unlock(&dev->lock);
+      return OK;
+    }
+#endif
+
   /* No other block driver ioctl commands are not recognized by this
    * driver.  Other possible MTD driver ioctl commands are passed through
    * to the MTD driver (unchanged).
@@ -504,6 +551,9 @@ static int dhara_unlink(FAR struct inode *inode)
 
   if (dev->refs == 0)
     {
+#ifdef CONFIG_MTD_GC
+      mtd_gc_uninitialize(&dev->gc);
+#endif
       nxmutex_destroy(&dev->lock);
       dhara_deinit_readcache(dev);
       kmm_free(dev->pagebuf);
@@ -514,6 +564,65 @@ static int dhara_unlink(FAR struct inode *inode)
 }
 #endif
 
+/****************************************************************************
+ * Name: dhara_gc_avail
+ *
+ * Description: Garbage collection scheduler callback returning the number
+ *              of pages that can be written before dhara_map_write() has
+ *              to collect garbage itself.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_GC
+static uint32_t dhara_gc_avail(FAR void *priv)
+{
+  FAR dhara_dev_t *dev = priv;
+  dhara_page_t capacity = dhara_map_capacity(&dev->map);
+  dhara_page_t size = dhara_journal_size(&dev->map.journal);
+
+  return capacity > size ? capacity - size : 0;
+}
+
+/****************************************************************************
+ * Name: dhara_gc_collect
+ *
+ * Description: Garbage collection scheduler callback.  Advances the
+ *              journal tail by one erase block worth of pages, which
+ *              copies live sectors forward and drops the garbage.
+ *
+ ****************************************************************************/
+
+static int dhara_gc_collect(FAR void *priv, bool idle)
+{
+  FAR dhara_dev_t *dev = priv;
+  uint32_t before;
+  int i;
+
+  if (dhara_map_size(&dev->map) == 0)
+    {
+      return 0;
+    }
+
+  before = dhara_gc_avail(dev);
+  for (i = 0; i < dev->blkper; i++)
+    {
+      dhara_error_t err;
+
+      if (dhara_map_gc(&dev->map, &err) < 0)
+        {
+          ferr("Garbage collection failed: %s\n", dhara_strerror(err));
+          return dhara_convert_result(err);
+        }
+    }
+
+  /* A tail full of live sectors is only moved around, report that there
+   * was nothing to reclaim so that the scheduler stops.
+   */
+
+  return dhara_gc_avail(dev) > before;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -748,6 +857,16 @@ int dhara_initialize_by_path(FAR const char *path,
 
   dhara_map_resume(&dev->map, NULL);
 
+#ifdef CONFIG_MTD_GC
+  /* Collect in the background below 1/16 of the capacity free and stop
+   * at 1/8.
+   */
+
+  mtd_gc_initialize(&dev->gc, &g_dhara_gcops, dev, &dev->lock,
+                    dhara_map_capacity(&dev->map) >> 4,
+                    dhara_map_capacity(&dev->map) >> 3);
+#endif
+
   /* Inode private data is a reference to the
    * DHARA_MTDBLOCK device structure
    */
@@ -720,6 +720,21 @@ static int ftl_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
       rwb_flush(&dev->rwb);
 #endif
     }
+#if defined(FTL_HAVE_RWBUFFER) && defined(CONFIG_DRVR_RWBUFFER_STATS)
+  else if (cmd == BIOC_RWBSTATS)
+    {
+      if (arg == 0)
+        {
+          return -EINVAL;
+        }
+
+      return rwb_getstats(&dev->rwb, (FAR struct rwb_stats_s *)arg, false);
+    }
+  else if (cmd == BIOC_RWBRESET)
+    {
+      return rwb_getstats(&dev->rwb, NULL, true);
+    }
+#endif
 
   /* No other block driver ioctl commands are not recognized by this
    * driver.  Other possible MTD driver ioctl commands are passed through
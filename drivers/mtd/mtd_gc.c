@@ -0,0 +1,235 @@
+/****************************************************************************
+ * drivers/mtd/mtd_gc.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* Garbage collection scheduler shared by the flash translation layers.
+ *
+ * Reclaiming an erase block means relocating its live data and erasing
+ * it, which may take hundreds of milliseconds on NOR parts.  The scheduler
+ * moves that work out of the write path: once free space drops below a
+ * low watermark, a worker on the low priority work queue reclaims one
+ * erase block at a time while the device is idle, until the high
+ * watermark is reached.  Writers only reclaim what they need right now.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+#include <string.h>
+#include <time.h>
+
+#include <nuttx/clock.h>
+#include <nuttx/mtd/mtd_gc.h>
+
+#ifdef CONFIG_MTD_GC
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_MTD_GC_IDLE_DELAY
+#  define CONFIG_MTD_GC_IDLE_DELAY 100
+#endif
+
+#define MTD_GC_IDLE_TICKS MSEC2TICK(CONFIG_MTD_GC_IDLE_DELAY)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mtd_gc_worker
+ *
+ * Description:
+ *   Reclaim one unit in the background and requeue while below the high
+ *   watermark.  The device lock is dropped between units so that a writer
+ *   waits for at most one erase block.
+ *
+ ****************************************************************************/
+
+static void mtd_gc_worker(FAR void *arg)
+{
+  FAR struct mtd_gc_s *gc = arg;
+  bool again = false;
+  int ret;
+
+  ret = nxmutex_lock(gc->lock);
+  if (ret < 0)
+    {
+      return;
+    }
+
+  if (gc->ops->avail(gc->priv) < gc->hiwater)
+    {
+      ret = gc->ops->collect(gc->priv, true);
+      if (ret > 0)
+        {
+          gc->stats.bgcollects++;
+          again = gc->ops->avail(gc->priv) < gc->hiwater;
+        }
+      else if (ret < 0)
+        {
+          ferr("ERROR: Background collection failed: %d\n", ret);
+          gc->stats.errors++;
+        }
+    }
+
+  gc->active = again;
+  if (again)
+    {
+      work_queue(LPWORK, &gc->work, mtd_gc_worker, gc, 0);
+    }
+
+  nxmutex_unlock(gc->lock);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mtd_gc_initialize
+ ****************************************************************************/
+
+void mtd_gc_initialize(FAR struct mtd_gc_s *gc,
+                       FAR const struct mtd_gc_ops_s *ops, FAR void *priv,
+                       FAR mutex_t *lock, uint32_t lowater,
+                       uint32_t hiwater)
+{
+  DEBUGASSERT(gc != NULL && ops != NULL && lock != NULL);
+  DEBUGASSERT(lowater <= hiwater);
+
+  memset(gc, 0, sizeof(*gc));
+  gc->ops     = ops;
+  gc->priv    = priv;
+  gc->lock    = lock;
+  gc->lowater = lowater;
+  gc->hiwater = hiwater;
+}
+
+/****************************************************************************
+ * Name: mtd_gc_uninitialize
+ ****************************************************************************/
+
+void mtd_gc_uninitialize(FAR struct mtd_gc_s *gc)
+{
+  work_cancel_sync(LPWORK, &gc->work);
+}
+
+/****************************************************************************
+ * Name: mtd_gc_kick
+ ****************************************************************************/
+
+void mtd_gc_kick(FAR struct mtd_gc_s *gc)
+{
+  if (gc->active || gc->ops->avail(gc->priv) < gc->lowater)
+    {
+      /* Requeueing pushes the worker back, so it only runs once the
+       * writes have stopped for the idle delay.
+       */
+
+      gc->active = true;
+      work_queue(LPWORK, &gc->work, mtd_gc_worker, gc, MTD_GC_IDLE_TICKS);
+    }
+}
+
+/****************************************************************************
+ * Name: mtd_gc_reserve
+ ****************************************************************************/
+
+int mtd_gc_reserve(FAR struct mtd_gc_s *gc, uint32_t needed)
+{
+  struct timespec ts;
+  clock_t start;
+  uint32_t us;
+  int ret = OK;
+
+  if (gc->ops->avail(gc->priv) >= needed)
+    {
+      return OK;
+    }
+
+  start = perf_gettime();
+  do
+    {
+      ret = gc->ops->collect(gc->priv, false);
+      if (ret <= 0)
+        {
+          if (ret < 0)
+            {
+              gc->stats.errors++;
+            }
+          else
+            {
+              ret = -ENOSPC;
+            }
+
+          break;
+        }
+
+      gc->stats.fgcollects++;
+      ret = OK;
+    }
+  while (gc->ops->avail(gc->priv) < needed);
+
+  perf_convert(perf_gettime() - start, &ts);
+  us = ts.tv_sec * USEC_PER_SEC + ts.tv_nsec / NSEC_PER_USEC;
+
+  gc->stats.fgstalls++;
+  gc->stats.fgtotalus += us;
+  if (us > gc->stats.fgmaxus)
+    {
+      gc->stats.fgmaxus = us;
+    }
+
+  /* The writer caught up with the background worker, let it refill the
+   * reserve as soon as the device goes idle.
+   */
+
+  mtd_gc_kick(gc);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: mtd_gc_getstats
+ ****************************************************************************/
+
+void mtd_gc_getstats(FAR struct mtd_gc_s *gc,
+                     FAR struct mtd_gc_stats_s *stats, bool reset)
+{
+  if (stats != NULL)
+    {
+      memcpy(stats, &gc->stats, sizeof(*stats));
+    }
+
+  if (reset)
+    {
+      memset(&gc->stats, 0, sizeof(gc->stats));
+    }
+}
+
+#endif /* CONFIG_MTD_GC */
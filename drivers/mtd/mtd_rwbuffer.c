@@ -66,6 +66,10 @@
 #  define CONFIG_MTD_NRDBLOCKS 4
 #endif
 
+#ifndef CONFIG_MTD_NRDMINBLOCKS
+#  define CONFIG_MTD_NRDMINBLOCKS 1
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -334,6 +338,23 @@ static int mtd_ioctl(FAR struct mtd_dev_s *dev, int cmd, unsigned long arg)
         }
         break;
 
+#ifdef CONFIG_DRVR_RWBUFFER_STATS
+      case BIOC_RWBSTATS:
+        {
+          FAR struct rwb_stats_s *stats =
+            (FAR struct rwb_stats_s *)((uintptr_t)arg);
+          if (stats != NULL)
+            {
+              ret = rwb_getstats(&priv->rwb, stats, false);
+            }
+        }
+        break;
+
+      case BIOC_RWBRESET:
+        ret = rwb_getstats(&priv->rwb, NULL, true);
+        break;
+#endif
+
       default:
         ret = -ENOTTY; /* Bad command */
         break;
@@ -428,6 +449,7 @@ FAR struct mtd_dev_s *mtd_rwb_initialize(FAR struct mtd_dev_s *mtd)
 #endif
 #ifdef CONFIG_DRVR_READAHEAD
   priv->rwb.rhmaxblocks = CONFIG_MTD_NRDBLOCKS;
+  priv->rwb.rhminblocks = CONFIG_MTD_NRDMINBLOCKS;
 #endif
 
   /* Callouts */
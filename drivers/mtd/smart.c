@@ -46,6 +46,7 @@
 #include <nuttx/fs/fs.h>
 #include <nuttx/fs/ioctl.h>
 #include <nuttx/mtd/mtd.h>
+#include <nuttx/mtd/mtd_gc.h>
 #include <nuttx/mtd/smart.h>
 #include <nuttx/fs/smart.h>
 
@@ -125,6 +126,24 @@
 
 #define SMART_MAX_ALLOCS        10
 
+/* Free sectors that must remain available so that garbage collection can
+ * always relocate a full erase block.
+ */
+
+#define SMART_RESERVED_SECTORS(d) ((d)->sectorsperblk + 4)
+
+/* With background garbage collection the device state is shared with the
+ * collection worker and must be locked.
+ */
+
+#ifdef CONFIG_MTD_GC
+#  define smart_lock(d)         nxmutex_lock(&(d)->lock)
+#  define smart_unlock(d)       nxmutex_unlock(&(d)->lock)
+#else
+#  define smart_lock(d)         OK
+#  define smart_unlock(d)
+#endif
+
 #ifndef CONFIG_MTD_SMART_ALLOC_DEBUG
 #define smart_malloc(d, b, n)   kmm_malloc(b)
 #define smart_zalloc(d, b, n)   kmm_zalloc(b)
@@ -297,6 +316,10 @@ struct smart_struct_s
   size_t                bytesalloc;
   struct smart_alloc_s  alloc[SMART_MAX_ALLOCS];   /* Array of memory allocations */
 #endif
+#ifdef CONFIG_MTD_GC
+  mutex_t               lock;             /* Shared with the GC worker */
+  struct mtd_gc_s       gc;               /* Garbage collection scheduler */
+#endif
 };
 
 #ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
@@ -443,6 +466,11 @@ static int     smart_relocate_static_data(FAR struct smart_struct_s *dev,
                                           uint16_t block);
 #endif
 
+static int     smart_garbagecollect(FAR struct smart_struct_s *dev);
+#ifdef CONFIG_MTD_GC
+static uint32_t smart_gc_avail(FAR void *priv);
+static int     smart_gc_collect(FAR void *priv, bool idle);
+#endif
 static int     smart_relocate_sector(FAR struct smart_struct_s *dev,
                                      uint16_t oldsector, uint16_t newsector);
 
@@ -473,6 +501,14 @@ static const struct block_operations g_bops =
   smart_ioctl     /* ioctl    */
 };
 
+#ifdef CONFIG_MTD_GC
+static const struct mtd_gc_ops_s g_smart_gcops =
+{
+  smart_gc_avail,   /* avail */
+  smart_gc_collect  /* collect */
+};
+#endif
+
 #ifdef CONFIG_SMART_DEV_LOOP
 static const struct file_operations g_fops =
 {
@@ -900,6 +936,7 @@ static ssize_t smart_read(FAR struct inode *inode, FAR unsigned char *buffer,
                           blkcnt_t start_sector, unsigned int nsectors)
 {
   FAR struct smart_struct_s *dev;
+  ssize_t ret;
 
   finfo("SMART: sector: %" PRIuOFF " nsectors: %u\n",
         start_sector, nsectors);
@@ -910,7 +947,16 @@ static ssize_t smart_read(FAR struct inode *inode, FAR unsigned char *buffer,
 #else
   dev = inode->i_private;
 #endif
-  return smart_reload(dev, buffer, start_sector, nsectors);
+
+  ret = smart_lock(dev);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ret = smart_reload(dev, buffer, start_sector, nsectors);
+  smart_unlock(dev);
+  return ret;
 }
 
 /****************************************************************************
@@ -947,7 +993,11 @@ static ssize_t smart_write(FAR struct inode *inode,
   dev = inode->i_private;
 #endif
 
-  /* I think maybe we need to lock on a mutex here */
+  ret = smart_lock(dev);
+  if (ret < 0)
+    {
+      return ret;
+    }
 
   /* Get the aligned block.  Here is is assumed: (1) The number of R/W blocks
    * per erase block is a power of 2, and (2) the erase begins with that same
@@ -989,8 +1039,7 @@ static ssize_t smart_write(FAR struct inode *inode,
               ferr("ERROR: Erase block=%" PRIdOFF " failed: %d\n",
                    eraseblock, ret);
 
-              /* Unlock the mutex if we add one */
-
+              smart_unlock(dev);
               return ret;
             }
         }
@@ -1020,8 +1069,7 @@ static ssize_t smart_write(FAR struct inode *inode,
           ferr("ERROR: Write block %" PRIdOFF " failed: %zd.\n",
                nextblock, nxfrd);
 
-          /* Unlock the mutex if we add one */
-
+          smart_unlock(dev);
           return -EIO;
         }
 
@@ -1033,6 +1081,7 @@ static ssize_t smart_write(FAR struct inode *inode,
       alignedblock += mtdblkspererase;
     }
 
+  smart_unlock(dev);
   return nsectors;
 }
 
@@ -4013,25 +4062,120 @@ retry:
 }
 
 /****************************************************************************
- * Name: smart_garbagecollect
+ * Name: smart_collectblock
  *
- * Description:  Performs garbage collection if needed.  This is determined
- *               by the count of released sectors relative to free and
- *               total sectors.
+ * Description:  Relocates the active data of the erase block with the most
+ *               released sectors and erases it.  When called from the
+ *               background (idle), blocks that are less than half released
+ *               are not worth the erase cycle and are left alone.
+ *
+ * Returned value: 1 if a block was collected, 0 if there was no candidate,
+ *               or a negated errno value on failure.
  *
  ****************************************************************************/
 
-static int smart_garbagecollect(FAR struct smart_struct_s *dev)
+static int smart_collectblock(FAR struct smart_struct_s *dev, bool idle)
 {
   uint16_t collectblock;
   uint16_t releasemax;
-  bool collect = true;
   int x;
   int ret;
 #ifdef CONFIG_MTD_SMART_PACK_COUNTS
   uint8_t count;
 #endif
 
+  /* Find the block with the most released sectors */
+
+  collectblock = 0xffff;
+  releasemax = 0;
+  for (x = 0; x < dev->neraseblocks; x++)
+    {
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+      /* Don't collect blocks that have been worn completely */
+
+      if (smart_get_wear_level(dev, x) >= SMART_WEAR_REORG_THRESHOLD)
+        {
+          continue;
+        }
+#endif
+
+#ifdef CONFIG_MTD_SMART_PACK_COUNTS
+      count = smart_get_count(dev, dev->releasecount, x);
+      if (count > releasemax)
+        {
+          releasemax = count;
+          collectblock = x;
+        }
+#else
+      if (dev->releasecount[x] > releasemax)
+        {
+          releasemax = dev->releasecount[x];
+          collectblock = x;
+        }
+#endif
+    }
+
+  if (collectblock == 0xffff ||
+      (idle && releasemax < (dev->availsectperblk + 1) / 2))
+    {
+      return 0;
+    }
+
+#ifdef CONFIG_SMART_LOCAL_CHECKFREE
+  if (smart_checkfree(dev, __LINE__) != OK)
+    {
+      fwarn("   ...before collecting block %d\n", collectblock);
+    }
+#endif
+
+#ifdef CONFIG_MTD_SMART_PACK_COUNTS
+  finfo("Collecting block %d, free=%d released=%d, "
+        "totalfree=%d, totalrelease=%d\n",
+        collectblock,
+        smart_get_count(dev, dev->freecount, collectblock),
+        smart_get_count(dev, dev->releasecount, collectblock),
+        dev->freesectors, dev->releasesectors);
+#else
+  finfo("Collecting block %d, free=%d released=%d\n",
+        collectblock, dev->freecount[collectblock],
+        dev->releasecount[collectblock]);
+#endif
+
+  /* Relocate the active data in the collection block */
+
+  ret = smart_relocate_block(dev, collectblock);
+
+#ifdef CONFIG_SMART_LOCAL_CHECKFREE
+  if (smart_checkfree(dev, __LINE__) != OK)
+    {
+      fwarn("   ...while collecting block %d\n", collectblock);
+    }
+#endif
+
+  return ret < 0 ? ret : 1;
+}
+
+/****************************************************************************
+ * Name: smart_garbagecollect
+ *
+ * Description:  Performs garbage collection if needed.  This is determined
+ *               by the count of released sectors relative to free and
+ *               total sectors.
+ *
+ *               With CONFIG_MTD_GC, only the reserved free sectors are
+ *               restored here and the rest is left to the background
+ *               worker.
+ *
+ ****************************************************************************/
+
+static int smart_garbagecollect(FAR struct smart_struct_s *dev)
+{
+#ifdef CONFIG_MTD_GC
+  return mtd_gc_reserve(&dev->gc, SMART_RESERVED_SECTORS(dev) + 1);
+#else
+  bool collect = true;
+  int ret;
+
   while (collect)
     {
       collect = false;
@@ -4048,7 +4192,7 @@ static int smart_garbagecollect(FAR struct smart_struct_s *dev)
 
       /* Test if we have more reached our reserved free sector limit */
 
-      if (dev->freesectors <= (dev->sectorsperblk << 0) + 4)
+      if (dev->freesectors <= SMART_RESERVED_SECTORS(dev))
         {
           collect = true;
         }
@@ -4057,92 +4201,49 @@ static int smart_garbagecollect(FAR struct smart_struct_s *dev)
 
       if (collect)
         {
-          /* Find the block with the most released sectors */
-
-          collectblock = 0xffff;
-          releasemax = 0;
-          for (x = 0; x < dev->neraseblocks; x++)
-            {
-#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
-              /* Don't collect blocks that have been worn completely */
-
-              if (smart_get_wear_level(dev, x) >= SMART_WEAR_REORG_THRESHOLD)
-                {
-                  continue;
-                }
-#endif
-
-#ifdef CONFIG_MTD_SMART_PACK_COUNTS
-              count = smart_get_count(dev, dev->releasecount, x);
-              if (count > releasemax)
-                {
-                  releasemax = count;
-                  collectblock = x;
-                }
-#else
-              if (dev->releasecount[x] > releasemax)
-                {
-                  releasemax = dev->releasecount[x];
-                  collectblock = x;
-                }
-#endif
-            }
-
-#if 0
-          releasemax = smart_get_count(dev, dev->releasecount, collectblock);
-#endif
-
-          if (collectblock == 0xffff)
+          ret = smart_collectblock(dev, false);
+          if (ret <= 0)
             {
               /* Need to collect, but no sectors with released blocks! */
 
-              ret = -ENOSPC;
-              goto errout;
+              return ret < 0 ? ret : -ENOSPC;
             }
+        }
+    }
 
-#ifdef CONFIG_SMART_LOCAL_CHECKFREE
-          if (smart_checkfree(dev, __LINE__) != OK)
-            {
-              fwarn("   ...before collecting block %d\n", collectblock);
-            }
-#endif
-
-#ifdef CONFIG_MTD_SMART_PACK_COUNTS
-          finfo("Collecting block %d, free=%d released=%d, "
-                "totalfree=%d, totalrelease=%d\n",
-                collectblock,
-                smart_get_count(dev, dev->freecount, collectblock),
-                smart_get_count(dev, dev->releasecount, collectblock),
-                dev->freesectors, dev->releasesectors);
-#else
-          finfo("Collecting block %d, free=%d released=%d\n",
-                collectblock, dev->freecount[collectblock],
-                dev->releasecount[collectblock]);
+  return OK;
 #endif
+}
 
-          /* Relocate the active data in the collection block */
-
-          ret = smart_relocate_block(dev, collectblock);
+/****************************************************************************
+ * Name: smart_gc_avail
+ *
+ * Description:  Garbage collection scheduler callback returning the number
+ *               of free sectors.
+ *
+ ****************************************************************************/
 
-#ifdef CONFIG_SMART_LOCAL_CHECKFREE
-          if (smart_checkfree(dev, __LINE__) != OK)
-            {
-              fwarn("   ...while collecting block %d\n", collectblock);
-            }
-#endif
+#ifdef CONFIG_MTD_GC
+static uint32_t smart_gc_avail(FAR void *priv)
+{
+  FAR struct smart_struct_s *dev = priv;
 
-          if (ret != OK)
-            {
-              goto errout;
-            }
-        }
-    }
+  return dev->freesectors;
+}
 
-  return OK;
+/****************************************************************************
+ * Name: smart_gc_collect
+ *
+ * Description:  Garbage collection scheduler callback collecting one erase
+ *               block.
+ *
+ ****************************************************************************/
 
-errout:
-  return ret;
+static int smart_gc_collect(FAR void *priv, bool idle)
+{
+  return smart_collectblock(priv, idle);
 }
+#endif
 
 /****************************************************************************
  * Name: smart_write_wearstatus
@@ -5500,6 +5601,12 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
   dev = inode->i_private;
 #endif
 
+  ret = smart_lock(dev);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
   /* Process the ioctl's we care about first, pass any we don't respond
    * to directly to the underlying MTD device.
    */
@@ -5545,14 +5652,14 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
       /* Allocate a logical sector for the upper layer file system */
 
       ret = smart_allocsector(dev, arg);
-      goto ok_out;
+      goto kick_out;
 
     case BIOC_FREESECT:
 
       /* Free the specified logical sector */
 
       ret = smart_freesector(dev, arg);
-      goto ok_out;
+      goto kick_out;
 
     case BIOC_WRITESECT:
 
@@ -5569,7 +5676,7 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
         }
 #endif
 
-      goto ok_out;
+      goto kick_out;
 
 #if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
     case BIOC_GETPROCFSD:
@@ -5610,6 +5717,19 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
       goto ok_out;
 #endif
 
+#ifdef CONFIG_MTD_GC
+    case BIOC_GCSTATS:
+    case BIOC_GCRESET:
+
+      /* Get and/or reset the garbage collection statistics */
+
+      mtd_gc_getstats(&dev->gc, cmd == BIOC_GCSTATS ?
+                      (FAR struct mtd_gc_stats_s *)((uintptr_t)arg) : NULL,
+                      cmd == BIOC_GCRESET);
+      ret = OK;
+      goto ok_out;
+#endif
+
     case BIOC_DEBUGCMD:
 #if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
       debug_data = (FAR struct mtd_smart_debug_data_s *)arg;
@@ -5638,7 +5758,19 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
       ferr("ERROR: MTD ioctl(%04x) failed: %d\n", cmd, ret);
     }
 
+  goto ok_out;
+
+kick_out:
+#ifdef CONFIG_MTD_GC
+  /* Let the background worker know the device is busy and whether it
+   * is running short of free sectors.
+   */
+
+  mtd_gc_kick(&dev->gc);
+#endif
+
 ok_out:
+  smart_unlock(dev);
   return ret;
 }
 
@@ -6181,6 +6313,9 @@ int smart_initialize(int minor, FAR struct mtd_dev_s *mtd,
       /* Initialize the SMART device structure */
 
       dev->mtd = mtd;
+#ifdef CONFIG_MTD_GC
+      nxmutex_init(&dev->lock);
+#endif
 
       /* Get the device geometry. (casting to uintptr_t first eliminates
        * complaints on some architectures where the sizeof long is different
@@ -6226,6 +6361,16 @@ int smart_initialize(int minor, FAR struct mtd_dev_s *mtd,
       dev->lastallocblock = 0;
       dev->debuglevel     = 0;
 
+#ifdef CONFIG_MTD_GC
+      /* Collect in the background below 1/16 of the device free and stop
+       * at 1/8, on top of the sectors reserved for collection itself.
+       */
+
+      mtd_gc_initialize(&dev->gc, &g_smart_gcops, dev, &dev->lock,
+                        SMART_RESERVED_SECTORS(dev) + (totalsectors >> 4),
+                        SMART_RESERVED_SECTORS(dev) + (totalsectors >> 3));
+#endif
+
       /* Mark the device format status an unknown */
 
       dev->formatstatus = SMART_FMT_STAT_UNKNOWN;
@@ -6329,6 +6474,9 @@ errout:
       smart_free(dev, rootdirdev);
     }
 #endif
+#ifdef CONFIG_MTD_GC
+  nxmutex_destroy(&dev->lock);
+#endif
 
   kmm_free(dev);
   return ret;
@@ -6459,6 +6607,11 @@ static int smart_loteardown(FAR const char *devname)
 
   close_blockdriver(inode);
 
+#ifdef CONFIG_MTD_GC
+  mtd_gc_uninitialize(&dev->gc);
+  nxmutex_destroy(&dev->lock);
+#endif
+
   /* Now teardown the filemtd */
 
   filemtd_teardown(dev->mtd);
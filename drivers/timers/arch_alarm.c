@@ -28,10 +28,24 @@
 #include <nuttx/clock.h>
 #include <nuttx/timers/arch_alarm.h>
 
+#ifdef CONFIG_HRTIMER
+#  include <sys/param.h>
+#  include <nuttx/hrtimer.h>
+#  include <nuttx/spinlock.h>
+#endif
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* The periodic tick is not re-armed when the oneshot is shared with the
+ * high resolution timers.
+ */
+
+#if defined(CONFIG_HRTIMER) && !defined(CONFIG_SCHED_TICKLESS)
+#  error CONFIG_HRTIMER requires CONFIG_SCHED_TICKLESS
+#endif
+
 #define CONFIG_BOARD_LOOPSPER100USEC ((CONFIG_BOARD_LOOPSPERMSEC+5)/10)
 #define CONFIG_BOARD_LOOPSPER10USEC  ((CONFIG_BOARD_LOOPSPERMSEC+50)/100)
 #define CONFIG_BOARD_LOOPSPERUSEC    ((CONFIG_BOARD_LOOPSPERMSEC+500)/1000)
@@ -46,6 +60,18 @@ static FAR struct oneshot_lowerhalf_s *g_oneshot_lower;
 static clock_t g_current_tick;
 #endif
 
+#ifdef CONFIG_HRTIMER
+/* The oneshot timer is shared by the scheduler alarm and the high
+ * resolution timers.  Both expirations are kept here as absolute times in
+ * nanoseconds (UINT64_MAX when not armed) and the oneshot is programmed
+ * for whichever comes first.
+ */
+
+static uint64_t g_alarm_sched = UINT64_MAX;
+static uint64_t g_alarm_hrtimer = UINT64_MAX;
+static spinlock_t g_alarm_lock = SP_UNLOCKED;
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -97,10 +123,84 @@ static void udelay_coarse(useconds_t microseconds)
     }
 }
 
+#ifdef CONFIG_HRTIMER
+static void oneshot_callback(FAR struct oneshot_lowerhalf_s *lower,
+                             FAR void *arg);
+
+static uint64_t oneshot_current_nsec(void)
+{
+  struct timespec ts;
+
+  ONESHOT_CURRENT(g_oneshot_lower, &ts);
+  return clock_time2nsec(&ts);
+}
+
+/* Program the oneshot for the earlier of the two expirations.  Must be
+ * called with g_alarm_lock held.
+ */
+
+static int oneshot_reprogram(void)
+{
+  struct timespec ts;
+  uint64_t expired;
+  uint64_t now;
+
+  expired = MIN(g_alarm_sched, g_alarm_hrtimer);
+  if (expired == UINT64_MAX)
+    {
+      return ONESHOT_CANCEL(g_oneshot_lower, &ts);
+    }
+
+  now = oneshot_current_nsec();
+  clock_nsec2time(&ts, expired > now ? expired - now : 0);
+  return ONESHOT_START(g_oneshot_lower, oneshot_callback, NULL, &ts);
+}
+#endif
+
 static void oneshot_callback(FAR struct oneshot_lowerhalf_s *lower,
                              FAR void *arg)
 {
   clock_t now;
+
+#ifdef CONFIG_HRTIMER
+  irqstate_t flags;
+  uint64_t nsec;
+  bool hrtimer = false;
+  bool sched = false;
+
+  /* Find out which of the two users the expiration is for and rearm the
+   * oneshot for the other one before running any handler.
+   */
+
+  flags = spin_lock_irqsave(&g_alarm_lock);
+
+  nsec = oneshot_current_nsec();
+  if (g_alarm_hrtimer <= nsec)
+    {
+      g_alarm_hrtimer = UINT64_MAX;
+      hrtimer = true;
+    }
+
+  if (g_alarm_sched <= nsec)
+    {
+      g_alarm_sched = UINT64_MAX;
+      sched = true;
+    }
+
+  oneshot_reprogram();
+  spin_unlock_irqrestore(&g_alarm_lock, flags);
+
+  if (hrtimer)
+    {
+      hrtimer_process(nsec);
+    }
+
+  if (!sched)
+    {
+      return;
+    }
+#endif
+
   ONESHOT_TICK_CURRENT(g_oneshot_lower, &now);
 
 #ifdef CONFIG_SCHED_TICKLESS
@@ -140,12 +240,22 @@ void up_alarm_set_lowerhalf(FAR struct oneshot_lowerhalf_s *lower)
 #ifdef CONFIG_SCHED_TICKLESS
   clock_t ticks;
 #endif
+#ifdef CONFIG_HRTIMER
+  irqstate_t flags;
+#endif
 
   g_oneshot_lower = lower;
 
 #ifdef CONFIG_SCHED_TICKLESS
   ONESHOT_TICK_MAX_DELAY(g_oneshot_lower, &ticks);
   g_oneshot_maxticks = ticks < UINT32_MAX ? ticks : UINT32_MAX;
+#  ifdef CONFIG_HRTIMER
+  /* Arm any high resolution timer started before the lower half */
+
+  flags = spin_lock_irqsave(&g_alarm_lock);
+  oneshot_reprogram();
+  spin_unlock_irqrestore(&g_alarm_lock, flags);
+#  endif
 #else
   ONESHOT_TICK_CURRENT(g_oneshot_lower, &g_current_tick);
   ONESHOT_TICK_START(g_oneshot_lower, oneshot_callback, NULL, 1);
@@ -277,7 +387,16 @@ int weak_function up_alarm_tick_cancel(FAR clock_t *ticks)
 
   if (g_oneshot_lower != NULL)
     {
+#ifdef CONFIG_HRTIMER
+      irqstate_t flags;
+
+      flags = spin_lock_irqsave(&g_alarm_lock);
+      g_alarm_sched = UINT64_MAX;
+      ret = oneshot_reprogram();
+      spin_unlock_irqrestore(&g_alarm_lock, flags);
+#else
       ret = ONESHOT_TICK_CANCEL(g_oneshot_lower, ticks);
+#endif
       ONESHOT_TICK_CURRENT(g_oneshot_lower, ticks);
     }
 
@@ -316,6 +435,14 @@ int weak_function up_alarm_tick_start(clock_t ticks)
 
   if (g_oneshot_lower != NULL)
     {
+#ifdef CONFIG_HRTIMER
+      irqstate_t flags;
+
+      flags = spin_lock_irqsave(&g_alarm_lock);
+      g_alarm_sched = (uint64_t)ticks * NSEC_PER_TICK;
+      ret = oneshot_reprogram();
+      spin_unlock_irqrestore(&g_alarm_lock, flags);
+#else
       clock_t now;
       clock_t delta;
 
@@ -328,8 +455,45 @@ int weak_function up_alarm_tick_start(clock_t ticks)
 
       ret = ONESHOT_TICK_START(g_oneshot_lower, oneshot_callback,
                                NULL, delta);
+#endif
+    }
+
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Name: up_hrtimer_start
+ *
+ * Description:
+ *   Program the expiration of the earliest high resolution timer.
+ *   hrtimer_process() will be called from the oneshot callback when that
+ *   time is reached.
+ *
+ * Input Parameters:
+ *   expired - The absolute time in nanoseconds, UINT64_MAX for none.
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success; a negated errno value is returned on
+ *   any failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_HRTIMER
+int up_hrtimer_start(uint64_t expired)
+{
+  irqstate_t flags;
+  int ret = -EAGAIN;
+
+  flags = spin_lock_irqsave(&g_alarm_lock);
+  g_alarm_hrtimer = expired;
+
+  if (g_oneshot_lower != NULL)
+    {
+      ret = oneshot_reprogram();
     }
 
+  spin_unlock_irqrestore(&g_alarm_lock, flags);
   return ret;
 }
 #endif
@@ -27,6 +27,7 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <limits.h>
 #include <string.h>
 #include <assert.h>
 #include <execinfo.h>
@@ -58,12 +59,59 @@
 #include "inode/inode.h"
 #include "fs_heap.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The maximum number of rows in a file list */
+
+#define FILES_MAXROWS \
+  ((OPEN_MAX + CONFIG_NFILE_DESCRIPTORS_PER_BLOCK - 1) / \
+   CONFIG_NFILE_DESCRIPTORS_PER_BLOCK)
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: files_tryref
+ *
+ * Description:
+ *   Take a reference on a file unless its reference count already dropped
+ *   to zero, i.e. the file is being closed.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_REFCOUNT
+static bool files_tryref(FAR struct file *filep)
+{
+  int refs = atomic_load(&filep->f_refs);
+
+  do
+    {
+      if (refs == 0)
+        {
+          return false;
+        }
+    }
+  while (!atomic_compare_exchange_weak_explicit(&filep->f_refs, &refs,
+                                                refs + 1,
+                                                memory_order_acquire,
+                                                memory_order_relaxed));
+
+  return true;
+}
+#endif
+
 /****************************************************************************
  * Name: files_fget_by_index
+ *
+ * Description:
+ *   Get the file at (l1, l2).  Plain lookups (new == NULL) are lock-free:
+ *   the rows never move once published, so the only synchronization needed
+ *   is the atomic reference taken on the file itself.  Lookups that may
+ *   claim an empty slot (new != NULL) still serialize with allocation.
+ *
  ****************************************************************************/
 
 static FAR struct file *files_fget_by_index(FAR struct filelist *list,
@@ -72,43 +120,56 @@ static FAR struct file *files_fget_by_index(FAR struct filelist *list,
   FAR struct file *filep;
   irqstate_t flags;
 
-  flags = spin_lock_irqsave(NULL);
-
   filep = &list->fl_files[l1][l2];
-#ifdef CONFIG_FS_REFCOUNT
-  if (filep->f_inode != NULL)
+
+  if (new == NULL)
     {
+      if (filep->f_inode == NULL)
+        {
+          return NULL;
+        }
+
+#ifdef CONFIG_FS_REFCOUNT
       /* When the reference count is zero but the inode has not yet been
        * released, At this point we should return a null pointer
        */
 
-      if (filep->f_refs == 0)
+      if (!files_tryref(filep))
         {
-          filep = NULL;
+          return NULL;
         }
-      else
+
+      /* The slot may have been closed before we got the reference */
+
+      if (filep->f_inode == NULL)
         {
-          filep->f_refs++;
+          fs_putfilep(filep);
+          return NULL;
         }
+#endif
+
+      return filep;
     }
-  else if (new == NULL)
+
+  flags = spin_lock_irqsave(NULL);
+
+#ifdef CONFIG_FS_REFCOUNT
+  if (filep->f_inode != NULL)
     {
-      filep = NULL;
+      if (!files_tryref(filep))
+        {
+          filep = NULL;
+        }
     }
-  else if (filep->f_refs)
+  else if (atomic_load(&filep->f_refs))
     {
-      filep->f_refs++;
+      atomic_fetch_add(&filep->f_refs, 1);
     }
   else
     {
-      filep->f_refs = 2;
+      atomic_store(&filep->f_refs, 2);
       *new = true;
     }
-#else
-  if (filep->f_inode == NULL && new == NULL)
-    {
-      filep = NULL;
-    }
 #endif
 
   spin_unlock_irqrestore(NULL, flags);
@@ -117,90 +178,91 @@ static FAR struct file *files_fget_by_index(FAR struct filelist *list,
 
 /****************************************************************************
  * Name: files_extend
+ *
+ * Description:
+ *   Grow the file list to 'row' rows.  The row pointer array is allocated
+ *   once at its maximum size and new rows are appended in order, each one
+ *   made visible to lock-free readers by the release store of fl_rows.
+ *   Nothing that a reader may be looking at is ever moved or freed here.
+ *
  ****************************************************************************/
 
 static int files_extend(FAR struct filelist *list, size_t row)
 {
   FAR struct file **files;
-  uint8_t orig_rows;
-  FAR void *tmp;
-  int flags;
-  int i;
-  int j;
+  FAR struct file *block;
+  irqstate_t flags;
+  size_t i;
 
-  orig_rows = list->fl_rows;
-  if (row <= orig_rows)
+  i = atomic_load(&list->fl_rows);
+  if (row <= i)
     {
       return 0;
     }
 
-  if (CONFIG_NFILE_DESCRIPTORS_PER_BLOCK * orig_rows > OPEN_MAX)
+  if (row > FILES_MAXROWS)
     {
       files_dumplist(list);
       return -EMFILE;
     }
 
-  files = fs_heap_malloc(sizeof(FAR struct file *) * row);
-  DEBUGASSERT(files);
-  if (files == NULL)
+  if (list->fl_files == NULL)
     {
-      return -ENFILE;
-    }
+      files = fs_heap_zalloc(sizeof(FAR struct file *) * FILES_MAXROWS);
+      DEBUGASSERT(files);
+      if (files == NULL)
+        {
+          return -ENFILE;
+        }
 
-  i = orig_rows;
-  do
-    {
-      files[i] = fs_heap_zalloc(sizeof(struct file) *
-                            CONFIG_NFILE_DESCRIPTORS_PER_BLOCK);
-      if (files[i] == NULL)
+      flags = spin_lock_irqsave(NULL);
+      if (list->fl_files == NULL)
         {
-          while (--i >= orig_rows)
-            {
-              fs_heap_free(files[i]);
-            }
+          list->fl_files = files;
+          files = NULL;
+        }
 
+      spin_unlock_irqrestore(NULL, flags);
+
+      if (files != NULL)
+        {
           fs_heap_free(files);
-          return -ENFILE;
         }
     }
-  while (++i < row);
-
-  flags = spin_lock_irqsave(NULL);
-
-  /* To avoid race condition, if the file list is updated by other threads
-   * and list rows is greater or equal than temp list,
-   * release the obsolete buffers
-   */
 
-  if (orig_rows != list->fl_rows && list->fl_rows >= row)
+  for (; i < row; i++)
     {
-      spin_unlock_irqrestore(NULL, flags);
-
-      for (j = orig_rows; j < i; j++)
+      block = fs_heap_zalloc(sizeof(struct file) *
+                             CONFIG_NFILE_DESCRIPTORS_PER_BLOCK);
+      if (block == NULL)
         {
-          fs_heap_free(files[j]);
+          return -ENFILE;
         }
 
-      fs_heap_free(files);
+      flags = spin_lock_irqsave(NULL);
 
-      return OK;
-    }
+      /* To avoid race condition, if the row was already added by another
+       * thread, release the obsolete buffer.
+       */
 
-  if (list->fl_files != NULL)
-    {
-      memcpy(files, list->fl_files,
-             list->fl_rows * sizeof(FAR struct file *));
-    }
+      if (list->fl_files[i] == NULL)
+        {
+          list->fl_files[i] = block;
+          block = NULL;
+        }
 
-  tmp = list->fl_files;
-  list->fl_files = files;
-  list->fl_rows = row;
+      if (atomic_load(&list->fl_rows) <= i)
+        {
+          atomic_store_explicit(&list->fl_rows, i + 1,
+                                memory_order_release);
+        }
 
-  spin_unlock_irqrestore(NULL, flags);
+      spin_unlock_irqrestore(NULL, flags);
 
-  if (tmp != NULL)
-    {
-      fs_heap_free(tmp);
+      if (block != NULL)
+        {
+          fs_heap_free(block);
+        }
     }
 
   return OK;
@@ -218,7 +280,8 @@ static void task_fssync(FAR struct tcb_s *tcb, FAR void *arg)
       return;
     }
 
-  for (i = 0; i < list->fl_rows; i++)
+  for (i = 0; i < atomic_load_explicit(&list->fl_rows,
+                                       memory_order_acquire); i++)
     {
       for (j = 0; j < CONFIG_NFILE_DESCRIPTORS_PER_BLOCK; j++)
         {
@@ -493,7 +556,7 @@ void files_putlist(FAR struct filelist *list)
    * because there should not be any references in this context.
    */
 
-  for (i = list->fl_rows - 1; i >= 0; i--)
+  for (i = atomic_load(&list->fl_rows) - 1; i >= 0; i--)
     {
       for (j = CONFIG_NFILE_DESCRIPTORS_PER_BLOCK - 1; j >= 0; j--)
         {
@@ -501,10 +564,11 @@ void files_putlist(FAR struct filelist *list)
         }
 
       fs_heap_free(list->fl_files[i]);
-      list->fl_rows--;
+      atomic_store(&list->fl_rows, i);
     }
 
   fs_heap_free(list->fl_files);
+  list->fl_files = NULL;
 }
 
 /****************************************************************************
@@ -523,7 +587,12 @@ void files_putlist(FAR struct filelist *list)
 
 int files_countlist(FAR struct filelist *list)
 {
-  return list->fl_rows * CONFIG_NFILE_DESCRIPTORS_PER_BLOCK;
+  /* Pairs with the release store in files_extend(): every row below the
+   * returned count is guaranteed to be visible.
+   */
+
+  return atomic_load_explicit(&list->fl_rows, memory_order_acquire) *
+         CONFIG_NFILE_DESCRIPTORS_PER_BLOCK;
 }
 
 /****************************************************************************
@@ -581,7 +650,7 @@ int file_allocate_from_tcb(FAR struct tcb_s *tcb, FAR struct inode *inode,
 
   for (; ; i++, j = 0)
     {
-      if (i >= list->fl_rows)
+      if (i >= atomic_load(&list->fl_rows))
         {
           spin_unlock_irqrestore(NULL, flags);
 
@@ -603,15 +672,21 @@ int file_allocate_from_tcb(FAR struct tcb_s *tcb, FAR struct inode *inode,
               filep->f_pos         = pos;
               filep->f_inode       = inode;
               filep->f_priv        = priv;
-#ifdef CONFIG_FS_REFCOUNT
-              filep->f_refs        = 1;
-#endif
 #ifdef CONFIG_FDSAN
               filep->f_tag_fdsan   = 0;
 #endif
 #ifdef CONFIG_FDCHECK
               filep->f_tag_fdcheck = 0;
 #endif
+#ifdef CONFIG_FS_REFCOUNT
+
+              /* Publish the reference last, lock-free lookups only use the
+               * file once they managed to take a reference on it.
+               */
+
+              atomic_store_explicit(&filep->f_refs, 1,
+                                    memory_order_release);
+#endif
 
               goto found;
             }
@@ -674,7 +749,8 @@ int files_duplist(FAR struct filelist *plist, FAR struct filelist *clist,
   int i;
   int j;
 
-  for (i = 0; i < plist->fl_rows; i++)
+  for (i = 0; i < atomic_load_explicit(&plist->fl_rows,
+                                       memory_order_acquire); i++)
     {
       for (j = 0; j < CONFIG_NFILE_DESCRIPTORS_PER_BLOCK; j++)
         {
@@ -834,12 +910,8 @@ void fs_reffilep(FAR struct file *filep)
 {
   /* This interface is used to increase the reference count of filep */
 
-  irqstate_t flags;
-
   DEBUGASSERT(filep);
-  flags = spin_lock_irqsave(NULL);
-  filep->f_refs++;
-  spin_unlock_irqrestore(NULL, flags);
+  atomic_fetch_add(&filep->f_refs, 1);
 }
 
 /****************************************************************************
@@ -856,16 +928,11 @@ void fs_reffilep(FAR struct file *filep)
 
 int fs_putfilep(FAR struct file *filep)
 {
-  irqstate_t flags;
   int ret = 0;
   int refs;
 
   DEBUGASSERT(filep);
-  flags = spin_lock_irqsave(NULL);
-
-  refs = --filep->f_refs;
-
-  spin_unlock_irqrestore(NULL, flags);
+  refs = atomic_fetch_sub(&filep->f_refs, 1) - 1;
 
   /* If refs is zero, the close() had called, closing it now. */
 
@@ -35,6 +35,7 @@
 #include <nuttx/kmalloc.h>
 #include <nuttx/mtd/mtd.h>
 #include <nuttx/mutex.h>
+#include <nuttx/wqueue.h>
 
 #include <sys/stat.h>
 #include <sys/statfs.h>
@@ -80,6 +81,9 @@ struct littlefs_mountpt_s
   struct mtd_geometry_s geo;
   struct lfs_config     cfg;
   struct lfs            lfs;
+#ifdef CONFIG_FS_LITTLEFS_BACKGROUND_SCAN
+  struct work_s         scanwork;
+#endif
 };
 
 struct littlefs_attr_s
@@ -1074,6 +1078,38 @@ static int littlefs_rewinddir(FAR struct inode *mountpt,
   return ret;
 }
 
+/****************************************************************************
+ * Name: littlefs_scan_worker
+ *
+ * Description:
+ *   Populate the allocator lookahead in the background after mount with
+ *   lfs_fs_gc(), so that the first writer does not pay for the traversal.
+ *   The mount lock is held for the duration of the scan, so any operation
+ *   racing with it simply waits.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_LITTLEFS_BACKGROUND_SCAN
+static void littlefs_scan_worker(FAR void *arg)
+{
+  FAR struct littlefs_mountpt_s *fs = arg;
+  int ret;
+
+  if (nxmutex_lock(&fs->lock) < 0)
+    {
+      return;
+    }
+
+  ret = littlefs_convert_result(lfs_fs_gc(&fs->lfs));
+  if (ret < 0)
+    {
+      ferr("ERROR: lookahead scan failed: %d\n", ret);
+    }
+
+  nxmutex_unlock(&fs->lock);
+}
+#endif
+
 /****************************************************************************
  * Name: littlefs_bind
  *
@@ -1337,6 +1373,15 @@ static int littlefs_bind(FAR struct inode *driver, FAR const void *data,
         }
     }
 
+#ifdef CONFIG_FS_LITTLEFS_BACKGROUND_SCAN
+  /* lfs_mount() only reads the superblock and metadata root, populate the
+   * allocator in the background so that the first write does not pay for
+   * a full filesystem traversal.
+   */
+
+  work_queue(LPWORK, &fs->scanwork, littlefs_scan_worker, fs, 0);
+#endif
+
   *handle = fs;
   return OK;
 
@@ -1367,6 +1412,12 @@ static int littlefs_unbind(FAR void *handle, FAR struct inode **driver,
   FAR struct inode *drv = fs->drv;
   int ret;
 
+#ifdef CONFIG_FS_LITTLEFS_BACKGROUND_SCAN
+  /* Make sure the lookahead scan is not running or pending */
+
+  work_cancel_sync(LPWORK, &fs->scanwork);
+#endif
+
   /* Unmount */
 
   ret = nxmutex_lock(&fs->lock);
@@ -38,6 +38,7 @@
 #include <nuttx/fs/nxffs.h>
 #include <nuttx/mutex.h>
 #include <nuttx/semaphore.h>
+#include <nuttx/wqueue.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -281,6 +282,12 @@ struct nxffs_volume_s
   FAR struct nxffs_ofile_s *ofiles;    /* A singly-linked list of open files */
   FAR uint8_t              *cache;     /* On cached erase block for general I/O */
   FAR uint8_t              *pack;      /* A full erase block to support packing */
+#ifdef CONFIG_NXFFS_BACKGROUND_SCAN
+  struct work_s             scanwork;  /* Background scan for the free offset */
+  sem_t                     scansem;   /* Held while the scan is in progress */
+  off_t                     scanoffset; /* End of the last inode scanned so far */
+  int                       scanresult; /* Outcome of the background scan */
+#endif
 };
 
 /* This structure describes the state of the blocks on the NXFFS volume */
@@ -356,6 +363,31 @@ extern struct nxffs_volume_s g_volume;
 
 int nxffs_limits(FAR struct nxffs_volume_s *volume);
 
+/****************************************************************************
+ * Name: nxffs_waitscan
+ *
+ * Description:
+ *   Wait for the background scan started by nxffs_initialize() to locate
+ *   the free FLASH region.  Must be called before anything that uses
+ *   volume->froffset, without holding the volume lock.
+ *
+ * Input Parameters:
+ *   volume - Identifies the NXFFS volume
+ *
+ * Returned Value:
+ *   Zero on success. Otherwise, a negated error is returned indicating the
+ *   nature of the failure.
+ *
+ * Defined in nxffs_initialize.c
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_BACKGROUND_SCAN
+int nxffs_waitscan(FAR struct nxffs_volume_s *volume);
+#else
+#  define nxffs_waitscan(v) OK
+#endif
+
 /****************************************************************************
  * Name: nxffs_rdle16
  *
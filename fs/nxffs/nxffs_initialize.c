@@ -40,6 +40,14 @@
 #include "nxffs.h"
 #include "fs_heap.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Number of inode headers examined by each step of the background scan */
+
+#define NXFFS_SCAN_NENTRIES 16
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -124,6 +132,286 @@ const uint8_t g_datamagic[NXFFS_MAGICSIZE] =
 struct nxffs_volume_s g_volume;
 #endif
 
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxffs_firstinode
+ *
+ * Description:
+ *   Compute the lower file system limit: the FLASH offset to the first
+ *   valid inode.  On return, 'offset' is where the search for the last
+ *   inode should continue, and 'noinodes' tells if the volume is empty.
+ *
+ ****************************************************************************/
+
+static int nxffs_firstinode(FAR struct nxffs_volume_s *volume,
+                            FAR off_t *offset, FAR bool *noinodes)
+{
+  FAR struct nxffs_entry_s entry;
+  off_t block;
+  int ret;
+
+  /* Get the offset to the first valid block on the FLASH */
+
+  block = 0;
+  ret = nxffs_validblock(volume, &block);
+  if (ret < 0)
+    {
+      ferr("ERROR: Failed to find a valid block: %d\n", -ret);
+      return ret;
+    }
+
+  /* Then find the first valid inode in or beyond the first valid block */
+
+  *offset   = block * volume->geo.blocksize;
+  *noinodes = false;
+
+  ret = nxffs_nextentry(volume, *offset, &entry);
+  if (ret < 0)
+    {
+      /* The value -ENOENT is special.  This simply means that the FLASH
+       * was searched to the end and no valid inode was found... the file
+       * system is empty (or, in more perverse cases, all inodes are
+       * deleted or corrupted).
+       */
+
+      if (ret != -ENOENT)
+        {
+          ferr("ERROR: nxffs_nextentry failed: %d\n", -ret);
+          return ret;
+        }
+
+      /* Set a flag the just indicates that no inodes were found.  Later,
+       * we will set the location of the first inode to be the same as
+       * the location of the free FLASH region.
+       */
+
+      finfo("No inodes found\n");
+      *noinodes = true;
+    }
+  else
+    {
+      /* Save the offset to the first inode */
+
+      volume->inoffset = entry.hoffset;
+      finfo("First inode at offset %jd\n", (intmax_t)volume->inoffset);
+
+      /* Discard this entry and set the next offset. */
+
+      *offset = nxffs_inodeend(volume, &entry);
+      nxffs_freeentry(&entry);
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxffs_freelimit
+ *
+ * Description:
+ *   Compute the upper file system limit: the FLASH offset to the first
+ *   unused byte after 'offset', the end of the last inode.
+ *
+ ****************************************************************************/
+
+static int nxffs_freelimit(FAR struct nxffs_volume_s *volume, off_t offset,
+                           bool noinodes)
+{
+  int nerased;
+
+  /* No inodes were found after this offset.  Now search for a block of
+   * erased flash.
+   */
+
+  nxffs_ioseek(volume, offset);
+  nerased = 0;
+  for (; ; )
+    {
+      int ch = nxffs_getc(volume, 1);
+      if (ch < 0)
+        {
+          /* Failed to read the next byte... this could mean that the FLASH
+           * is full?
+           */
+
+          if (volume->ioblock + 1 >= volume->nblocks &&
+              volume->iooffset + 1 >= volume->geo.blocksize)
+            {
+              /* Yes.. the FLASH is full.  Force the offsets to the end of
+               * FLASH
+               */
+
+              volume->froffset = volume->nblocks * volume->geo.blocksize;
+              finfo("Assume no free FLASH, froffset: %jd\n",
+                    (intmax_t)volume->froffset);
+              if (noinodes)
+                {
+                  volume->inoffset = volume->froffset;
+                  finfo("No inodes, inoffset: %jd\n",
+                        (intmax_t)volume->inoffset);
+                }
+
+              return OK;
+            }
+
+          /* No?  Then it is some other failure that we do not know how to
+           * handle
+           */
+
+          ferr("ERROR: nxffs_getc failed: %d\n", -ch);
+          return ch;
+        }
+
+      /* Check for another erased byte */
+
+      else if (ch == CONFIG_NXFFS_ERASEDSTATE)
+        {
+          /* If we have encountered NXFFS_NERASED number of consecutive
+           * erased bytes, then presume we have reached the end of valid
+           * data.
+           */
+
+          if (++nerased >= NXFFS_NERASED)
+            {
+              /* Okay.. we have a long stretch of erased FLASH in a valid
+               * FLASH block.  Let's say that this is the beginning of
+               * the free FLASH region.
+               */
+
+              volume->froffset = offset;
+              finfo("Free FLASH region begins at offset: %jd\n",
+                    (intmax_t)volume->froffset);
+              if (noinodes)
+                {
+                  volume->inoffset = offset;
+                  finfo("First inode at offset %jd\n",
+                        (intmax_t)volume->inoffset);
+                }
+
+              return OK;
+            }
+        }
+      else
+        {
+          offset += nerased + 1;
+          nerased = 0;
+        }
+    }
+
+  /* Won't get here */
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxffs_scanworker
+ *
+ * Description:
+ *   Walk the next NXFFS_SCAN_NENTRIES inode headers looking for the end of
+ *   the last inode, then requeue.  The volume lock is only held for one
+ *   step at a time so that lookups and reads proceed during the scan.
+ *   Writers are held off by scansem, so the saved offset stays valid.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_BACKGROUND_SCAN
+static void nxffs_scanworker(FAR void *arg)
+{
+  FAR struct nxffs_volume_s *volume = arg;
+  FAR struct nxffs_entry_s entry;
+  int ret;
+  int i;
+
+  ret = nxmutex_lock(&volume->lock);
+  if (ret < 0)
+    {
+      volume->scanresult = ret;
+      nxsem_post(&volume->scansem);
+      return;
+    }
+
+  for (i = 0; i < NXFFS_SCAN_NENTRIES; i++)
+    {
+      if (nxffs_nextentry(volume, volume->scanoffset, &entry) != OK)
+        {
+          break;
+        }
+
+      volume->scanoffset = nxffs_inodeend(volume, &entry);
+      nxffs_freeentry(&entry);
+    }
+
+  if (i >= NXFFS_SCAN_NENTRIES)
+    {
+      nxmutex_unlock(&volume->lock);
+      work_queue(LPWORK, &volume->scanwork, nxffs_scanworker, volume, 0);
+      return;
+    }
+
+  finfo("Last inode before offset %jd\n", (intmax_t)volume->scanoffset);
+
+  /* The volume is already mounted, so never reformat it from here.  A
+   * failure is reported to writers and FIOC_* callers by nxffs_waitscan()
+   * and only an explicit FIOC_REFORMAT can recover the volume.
+   */
+
+  ret = nxffs_freelimit(volume, volume->scanoffset, false);
+  if (ret < 0)
+    {
+      ferr("ERROR: Failed to calculate file system limits: %d\n", -ret);
+    }
+
+  volume->scanresult = ret;
+  nxmutex_unlock(&volume->lock);
+  nxsem_post(&volume->scansem);
+}
+
+/****************************************************************************
+ * Name: nxffs_startscan
+ *
+ * Description:
+ *   Compute the lower file system limit now and start the background scan
+ *   for the upper limit.  Empty volumes need no scan at all.
+ *
+ ****************************************************************************/
+
+static int nxffs_startscan(FAR struct nxffs_volume_s *volume)
+{
+  off_t offset;
+  bool noinodes;
+  int ret;
+
+  ret = nxffs_firstinode(volume, &offset, &noinodes);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (noinodes)
+    {
+      return nxffs_freelimit(volume, offset, true);
+    }
+
+  /* Hold off writers until the free FLASH offset is known */
+
+  ret = nxsem_trywait(&volume->scansem);
+  DEBUGASSERT(ret == OK);
+
+  volume->scanoffset = offset;
+  volume->scanresult = OK;
+
+  ret = work_queue(LPWORK, &volume->scanwork, nxffs_scanworker, volume, 0);
+  if (ret < 0)
+    {
+      nxsem_post(&volume->scansem);
+    }
+
+  return ret;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -178,6 +466,9 @@ int nxffs_initialize(FAR struct mtd_dev_s *mtd)
   volume->cblock = (off_t)-1;
   nxmutex_init(&volume->lock);
   nxsem_init(&volume->wrsem, 0, 1);
+#ifdef CONFIG_NXFFS_BACKGROUND_SCAN
+  nxsem_init(&volume->scansem, 0, 1);
+#endif
 
   /* Get the volume geometry. (casting to uintptr_t first eliminates
    * complaints on some architectures where the sizeof long is different
@@ -265,7 +556,11 @@ int nxffs_initialize(FAR struct mtd_dev_s *mtd)
 
   /* Get the file system limits */
 
+#ifdef CONFIG_NXFFS_BACKGROUND_SCAN
+  ret = nxffs_startscan(volume);
+#else
   ret = nxffs_limits(volume);
+#endif
   if (ret == OK)
     {
       return OK;
@@ -311,6 +606,9 @@ errout_with_cache:
 errout_with_volume:
   nxmutex_destroy(&volume->lock);
   nxsem_destroy(&volume->wrsem);
+#ifdef CONFIG_NXFFS_BACKGROUND_SCAN
+  nxsem_destroy(&volume->scansem);
+#endif
 #ifndef CONFIG_NXFFS_PREALLOCATED
   fs_heap_free(volume);
 #endif
@@ -345,61 +643,16 @@ errout_with_volume:
 int nxffs_limits(FAR struct nxffs_volume_s *volume)
 {
   FAR struct nxffs_entry_s entry;
-  off_t block;
   off_t offset;
-  bool noinodes = false;
-  int nerased;
+  bool noinodes;
   int ret;
 
-  /* Get the offset to the first valid block on the FLASH */
-
-  block = 0;
-  ret = nxffs_validblock(volume, &block);
+  ret = nxffs_firstinode(volume, &offset, &noinodes);
   if (ret < 0)
     {
-      ferr("ERROR: Failed to find a valid block: %d\n", -ret);
       return ret;
     }
 
-  /* Then find the first valid inode in or beyond the first valid block */
-
-  offset = block * volume->geo.blocksize;
-  ret = nxffs_nextentry(volume, offset, &entry);
-  if (ret < 0)
-    {
-      /* The value -ENOENT is special.  This simply means that the FLASH
-       * was searched to the end and no valid inode was found... the file
-       * system is empty (or, in more perverse cases, all inodes are
-       * deleted or corrupted).
-       */
-
-      if (ret != -ENOENT)
-        {
-          ferr("ERROR: nxffs_nextentry failed: %d\n", -ret);
-          return ret;
-        }
-
-      /* Set a flag the just indicates that no inodes were found.  Later,
-       * we will set the location of the first inode to be the same as
-       * the location of the free FLASH region.
-       */
-
-      finfo("No inodes found\n");
-      noinodes = true;
-    }
-  else
-    {
-      /* Save the offset to the first inode */
-
-      volume->inoffset = entry.hoffset;
-      finfo("First inode at offset %jd\n", (intmax_t)volume->inoffset);
-
-      /* Discard this entry and set the next offset. */
-
-      offset = nxffs_inodeend(volume, &entry);
-      nxffs_freeentry(&entry);
-    }
-
   /* Now, search for the last valid entry */
 
   if (!noinodes)
@@ -415,89 +668,33 @@ int nxffs_limits(FAR struct nxffs_volume_s *volume)
       finfo("Last inode before offset %jd\n", (intmax_t)offset);
     }
 
-  /* No inodes were found after this offset.  Now search for a block of
-   * erased flash.
-   */
-
-  nxffs_ioseek(volume, offset);
-  nerased = 0;
-  for (; ; )
-    {
-      int ch = nxffs_getc(volume, 1);
-      if (ch < 0)
-        {
-          /* Failed to read the next byte... this could mean that the FLASH
-           * is full?
-           */
-
-          if (volume->ioblock + 1 >= volume->nblocks &&
-              volume->iooffset + 1 >= volume->geo.blocksize)
-            {
-              /* Yes.. the FLASH is full.  Force the offsets to the end of
-               * FLASH
-               */
-
-              volume->froffset = volume->nblocks * volume->geo.blocksize;
-              finfo("Assume no free FLASH, froffset: %jd\n",
-                    (intmax_t)volume->froffset);
-              if (noinodes)
-                {
-                  volume->inoffset = volume->froffset;
-                  finfo("No inodes, inoffset: %jd\n",
-                        (intmax_t)volume->inoffset);
-                }
-
-              return OK;
-            }
-
-          /* No?  Then it is some other failure that we do not know how to
-           * handle
-           */
-
-          ferr("ERROR: nxffs_getc failed: %d\n", -ch);
-          return ch;
-        }
-
-      /* Check for another erased byte */
-
-      else if (ch == CONFIG_NXFFS_ERASEDSTATE)
-        {
-          /* If we have encountered NXFFS_NERASED number of consecutive
-           * erased bytes, then presume we have reached the end of valid
-           * data.
-           */
+  return nxffs_freelimit(volume, offset, noinodes);
+}
 
-          if (++nerased >= NXFFS_NERASED)
-            {
-              /* Okay.. we have a long stretch of erased FLASH in a valid
-               * FLASH block.  Let's say that this is the beginning of
-               * the free FLASH region.
-               */
+/****************************************************************************
+ * Name: nxffs_waitscan
+ *
+ * Description:
+ *   Wait for the background scan started by nxffs_initialize() to locate
+ *   the free FLASH region.
+ *
+ ****************************************************************************/
 
-              volume->froffset = offset;
-              finfo("Free FLASH region begins at offset: %jd\n",
-                    (intmax_t)volume->froffset);
-              if (noinodes)
-                {
-                  volume->inoffset = offset;
-                  finfo("First inode at offset %jd\n",
-                        (intmax_t)volume->inoffset);
-                }
+#ifdef CONFIG_NXFFS_BACKGROUND_SCAN
+int nxffs_waitscan(FAR struct nxffs_volume_s *volume)
+{
+  int ret;
 
-              return OK;
-            }
-        }
-      else
-        {
-          offset += nerased + 1;
-          nerased = 0;
-        }
+  ret = nxsem_wait(&volume->scansem);
+  if (ret < 0)
+    {
+      return ret;
     }
 
-  /* Won't get here */
-
-  return OK;
+  nxsem_post(&volume->scansem);
+  return volume->scanresult;
 }
+#endif
 
 /****************************************************************************
  * Name: nxffs_bind
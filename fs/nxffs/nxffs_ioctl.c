@@ -65,6 +65,16 @@ int nxffs_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
   volume = filep->f_inode->i_private;
   DEBUGASSERT(volume != NULL);
 
+  /* Both reformat and packing must not race with the mount scan.  A failed
+   * scan does not prevent reformatting the volume.
+   */
+
+  ret = nxffs_waitscan(volume);
+  if (ret < 0 && cmd != FIOC_REFORMAT)
+    {
+      goto errout;
+    }
+
   /* Get exclusive access to the volume.  Note that the volume lock
    * protects the open file list.
    */
@@ -94,6 +104,13 @@ int nxffs_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
       /* Re-format the volume -- all is lost */
 
       ret = nxffs_reformat(volume);
+#ifdef CONFIG_NXFFS_BACKGROUND_SCAN
+      if (ret >= 0 && volume->scanresult < 0)
+        {
+          ret = nxffs_limits(volume);
+          volume->scanresult = ret;
+        }
+#endif
     }
 
   else if (cmd == FIOC_OPTIMIZE)
@@ -385,6 +385,15 @@ static inline int nxffs_wropen(FAR struct nxffs_volume_s *volume,
       goto errout;
     }
 
+  /* Writing needs to know where the free FLASH begins */
+
+  ret = nxffs_waitscan(volume);
+  if (ret < 0)
+    {
+      ferr("ERROR: nxffs_waitscan failed: %d\n", ret);
+      goto errout_with_wrsem;
+    }
+
   /* Get exclusive access to the volume.  Note that the volume lock
    * protects the open file list.  Note that lock is ALWAYS taken
    * after wrsem to avoid deadlocks.
@@ -143,6 +143,15 @@ int nxffs_unlink(FAR struct inode *mountpt, FAR const char *relpath)
   /* Get the mountpoint private data from the NuttX inode structure */
 
   volume = mountpt->i_private;
+
+  /* A volume whose mount scan failed is read-only */
+
+  ret = nxffs_waitscan(volume);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
   ret = nxmutex_lock(&volume->lock);
   if (ret != OK)
     {
@@ -56,6 +56,7 @@
  * External Definitions
  ****************************************************************************/
 
+extern const struct procfs_operations g_buddyinfo_operations;
 extern const struct procfs_operations g_clk_operations;
 extern const struct procfs_operations g_cpuinfo_operations;
 extern const struct procfs_operations g_cpuload_operations;
@@ -64,12 +65,15 @@ extern const struct procfs_operations g_critmon_operations;
 extern const struct procfs_operations g_fdt_operations;
 extern const struct procfs_operations g_iobinfo_operations;
 extern const struct procfs_operations g_irq_operations;
+extern const struct procfs_operations g_latency_operations;
 extern const struct procfs_operations g_meminfo_operations;
 extern const struct procfs_operations g_memdump_operations;
 extern const struct procfs_operations g_mempool_operations;
+extern const struct procfs_operations g_memprof_operations;
 extern const struct procfs_operations g_module_operations;
 extern const struct procfs_operations g_pm_operations;
 extern const struct procfs_operations g_proc_operations;
+extern const struct procfs_operations g_profile_operations;
 extern const struct procfs_operations g_tcbinfo_operations;
 extern const struct procfs_operations g_thermal_operations;
 extern const struct procfs_operations g_uptime_operations;
@@ -105,6 +109,11 @@ static const struct procfs_entry_s g_procfs_entries[] =
   { "[0-9]*",       &g_proc_operations,     PROCFS_DIR_TYPE    },
 #endif
 
+#if defined(CONFIG_MM_PGALLOC_BUDDY) && \
+    !defined(CONFIG_FS_PROCFS_EXCLUDE_MEMINFO)
+  { "buddyinfo",    &g_buddyinfo_operations, PROCFS_FILE_TYPE  },
+#endif
+
 #if defined(CONFIG_CLK) && !defined(CONFIG_FS_PROCFS_EXCLUDE_CLK)
   { "clk",          &g_clk_operations,      PROCFS_FILE_TYPE   },
 #endif
@@ -154,11 +163,18 @@ static const struct procfs_entry_s g_procfs_entries[] =
   { "irqs",         &g_irq_operations,      PROCFS_FILE_TYPE   },
 #endif
 
+#ifdef CONFIG_SCHED_LATENCYMON
+  { "latency",      &g_latency_operations,  PROCFS_FILE_TYPE   },
+#endif
+
 #ifndef CONFIG_FS_PROCFS_EXCLUDE_MEMINFO
 #  ifndef CONFIG_FS_PROCFS_EXCLUDE_MEMDUMP
   { "memdump",      &g_memdump_operations,  PROCFS_FILE_TYPE   },
 #  endif
   { "meminfo",      &g_meminfo_operations,  PROCFS_FILE_TYPE   },
+#  ifdef CONFIG_MM_HEAP_PROFILE
+  { "memprof",      &g_memprof_operations,  PROCFS_FILE_TYPE   },
+#  endif
 #endif
 
 #if defined(CONFIG_MM_HEAP_MEMPOOL) && !defined(CONFIG_FS_PROCFS_EXCLUDE_MEMPOOL)
@@ -192,6 +208,10 @@ static const struct procfs_entry_s g_procfs_entries[] =
   { "pressure/**",  &g_pressure_operations, PROCFS_FILE_TYPE   },
 #endif
 
+#ifdef CONFIG_SCHED_PROFILE_SAMPLER
+  { "profile",      &g_profile_operations,  PROCFS_FILE_TYPE   },
+#endif
+
 #ifndef CONFIG_FS_PROCFS_EXCLUDE_PROCESS
   { "self",         &g_proc_operations,     PROCFS_DIR_TYPE    },
   { "self/**",      &g_proc_operations,     PROCFS_UNKOWN_TYPE },
@@ -29,6 +29,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 
+#include <inttypes.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -108,6 +109,14 @@ static ssize_t memdump_write(FAR struct file *filep, FAR const char *buffer,
 #endif
 static ssize_t meminfo_read(FAR struct file *filep, FAR char *buffer,
                  size_t buflen);
+#ifdef CONFIG_MM_HEAP_PROFILE
+static ssize_t memprof_read(FAR struct file *filep, FAR char *buffer,
+                 size_t buflen);
+#endif
+#ifdef CONFIG_MM_PGALLOC_BUDDY
+static ssize_t buddyinfo_read(FAR struct file *filep, FAR char *buffer,
+                 size_t buflen);
+#endif
 static int     meminfo_dup(FAR const struct file *oldp,
                  FAR struct file *newp);
 static int     meminfo_stat(FAR const char *relpath, FAR struct stat *buf);
@@ -153,6 +162,40 @@ const struct procfs_operations g_memdump_operations =
 };
 #endif
 
+#ifdef CONFIG_MM_HEAP_PROFILE
+const struct procfs_operations g_memprof_operations =
+{
+  meminfo_open,   /* open */
+  meminfo_close,  /* close */
+  memprof_read,   /* read */
+  NULL,           /* write */
+  NULL,           /* poll */
+  meminfo_dup,    /* dup */
+  NULL,           /* opendir */
+  NULL,           /* closedir */
+  NULL,           /* readdir */
+  NULL,           /* rewinddir */
+  meminfo_stat    /* stat */
+};
+#endif
+
+#ifdef CONFIG_MM_PGALLOC_BUDDY
+const struct procfs_operations g_buddyinfo_operations =
+{
+  meminfo_open,   /* open */
+  meminfo_close,  /* close */
+  buddyinfo_read, /* read */
+  NULL,           /* write */
+  NULL,           /* poll */
+  meminfo_dup,    /* dup */
+  NULL,           /* opendir */
+  NULL,           /* closedir */
+  NULL,           /* readdir */
+  NULL,           /* rewinddir */
+  meminfo_stat    /* stat */
+};
+#endif
+
 static FAR struct procfs_meminfo_entry_s *g_procfs_meminfo = NULL;
 
 /****************************************************************************
@@ -409,6 +452,153 @@ static ssize_t meminfo_read(FAR struct file *filep, FAR char *buffer,
   return totalsize;
 }
 
+/****************************************************************************
+ * Name: memprof_read
+ *
+ * Description:
+ *   Export the sampling heap profile in the legacy pprof heap format:
+ *   "<inuse objs>: <inuse bytes> [<alloc objs>: <alloc bytes>] @ <pcs>"
+ *   per call site, after a header line with the totals and the sampling
+ *   rate.  The counts are those of the samples, pprof scales them.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MM_HEAP_PROFILE
+static ssize_t memprof_read(FAR struct file *filep, FAR char *buffer,
+                            size_t buflen)
+{
+  FAR struct meminfo_file_s *procfile;
+  struct mm_heapprof_site_s site;
+  size_t linesize;
+  size_t copysize;
+  size_t totalsize;
+  off_t offset;
+  int index = 0;
+  int i;
+
+  finfo("buffer=%p buflen=%d\n", buffer, (int)buflen);
+
+  DEBUGASSERT(buffer != NULL && buflen > 0);
+  offset = filep->f_pos;
+
+  /* Recover our private data from the struct file instance */
+
+  procfile = (FAR struct meminfo_file_s *)filep->f_priv;
+  DEBUGASSERT(procfile);
+
+  mm_heapprof_total(&site);
+  linesize  = procfs_snprintf(procfile->line, MEMINFO_LINELEN,
+                              "heap profile: %zu: %zu [%zu: %zu] "
+                              "@ heap_v2/%d\n",
+                              site.inuse_objs, site.inuse_bytes,
+                              site.alloc_objs, site.alloc_bytes,
+                              CONFIG_MM_HEAP_PROFILE_RATE);
+  copysize  = procfs_memcpy(procfile->line, linesize, buffer, buflen,
+                            &offset);
+  totalsize = copysize;
+
+  while (buflen > 0 && (index = mm_heapprof_site(index, &site)) >= 0)
+    {
+      buffer   += copysize;
+      buflen   -= copysize;
+
+      linesize  = procfs_snprintf(procfile->line, MEMINFO_LINELEN,
+                                  "%zu: %zu [%zu: %zu] @",
+                                  site.inuse_objs, site.inuse_bytes,
+                                  site.alloc_objs, site.alloc_bytes);
+      for (i = 0; i < site.depth; i++)
+        {
+          linesize += procfs_snprintf(procfile->line + linesize,
+                                      MEMINFO_LINELEN - linesize,
+                                      " 0x%" PRIxPTR,
+                                      (uintptr_t)site.pc[i]);
+        }
+
+      linesize += procfs_snprintf(procfile->line + linesize,
+                                  MEMINFO_LINELEN - linesize, "\n");
+
+      copysize   = procfs_memcpy(procfile->line, linesize, buffer, buflen,
+                                 &offset);
+      totalsize += copysize;
+    }
+
+  /* Update the file offset */
+
+  filep->f_pos += totalsize;
+  return totalsize;
+}
+#endif
+
+/****************************************************************************
+ * Name: buddyinfo_read
+ *
+ * Description:
+ *   Show the free blocks of each order of the buddy page allocator.  The
+ *   last column is the unusable free space index of the order: the share
+ *   of the free pages that lies in blocks too small for an allocation of
+ *   that order.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MM_PGALLOC_BUDDY
+static ssize_t buddyinfo_read(FAR struct file *filep, FAR char *buffer,
+                              size_t buflen)
+{
+  FAR struct meminfo_file_s *procfile;
+  struct pginfo_s pginfo;
+  unsigned long unusable = 0;
+  size_t linesize;
+  size_t copysize;
+  size_t totalsize;
+  off_t offset;
+  int order;
+
+  finfo("buffer=%p buflen=%d\n", buffer, (int)buflen);
+
+  DEBUGASSERT(buffer != NULL && buflen > 0);
+  offset = filep->f_pos;
+
+  /* Recover our private data from the struct file instance */
+
+  procfile = (FAR struct meminfo_file_s *)filep->f_priv;
+  DEBUGASSERT(procfile);
+
+  mm_pginfo(&pginfo);
+
+  linesize  = procfs_snprintf(procfile->line, MEMINFO_LINELEN,
+                              "%5s%11s%11s%9s\n",
+                              "Order", "Blocks", "Pages", "Unusable");
+  copysize  = procfs_memcpy(procfile->line, linesize, buffer, buflen,
+                            &offset);
+  totalsize = copysize;
+
+  for (order = 0; buflen > 0 && order <= CONFIG_MM_PGALLOC_MAXORDER;
+       order++)
+    {
+      buffer   += copysize;
+      buflen   -= copysize;
+
+      linesize  = procfs_snprintf(procfile->line, MEMINFO_LINELEN,
+                                  "%5d%11u%11lu%8lu%%\n", order,
+                                  pginfo.nblocks[order],
+                                  (unsigned long)pginfo.nblocks[order] <<
+                                  order,
+                                  pginfo.nfree ?
+                                  unusable * 100 / pginfo.nfree : 0);
+      copysize   = procfs_memcpy(procfile->line, linesize, buffer, buflen,
+                                 &offset);
+      totalsize += copysize;
+
+      unusable  += (unsigned long)pginfo.nblocks[order] << order;
+    }
+
+  /* Update the file offset */
+
+  filep->f_pos += totalsize;
+  return totalsize;
+}
+#endif
+
 /****************************************************************************
  * Name: memdump_read
  ****************************************************************************/
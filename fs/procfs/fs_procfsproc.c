@@ -163,7 +163,7 @@ struct proc_envinfo_s
 
 static FAR const char * const g_policy[4] =
 {
-  "SCHED_FIFO", "SCHED_RR", "SCHED_SPORADIC"
+  "SCHED_FIFO", "SCHED_RR", "SCHED_SPORADIC", "SCHED_DEADLINE"
 };
 
 /****************************************************************************
@@ -468,7 +468,9 @@ static FAR const struct proc_node_s *proc_findnode(FAR const char *relpath)
  *                                   MQ full}
  *   Flags:      xxx                N,P,X
  *   Priority:   nnn                Decimal, 0-255
- *   Scheduler:  xxxxxxxxxxxxxx     {SCHED_FIFO, SCHED_RR, SCHED_SPORADIC}
+ *   Scheduler:  xxxxxxxxxxxxxx     {SCHED_FIFO, SCHED_RR, SCHED_SPORADIC,
+ *                                   SCHED_DEADLINE}
+ *   Deadline:   n missed, n overrun SCHED_DEADLINE only
  *   Sigmask:    nnnnnnnn           Hexadecimal, 32-bit
  *
  ****************************************************************************/
@@ -639,6 +641,32 @@ static ssize_t proc_status(FAR struct proc_file_s *procfile,
       return totalsize;
     }
 
+#ifdef CONFIG_SCHED_DEADLINE
+  /* Show the deadline misses and budget overruns of SCHED_DEADLINE
+   * threads.
+   */
+
+  if ((tcb->flags & TCB_FLAG_POLICY_MASK) == TCB_FLAG_SCHED_DEADLINE)
+    {
+      linesize   = procfs_snprintf(procfile->line, STATUS_LINELEN,
+                                   "%-12s%" PRIu32 " missed, %" PRIu32
+                                   " overrun\n", "Deadline:",
+                                   tcb->deadline->nmisses,
+                                   tcb->deadline->noverruns);
+      copysize   = procfs_memcpy(procfile->line, linesize, buffer,
+                                 remaining, &offset);
+
+      totalsize += copysize;
+      buffer    += copysize;
+      remaining -= copysize;
+
+      if (totalsize >= buflen)
+        {
+          return totalsize;
+        }
+    }
+#endif
+
   /* Show the signal mask. Note: sigset_t is uint32_t on NuttX. */
 
   linesize = procfs_snprintf(procfile->line, STATUS_LINELEN,
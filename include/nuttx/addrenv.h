@@ -389,6 +389,27 @@ int addrenv_attach(FAR struct tcb_s *tcb, FAR struct addrenv_s *addrenv);
 
 int addrenv_join(FAR struct tcb_s *ptcb, FAR struct tcb_s *tcb);
 
+/****************************************************************************
+ * Name: addrenv_fork
+ *
+ * Description:
+ *   Move a child created by fork() from the address environment it joined
+ *   to a copy-on-write duplicate of that address environment.
+ *
+ * Input Parameters:
+ *   tcb  - The tcb of the child process.
+ *
+ * Returned Value:
+ *   This is a NuttX internal function so it follows the convention that
+ *   0 (OK) is returned on success and a negated errno is returned on
+ *   failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_ARCH_ADDRENV_COW
+int addrenv_fork(FAR struct tcb_s *tcb);
+#endif
+
 /****************************************************************************
  * Name: addrenv_leave
  *
@@ -1013,6 +1013,8 @@ int up_copy_section(FAR void *dest, FAR const void *src, size_t n);
  *   up_addrenv_select   - Instantiate an address environment
  *   up_addrenv_clone    - Copy an address environment from one location to
  *                         another.
+ *   up_addrenv_fork     - Share an address environment copy-on-write with
+ *                         a child process.
  *
  * Higher-level interfaces used by the tasking logic.  These interfaces are
  * used by the functions in sched/ and all operate on the thread which whose
@@ -1279,6 +1281,29 @@ int up_addrenv_clone(FAR const arch_addrenv_t *src,
                      FAR arch_addrenv_t *dest);
 #endif
 
+/****************************************************************************
+ * Name: up_addrenv_fork
+ *
+ * Description:
+ *   Create the address environment of a child process created by fork().
+ *   The user memory of src is shared with dest copy-on-write: writable
+ *   pages become read-only in both address environments and the page
+ *   fault handler copies a page on the first write to it by either
+ *   process.
+ *
+ * Input Parameters:
+ *   src  - The address environment of the parent.
+ *   dest - The location to receive the address environment of the child.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_ARCH_ADDRENV_COW
+int up_addrenv_fork(FAR arch_addrenv_t *src, FAR arch_addrenv_t *dest);
+#endif
+
 /****************************************************************************
  * Name: up_addrenv_attach
  *
@@ -1947,7 +1972,8 @@ void up_timer_initialize(void);
  *
  ****************************************************************************/
 
-#if defined(CONFIG_SCHED_TICKLESS) && !defined(CONFIG_SCHED_TICKLESS_TICK_ARGUMENT)
+#if defined(CONFIG_SCHED_TICKLESS) && \
+    (!defined(CONFIG_SCHED_TICKLESS_TICK_ARGUMENT) || defined(CONFIG_HRTIMER))
 int up_timer_gettime(FAR struct timespec *ts);
 #endif
 
@@ -2034,6 +2060,36 @@ int up_alarm_tick_start(clock_t ticks);
 #  endif
 #endif
 
+/****************************************************************************
+ * Name: up_hrtimer_start
+ *
+ * Description:
+ *   Program the absolute time at which the earliest high resolution timer
+ *   expires.  hrtimer_process() will be called when that time is reached.
+ *   The expiration is shared with the scheduler alarm: the platform code
+ *   must program the hardware for whichever of the two comes first.
+ *
+ *   Provided by platform-specific code and called from the RTOS base code.
+ *
+ * Input Parameters:
+ *   expired - The CLOCK_MONOTONIC time in nanoseconds at which
+ *             hrtimer_process() is to be called, or UINT64_MAX if no
+ *             high resolution timer is active.
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success; a negated errno value is returned on
+ *   any failure.
+ *
+ * Assumptions:
+ *   May be called from interrupt level handling or from the normal tasking
+ *   level.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_HRTIMER
+int up_hrtimer_start(uint64_t expired);
+#endif
+
 /****************************************************************************
  * Name: up_timer_cancel
  *
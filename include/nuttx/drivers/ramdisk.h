@@ -49,6 +49,24 @@
  * Type Definitions
  ****************************************************************************/
 
+/* Statistics returned by the BIOC_ZRAMSTATS ioctl of a compressed RAM
+ * disk.
+ */
+
+#ifdef CONFIG_DRVR_ZRAM
+struct zram_stats_s
+{
+  uint32_t nsectors;     /* Number of sectors on device */
+  uint32_t zerosectors;  /* Sectors written with zeros, no storage used */
+  uint32_t lzfsectors;   /* Sectors stored compressed */
+  uint32_t rawsectors;   /* Sectors stored uncompressed */
+  uint64_t origsize;     /* Bytes in the stored (non-zero) sectors */
+  uint64_t comprsize;    /* Bytes after compression */
+  uint64_t memused;      /* Pool memory used, including size rounding */
+  uint32_t ratio;        /* origsize / memused, in percent */
+};
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -108,6 +126,30 @@ int ramdisk_register(int minor, FAR uint8_t *buffer, uint32_t nsectors,
 int mkrd(int minor, uint32_t nsectors, uint16_t sectsize, uint8_t rdflags);
 #endif
 
+/****************************************************************************
+ * Name: zram_register
+ *
+ * Description:
+ *   Register a compressed RAM disk as /dev/zramN.  Each sector is
+ *   compressed with LZF and kept in a size-classed memory pool that grows
+ *   on demand; sectors containing only zeros use no storage at all.  The
+ *   RAM disk is always writable and all memory is released when it is
+ *   unlinked.
+ *
+ * Input Parameters:
+ *   minor:         Selects suffix of device named /dev/zramN, N={1,2,3...}
+ *   nsectors:      Number of sectors on device
+ *   sectsize:      The size of one sector
+ *
+ * Returned Value:
+ *   Zero on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_DRVR_ZRAM
+int zram_register(int minor, uint32_t nsectors, uint16_t sectsize);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -30,6 +30,7 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 #include <nuttx/mutex.h>
@@ -55,6 +56,29 @@ typedef CODE ssize_t (*rwbreload_t)(FAR void *dev, FAR uint8_t *buffer,
 typedef CODE ssize_t (*rwbflush_t)(FAR void *dev, FAR const uint8_t *buffer,
                                    off_t startblock, size_t nblocks);
 
+/* Buffer statistics returned by rwb_getstats() (and the BIOC_RWBSTATS
+ * ioctl of drivers built on top of rwbuffer).  All counts are in blocks
+ * unless stated otherwise.  rdhits and rdmisses are only counted when the
+ * read-ahead buffer is in use, its hit rate is
+ * rdhits / (rdhits + rdmisses).
+ */
+
+#ifdef CONFIG_DRVR_RWBUFFER_STATS
+struct rwb_stats_s
+{
+  uint32_t      rdhits;          /* Blocks served from read-ahead buffer */
+  uint32_t      rdmisses;        /* Blocks that had to come from the media */
+  uint32_t      wrhits;          /* Read blocks served from write buffer */
+  uint32_t      rhreloads;       /* Number of read-ahead buffer reloads */
+  uint32_t      rhblocks;        /* Blocks loaded into the read-ahead buffer */
+  uint32_t      wrmerged;        /* Blocks merged into buffered data */
+  uint32_t      wrholes;         /* Blocks read back to fill write holes */
+  uint32_t      wrflushes;       /* Number of write buffer flushes */
+  uint32_t      wrflushblocks;   /* Blocks written by write buffer flushes */
+  uint32_t      wrbypass;        /* Blocks written without buffering */
+};
+#endif
+
 /* This structure holds the state of the buffers.  In typical usage,
  * an instance of this structure is declared within each block driver
  * status structure like:
@@ -106,6 +130,9 @@ struct rwbuffer_s
 #endif
 #ifdef CONFIG_DRVR_READAHEAD
   uint16_t      rhmaxblocks;     /* The number of blocks to buffer in memory */
+  uint16_t      rhminblocks;     /* Smallest adaptive read-ahead window.  If
+                                  * zero, every reload fills rhmaxblocks.
+                                  */
 #endif
 
   /* Callback functions.
@@ -142,7 +169,13 @@ struct rwbuffer_s
   mutex_t       rhlock;          /* Enforces exclusive access to the read-ahead buffer */
   FAR uint8_t  *rhbuffer;        /* Allocated read-ahead buffer */
   uint16_t      rhnblocks;       /* Number of blocks in read-ahead buffer */
+  uint16_t      rhwindow;        /* Current adaptive read-ahead window */
   off_t         rhblockstart;    /* First block in read-ahead buffer */
+  off_t         rhnextblock;     /* Block expected next by a sequential reader */
+#endif
+
+#ifdef CONFIG_DRVR_RWBUFFER_STATS
+  struct rwb_stats_s stats;      /* Buffer statistics */
 #endif
 };
 
@@ -198,6 +231,13 @@ int rwb_invalidate(FAR struct rwbuffer_s *rwb,
 int rwb_flush(FAR struct rwbuffer_s *rwb);
 #endif
 
+/* Statistics */
+
+#ifdef CONFIG_DRVR_RWBUFFER_STATS
+int rwb_getstats(FAR struct rwbuffer_s *rwb, FAR struct rwb_stats_s *stats,
+                 bool reset);
+#endif
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
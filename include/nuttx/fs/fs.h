@@ -476,7 +476,7 @@ struct file
 {
   int               f_oflags;   /* Open mode flags */
 #ifdef CONFIG_FS_REFCOUNT
-  int               f_refs;     /* Reference count */
+  atomic_int        f_refs;     /* Reference count */
 #endif
   off_t             f_pos;      /* File position */
   FAR struct inode *f_inode;    /* Driver or file system interface */
@@ -503,11 +503,16 @@ struct file
  * You can get file instance in filelist by the follow methods:
  * (file descriptor / CONFIG_NFILE_DESCRIPTORS_PER_BLOCK) as row index and
  * (file descriptor % CONFIG_NFILE_DESCRIPTORS_PER_BLOCK) as column index.
+ *
+ * The row pointer array is allocated once with room for OPEN_MAX
+ * descriptors and rows are only ever appended, so that file descriptor
+ * lookups may walk the array without taking any lock.  fl_rows is
+ * published after the new row is in place.
  */
 
 struct filelist
 {
-  uint8_t           fl_rows;    /* The number of rows of fl_files array */
+  atomic_uchar      fl_rows;    /* The number of rows of fl_files array */
   uint8_t           fl_crefs;   /* The references to filelist */
   FAR struct file **fl_files;   /* The pointer of two layer file descriptors array */
 };
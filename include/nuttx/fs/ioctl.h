@@ -107,6 +107,7 @@
 #define _PINCTRLBASE    (0x4000) /* Pinctrl driver ioctl commands */
 #define _PCIBASE        (0x4100) /* Pci ioctl commands */
 #define _I3CBASE        (0x4200) /* I3C driver ioctl commands */
+#define _PERFBASE       (0x4300) /* Perf event ioctl commands */
 #define _WLIOCBASE      (0x8b00) /* Wireless modules ioctl network commands */
 
 /* boardctl() commands share the same number space */
@@ -346,6 +347,32 @@
                                            *      to return sector numbers.
                                            * OUT: Data return in user-provided
                                            *      buffer. */
+#define BIOC_RWBSTATS   _BIOC(0x0011)     /* Get read-ahead/write buffer
+                                           * statistics.
+                                           * IN:  Pointer to writable instance
+                                           *      of struct rwb_stats_s
+                                           * OUT: Statistics returned in the
+                                           *      user-provided buffer. */
+#define BIOC_RWBRESET   _BIOC(0x0012)     /* Reset read-ahead/write buffer
+                                           * statistics.
+                                           * IN:  None
+                                           * OUT: None */
+#define BIOC_GCSTATS    _BIOC(0x0013)     /* Get garbage collection
+                                           * statistics.
+                                           * IN:  Pointer to writable instance
+                                           *      of struct mtd_gc_stats_s
+                                           * OUT: Statistics returned in the
+                                           *      user-provided buffer. */
+#define BIOC_GCRESET    _BIOC(0x0014)     /* Reset garbage collection
+                                           * statistics.
+                                           * IN:  None
+                                           * OUT: None */
+#define BIOC_ZRAMSTATS  _BIOC(0x0015)     /* Get compressed RAM disk
+                                           * statistics.
+                                           * IN:  Pointer to writable instance
+                                           *      of struct zram_stats_s
+                                           * OUT: Statistics returned in the
+                                           *      user-provided buffer. */
 
 /* NuttX MTD driver ioctl definitions ***************************************/
 
@@ -754,6 +781,13 @@
 #define _PINCTRLIOCVALID(c) (_IOC_TYPE(c)==_PINCTRLBASE)
 #define _PINCTRLIOC(nr)     _IOC(_PINCTRLBASE,nr)
 
+/* Perf event command definitions *******************************************/
+
+/* see nuttx/include/nuttx/perf.h */
+
+#define _PERFIOCVALID(c)  (_IOC_TYPE(c)==_PERFBASE)
+#define _PERFIOC(nr)      _IOC(_PERFBASE,nr)
+
 /****************************************************************************
  * Public Type Definitions
  ****************************************************************************/
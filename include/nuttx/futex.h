@@ -0,0 +1,141 @@
+/****************************************************************************
+ * include/nuttx/futex.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_FUTEX_H
+#define __INCLUDE_NUTTX_FUTEX_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <time.h>
+
+#ifdef CONFIG_FUTEX
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Futex operations.  The values and the encoding of FUTEX_WAKE_OP match
+ * Linux so that existing user-space code can be reused unmodified.
+ */
+
+#define FUTEX_WAIT             0  /* Sleep if *uaddr == val */
+#define FUTEX_WAKE             1  /* Wake up to val waiters */
+#define FUTEX_REQUEUE          3  /* Wake val, move val2 to uaddr2 */
+#define FUTEX_CMP_REQUEUE      4  /* Same, but only if *uaddr == val3 */
+#define FUTEX_WAKE_OP          5  /* Modify *uaddr2, wake on both */
+#define FUTEX_WAIT_BITSET      9  /* FUTEX_WAIT, absolute timeout */
+#define FUTEX_WAKE_BITSET      10 /* FUTEX_WAKE, matching bitset */
+
+#define FUTEX_PRIVATE_FLAG     128 /* Futex is private to the process */
+#define FUTEX_CLOCK_REALTIME   256 /* Timeout is against CLOCK_REALTIME */
+#define FUTEX_CMD_MASK         ~(FUTEX_PRIVATE_FLAG | FUTEX_CLOCK_REALTIME)
+
+#define FUTEX_WAIT_PRIVATE        (FUTEX_WAIT | FUTEX_PRIVATE_FLAG)
+#define FUTEX_WAKE_PRIVATE        (FUTEX_WAKE | FUTEX_PRIVATE_FLAG)
+#define FUTEX_REQUEUE_PRIVATE     (FUTEX_REQUEUE | FUTEX_PRIVATE_FLAG)
+#define FUTEX_CMP_REQUEUE_PRIVATE (FUTEX_CMP_REQUEUE | FUTEX_PRIVATE_FLAG)
+#define FUTEX_WAKE_OP_PRIVATE     (FUTEX_WAKE_OP | FUTEX_PRIVATE_FLAG)
+#define FUTEX_WAIT_BITSET_PRIVATE (FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG)
+#define FUTEX_WAKE_BITSET_PRIVATE (FUTEX_WAKE_BITSET | FUTEX_PRIVATE_FLAG)
+
+#define FUTEX_BITSET_MATCH_ANY 0xffffffff
+
+/* FUTEX_WAKE_OP operations and comparisons, encoded in val3 as
+ * FUTEX_OP(op, oparg, cmp, cmparg).
+ */
+
+#define FUTEX_OP_SET           0  /* *uaddr2 = oparg */
+#define FUTEX_OP_ADD           1  /* *uaddr2 += oparg */
+#define FUTEX_OP_OR            2  /* *uaddr2 |= oparg */
+#define FUTEX_OP_ANDN          3  /* *uaddr2 &= ~oparg */
+#define FUTEX_OP_XOR           4  /* *uaddr2 ^= oparg */
+#define FUTEX_OP_OPARG_SHIFT   8  /* Use (1 << oparg) as operand */
+
+#define FUTEX_OP_CMP_EQ        0  /* if (oldval == cmparg) wake */
+#define FUTEX_OP_CMP_NE        1  /* if (oldval != cmparg) wake */
+#define FUTEX_OP_CMP_LT        2  /* if (oldval < cmparg) wake */
+#define FUTEX_OP_CMP_LE        3  /* if (oldval <= cmparg) wake */
+#define FUTEX_OP_CMP_GT        4  /* if (oldval > cmparg) wake */
+#define FUTEX_OP_CMP_GE        5  /* if (oldval >= cmparg) wake */
+
+#define FUTEX_OP(op, oparg, cmp, cmparg) \
+  ((((op) & 0xf) << 28) | (((cmp) & 0xf) << 24) | \
+   (((oparg) & 0xfff) << 12) | ((cmparg) & 0xfff))
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: futex
+ *
+ * Description:
+ *   Fast user-space locking.  A thread blocks on (or wakes threads blocked
+ *   on) a 32-bit word in its own memory.  Uncontended operations never
+ *   enter the kernel; only the contended slow path calls futex().
+ *
+ *   Private futexes (FUTEX_PRIVATE_FLAG) are keyed by the task group and
+ *   the virtual address.  Shared futexes are keyed by the physical address
+ *   when the architecture can translate it, so that processes mapping the
+ *   same page at different addresses still rendezvous.
+ *
+ * Input Parameters:
+ *   uaddr   - The 4-byte aligned futex word
+ *   op      - The operation, optionally or'ed with FUTEX_PRIVATE_FLAG and
+ *             FUTEX_CLOCK_REALTIME
+ *   val     - Operation dependent: expected value or number of waiters
+ *   timeout - FUTEX_WAIT: relative timeout; FUTEX_WAIT_BITSET: absolute
+ *             timeout.  NULL waits forever.  For the requeue and wake-op
+ *             operations this carries the second count (val2) instead.
+ *   uaddr2  - The second futex word for the requeue and wake-op operations
+ *   val3    - Operation dependent: compare value, wake-op or bitset
+ *
+ * Returned Value:
+ *   On success, zero for the wait operations or the number of woken (and
+ *   requeued) waiters.  On failure, -1 (ERROR) with errno set.
+ *
+ ****************************************************************************/
+
+int futex(FAR uint32_t *uaddr, int op, uint32_t val,
+          FAR const struct timespec *timeout, FAR uint32_t *uaddr2,
+          uint32_t val3);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_FUTEX */
+#endif /* __INCLUDE_NUTTX_FUTEX_H */
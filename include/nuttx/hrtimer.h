@@ -0,0 +1,233 @@
+/****************************************************************************
+ * include/nuttx/hrtimer.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_HRTIMER_H
+#define __INCLUDE_NUTTX_HRTIMER_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <nuttx/compiler.h>
+#include <nuttx/list.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef CONFIG_HRTIMER
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define HRTIMER_ISACTIVE(t)  list_in_list(&(t)->node)
+
+/****************************************************************************
+ * Public Type Declarations
+ ****************************************************************************/
+
+/* hrtimer_start() interprets the expiration time either as an absolute
+ * CLOCK_MONOTONIC time or as a delay relative to the current time.  Both
+ * are in nanoseconds.
+ */
+
+enum hrtimer_mode_e
+{
+  HRTIMER_MODE_ABS = 0,          /* Absolute CLOCK_MONOTONIC time */
+  HRTIMER_MODE_REL               /* Relative to the current time */
+};
+
+/* This is the form of the function that is called when the timer expires.
+ * It runs in the context of the timer interrupt handler.  'expired' is the
+ * programmed expiration time.  The callback returns zero to stop the timer
+ * or the period in nanoseconds after which it is to be called again,
+ * measured from 'expired' so that periodic timers do not drift.
+ */
+
+struct hrtimer_s;
+typedef CODE uint64_t (*hrtimer_cb)(FAR struct hrtimer_s *timer,
+                                    uint64_t expired);
+
+struct hrtimer_s
+{
+  struct list_node node;         /* Supports a doubly linked list */
+  hrtimer_cb       func;         /* Function to execute on expiration */
+  FAR void        *arg;          /* Callback argument */
+  uint64_t         expired;      /* Absolute expiration time (ns) */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: hrtimer_init
+ *
+ * Description:
+ *   Initialize a high resolution timer before its first use.
+ *
+ * Input Parameters:
+ *   timer - The timer to be initialized
+ *   func  - Function to call on expiration
+ *   arg   - Argument retrieved by the callback through timer->arg
+ *
+ ****************************************************************************/
+
+void hrtimer_init(FAR struct hrtimer_s *timer, hrtimer_cb func,
+                  FAR void *arg);
+
+/****************************************************************************
+ * Name: hrtimer_start
+ *
+ * Description:
+ *   Add a high resolution timer to the active timer list, replacing any
+ *   pending expiration.  Unlike watchdog timers, the expiration is not
+ *   rounded to the system tick; the timer hardware is programmed for the
+ *   exact time of the earliest pending timer.
+ *
+ * Input Parameters:
+ *   timer - The timer to be started
+ *   ns    - Expiration time in nanoseconds
+ *   mode  - HRTIMER_MODE_ABS or HRTIMER_MODE_REL
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success; a negated errno value is returned on
+ *   failure.
+ *
+ * Assumptions:
+ *   May be called from the interrupt level.
+ *
+ ****************************************************************************/
+
+int hrtimer_start(FAR struct hrtimer_s *timer, uint64_t ns,
+                  enum hrtimer_mode_e mode);
+
+/****************************************************************************
+ * Name: hrtimer_cancel
+ *
+ * Description:
+ *   Remove a high resolution timer from the active timer list.  Cancelling
+ *   a timer that is not active is not an error.
+ *
+ * Input Parameters:
+ *   timer - The timer to be cancelled
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success; a negated errno value is returned on
+ *   failure.
+ *
+ * Assumptions:
+ *   May be called from the interrupt level.
+ *
+ ****************************************************************************/
+
+int hrtimer_cancel(FAR struct hrtimer_s *timer);
+
+/****************************************************************************
+ * Name: hrtimer_cancel_sync
+ *
+ * Description:
+ *   Cancel a high resolution timer like hrtimer_cancel() and then wait
+ *   until its callback, if it is running on another CPU, has returned.
+ *   Use this before the memory of the timer is released.
+ *
+ * Input Parameters:
+ *   timer - The timer to be cancelled
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success; a negated errno value is returned on
+ *   failure.
+ *
+ * Assumptions:
+ *   The caller must not hold a lock that the callback takes, other than
+ *   the critical section.  May be called from the timer's own callback.
+ *
+ ****************************************************************************/
+
+int hrtimer_cancel_sync(FAR struct hrtimer_s *timer);
+
+/****************************************************************************
+ * Name: hrtimer_gettime
+ *
+ * Description:
+ *   Return the current CLOCK_MONOTONIC time in nanoseconds, the time base
+ *   used for hrtimer expirations.
+ *
+ ****************************************************************************/
+
+uint64_t hrtimer_gettime(void);
+
+/****************************************************************************
+ * Name: hrtimer_abstime2nsec
+ *
+ * Description:
+ *   Convert an absolute time on the clock 'clockid' to the CLOCK_MONOTONIC
+ *   nanosecond time base of hrtimer_start().  A time in the past converts
+ *   to the current time.
+ *
+ * Input Parameters:
+ *   clockid - The clock on which abstime is measured
+ *   abstime - The absolute time to be converted
+ *
+ * Returned Value:
+ *   The corresponding CLOCK_MONOTONIC time in nanoseconds.
+ *
+ ****************************************************************************/
+
+uint64_t hrtimer_abstime2nsec(clockid_t clockid,
+                              FAR const struct timespec *abstime);
+
+/****************************************************************************
+ * Name: hrtimer_process
+ *
+ * Description:
+ *   Run the callbacks of all timers that have expired at 'now' and program
+ *   the next expiration through up_hrtimer_start().  Called by the
+ *   architecture timer logic when the time passed to up_hrtimer_start()
+ *   has been reached.
+ *
+ * Input Parameters:
+ *   now - The current time in nanoseconds
+ *
+ * Assumptions:
+ *   Called from interrupt handler logic.
+ *
+ ****************************************************************************/
+
+void hrtimer_process(uint64_t now);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_HRTIMER */
+#endif /* __INCLUDE_NUTTX_HRTIMER_H */
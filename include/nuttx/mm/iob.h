@@ -57,6 +57,10 @@
 #  define CONFIG_IOB_THROTTLE 0
 #endif
 
+#if !defined(CONFIG_IOB_NCACHE)
+#  define CONFIG_IOB_NCACHE 0
+#endif
+
 /* Some I/O buffers should be allocated */
 
 #if !defined(CONFIG_IOB_NBUFFERS)
@@ -221,6 +225,28 @@ FAR struct iob_s *iob_alloc(bool throttled);
 
 FAR struct iob_s *iob_tryalloc(bool throttled);
 
+/****************************************************************************
+ * Name: iob_alloc_chain
+ *
+ * Description:
+ *   Allocate a chain of I/O buffers large enough to hold 'len' bytes,
+ *   without waiting.  All buffers are taken with a single acquisition of
+ *   the IOB locks.  io_len of each buffer and io_pktlen of the head are
+ *   set up for 'len' bytes, so that the chain can be filled directly or
+ *   with iob_copyin(); the data itself is not initialized.
+ *
+ * Input Parameters:
+ *   len       - The number of bytes the chain must hold
+ *   throttled - An indication of the IOB allocation is "throttled"
+ *
+ * Returned Value:
+ *   The head of the chain, or NULL if not enough I/O buffers are
+ *   available, in which case nothing is allocated.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_alloc_chain(unsigned int len, bool throttled);
+
 #ifdef CONFIG_IOB_ALLOC
 /****************************************************************************
  * Name: iob_alloc_dynamic
@@ -0,0 +1,161 @@
+/****************************************************************************
+ * include/nuttx/mm/kmem_cache.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_MM_KMEM_CACHE_H
+#define __INCLUDE_NUTTX_MM_KMEM_CACHE_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+
+/* Object caches hand out same-size kernel objects one at a time and keep
+ * them constructed while they are free.  Subsystems that preallocate a
+ * fixed number of objects (TCBs, network connections) use a cache for the
+ * ones that do not fit, instead of growing their free list in batches
+ * from the heap that are never given back.
+ */
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Called once for each object when the memory backing it is added to the
+ * cache, not on every allocation.  Objects must be handed back to
+ * kmem_cache_free() in the state the constructor left them in.
+ */
+
+typedef CODE void (*kmem_cache_ctor_t)(FAR void *obj);
+
+struct kmem_cache_s;
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#undef EXTERN
+#if defined(__cplusplus)
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+#if defined(CONFIG_MM_KMEM_CACHE) && \
+    (defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__))
+
+/****************************************************************************
+ * Name: kmem_cache_create
+ *
+ * Description:
+ *   Create a cache of objects of the same size, allocated from the kernel
+ *   heap in slabs of CONFIG_MM_KMEM_CACHE_SLABSIZE bytes.
+ *
+ * Input Parameters:
+ *   name  - The name of the cache, shown in /proc/mempool.
+ *   size  - The size of an object.
+ *   align - The alignment of an object, zero for the default.
+ *   ctor  - The object constructor, may be NULL.
+ *
+ * Returned Value:
+ *   The cache on success; NULL on failure.
+ *
+ ****************************************************************************/
+
+FAR struct kmem_cache_s *kmem_cache_create(FAR const char *name,
+                                           size_t size, size_t align,
+                                           kmem_cache_ctor_t ctor);
+
+/****************************************************************************
+ * Name: kmem_cache_destroy
+ *
+ * Description:
+ *   Release a cache and all of its memory.
+ *
+ * Returned Value:
+ *   OK on success; -EBUSY if objects are still allocated from it.
+ *
+ ****************************************************************************/
+
+int kmem_cache_destroy(FAR struct kmem_cache_s *cache);
+
+/****************************************************************************
+ * Name: kmem_cache_alloc
+ *
+ * Description:
+ *   Allocate a constructed object.  May be called from an interrupt
+ *   handler, but only objects on the calling CPU's hot list are returned
+ *   there.
+ *
+ * Returned Value:
+ *   The object on success; NULL if out of memory.
+ *
+ ****************************************************************************/
+
+FAR void *kmem_cache_alloc(FAR struct kmem_cache_s *cache);
+
+/****************************************************************************
+ * Name: kmem_cache_zalloc
+ *
+ * Description:
+ *   Allocate a zeroed object, for caches without a constructor.
+ *
+ ****************************************************************************/
+
+FAR void *kmem_cache_zalloc(FAR struct kmem_cache_s *cache);
+
+/****************************************************************************
+ * Name: kmem_cache_free
+ *
+ * Description:
+ *   Give an object back to its cache.
+ *
+ ****************************************************************************/
+
+void kmem_cache_free(FAR struct kmem_cache_s *cache, FAR void *obj);
+
+/****************************************************************************
+ * Name: kmem_cache_shrink
+ *
+ * Description:
+ *   Flush the per-CPU hot lists and release the slabs that are completely
+ *   free.
+ *
+ * Returned Value:
+ *   The number of bytes given back to the heap.
+ *
+ ****************************************************************************/
+
+size_t kmem_cache_shrink(FAR struct kmem_cache_s *cache);
+
+#endif /* CONFIG_MM_KMEM_CACHE && (CONFIG_BUILD_FLAT || __KERNEL__) */
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INCLUDE_NUTTX_MM_KMEM_CACHE_H */
@@ -247,6 +247,39 @@ int mempool_info(FAR struct mempool_s *pool, FAR struct mempoolinfo_s *info);
 void mempool_memdump(FAR struct mempool_s *pool,
                      FAR const struct mm_memdump_s *dump);
 
+/****************************************************************************
+ * Name: mempool_shrink
+ *
+ * Description:
+ *   Give the expansion blocks of the pool whose blocks are all free back
+ *   to the pool's free function.  The initial block and the interrupt
+ *   blocks are kept.
+ *
+ * Input Parameters:
+ *   pool    - Address of the memory pool to be used.
+ *
+ * Returned Value:
+ *   The number of expansion blocks released.
+ ****************************************************************************/
+
+size_t mempool_shrink(FAR struct mempool_s *pool);
+
+/****************************************************************************
+ * Name: mempool_shrink_count
+ *
+ * Description:
+ *   Estimate how much memory mempool_shrink() can give back, leaving out
+ *   the initial block and expansions that are not entirely free.
+ *
+ * Input Parameters:
+ *   pool    - Address of the memory pool to be used.
+ *
+ * Returned Value:
+ *   The number of bytes that mempool_shrink() may release.
+ ****************************************************************************/
+
+size_t mempool_shrink_count(FAR struct mempool_s *pool);
+
 /****************************************************************************
  * Name: mempool_deinit
  *
@@ -176,6 +176,23 @@ struct mempool_init_s
   size_t            dict_expendsize;
 };
 
+#ifdef CONFIG_MM_HEAP_PROFILE
+/* One call site of the sampling heap profiler.  The counts are those of
+ * the sampled allocations only, on average one per
+ * CONFIG_MM_HEAP_PROFILE_RATE bytes allocated.
+ */
+
+struct mm_heapprof_site_s
+{
+  size_t    inuse_objs;                           /* Live samples */
+  size_t    inuse_bytes;                          /* Size of live samples */
+  size_t    alloc_objs;                           /* Samples since boot */
+  size_t    alloc_bytes;                          /* Size of all samples */
+  int       depth;                                /* Valid entries in pc */
+  FAR void *pc[CONFIG_MM_HEAP_PROFILE_DEPTH];     /* Allocation stack */
+};
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -419,6 +436,13 @@ struct mallinfo_task kmm_mallinfo_task(FAR const struct malltask *task);
 void mm_memdump(FAR struct mm_heap_s *heap,
                 FAR const struct mm_memdump_s *dump);
 
+/* Functions contained in mm_heapprof.c *************************************/
+
+#ifdef CONFIG_MM_HEAP_PROFILE
+int mm_heapprof_site(int index, FAR struct mm_heapprof_site_s *site);
+void mm_heapprof_total(FAR struct mm_heapprof_site_s *total);
+#endif
+
 /* Functions contained in umm_memdump.c *************************************/
 
 void umm_memdump(FAR const struct mm_memdump_s *dump);
@@ -0,0 +1,172 @@
+/****************************************************************************
+ * include/nuttx/mm/shrinker.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_MM_SHRINKER_H
+#define __INCLUDE_NUTTX_MM_SHRINKER_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+
+#include <nuttx/queue.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_MM_SHRINKER_LOWATER
+#  define CONFIG_MM_SHRINKER_LOWATER 0
+#endif
+
+/* Suggested costs, shrinkers of lower cost are asked first */
+
+#define MM_SHRINKER_COST_FREE     0   /* Unused memory kept for speed only */
+#define MM_SHRINKER_COST_CACHE    16  /* Clean data that can be reread */
+#define MM_SHRINKER_COST_REBUILD  64  /* State that is costly to rebuild */
+
+/* An allocation that failed is retried at most this many times after the
+ * shrinkers gave memory back, other threads may take it first.
+ */
+
+#define MM_SHRINK_RETRIES         3
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+struct mm_heap_s;
+
+/* A cache that gives memory back to the heap under memory pressure.  The
+ * structure is owned by the subsystem and must stay valid until it is
+ * unregistered.  Both callbacks are called from a thread, never from an
+ * interrupt handler, and must neither allocate memory from the heap being
+ * shrunk nor (un)register shrinkers.
+ */
+
+struct mm_shrinker_s
+{
+  sq_entry_t      entry;    /* Used internally, sorted by cost */
+  FAR const char *name;     /* For debug output */
+  unsigned int    cost;     /* Relative cost of reclaiming, see above */
+  FAR void       *priv;     /* Private data of the callbacks */
+
+  /* Return an estimate of the number of bytes that scan() could free */
+
+  CODE size_t (*count)(FAR struct mm_shrinker_s *shrinker);
+
+  /* Free about 'nbytes' bytes and return the number of bytes given back
+   * to the heap.
+   */
+
+  CODE size_t (*scan)(FAR struct mm_shrinker_s *shrinker, size_t nbytes);
+
+  /* Statistics */
+
+  size_t          nscans;   /* Number of calls to scan() */
+  size_t          nfreed;   /* Total bytes returned by scan() */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#undef EXTERN
+#if defined(__cplusplus)
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+#if defined(CONFIG_MM_SHRINKER) && \
+    (defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__))
+
+/****************************************************************************
+ * Name: mm_register_shrinker
+ *
+ * Description:
+ *   Register a cache to be shrunk when an allocation from the kernel heap
+ *   fails, or when its free memory drops below CONFIG_MM_SHRINKER_LOWATER.
+ *
+ ****************************************************************************/
+
+void mm_register_shrinker(FAR struct mm_shrinker_s *shrinker);
+
+/****************************************************************************
+ * Name: mm_unregister_shrinker
+ *
+ * Description:
+ *   Unregister a cache.  Waits for a running scan() to complete.
+ *
+ ****************************************************************************/
+
+void mm_unregister_shrinker(FAR struct mm_shrinker_s *shrinker);
+
+/****************************************************************************
+ * Name: mm_shrink
+ *
+ * Description:
+ *   Ask the registered caches, cheapest first, to free at least 'nbytes'
+ *   bytes.
+ *
+ * Returned Value:
+ *   The number of bytes freed.  Zero if nothing could be freed, if called
+ *   from an interrupt handler, or if the caches are already being shrunk.
+ *
+ ****************************************************************************/
+
+size_t mm_shrink(size_t nbytes);
+
+/****************************************************************************
+ * Name: mm_shrink_notify
+ *
+ * Description:
+ *   Called after an allocation from 'heap'.  If free memory dropped below
+ *   CONFIG_MM_SHRINKER_LOWATER, schedule the caches to be shrunk in the
+ *   background until CONFIG_MM_SHRINKER_HIWATER bytes are free.
+ *
+ ****************************************************************************/
+
+#  if CONFIG_MM_SHRINKER_LOWATER > 0
+void mm_shrink_notify(FAR struct mm_heap_s *heap);
+#  else
+#    define mm_shrink_notify(heap)
+#  endif
+
+#else
+#  define mm_register_shrinker(shrinker)
+#  define mm_unregister_shrinker(shrinker)
+#  define mm_shrink(nbytes) 0
+#  define mm_shrink_notify(heap)
+#endif
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INCLUDE_NUTTX_MM_SHRINKER_H */
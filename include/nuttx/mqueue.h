@@ -94,6 +94,14 @@
 #  define MQ_WNELIST(cmn)             (&((cmn).waitfornotempty))
 #  define MQ_WNFLIST(cmn)             (&((cmn).waitfornotfull))
 
+/* With CONFIG_MQ_PRIO_BUCKETS, the messages of a queue are kept on one
+ * list per range of MQ_PRIO_BUCKET_WIDTH priorities.
+ */
+
+#define MQ_PRIO_NBUCKETS              32
+#define MQ_PRIO_BUCKET_WIDTH \
+  ((MQ_PRIO_MAX + MQ_PRIO_NBUCKETS - 1) / MQ_PRIO_NBUCKETS)
+
 /****************************************************************************
  * Public Type Declarations
  ****************************************************************************/
@@ -114,7 +122,15 @@ struct mqueue_inode_s
 {
   struct mqueue_cmn_s cmn;    /* Common prologue */
   FAR struct inode *inode;    /* Containing inode */
+#ifdef CONFIG_MQ_PRIO_BUCKETS
+  struct list_node msglist[MQ_PRIO_NBUCKETS]; /* Messages by priority range */
+  uint32_t msgmap;            /* Bitmap of the non-empty message lists */
+#else
   struct list_node msglist;   /* Prioritized message list */
+#endif
+#ifdef CONFIG_MQ_PERQUEUE_MSGS
+  struct list_node msgfree;   /* Free messages allocated with the queue */
+#endif
   int16_t maxmsgs;            /* Maximum number of messages in the queue */
   int16_t nmsgs;              /* Number of message in the queue */
 #if CONFIG_MQ_MAXMSGSIZE < 256
@@ -742,6 +758,49 @@ ssize_t file_mq_tickreceive(FAR struct file *mq, FAR char *msg,
                             size_t msglen, FAR unsigned int *prio,
                             sclock_t ticks);
 
+/****************************************************************************
+ * Name: file_mq_borrow
+ *
+ * Description:
+ *   Receive a message like file_mq_timedreceive(), but without copying it
+ *   out of the message queue's buffer: on success, *msg points to the
+ *   message data, which stays valid and owned by the caller until it is
+ *   given back with file_mq_release().  Each borrowed message holds one
+ *   message buffer, so borrowed messages must be released promptly and
+ *   before the message queue is closed.
+ *
+ * Input Parameters:
+ *   mq      - Message Queue Descriptor
+ *   msg     - The location to return the message data
+ *   prio    - If not NULL, the location to store message priority.
+ *   abstime - The absolute time to wait until a timeout is declared, or
+ *             NULL to wait without a timeout.
+ *
+ * Returned Value:
+ *   The length of the message in bytes on success.  A negated errno value
+ *   is returned on failure (see mq_timedreceive() for the list of valid
+ *   return values).
+ *
+ ****************************************************************************/
+
+ssize_t file_mq_borrow(FAR struct file *mq, FAR char **msg,
+                       FAR unsigned int *prio,
+                       FAR const struct timespec *abstime);
+
+/****************************************************************************
+ * Name: file_mq_release
+ *
+ * Description:
+ *   Give back a message borrowed with file_mq_borrow().
+ *
+ * Input Parameters:
+ *   mq  - Message Queue Descriptor the message was borrowed from
+ *   msg - The message data returned by file_mq_borrow()
+ *
+ ****************************************************************************/
+
+void file_mq_release(FAR struct file *mq, FAR char *msg);
+
 /****************************************************************************
  * Name:  file_mq_setattr
  *
@@ -0,0 +1,178 @@
+/****************************************************************************
+ * include/nuttx/mtd/mtd_gc.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_MTD_MTD_GC_H
+#define __INCLUDE_NUTTX_MTD_MTD_GC_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <nuttx/mutex.h>
+#include <nuttx/wqueue.h>
+
+#ifdef CONFIG_MTD_GC
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Callbacks provided by the flash translation layer using the garbage
+ * collection scheduler.  Both are called with the device lock held.
+ */
+
+struct mtd_gc_ops_s
+{
+  /* Return the number of free allocation units (sectors or pages) */
+
+  CODE uint32_t (*avail)(FAR void *priv);
+
+  /* Reclaim one unit of garbage, typically one erase block.  'idle' is
+   * true when called from the background worker, in which case the
+   * layer may decline candidates that are not worth the erase cycle.
+   * Returns a positive value if something was reclaimed, zero if there
+   * was nothing (worth) reclaiming, or a negated errno value.
+   */
+
+  CODE int (*collect)(FAR void *priv, bool idle);
+};
+
+/* Statistics returned by the BIOC_GCSTATS ioctl command */
+
+struct mtd_gc_stats_s
+{
+  uint32_t bgcollects;    /* Units reclaimed by the background worker */
+  uint32_t fgcollects;    /* Units reclaimed in the context of a writer */
+  uint32_t fgstalls;      /* Writes that had to wait for reclamation */
+  uint32_t fgmaxus;       /* Longest writer stall (microseconds) */
+  uint64_t fgtotalus;     /* Total writer stall time (microseconds) */
+  uint32_t errors;        /* Failed collection attempts */
+};
+
+/* Garbage collection scheduler state, embedded in the device structure */
+
+struct mtd_gc_s
+{
+  FAR const struct mtd_gc_ops_s *ops;
+  FAR void              *priv;     /* Argument passed to the callbacks */
+  FAR mutex_t           *lock;     /* Device lock held while collecting */
+  uint32_t               lowater;  /* Start collecting below this many free */
+  uint32_t               hiwater;  /* Stop collecting at this many free */
+  bool                   active;   /* Between lowater and hiwater */
+  struct work_s          work;     /* Background collection work */
+  struct mtd_gc_stats_s  stats;
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#undef EXTERN
+#if defined(__cplusplus)
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: mtd_gc_initialize
+ *
+ * Description:
+ *   Initialize the garbage collection scheduler of a flash translation
+ *   layer.  Background collection starts when the number of free units
+ *   drops below 'lowater' and the device has been idle for
+ *   CONFIG_MTD_GC_IDLE_DELAY milliseconds, and continues one unit at a time
+ *   until 'hiwater' free units are available.
+ *
+ ****************************************************************************/
+
+void mtd_gc_initialize(FAR struct mtd_gc_s *gc,
+                       FAR const struct mtd_gc_ops_s *ops, FAR void *priv,
+                       FAR mutex_t *lock, uint32_t lowater,
+                       uint32_t hiwater);
+
+/****************************************************************************
+ * Name: mtd_gc_uninitialize
+ *
+ * Description:
+ *   Stop the background worker.  Must be called without the device lock
+ *   held before the device structure is freed.
+ *
+ ****************************************************************************/
+
+void mtd_gc_uninitialize(FAR struct mtd_gc_s *gc);
+
+/****************************************************************************
+ * Name: mtd_gc_kick
+ *
+ * Description:
+ *   Notify the scheduler that the device was written.  This (re)arms the
+ *   idle timer of the background worker if free space is low, so that
+ *   background collection never competes with a stream of writes.  Called
+ *   with the device lock held.
+ *
+ ****************************************************************************/
+
+void mtd_gc_kick(FAR struct mtd_gc_s *gc);
+
+/****************************************************************************
+ * Name: mtd_gc_reserve
+ *
+ * Description:
+ *   Foreground collection: reclaim just enough for the current write, i.e.
+ *   until at least 'needed' units are free.  Called with the device lock
+ *   held.  The time spent is accounted as a writer stall.
+ *
+ * Returned Value:
+ *   Zero on success, -ENOSPC if 'needed' units cannot be made available,
+ *   or another negated errno value from the collect callback.
+ *
+ ****************************************************************************/
+
+int mtd_gc_reserve(FAR struct mtd_gc_s *gc, uint32_t needed);
+
+/****************************************************************************
+ * Name: mtd_gc_getstats
+ *
+ * Description:
+ *   Return a snapshot of the statistics, optionally resetting them.
+ *   Called with the device lock held.
+ *
+ ****************************************************************************/
+
+void mtd_gc_getstats(FAR struct mtd_gc_s *gc,
+                     FAR struct mtd_gc_stats_s *stats, bool reset);
+
+#undef EXTERN
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* CONFIG_MTD_GC */
+#endif /* __INCLUDE_NUTTX_MTD_MTD_GC_H */
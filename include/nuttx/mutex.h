@@ -52,6 +52,11 @@ struct mutex_s
 #if CONFIG_LIBC_MUTEX_BACKTRACE > 0
   FAR void *backtrace[CONFIG_LIBC_MUTEX_BACKTRACE];
 #endif
+#ifdef CONFIG_LIBC_MUTEX_STATISTICS
+  uint32_t ncontended;  /* Lock attempts that found the mutex locked */
+  uint32_t nspun;       /* Contended locks taken by spinning */
+  uint32_t nblocked;    /* Contended locks taken after blocking */
+#endif
 };
 
 typedef struct mutex_s mutex_t;
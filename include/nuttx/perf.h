@@ -782,25 +782,35 @@ struct perf_event_header_s
 int perf_event_init(void);
 
 /****************************************************************************
- * Name: perf_event_open
+ * Name: perf_event_open and nxperf_event_open
  *
  * Description:
- *   Create and open a perf event
+ *   Create and open a perf event.  Reading the returned file descriptor
+ *   gives the current count; mapping it gives a ring buffer of samples.
+ *   Events opened with attr->inherit set are inherited by the tasks and
+ *   threads the measured task creates afterwards; their counts are added
+ *   to the parent event.
+ *
+ *   nxperf_event_open() is the internal version that does not modify
+ *   errno.
  *
  * Input Parameters:
  *   attr     - Perf event attribute
- *   pid      - Task pid perf event bind
- *   cpu      - Cpu id perf event bind
- *   group_fd - Perf event fd for group leader
+ *   pid      - Task to measure: 0 for the caller, -1 for all tasks on cpu
+ *   cpu      - CPU to measure, or -1 for any CPU the task runs on
+ *   group_fd - Perf event fd of the group leader, or -1
  *   flags    - Perf event flags
  *
  * Returned Value:
- *   Perf event fd
+ *   Perf event fd on success.  On failure perf_event_open() returns -1
+ *   (ERROR) with errno set and nxperf_event_open() a negated errno value.
  *
  ****************************************************************************/
 
 int perf_event_open(FAR struct perf_event_attr_s *attr, pid_t pid,
                     int cpu, int group_fd, unsigned long flags);
+int nxperf_event_open(FAR struct perf_event_attr_s *attr, pid_t pid,
+                      int cpu, int group_fd, unsigned long flags);
 
 /****************************************************************************
  * Name: perf_event_overflow
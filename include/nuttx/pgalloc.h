@@ -30,6 +30,7 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 #ifdef CONFIG_MM_PGALLOC
@@ -47,7 +48,13 @@
  * CONFIG_DEBUG_PGALLOC - Just like CONFIG_DEBUG_MM, but only generates
  *   output from the page allocation logic.
  *
- * Dependencies:  CONFIG_ARCH_USE_MMU and CONFIG_GRAN
+ * CONFIG_MM_PGALLOC_BUDDY - Use the buddy allocator instead of the
+ *   granule allocator.
+ * CONFIG_MM_PGALLOC_MAXORDER - The largest buddy block is
+ *   2^CONFIG_MM_PGALLOC_MAXORDER pages.
+ *
+ * Dependencies:  CONFIG_ARCH_USE_MMU and CONFIG_GRAN, if the granule
+ *   allocator is used.
  */
 
 #ifndef CONFIG_MM_PGALLOC_PGSIZE
@@ -92,6 +99,12 @@ struct pginfo_s
   uint16_t  ntotal;  /* The total number of pages */
   uint16_t  nfree;   /* The number of free pages */
   uint16_t  mxfree;  /* The longest sequence of free pages */
+#ifdef CONFIG_MM_PGALLOC_BUDDY
+
+  /* The number of free blocks of 2^n pages */
+
+  uint16_t  nblocks[CONFIG_MM_PGALLOC_MAXORDER + 1];
+#endif
 };
 
 /****************************************************************************
@@ -203,6 +216,64 @@ void mm_pgfree(uintptr_t paddr, unsigned int npages);
 
 void mm_pginfo(FAR struct pginfo_s *info);
 
+#ifdef CONFIG_MM_PGREF
+
+/****************************************************************************
+ * Name: mm_pgref_initialize
+ *
+ * Description:
+ *   Initialize the page reference counts.  Called by mm_pginitialize() with
+ *   the same region.
+ *
+ ****************************************************************************/
+
+void mm_pgref_initialize(FAR void *heap_start, size_t heap_size);
+
+/****************************************************************************
+ * Name: mm_pgget
+ *
+ * Description:
+ *   Take another reference to a page allocated by mm_pgalloc(), for a page
+ *   that is about to be mapped by one more address environment.  A freshly
+ *   allocated page holds one reference.
+ *
+ * Input Parameters:
+ *   paddr - The physical address of the page.
+ *
+ ****************************************************************************/
+
+void mm_pgget(uintptr_t paddr);
+
+/****************************************************************************
+ * Name: mm_pgput
+ *
+ * Description:
+ *   Drop a reference to a page, returning it to the page memory pool when
+ *   this was the last one.
+ *
+ * Input Parameters:
+ *   paddr - The physical address of the page.
+ *
+ * Returned Value:
+ *   True if the page was freed.
+ *
+ ****************************************************************************/
+
+bool mm_pgput(uintptr_t paddr);
+
+/****************************************************************************
+ * Name: mm_pgrefs
+ *
+ * Description:
+ *   Return the number of references to a page.  The answer is only stable
+ *   when the caller holds the only reference.
+ *
+ ****************************************************************************/
+
+unsigned int mm_pgrefs(uintptr_t paddr);
+
+#endif /* CONFIG_MM_PGREF */
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -164,6 +164,46 @@ int nx_pthread_create(pthread_trampoline_t trampoline, FAR pthread_t *thread,
 
 void nx_pthread_exit(FAR void *exit_value) noreturn_function;
 
+#ifdef CONFIG_FUTEX
+/****************************************************************************
+ * Name: nx_pthread_mutex_timedlock, nx_pthread_mutex_trylock and
+ *       nx_pthread_mutex_unlock
+ *
+ * Description:
+ *   Kernel side of pthread_mutex_timedlock(), pthread_mutex_trylock() and
+ *   pthread_mutex_unlock().  libc locks futex mutexes in user space and
+ *   only calls these for mutexes that need the kernel (robust, recursive,
+ *   error checking or priority inheritance/protection mutexes).
+ *
+ * Returned Value:
+ *   0 on success or an errno value on failure.
+ *
+ ****************************************************************************/
+
+int nx_pthread_mutex_timedlock(FAR pthread_mutex_t *mutex,
+                               FAR const struct timespec *abs_timeout);
+int nx_pthread_mutex_trylock(FAR pthread_mutex_t *mutex);
+int nx_pthread_mutex_unlock(FAR pthread_mutex_t *mutex);
+
+/****************************************************************************
+ * Name: nx_pthread_mutex_breaklock and nx_pthread_mutex_restorelock
+ *
+ * Description:
+ *   Release a kernel mutex however many times the caller holds it, and
+ *   reacquire it with the same count.  Used by the futex-based condition
+ *   variables.
+ *
+ * Returned Value:
+ *   0 on success or an errno value on failure.
+ *
+ ****************************************************************************/
+
+int nx_pthread_mutex_breaklock(FAR pthread_mutex_t *mutex,
+                               FAR unsigned int *nlocks);
+int nx_pthread_mutex_restorelock(FAR pthread_mutex_t *mutex,
+                                 unsigned int nlocks);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
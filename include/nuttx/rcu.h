@@ -0,0 +1,150 @@
+/****************************************************************************
+ * include/nuttx/rcu.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_RCU_H
+#define __INCLUDE_NUTTX_RCU_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <nuttx/compiler.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* rcu_dereference() fetches an RCU protected pointer inside a read-side
+ * critical section exactly once.  rcu_assign_pointer() publishes a pointer
+ * after the object it points to has been initialized.  Both are available
+ * without CONFIG_RCU so that shared code need not be conditioned on it.
+ * rcu_assign_pointer() relies on SP_DMB() from <nuttx/spinlock.h>, which
+ * is not included here because <nuttx/sched.h> depends on this header.
+ */
+
+#ifdef __GNUC__
+#  define rcu_dereference(p)  (*(FAR volatile __typeof__(p) *)&(p))
+#else
+#  define rcu_dereference(p)  (p)
+#endif
+
+#define rcu_assign_pointer(p, v) \
+  do \
+    { \
+      SP_DMB(); \
+      (p) = (v); \
+    } \
+  while (0)
+
+#ifdef CONFIG_RCU
+
+/****************************************************************************
+ * Public Type Declarations
+ ****************************************************************************/
+
+/* An rcu_head is embedded in an object freed through call_rcu() */
+
+struct rcu_head;
+typedef CODE void (*rcu_callback_t)(FAR struct rcu_head *head);
+
+struct rcu_head
+{
+  FAR struct rcu_head *next;     /* Supports a singly linked list */
+  rcu_callback_t       func;     /* Called after the grace period */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: rcu_read_lock
+ *
+ * Description:
+ *   Enter an RCU read-side critical section.  Read-side critical sections
+ *   may nest and may be used from interrupt handlers.  They disable local
+ *   interrupts, so they must be short and must never block.
+ *
+ ****************************************************************************/
+
+void rcu_read_lock(void);
+
+/****************************************************************************
+ * Name: rcu_read_unlock
+ *
+ * Description:
+ *   Leave an RCU read-side critical section.
+ *
+ ****************************************************************************/
+
+void rcu_read_unlock(void);
+
+/****************************************************************************
+ * Name: synchronize_rcu
+ *
+ * Description:
+ *   Wait until every RCU read-side critical section that was in progress
+ *   when synchronize_rcu() was called has completed.  After it returns,
+ *   objects that were unlinked before the call may be freed.
+ *
+ * Assumptions:
+ *   Called from task context, outside of any read-side critical section.
+ *
+ ****************************************************************************/
+
+void synchronize_rcu(void);
+
+/****************************************************************************
+ * Name: call_rcu
+ *
+ * Description:
+ *   Call 'func' from the low priority work queue once a grace period has
+ *   elapsed, typically to free the object that contains 'head'.
+ *
+ * Input Parameters:
+ *   head - The rcu_head embedded in the object
+ *   func - The callback
+ *
+ * Assumptions:
+ *   May be called from interrupt handlers.
+ *
+ ****************************************************************************/
+
+void call_rcu(FAR struct rcu_head *head, rcu_callback_t func);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_RCU */
+#endif /* __INCLUDE_NUTTX_RCU_H */
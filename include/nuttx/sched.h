@@ -43,12 +43,17 @@
 #include <nuttx/mutex.h>
 #include <nuttx/semaphore.h>
 #include <nuttx/queue.h>
+#include <nuttx/rcu.h>
 #include <nuttx/wdog.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/net/net.h>
 #include <nuttx/mm/map.h>
 #include <nuttx/tls.h>
 
+#ifdef CONFIG_HRTIMER
+#  include <nuttx/hrtimer.h>
+#endif
+
 #include <arch/arch.h>
 
 /****************************************************************************
@@ -123,6 +128,7 @@
 #  define TCB_FLAG_SCHED_FIFO      (0 << TCB_FLAG_POLICY_SHIFT)  /* FIFO scheding policy */
 #  define TCB_FLAG_SCHED_RR        (1 << TCB_FLAG_POLICY_SHIFT)  /* Round robin scheding policy */
 #  define TCB_FLAG_SCHED_SPORADIC  (2 << TCB_FLAG_POLICY_SHIFT)  /* Sporadic scheding policy */
+#  define TCB_FLAG_SCHED_DEADLINE  (3 << TCB_FLAG_POLICY_SHIFT)  /* Deadline scheding policy */
 #define TCB_FLAG_CPU_LOCKED        (1 << 5)                      /* Bit 5: Locked to this CPU */
 #define TCB_FLAG_SIGNAL_ACTION     (1 << 6)                      /* Bit 6: In a signal handler */
 #define TCB_FLAG_SYSCALL           (1 << 7)                      /* Bit 7: In a system call */
@@ -283,6 +289,9 @@ enum tstate_e
 #ifdef CONFIG_SIG_SIGSTOP_ACTION
   TSTATE_TASK_STOPPED,        /* BLOCKED      - Waiting for SIGCONT */
 #endif
+#ifdef CONFIG_SCHED_DEADLINE
+  TSTATE_TASK_THROTTLED,      /* BLOCKED      - Waiting for deadline budget */
+#endif
 
   NUM_TASK_STATES             /* Must be last */
 };
@@ -369,6 +378,33 @@ struct sporadic_s
 
 #endif /* CONFIG_SCHED_SPORADIC */
 
+/* struct deadline_s ********************************************************/
+
+#ifdef CONFIG_SCHED_DEADLINE
+
+/* This structure is an allocated "plug-in" to the main TCB structure that
+ * holds the SCHED_DEADLINE parameters and the state of the constant
+ * bandwidth server (CBS) that enforces them.  All times are in system
+ * clock ticks.
+ */
+
+struct deadline_s
+{
+  FAR struct tcb_s *tcb;            /* The parent TCB structure              */
+  struct wdog_s timer;              /* Budget exhausted or replenished       */
+  clock_t   runtime;                /* Budget per period (Q)                 */
+  clock_t   deadline;               /* Relative deadline (D)                 */
+  clock_t   period;                 /* Period (P)                            */
+  clock_t   abs_deadline;           /* Current absolute deadline             */
+  clock_t   eventtime;              /* Time the thread was last resumed      */
+  sclock_t  budget;                 /* Budget remaining in this period       */
+  uint32_t  bandwidth;              /* Q/P in 12.20 fixed point              */
+  uint32_t  nmisses;                /* Jobs completed after their deadline   */
+  uint32_t  noverruns;              /* Budget exhausted before the deadline  */
+};
+
+#endif /* CONFIG_SCHED_DEADLINE */
+
 /* struct child_status_s ****************************************************/
 
 /* This structure is used to maintain information about child tasks.
@@ -581,6 +617,10 @@ struct task_group_s
  * definitions.
  */
 
+#ifdef CONFIG_SCHED_PERF_EVENTS
+struct perf_event_context_s;             /* Forward reference               */
+#endif
+
 struct tcb_s
 {
   /* Fields used to support list management *********************************/
@@ -629,6 +669,12 @@ struct tcb_s
   uint8_t  boost_priority;               /* Boosted priority of the thread  */
   uint8_t  base_priority;                /* Normal priority of the thread   */
   FAR struct semholder_s *holdsem;       /* List of held semaphores         */
+#ifdef CONFIG_SEM_PI_WAITERS
+  struct semholder_tree_s pi_waiters;    /* Held semaphores with waiters    */
+#  if CONFIG_SEM_PREALLOCHOLDERS > 0
+  struct semholder_s holders[CONFIG_SEM_TCBHOLDERS]; /* Holder records      */
+#  endif
+#endif
 #endif
 
 #ifdef CONFIG_SMP
@@ -649,8 +695,17 @@ struct tcb_s
 #ifdef CONFIG_SCHED_SPORADIC
   FAR struct sporadic_s *sporadic;       /* Sporadic scheduling parameters  */
 #endif
+#ifdef CONFIG_SCHED_DEADLINE
+  FAR struct deadline_s *deadline;       /* Deadline scheduling parameters  */
+#endif
 
   struct wdog_s waitdog;                 /* All timed waits use this timer  */
+#ifdef CONFIG_HRTIMER
+  struct hrtimer_s waithrtimer;          /* Timer for clock_nanosleep()     */
+#endif
+#ifdef CONFIG_RCU
+  struct rcu_head rcu;                   /* Defers nxsched_free_tcb()       */
+#endif
 
   /* Stack-Related Fields ***************************************************/
 
@@ -715,6 +770,18 @@ struct tcb_s
   void   *crit_max_caller;               /* Caller of max critical section  */
 #endif
 
+#ifdef CONFIG_SCHED_LATENCYMON
+  clock_t wake_start;                    /* Time the thread was woken up    */
+  uint8_t wake_type;                     /* Latency to record on resume     */
+#endif
+
+  /* Performance counters ***************************************************/
+
+#ifdef CONFIG_SCHED_PERF_EVENTS
+  FAR struct perf_event_context_s *perf_event_ctx; /* Per-task events      */
+  mutex_t perf_event_mutex;              /* Protects perf_event_ctx         */
+#endif
+
   /* State save areas *******************************************************/
 
   /* The form and content of these fields are platform-specific.            */
@@ -952,6 +1019,31 @@ FAR struct tcb_s *nxsched_get_tcb(pid_t pid);
 
 int nxsched_release_tcb(FAR struct tcb_s *tcb, uint8_t ttype);
 
+/****************************************************************************
+ * Name: nxsched_alloc_tcb and nxsched_free_tcb
+ *
+ * Description:
+ *   Allocate a zeroed TCB of 'size' bytes, at most the size of a
+ *   struct task_tcb_s or struct pthread_tcb_s, and free it again.  TCBs
+ *   marked with TCB_FLAG_FREE_TCB must be allocated this way, they are
+ *   freed with nxsched_free_tcb() when the task exits.  With CONFIG_RCU
+ *   the memory is released only after an RCU grace period, so that
+ *   lockless nxsched_get_tcb() callers never see a freed TCB.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MM_KMEM_CACHE
+FAR void *nxsched_alloc_tcb(size_t size);
+#else
+#  define nxsched_alloc_tcb(size) kmm_zalloc(size)
+#endif
+
+#if defined(CONFIG_MM_KMEM_CACHE) || defined(CONFIG_RCU)
+void nxsched_free_tcb(FAR struct tcb_s *tcb);
+#else
+#  define nxsched_free_tcb(tcb)   kmm_free(tcb)
+#endif
+
 /* File system helpers ******************************************************/
 
 /* These functions all extract lists from the group structure associated with
@@ -1697,6 +1789,26 @@ void nxsched_dumponexit(void);
 #  define nxsched_dumponexit()
 #endif /* CONFIG_SCHED_DUMP_ON_EXIT */
 
+/****************************************************************************
+ * Name: nxsched_profile_start, nxsched_profile_stop and
+ *       nxsched_profile_sample
+ *
+ * Description:
+ *   Control the system-wide sampling profiler.  While it is started, every
+ *   CPU records the running thread and its unwound call stack
+ *   CONFIG_SCHED_PROFILE_TICKSPERSEC times per second.  Interrupt handlers
+ *   of other event sources (e.g. PMU counter overflow) may also call
+ *   nxsched_profile_sample() to take a sample on the current CPU.  The
+ *   result is read from /proc/profile in folded stack format.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_PROFILE_SAMPLER
+int nxsched_profile_start(void);
+int nxsched_profile_stop(void);
+void nxsched_profile_sample(void);
+#endif
+
 #ifdef CONFIG_SMP
 /****************************************************************************
  * Name: nxsched_smp_call_handler
@@ -102,6 +102,10 @@ typedef union spinlock_u spinlock_t;
  *
  *   DMB - Data memory barrier.  Assures writes are completed to memory.
  *   DSB - Data synchronization barrier.
+ *
+ * As well as a hint that the CPU is busy-waiting:
+ *
+ *   RELAX - Yield pipeline resources to other hardware threads.
  */
 
 #undef __SP_UNLOCK_FUNCTION
@@ -119,6 +123,10 @@ typedef union spinlock_u spinlock_t;
 #  define SP_WFE()
 #endif
 
+#if !defined(SP_RELAX)
+#  define SP_RELAX()
+#endif
+
 #if !defined(SP_SEV)
 #  define SP_SEV()
 #endif
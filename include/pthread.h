@@ -189,6 +189,16 @@
 #define _PTHREAD_MFLAGS_INCONSISTENT  (1 << 1) /* Mutex is in an inconsistent state */
 #define _PTHREAD_MFLAGS_NRECOVERABLE  (1 << 2) /* Inconsistent mutex has been unlocked */
 
+/* Values for struct pthread_mutex_s futex.  A mutex whose futex word is
+ * _PTHREAD_MFUTEX_NONE is handled by the kernel; any other value means the
+ * mutex is locked and unlocked in user space with futex().
+ */
+
+#define _PTHREAD_MFUTEX_NONE          0 /* Kernel mutex */
+#define _PTHREAD_MFUTEX_UNLOCKED      1 /* Futex mutex, unlocked */
+#define _PTHREAD_MFUTEX_LOCKED        2 /* Futex mutex, locked */
+#define _PTHREAD_MFUTEX_CONTENDED     3 /* Futex mutex, locked with waiters */
+
 /* The contention scope attribute in thread attributes object */
 
 #define PTHREAD_SCOPE_SYSTEM          0
@@ -265,19 +275,39 @@ typedef struct pthread_condattr_s pthread_condattr_t;
 #  define __PTHREAD_CONDATTR_T_DEFINED 1
 #endif
 
+#ifdef CONFIG_FUTEX
+/* The futex-based condition variable sleeps on a sequence number that is
+ * bumped by every signal, so signalling with no waiters stays in user
+ * space.
+ */
+
+struct pthread_cond_s
+{
+  uint32_t seq;         /* Futex word, bumped by each signal */
+  uint32_t wait_count;  /* Number of threads waiting on the condition */
+  clockid_t clockid;
+  uint8_t pshared;      /* PTHREAD_PROCESS_PRIVATE or _SHARED */
+};
+#else
 struct pthread_cond_s
 {
   sem_t sem;
   clockid_t clockid;
   uint16_t wait_count;
 };
+#endif
 
 #ifndef __PTHREAD_COND_T_DEFINED
 typedef struct pthread_cond_s pthread_cond_t;
 #  define __PTHREAD_COND_T_DEFINED 1
 #endif
 
-#define PTHREAD_COND_INITIALIZER {SEM_INITIALIZER(0), CLOCK_REALTIME }
+#ifdef CONFIG_FUTEX
+#  define PTHREAD_COND_INITIALIZER {0, 0, CLOCK_REALTIME, \
+                                    PTHREAD_PROCESS_PRIVATE}
+#else
+#  define PTHREAD_COND_INITIALIZER {SEM_INITIALIZER(0), CLOCK_REALTIME }
+#endif
 
 struct pthread_mutexattr_s
 {
@@ -318,6 +348,9 @@ struct pthread_mutex_s
 #else
   mutex_t mutex;    /* Mutex underlying the implementation of the mutex */
 #endif
+#ifdef CONFIG_FUTEX
+  uint32_t futex;   /* See _PTHREAD_MFUTEX_* */
+#endif
 };
 
 #ifndef __PTHREAD_MUTEX_T_DEFINED
@@ -333,25 +366,48 @@ typedef struct pthread_mutex_s pthread_mutex_t;
 #  endif
 #endif
 
+/* Only default, non-robust mutexes without priority inheritance can be
+ * locked in user space; everything else stays a kernel mutex.
+ */
+
+#if !defined(CONFIG_FUTEX)
+#  define __PTHREAD_MUTEX_FUTEX_INIT
+#  define __PTHREAD_RMUTEX_FUTEX_INIT
+#elif !defined(CONFIG_PRIORITY_INHERITANCE) && \
+      (defined(CONFIG_PTHREAD_MUTEX_UNSAFE) || \
+       defined(CONFIG_PTHREAD_MUTEX_DEFAULT_UNSAFE))
+#  define __PTHREAD_MUTEX_FUTEX_INIT  , _PTHREAD_MFUTEX_UNLOCKED
+#  define __PTHREAD_RMUTEX_FUTEX_INIT , _PTHREAD_MFUTEX_NONE
+#else
+#  define __PTHREAD_MUTEX_FUTEX_INIT  , _PTHREAD_MFUTEX_NONE
+#  define __PTHREAD_RMUTEX_FUTEX_INIT , _PTHREAD_MFUTEX_NONE
+#endif
+
 #if defined(CONFIG_PTHREAD_MUTEX_TYPES) && !defined(CONFIG_PTHREAD_MUTEX_UNSAFE)
 #  define PTHREAD_MUTEX_INITIALIZER {NULL, __PTHREAD_MUTEX_DEFAULT_FLAGS, \
                                      PTHREAD_MUTEX_DEFAULT, \
-                                     NXRMUTEX_INITIALIZER}
+                                     NXRMUTEX_INITIALIZER \
+                                     __PTHREAD_MUTEX_FUTEX_INIT}
 #  define PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP \
                                     {NULL, __PTHREAD_MUTEX_DEFAULT_FLAGS, \
                                      PTHREAD_MUTEX_RECURSIVE, \
-                                     NXRMUTEX_INITIALIZER,}
+                                     NXRMUTEX_INITIALIZER \
+                                     __PTHREAD_RMUTEX_FUTEX_INIT}
 #elif defined(CONFIG_PTHREAD_MUTEX_TYPES)
 #  define PTHREAD_MUTEX_INITIALIZER {PTHREAD_MUTEX_DEFAULT, \
-                                     NXRMUTEX_INITIALIZER,}
+                                     NXRMUTEX_INITIALIZER \
+                                     __PTHREAD_MUTEX_FUTEX_INIT}
 #  define PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP \
                                     {PTHREAD_MUTEX_RECURSIVE, \
-                                     NXRMUTEX_INITIALIZER}
+                                     NXRMUTEX_INITIALIZER \
+                                     __PTHREAD_RMUTEX_FUTEX_INIT}
 #elif !defined(CONFIG_PTHREAD_MUTEX_UNSAFE)
 #  define PTHREAD_MUTEX_INITIALIZER {NULL, __PTHREAD_MUTEX_DEFAULT_FLAGS,\
-                                     NXMUTEX_INITIALIZER}
+                                     NXMUTEX_INITIALIZER \
+                                     __PTHREAD_MUTEX_FUTEX_INIT}
 #else
-#  define PTHREAD_MUTEX_INITIALIZER {NXMUTEX_INITIALIZER}
+#  define PTHREAD_MUTEX_INITIALIZER {NXMUTEX_INITIALIZER \
+                                     __PTHREAD_MUTEX_FUTEX_INIT}
 #endif
 
 struct pthread_barrierattr_s
@@ -398,6 +454,18 @@ typedef struct pthread_rwlockattr_s pthread_rwlockattr_t;
 #  define __PTHREAD_RWLOCKATTR_T_DEFINED 1
 #endif
 
+#ifdef CONFIG_FUTEX
+/* The futex-based read/write lock keeps the whole lock state in one word
+ * so that uncontended operations never enter the kernel.
+ */
+
+struct pthread_rwlock_s
+{
+  uint32_t state;       /* Reader count, writer and waiters bits */
+  uint32_t num_writers; /* Number of writers waiting for the lock */
+  uint8_t pshared;      /* PTHREAD_PROCESS_PRIVATE or _SHARED */
+};
+#else
 struct pthread_rwlock_s
 {
   pthread_mutex_t lock;
@@ -406,15 +474,20 @@ struct pthread_rwlock_s
   unsigned int num_writers;
   bool write_in_progress;
 };
+#endif
 
 #ifndef __PTHREAD_RWLOCK_T_DEFINED
 typedef struct pthread_rwlock_s pthread_rwlock_t;
 #  define __PTHREAD_RWLOCK_T_DEFINED 1
 #endif
 
-#define PTHREAD_RWLOCK_INITIALIZER  {PTHREAD_MUTEX_INITIALIZER, \
-                                     PTHREAD_COND_INITIALIZER, \
-                                     0, 0, false}
+#ifdef CONFIG_FUTEX
+#  define PTHREAD_RWLOCK_INITIALIZER  {0, 0, PTHREAD_PROCESS_PRIVATE}
+#else
+#  define PTHREAD_RWLOCK_INITIALIZER  {PTHREAD_MUTEX_INITIALIZER, \
+                                       PTHREAD_COND_INITIALIZER, \
+                                       0, 0, false}
+#endif
 
 #ifdef CONFIG_PTHREAD_SPINLOCKS
 /* This (non-standard) structure represents a pthread spinlock */
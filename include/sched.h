@@ -50,6 +50,7 @@
 #define SCHED_SPORADIC            3  /* Sporadic scheduling policy */
 #define SCHED_BATCH               4  /* Batch scheduling policy */
 #define SCHED_IDLE                5  /* Idle scheduling policy */
+#define SCHED_DEADLINE            6  /* Earliest deadline first policy */
 
 /* Maximum number of SCHED_SPORADIC replenishments */
 
@@ -203,6 +204,24 @@ struct sched_param
 #endif
 };
 
+/* Extended scheduling attributes for sched_setattr() and sched_getattr().
+ * The layout matches Linux.  For SCHED_DEADLINE, the thread is granted
+ * sched_runtime nanoseconds of CPU time in every sched_period, and each
+ * such job must complete within sched_deadline of its release.
+ */
+
+struct sched_attr
+{
+  uint32_t size;                        /* Size of this structure */
+  uint32_t sched_policy;                /* Scheduling policy */
+  uint64_t sched_flags;                 /* Reserved, must be zero */
+  int32_t  sched_nice;                  /* Unused */
+  uint32_t sched_priority;              /* SCHED_FIFO/RR priority */
+  uint64_t sched_runtime;               /* SCHED_DEADLINE budget (ns) */
+  uint64_t sched_deadline;              /* SCHED_DEADLINE deadline (ns) */
+  uint64_t sched_period;                /* SCHED_DEADLINE period (ns) */
+};
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -249,6 +268,10 @@ int    sched_yield(void);
 int    sched_get_priority_max(int policy);
 int    sched_get_priority_min(int policy);
 int    sched_rr_get_interval(pid_t pid, FAR struct timespec *interval);
+int    sched_setattr(pid_t pid, FAR const struct sched_attr *attr,
+                     unsigned int flags);
+int    sched_getattr(pid_t pid, FAR struct sched_attr *attr,
+                     unsigned int size, unsigned int flags);
 
 #ifdef CONFIG_SMP
 /* Task affinity */
@@ -33,6 +33,9 @@
 #include <limits.h>
 #include <time.h>
 #include <nuttx/queue.h>
+#ifdef CONFIG_SEM_PI_WAITERS
+#  include <sys/tree.h>
+#endif
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -74,8 +77,16 @@ struct semholder_s
   FAR struct sem_s *sem;          /* Ths corresponding semaphore           */
   FAR struct tcb_s *htcb;         /* Ths corresponding TCB                 */
   int16_t counts;                 /* Number of counts owned by this holder */
+#ifdef CONFIG_SEM_PI_WAITERS
+  uint8_t pi_prio;                /* Priority of the top waiter, 0 if none */
+  RB_ENTRY(semholder_s) pi_node;  /* Entry in the pi_waiters tree of htcb  */
+#endif
 };
 
+#ifdef CONFIG_SEM_PI_WAITERS
+RB_HEAD(semholder_tree_s, semholder_s);
+#endif
+
 #if CONFIG_SEM_PREALLOCHOLDERS > 0
 #  define SEMHOLDER_INITIALIZER   {NULL, NULL, NULL, NULL, 0}
 #  define INITIALIZE_SEMHOLDER(h) \
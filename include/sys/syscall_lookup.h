@@ -36,12 +36,14 @@ SYSCALL_LOOKUP(prctl,                      2)
   SYSCALL_LOOKUP(getppid,                  0)
 #endif
 
+SYSCALL_LOOKUP(sched_getattr,              4)
 SYSCALL_LOOKUP(sched_getcpu,               0)
 SYSCALL_LOOKUP(sched_getparam,             2)
 SYSCALL_LOOKUP(sched_getscheduler,         1)
 SYSCALL_LOOKUP(sched_lock,                 0)
 SYSCALL_LOOKUP(sched_lockcount,            0)
 SYSCALL_LOOKUP(sched_rr_get_interval,      2)
+SYSCALL_LOOKUP(sched_setattr,              3)
 SYSCALL_LOOKUP(sched_setparam,             2)
 SYSCALL_LOOKUP(sched_setscheduler,         3)
 SYSCALL_LOOKUP(sched_unlock,               0)
@@ -101,6 +103,14 @@ SYSCALL_LOOKUP(nxsem_wait,                 1)
   SYSCALL_LOOKUP(nxsem_unlink,             1)
 #endif
 
+#ifdef CONFIG_FUTEX
+  SYSCALL_LOOKUP(futex,                    6)
+#endif
+
+#ifdef CONFIG_SCHED_PERF_EVENTS
+  SYSCALL_LOOKUP(perf_event_open,          5)
+#endif
+
 #ifndef CONFIG_BUILD_KERNEL
   SYSCALL_LOOKUP(task_create,              5)
   SYSCALL_LOOKUP(task_spawn,               6)
@@ -310,9 +320,11 @@ SYSCALL_LOOKUP(munmap,                     2)
 #ifndef CONFIG_DISABLE_PTHREAD
   SYSCALL_LOOKUP(pthread_barrier_wait,     1)
   SYSCALL_LOOKUP(pthread_cancel,           1)
+#ifndef CONFIG_FUTEX
   SYSCALL_LOOKUP(pthread_cond_broadcast,   1)
   SYSCALL_LOOKUP(pthread_cond_signal,      1)
   SYSCALL_LOOKUP(pthread_cond_wait,        2)
+#endif
   SYSCALL_LOOKUP(nx_pthread_create,        5)
   SYSCALL_LOOKUP(pthread_detach,           1)
   SYSCALL_LOOKUP(nx_pthread_exit,          1)
@@ -320,9 +332,17 @@ SYSCALL_LOOKUP(munmap,                     2)
   SYSCALL_LOOKUP(pthread_join,             2)
   SYSCALL_LOOKUP(pthread_mutex_destroy,    1)
   SYSCALL_LOOKUP(pthread_mutex_init,       2)
+#ifdef CONFIG_FUTEX
+  SYSCALL_LOOKUP(nx_pthread_mutex_timedlock, 2)
+  SYSCALL_LOOKUP(nx_pthread_mutex_trylock, 1)
+  SYSCALL_LOOKUP(nx_pthread_mutex_unlock,  1)
+  SYSCALL_LOOKUP(nx_pthread_mutex_breaklock, 2)
+  SYSCALL_LOOKUP(nx_pthread_mutex_restorelock, 2)
+#else
   SYSCALL_LOOKUP(pthread_mutex_timedlock,  2)
   SYSCALL_LOOKUP(pthread_mutex_trylock,    1)
   SYSCALL_LOOKUP(pthread_mutex_unlock,     1)
+#endif
 #ifndef CONFIG_PTHREAD_MUTEX_UNSAFE
   SYSCALL_LOOKUP(pthread_mutex_consistent, 1)
 #endif
@@ -332,7 +352,9 @@ SYSCALL_LOOKUP(munmap,                     2)
   SYSCALL_LOOKUP(pthread_setaffinity_np,   3)
   SYSCALL_LOOKUP(pthread_getaffinity_np,   3)
 #endif
+#ifndef CONFIG_FUTEX
   SYSCALL_LOOKUP(pthread_cond_clockwait,   4)
+#endif
   SYSCALL_LOOKUP(pthread_sigmask,          3)
 #endif
 
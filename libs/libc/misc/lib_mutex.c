@@ -29,7 +29,9 @@
 #include <nuttx/sched.h>
 #include <nuttx/clock.h>
 #include <nuttx/mutex.h>
+#include <nuttx/rcu.h>
 #include <nuttx/semaphore.h>
+#include <nuttx/spinlock.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -37,6 +39,25 @@
 
 #define NXMUTEX_RESET          ((pid_t)-2)
 
+/* Spinning needs the TCB of the holder, so only kernel code spins */
+
+#if CONFIG_LIBC_MUTEX_SPIN > 0 && \
+    (defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__))
+#  define NXMUTEX_SPIN
+#endif
+
+/* The polls of a spinning lock are spaced by a number of CPU relax hints
+ * that doubles after each poll, up to this many.
+ */
+
+#define NXMUTEX_SPIN_BACKOFF   64
+
+#ifdef CONFIG_LIBC_MUTEX_STATISTICS
+#  define nxmutex_stats(mutex, field) ((mutex)->field++)
+#else
+#  define nxmutex_stats(mutex, field)
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -88,6 +109,152 @@ static void nxmutex_add_backtrace(FAR mutex_t *mutex)
 #  define nxmutex_add_backtrace(mutex)
 #endif
 
+/****************************************************************************
+ * Name: nxmutex_holder_running
+ *
+ * Description:
+ *   Check whether the holder of a mutex is running.  TCBs are freed only
+ *   after an RCU grace period, so this takes neither the critical section
+ *   nor a reference on the TCB.
+ *
+ * Parameters:
+ *   holder - The process ID of the holder.
+ *
+ * Return Value:
+ *   True if the holder is running on a CPU.
+ *
+ ****************************************************************************/
+
+#ifdef NXMUTEX_SPIN
+static bool nxmutex_holder_running(pid_t holder)
+{
+  FAR struct tcb_s *htcb;
+  bool running;
+
+  rcu_read_lock();
+  htcb    = nxsched_get_tcb(holder);
+  running = htcb != NULL && htcb->task_state == TSTATE_TASK_RUNNING;
+  rcu_read_unlock();
+
+  return running;
+}
+
+/****************************************************************************
+ * Name: nxmutex_spin
+ *
+ * Description:
+ *   Try to take a locked mutex by polling it as long as its holder is
+ *   running on another CPU, up to CONFIG_LIBC_MUTEX_SPIN times.
+ *
+ * Parameters:
+ *   mutex - mutex descriptor.
+ *
+ * Return Value:
+ *   Zero (OK) if the mutex was taken, a negated errno value otherwise.
+ *
+ ****************************************************************************/
+
+static int nxmutex_spin(FAR mutex_t *mutex)
+{
+  int backoff = 1;
+  int budget;
+  int i;
+
+  for (budget = 0; budget < CONFIG_LIBC_MUTEX_SPIN; budget++)
+    {
+      pid_t holder = *(FAR volatile pid_t *)&mutex->holder;
+
+      if (holder == NXMUTEX_NO_HOLDER)
+        {
+          /* Released, or the new holder did not record itself yet */
+
+          if (nxsem_trywait(&mutex->sem) >= 0)
+            {
+              return OK;
+            }
+        }
+      else if (!nxmutex_holder_running(holder))
+        {
+          /* There is no point in spinning if the holder is not running */
+
+          break;
+        }
+
+      /* Back off, so that spinning CPUs do not keep hammering the cache
+       * line of the mutex while the holder tries to release it.
+       */
+
+      for (i = 0; i < backoff; i++)
+        {
+          SP_RELAX();
+        }
+
+      if (backoff < NXMUTEX_SPIN_BACKOFF)
+        {
+          backoff <<= 1;
+        }
+    }
+
+  return -EAGAIN;
+}
+#endif
+
+/****************************************************************************
+ * Name: nxmutex_wait
+ *
+ * Description:
+ *   Take the semaphore of a mutex, spinning first if the mutex is locked
+ *   by a thread running on another CPU.
+ *
+ * Parameters:
+ *   mutex   - mutex descriptor.
+ *   clockid - The clock to be used as the time base
+ *   abstime - The absolute time when the mutex lock timed out, or NULL
+ *
+ * Return Value:
+ *   The result of nxsem_wait() or nxsem_clockwait().
+ *
+ ****************************************************************************/
+
+static int nxmutex_wait(FAR mutex_t *mutex, clockid_t clockid,
+                        FAR const struct timespec *abstime)
+{
+  int ret;
+
+#if defined(NXMUTEX_SPIN) || defined(CONFIG_LIBC_MUTEX_STATISTICS)
+  if (nxsem_trywait(&mutex->sem) >= 0)
+    {
+      return OK;
+    }
+
+  nxmutex_stats(mutex, ncontended);
+#endif
+
+#ifdef NXMUTEX_SPIN
+  if (nxmutex_spin(mutex) >= 0)
+    {
+      nxmutex_stats(mutex, nspun);
+      return OK;
+    }
+#endif
+
+  if (abstime)
+    {
+      ret = nxsem_clockwait(&mutex->sem, clockid, abstime);
+    }
+  else
+    {
+      ret = nxsem_wait(&mutex->sem);
+    }
+
+  if (ret >= 0)
+    {
+      nxmutex_stats(mutex, nblocked);
+    }
+
+  return ret;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -248,9 +415,9 @@ int nxmutex_lock(FAR mutex_t *mutex)
   DEBUGASSERT(!nxmutex_is_hold(mutex));
   for (; ; )
     {
-      /* Take the semaphore (perhaps waiting) */
+      /* Take the semaphore (perhaps spinning or waiting) */
 
-      ret = nxsem_wait(&mutex->sem);
+      ret = nxmutex_wait(mutex, CLOCK_REALTIME, NULL);
       if (ret >= 0)
         {
           mutex->holder = _SCHED_GETTID();
@@ -337,14 +504,7 @@ int nxmutex_clocklock(FAR mutex_t *mutex, clockid_t clockid,
 
   do
     {
-      if (abstime)
-        {
-          ret = nxsem_clockwait(&mutex->sem, clockid, abstime);
-        }
-      else
-        {
-          ret = nxsem_wait(&mutex->sem);
-        }
+      ret = nxmutex_wait(mutex, clockid, abstime);
     }
   while (ret == -EINTR || ret == -ECANCELED);
 
@@ -0,0 +1,312 @@
+/****************************************************************************
+ * libs/libc/pthread/pthread_cond_futex.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <limits.h>
+#include <pthread.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/atomic.h>
+#include <nuttx/cancelpt.h>
+#include <nuttx/futex.h>
+#include <nuttx/pthread.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define COND_SEQ(c)     ((FAR atomic_uint *)&(c)->seq)
+#define COND_WAITERS(c) ((FAR atomic_uint *)&(c)->wait_count)
+
+/* Process-private condition variables use the cheaper private futexes */
+
+#define COND_FUTEX_FLAGS(c) \
+  ((c)->pshared == PTHREAD_PROCESS_SHARED ? 0 : FUTEX_PRIVATE_FLAG)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: cond_wake
+ *
+ * Description:
+ *   Wake up to nwake waiters.  Nothing enters the kernel when nobody is
+ *   waiting.
+ *
+ ****************************************************************************/
+
+static int cond_wake(FAR pthread_cond_t *cond, int nwake)
+{
+  if (cond == NULL)
+    {
+      return EINVAL;
+    }
+
+  if (atomic_load(COND_WAITERS(cond)) > 0)
+    {
+      atomic_fetch_add(COND_SEQ(cond), 1);
+      futex(&cond->seq, FUTEX_WAKE | COND_FUTEX_FLAGS(cond), nwake,
+            NULL, NULL, 0);
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: pthread_cond_init
+ *
+ * Description:
+ *   A thread can create condition variables.
+ *
+ * Input Parameters:
+ *   cond - The condition variable to be initialized
+ *   attr - Condition variable attributes, may be NULL
+ *
+ * Returned Value:
+ *   0 on success or an errno value on failure.
+ *
+ ****************************************************************************/
+
+int pthread_cond_init(FAR pthread_cond_t *cond,
+                      FAR const pthread_condattr_t *attr)
+{
+  sinfo("cond=%p attr=%p\n", cond, attr);
+
+  if (cond == NULL)
+    {
+      return EINVAL;
+    }
+
+  cond->seq        = 0;
+  cond->wait_count = 0;
+  cond->clockid    = attr ? attr->clockid : CLOCK_REALTIME;
+  cond->pshared    = attr ? attr->pshared : PTHREAD_PROCESS_PRIVATE;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: pthread_cond_destroy
+ *
+ * Description:
+ *   A thread can delete condition variables.
+ *
+ * Input Parameters:
+ *   cond - The condition variable to be destroyed
+ *
+ * Returned Value:
+ *   0 on success, EBUSY if some thread still waits on the condition.
+ *
+ ****************************************************************************/
+
+int pthread_cond_destroy(FAR pthread_cond_t *cond)
+{
+  sinfo("cond=%p\n", cond);
+
+  if (cond == NULL)
+    {
+      return EINVAL;
+    }
+
+  return atomic_load(COND_WAITERS(cond)) > 0 ? EBUSY : OK;
+}
+
+/****************************************************************************
+ * Name: pthread_cond_clockwait
+ *
+ * Description:
+ *   Release the mutex and wait until the condition is signalled or the
+ *   absolute time abstime, measured on clockid, has passed, then reacquire
+ *   the mutex.  The wait sleeps on the sequence number observed before
+ *   the mutex was released, so a signal sent in between is never lost.
+ *   Kernel mutexes are released and reacquired however many times the
+ *   caller holds them, as recursive mutexes may be held more than once.
+ *
+ * Input Parameters:
+ *   cond    - The condition variable to wait on
+ *   mutex   - The mutex held by the caller
+ *   clockid - The clock abstime is measured on
+ *   abstime - The absolute timeout (NULL wait forever)
+ *
+ * Returned Value:
+ *   0 on success or an errno value on failure.
+ *
+ ****************************************************************************/
+
+int pthread_cond_clockwait(FAR pthread_cond_t *cond,
+                           FAR pthread_mutex_t *mutex,
+                           clockid_t clockid,
+                           FAR const struct timespec *abstime)
+{
+  int op = FUTEX_WAIT_BITSET;
+  unsigned int nlocks = 0;
+  unsigned int seq;
+  int status;
+  int ret;
+
+  sinfo("cond=%p mutex=%p abstime=%p\n", cond, mutex, abstime);
+
+  if (cond == NULL || mutex == NULL)
+    {
+      return EINVAL;
+    }
+
+  /* pthread_cond_clockwait() is a cancellation point */
+
+  enter_cancellation_point();
+
+  atomic_fetch_add(COND_WAITERS(cond), 1);
+  seq = atomic_load(COND_SEQ(cond));
+
+  /* Give up the mutex */
+
+  if (mutex->futex == _PTHREAD_MFUTEX_NONE)
+    {
+      ret = nx_pthread_mutex_breaklock(mutex, &nlocks);
+    }
+  else
+    {
+      ret = pthread_mutex_unlock(mutex);
+    }
+
+  if (ret != 0)
+    {
+      atomic_fetch_sub(COND_WAITERS(cond), 1);
+      leave_cancellation_point();
+      return ret;
+    }
+
+  op |= COND_FUTEX_FLAGS(cond);
+  if (clockid == CLOCK_REALTIME)
+    {
+      op |= FUTEX_CLOCK_REALTIME;
+    }
+
+  if (futex(&cond->seq, op, seq, abstime, NULL,
+            FUTEX_BITSET_MATCH_ANY) < 0)
+    {
+      int err = errno;
+
+      /* EAGAIN means we were signalled before we went to sleep.
+       * Interrupted and cancelled waits return as spurious wakeups, the
+       * cancellation is acted upon once the mutex is held again.
+       */
+
+      if (err != EAGAIN && err != EINTR && err != ECANCELED)
+        {
+          ret = err;
+        }
+    }
+
+  atomic_fetch_sub(COND_WAITERS(cond), 1);
+
+  /* Reacquire the mutex (retaining the ret). */
+
+  if (mutex->futex == _PTHREAD_MFUTEX_NONE)
+    {
+      status = nx_pthread_mutex_restorelock(mutex, nlocks);
+    }
+  else
+    {
+      status = pthread_mutex_lock(mutex);
+    }
+
+  if (ret == 0)
+    {
+      ret = status;
+    }
+
+  leave_cancellation_point();
+  sinfo("Returning %d\n", ret);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: pthread_cond_wait
+ *
+ * Description:
+ *   A thread can wait for a condition variable to be signalled or
+ *   broadcast.
+ *
+ * Input Parameters:
+ *   cond  - The condition variable to wait on
+ *   mutex - The mutex held by the caller
+ *
+ * Returned Value:
+ *   0 on success or an errno value on failure.
+ *
+ ****************************************************************************/
+
+int pthread_cond_wait(FAR pthread_cond_t *cond, FAR pthread_mutex_t *mutex)
+{
+  return pthread_cond_clockwait(cond, mutex, CLOCK_REALTIME, NULL);
+}
+
+/****************************************************************************
+ * Name: pthread_cond_signal
+ *
+ * Description:
+ *   A thread can signal on a condition variable.
+ *
+ * Input Parameters:
+ *   cond - The condition variable to signal
+ *
+ * Returned Value:
+ *   0 on success or an errno value on failure.
+ *
+ ****************************************************************************/
+
+int pthread_cond_signal(FAR pthread_cond_t *cond)
+{
+  sinfo("cond=%p\n", cond);
+  return cond_wake(cond, 1);
+}
+
+/****************************************************************************
+ * Name: pthread_cond_broadcast
+ *
+ * Description:
+ *   A thread broadcast on a condition variable.
+ *
+ * Input Parameters:
+ *   cond - The condition variable to broadcast on
+ *
+ * Returned Value:
+ *   0 on success or an errno value on failure.
+ *
+ ****************************************************************************/
+
+int pthread_cond_broadcast(FAR pthread_cond_t *cond)
+{
+  sinfo("cond=%p\n", cond);
+  return cond_wake(cond, INT_MAX);
+}
@@ -0,0 +1,190 @@
+/****************************************************************************
+ * libs/libc/pthread/pthread_mutex_futex.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <pthread.h>
+#include <errno.h>
+
+#include <nuttx/atomic.h>
+#include <nuttx/futex.h>
+#include <nuttx/pthread.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define MUTEX_FUTEX(m) ((FAR atomic_uint *)&(m)->futex)
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: pthread_mutex_timedlock
+ *
+ * Description:
+ *   Lock a mutex, waiting at most until abs_timeout (CLOCK_REALTIME).
+ *   Futex mutexes are taken with a single compare-and-swap when they are
+ *   free and only enter the kernel to sleep when they are contended.  They
+ *   are never process-shared, so they always use private futexes.  All
+ *   other mutexes are handled by nx_pthread_mutex_timedlock().
+ *
+ * Input Parameters:
+ *   mutex - A reference to the mutex to be locked.
+ *   abs_timeout - max wait time (NULL wait forever)
+ *
+ * Returned Value:
+ *   0 on success or an errno value on failure.  Note that the errno EINTR
+ *   is never returned by pthread_mutex_timedlock().
+ *
+ ****************************************************************************/
+
+int pthread_mutex_timedlock(FAR pthread_mutex_t *mutex,
+                            FAR const struct timespec *abs_timeout)
+{
+  unsigned int old = _PTHREAD_MFUTEX_UNLOCKED;
+
+  if (mutex == NULL)
+    {
+      return EINVAL;
+    }
+
+  if (mutex->futex == _PTHREAD_MFUTEX_NONE)
+    {
+      return nx_pthread_mutex_timedlock(mutex, abs_timeout);
+    }
+
+  if (atomic_compare_exchange_strong(MUTEX_FUTEX(mutex), &old,
+                                     _PTHREAD_MFUTEX_LOCKED))
+    {
+      return OK;
+    }
+
+  /* Contended: mark the mutex so that the owner wakes us when it unlocks.
+   * We may take the lock here with the contended mark set, which only
+   * costs a spurious wakeup later.
+   */
+
+  while (atomic_exchange(MUTEX_FUTEX(mutex), _PTHREAD_MFUTEX_CONTENDED) !=
+         _PTHREAD_MFUTEX_UNLOCKED)
+    {
+      if (futex(&mutex->futex,
+                FUTEX_WAIT_BITSET_PRIVATE | FUTEX_CLOCK_REALTIME,
+                _PTHREAD_MFUTEX_CONTENDED, abs_timeout, NULL,
+                FUTEX_BITSET_MATCH_ANY) < 0)
+        {
+          int err = errno;
+
+          /* pthread_mutex_lock() is not a cancellation point, keep
+           * waiting even if we are called from one.
+           */
+
+          if (err != EAGAIN && err != EINTR && err != ECANCELED)
+            {
+              return err;
+            }
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: pthread_mutex_trylock
+ *
+ * Description:
+ *   Lock a mutex if it is free, otherwise return EBUSY at once.
+ *
+ * Input Parameters:
+ *   mutex - A reference to the mutex to be locked.
+ *
+ * Returned Value:
+ *   0 on success or an errno value on failure.
+ *
+ ****************************************************************************/
+
+int pthread_mutex_trylock(FAR pthread_mutex_t *mutex)
+{
+  unsigned int old = _PTHREAD_MFUTEX_UNLOCKED;
+
+  if (mutex == NULL)
+    {
+      return EINVAL;
+    }
+
+  if (mutex->futex == _PTHREAD_MFUTEX_NONE)
+    {
+      return nx_pthread_mutex_trylock(mutex);
+    }
+
+  return atomic_compare_exchange_strong(MUTEX_FUTEX(mutex), &old,
+                                        _PTHREAD_MFUTEX_LOCKED) ?
+         OK : EBUSY;
+}
+
+/****************************************************************************
+ * Name: pthread_mutex_unlock
+ *
+ * Description:
+ *   Release a mutex.  A futex mutex only enters the kernel if some thread
+ *   may be waiting for it.
+ *
+ * Input Parameters:
+ *   mutex - A reference to the mutex to be unlocked.
+ *
+ * Returned Value:
+ *   0 on success or an errno value on failure.
+ *
+ ****************************************************************************/
+
+int pthread_mutex_unlock(FAR pthread_mutex_t *mutex)
+{
+  unsigned int old;
+
+  if (mutex == NULL)
+    {
+      return EINVAL;
+    }
+
+  if (mutex->futex == _PTHREAD_MFUTEX_NONE)
+    {
+      return nx_pthread_mutex_unlock(mutex);
+    }
+
+  old = atomic_exchange(MUTEX_FUTEX(mutex), _PTHREAD_MFUTEX_UNLOCKED);
+  if (old == _PTHREAD_MFUTEX_UNLOCKED)
+    {
+      return EPERM;
+    }
+
+  if (old == _PTHREAD_MFUTEX_CONTENDED)
+    {
+      futex(&mutex->futex, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+    }
+
+  return OK;
+}
@@ -0,0 +1,351 @@
+/****************************************************************************
+ * libs/libc/pthread/pthread_rwlock_futex.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <limits.h>
+#include <pthread.h>
+#include <errno.h>
+
+#include <nuttx/atomic.h>
+#include <nuttx/futex.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Layout of pthread_rwlock_t::state.  The lock is free when the word is
+ * zero (or only RWLOCK_WAITERS is set); acquiring and releasing it without
+ * contention is a single compare-and-swap in user space.
+ */
+
+#define RWLOCK_WRITER   0x80000000u /* A writer holds the lock */
+#define RWLOCK_WAITERS  0x40000000u /* Someone sleeps in futex() */
+#define RWLOCK_READERS  0x3fffffffu /* Number of readers holding the lock */
+
+#define RWLOCK_STATE(l) ((FAR atomic_uint *)&(l)->state)
+#define RWLOCK_NWRITERS(l) ((FAR atomic_uint *)&(l)->num_writers)
+
+/* Process-private locks use the cheaper private futexes */
+
+#define RWLOCK_FUTEX_FLAGS(l) \
+  ((l)->pshared == PTHREAD_PROCESS_SHARED ? 0 : FUTEX_PRIVATE_FLAG)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: rwlock_wait
+ *
+ * Description:
+ *   Mark the lock as having waiters and sleep until it changes from the
+ *   observed state.  Returns 0 when the caller should retry.
+ *
+ ****************************************************************************/
+
+static int rwlock_wait(FAR pthread_rwlock_t *rw_lock, unsigned int state,
+                       clockid_t clockid, FAR const struct timespec *ts)
+{
+  int op = FUTEX_WAIT_BITSET | RWLOCK_FUTEX_FLAGS(rw_lock);
+
+  if ((state & RWLOCK_WAITERS) == 0)
+    {
+      if (!atomic_compare_exchange_strong(RWLOCK_STATE(rw_lock), &state,
+                                          state | RWLOCK_WAITERS))
+        {
+          return 0;
+        }
+
+      state |= RWLOCK_WAITERS;
+    }
+
+  /* A reader may have backed off only because a writer was queued.  If
+   * that writer has gone in the meantime nobody would wake us, so retry
+   * instead.  The last writer to leave clears RWLOCK_WAITERS after it
+   * drops num_writers, which closes the window on the other side.
+   */
+
+  if ((state & RWLOCK_WRITER) == 0 &&
+      atomic_load(RWLOCK_NWRITERS(rw_lock)) == 0)
+    {
+      return 0;
+    }
+
+  if (clockid == CLOCK_REALTIME)
+    {
+      op |= FUTEX_CLOCK_REALTIME;
+    }
+
+  if (futex(&rw_lock->state, op, state, ts, NULL,
+            FUTEX_BITSET_MATCH_ANY) < 0)
+    {
+      int err = errno;
+
+      if (err != EAGAIN && err != EINTR)
+        {
+          return err;
+        }
+    }
+
+  return 0;
+}
+
+static void rwlock_wake(FAR pthread_rwlock_t *rw_lock)
+{
+  futex(&rw_lock->state, FUTEX_WAKE | RWLOCK_FUTEX_FLAGS(rw_lock), INT_MAX,
+        NULL, NULL, 0);
+}
+
+static int tryrdlock(FAR pthread_rwlock_t *rw_lock,
+                     FAR unsigned int *state)
+{
+  unsigned int old = atomic_load(RWLOCK_STATE(rw_lock));
+
+  do
+    {
+      /* Writers waiting for the lock take precedence over new readers */
+
+      if ((old & RWLOCK_WRITER) != 0 ||
+          atomic_load(RWLOCK_NWRITERS(rw_lock)) > 0)
+        {
+          *state = old;
+          return EBUSY;
+        }
+
+      if ((old & RWLOCK_READERS) == RWLOCK_READERS)
+        {
+          return EAGAIN;
+        }
+    }
+  while (!atomic_compare_exchange_weak(RWLOCK_STATE(rw_lock), &old,
+                                       old + 1));
+
+  return OK;
+}
+
+static int trywrlock(FAR pthread_rwlock_t *rw_lock,
+                     FAR unsigned int *state)
+{
+  unsigned int old = atomic_load(RWLOCK_STATE(rw_lock));
+
+  do
+    {
+      if ((old & ~RWLOCK_WAITERS) != 0)
+        {
+          *state = old;
+          return EBUSY;
+        }
+    }
+  while (!atomic_compare_exchange_weak(RWLOCK_STATE(rw_lock), &old,
+                                       old | RWLOCK_WRITER));
+
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int pthread_rwlock_init(FAR pthread_rwlock_t *lock,
+                        FAR const pthread_rwlockattr_t *attr)
+{
+  lock->state       = 0;
+  lock->num_writers = 0;
+  lock->pshared     = attr ? attr->pshared : PTHREAD_PROCESS_PRIVATE;
+  return OK;
+}
+
+int pthread_rwlock_destroy(FAR pthread_rwlock_t *lock)
+{
+  return (lock->state & ~RWLOCK_WAITERS) != 0 ? EBUSY : OK;
+}
+
+int pthread_rwlock_unlock(FAR pthread_rwlock_t *rw_lock)
+{
+  unsigned int old = atomic_load(RWLOCK_STATE(rw_lock));
+  unsigned int new;
+
+  do
+    {
+      if ((old & RWLOCK_WRITER) != 0)
+        {
+          new = 0;
+        }
+      else if ((old & RWLOCK_READERS) != 0)
+        {
+          new = old - 1;
+          if ((new & RWLOCK_READERS) == 0)
+            {
+              new = 0;
+            }
+        }
+      else
+        {
+          return EINVAL;
+        }
+    }
+  while (!atomic_compare_exchange_weak(RWLOCK_STATE(rw_lock), &old, new));
+
+  /* Only the release that frees the lock needs to wake anyone up */
+
+  if (new == 0 && (old & RWLOCK_WAITERS) != 0)
+    {
+      rwlock_wake(rw_lock);
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: pthread_rwlock_rdlock
+ *
+ * Description:
+ *   Locks a read/write lock for reading
+ *
+ * Input Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *
+ ****************************************************************************/
+
+int pthread_rwlock_tryrdlock(FAR pthread_rwlock_t *rw_lock)
+{
+  unsigned int state;
+
+  return tryrdlock(rw_lock, &state);
+}
+
+int pthread_rwlock_clockrdlock(FAR pthread_rwlock_t *rw_lock,
+                               clockid_t clockid,
+                               FAR const struct timespec *ts)
+{
+  unsigned int state;
+  int err;
+
+  while ((err = tryrdlock(rw_lock, &state)) == EBUSY)
+    {
+      err = rwlock_wait(rw_lock, state, clockid, ts);
+      if (err != 0)
+        {
+          break;
+        }
+    }
+
+  return err;
+}
+
+int pthread_rwlock_timedrdlock(FAR pthread_rwlock_t *rw_lock,
+                               FAR const struct timespec *ts)
+{
+  return pthread_rwlock_clockrdlock(rw_lock, CLOCK_REALTIME, ts);
+}
+
+int pthread_rwlock_rdlock(FAR pthread_rwlock_t *rw_lock)
+{
+  return pthread_rwlock_timedrdlock(rw_lock, NULL);
+}
+
+/****************************************************************************
+ * Name: pthread_rwlock_wrlock
+ *
+ * Description:
+ *   Locks a read/write lock for writing
+ *
+ * Input Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *
+ ****************************************************************************/
+
+int pthread_rwlock_trywrlock(FAR pthread_rwlock_t *rw_lock)
+{
+  unsigned int state;
+
+  return trywrlock(rw_lock, &state);
+}
+
+int pthread_rwlock_clockwrlock(FAR pthread_rwlock_t *rw_lock,
+                               clockid_t clockid,
+                               FAR const struct timespec *ts)
+{
+  unsigned int state;
+  int err;
+
+  err = trywrlock(rw_lock, &state);
+  if (err != EBUSY)
+    {
+      return err;
+    }
+
+  if (atomic_fetch_add(RWLOCK_NWRITERS(rw_lock), 1) == UINT_MAX)
+    {
+      atomic_fetch_sub(RWLOCK_NWRITERS(rw_lock), 1);
+      return EAGAIN;
+    }
+
+  while ((err = trywrlock(rw_lock, &state)) == EBUSY)
+    {
+      err = rwlock_wait(rw_lock, state, clockid, ts);
+      if (err != 0)
+        {
+          break;
+        }
+    }
+
+  /* Readers may be blocked only because writers were queued; the last
+   * writer to leave lets them retry, whether or not it got the lock.
+   */
+
+  if (atomic_fetch_sub(RWLOCK_NWRITERS(rw_lock), 1) == 1 &&
+      (atomic_fetch_and(RWLOCK_STATE(rw_lock), ~RWLOCK_WAITERS) &
+       RWLOCK_WAITERS) != 0)
+    {
+      rwlock_wake(rw_lock);
+    }
+
+  return err;
+}
+
+int pthread_rwlock_timedwrlock(FAR pthread_rwlock_t *rw_lock,
+                               FAR const struct timespec *ts)
+{
+  return pthread_rwlock_clockwrlock(rw_lock, CLOCK_REALTIME, ts);
+}
+
+int pthread_rwlock_wrlock(FAR pthread_rwlock_t *rw_lock)
+{
+  return pthread_rwlock_timedwrlock(rw_lock, NULL);
+}
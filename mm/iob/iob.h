@@ -43,6 +43,12 @@
 
 #define ROUNDUP(x, y)            (((x) + (y) - 1) / (y) * (y))
 
+/* Number of I/O buffers moved between a per-CPU cache and the free list */
+
+#if CONFIG_IOB_NCACHE > 0
+#  define IOB_CACHE_BATCH        ((CONFIG_IOB_NCACHE + 1) / 2)
+#endif
+
 #if defined(CONFIG_DEBUG_FEATURES) && defined(CONFIG_IOB_DEBUG)
 #  define ioberr                 _err
 #  define iobwarn                _warn
@@ -53,6 +59,24 @@
 #  define iobinfo                _none
 #endif /* CONFIG_DEBUG_FEATURES && CONFIG_IOB_DEBUG */
 
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+#if CONFIG_IOB_NCACHE > 0
+/* A per-CPU cache of free I/O buffers.  The buffers in a cache are not
+ * counted in g_iob_count.  The lock is only contended while the cache is
+ * flushed for a waiting task.
+ */
+
+struct iob_cache_s
+{
+  spinlock_t        lock;
+  FAR struct iob_s *head;   /* List of cached buffers */
+  int16_t           count;  /* Number of cached buffers */
+};
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -100,6 +124,12 @@ extern volatile int16_t g_qentry_count;
 
 extern volatile spinlock_t g_iob_lock;
 
+#if CONFIG_IOB_NCACHE > 0
+/* Per-CPU caches of free I/O buffers */
+
+extern struct iob_cache_s g_iob_cache[CONFIG_SMP_NCPUS];
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -139,6 +169,42 @@ FAR struct iob_qentry_s *iob_tryalloc_qentry(void);
 
 FAR struct iob_qentry_s *iob_free_qentry(FAR struct iob_qentry_s *iobq);
 
+/****************************************************************************
+ * Name: iob_free_global
+ *
+ * Description:
+ *   Return a list of I/O buffers linked through io_flink to the free list,
+ *   handing them over to the tasks waiting for an IOB first.  This function
+ *   is intended only for internal use by the IOB module.
+ *
+ ****************************************************************************/
+
+void iob_free_global(FAR struct iob_s *iob);
+
+#if CONFIG_IOB_NCACHE > 0
+/****************************************************************************
+ * Name: iob_cache_flush
+ *
+ * Description:
+ *   Return the contents of all per-CPU caches to the free list.  Called
+ *   before a task waits for an IOB, so that the buffers held by the caches
+ *   of other CPUs are not kept from it.
+ *
+ ****************************************************************************/
+
+void iob_cache_flush(void);
+
+/****************************************************************************
+ * Name: iob_cache_navail
+ *
+ * Description:
+ *   Return the number of I/O buffers held by the per-CPU caches.
+ *
+ ****************************************************************************/
+
+int iob_cache_navail(void);
+#endif
+
 /****************************************************************************
  * Name: iob_notifier_signal
  *
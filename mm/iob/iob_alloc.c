@@ -28,6 +28,7 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <sys/param.h>
 
 #include <nuttx/irq.h>
 #include <nuttx/arch.h>
@@ -173,6 +174,65 @@ static FAR struct iob_s *iob_tryalloc_internal(bool throttled)
   return NULL;
 }
 
+#if CONFIG_IOB_NCACHE > 0
+/****************************************************************************
+ * Name: iob_cache_alloc
+ *
+ * Description:
+ *   Allocate an I/O buffer from the cache of the calling CPU, refilling the
+ *   cache with a batch from the free list when it is empty.  The refill
+ *   leaves the buffers reserved by the throttle on the free list.
+ *
+ ****************************************************************************/
+
+static FAR struct iob_s *iob_cache_alloc(void)
+{
+  FAR struct iob_cache_s *cache;
+  FAR struct iob_s *iob;
+  irqstate_t flags;
+  int i;
+
+  flags = up_irq_save();
+  cache = &g_iob_cache[this_cpu()];
+  spin_lock(&cache->lock);
+
+  if (cache->head == NULL)
+    {
+      spin_lock(&g_iob_lock);
+      for (i = 0; i < IOB_CACHE_BATCH && g_iob_count > CONFIG_IOB_THROTTLE;
+           i++)
+        {
+          iob = iob_tryalloc_internal(false);
+          DEBUGASSERT(iob != NULL);
+
+          iob->io_flink = cache->head;
+          cache->head   = iob;
+          cache->count++;
+        }
+
+      spin_unlock(&g_iob_lock);
+    }
+
+  iob = cache->head;
+  if (iob != NULL)
+    {
+      cache->head = iob->io_flink;
+      cache->count--;
+
+      /* Put the I/O buffer in a known state */
+
+      iob->io_flink  = NULL; /* Not in a chain */
+      iob->io_len    = 0;    /* Length of the data in the entry */
+      iob->io_offset = 0;    /* Offset to the beginning of data */
+      iob->io_pktlen = 0;    /* Total length of the packet */
+    }
+
+  spin_unlock(&cache->lock);
+  up_irq_restore(flags);
+  return iob;
+}
+#endif
+
 /****************************************************************************
  * Name: iob_allocwait
  *
@@ -207,6 +267,17 @@ static FAR struct iob_s *iob_allocwait(bool throttled, unsigned int timeout)
    * we are waiting for I/O buffers to become free.
    */
 
+#if CONFIG_IOB_NCACHE > 0
+  if (!throttled)
+    {
+      iob = iob_cache_alloc();
+      if (iob != NULL)
+        {
+          return iob;
+        }
+    }
+#endif
+
   flags = spin_lock_irqsave(&g_iob_lock);
 
   /* Try to get an I/O buffer.  If successful, the semaphore count will be
@@ -226,6 +297,15 @@ static FAR struct iob_s *iob_allocwait(bool throttled, unsigned int timeout)
 
       spin_unlock_irqrestore(&g_iob_lock, flags);
 
+#if CONFIG_IOB_NCACHE > 0
+      /* Now that we are counted as a waiter, buffers are no longer freed
+       * to the caches.  Return what they hold, this may already satisfy
+       * the wait.
+       */
+
+      iob_cache_flush();
+#endif
+
       if (timeout == UINT_MAX)
         {
           ret = nxsem_wait_uninterruptible(sem);
@@ -333,6 +413,17 @@ FAR struct iob_s *iob_tryalloc(bool throttled)
   FAR struct iob_s *iob;
   irqstate_t flags;
 
+#if CONFIG_IOB_NCACHE > 0
+  if (!throttled)
+    {
+      iob = iob_cache_alloc();
+      if (iob != NULL)
+        {
+          return iob;
+        }
+    }
+#endif
+
   /* We don't know what context we are called from so we use extreme measures
    * to protect the free list:  We disable interrupts very briefly.
    */
@@ -343,6 +434,108 @@ FAR struct iob_s *iob_tryalloc(bool throttled)
   return iob;
 }
 
+/****************************************************************************
+ * Name: iob_alloc_chain
+ *
+ * Description:
+ *   Allocate a chain of I/O buffers large enough to hold 'len' bytes,
+ *   without waiting.  Non-throttled allocations take what they can from
+ *   the cache of the calling CPU, the rest comes from the free list.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_alloc_chain(unsigned int len, bool throttled)
+{
+  FAR struct iob_s *head = NULL;
+  FAR struct iob_s *iob;
+  irqstate_t flags;
+  unsigned int remain;
+  int nglobal;
+  int n;
+#if CONFIG_IOB_NCACHE > 0
+  FAR struct iob_cache_s *cache;
+  int ncached = 0;
+#endif
+
+  n = len > 0 ? (len + CONFIG_IOB_BUFSIZE - 1) / CONFIG_IOB_BUFSIZE : 1;
+  nglobal = n;
+
+  flags = up_irq_save();
+
+#if CONFIG_IOB_NCACHE > 0
+  cache = &g_iob_cache[this_cpu()];
+  spin_lock(&cache->lock);
+
+  if (!throttled)
+    {
+      ncached  = MIN(n, cache->count);
+      nglobal -= ncached;
+    }
+#endif
+
+  if (nglobal > 0)
+    {
+      spin_lock(&g_iob_lock);
+
+#if CONFIG_IOB_THROTTLE > 0
+      if ((throttled ? g_throttle_count : g_iob_count) < nglobal)
+#else
+      if (g_iob_count < nglobal)
+#endif
+        {
+          /* All or nothing */
+
+          n = 0;
+        }
+      else
+        {
+          while (nglobal-- > 0)
+            {
+              iob = iob_tryalloc_internal(throttled);
+              DEBUGASSERT(iob != NULL);
+
+              iob->io_flink = head;
+              head = iob;
+            }
+        }
+
+      spin_unlock(&g_iob_lock);
+    }
+
+#if CONFIG_IOB_NCACHE > 0
+  while (n > 0 && ncached-- > 0)
+    {
+      iob = cache->head;
+      cache->head = iob->io_flink;
+      cache->count--;
+
+      iob->io_flink = head;
+      head = iob;
+    }
+
+  spin_unlock(&cache->lock);
+#endif
+
+  up_irq_restore(flags);
+
+  /* Size the buffers for the packet */
+
+  for (iob = head, remain = len; iob != NULL; iob = iob->io_flink)
+    {
+      iob->io_offset = 0;
+      iob->io_len    = MIN(remain, CONFIG_IOB_BUFSIZE);
+      iob->io_pktlen = 0;
+      remain        -= iob->io_len;
+    }
+
+  if (head != NULL)
+    {
+      head->io_pktlen = len;
+    }
+
+  return head;
+}
+
 #ifdef CONFIG_IOB_ALLOC
 
 /****************************************************************************
@@ -63,10 +63,217 @@
 
 #define IOB_MASK      (IOB_DIVIDER - 1)
 
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#if CONFIG_IOB_NCACHE > 0
+/****************************************************************************
+ * Name: iob_cache_free
+ *
+ * Description:
+ *   Free an I/O buffer to the cache of the calling CPU.  When the cache
+ *   overflows, a batch of the least recently freed buffers is returned to
+ *   the free list.  Returns false if the buffer must go to the free list
+ *   because a task is waiting for an IOB.
+ *
+ ****************************************************************************/
+
+static bool iob_cache_free(FAR struct iob_s *iob)
+{
+  FAR struct iob_cache_s *cache;
+  FAR struct iob_s *drain = NULL;
+  irqstate_t flags;
+  int i;
+
+  flags = up_irq_save();
+  cache = &g_iob_cache[this_cpu()];
+  spin_lock(&cache->lock);
+
+  /* A waiter flushes all caches after it is counted, so checking under
+   * the cache lock is enough for it to never miss this buffer.
+   */
+
+#if CONFIG_IOB_THROTTLE > 0
+  if (g_iob_count < 0 || g_throttle_count < 0)
+#else
+  if (g_iob_count < 0)
+#endif
+    {
+      spin_unlock(&cache->lock);
+      up_irq_restore(flags);
+      return false;
+    }
+
+  iob->io_flink = cache->head;
+  cache->head   = iob;
+  cache->count++;
+
+  if (cache->count > CONFIG_IOB_NCACHE)
+    {
+      for (i = 1; i < cache->count - IOB_CACHE_BATCH; i++)
+        {
+          iob = iob->io_flink;
+        }
+
+      drain         = iob->io_flink;
+      iob->io_flink = NULL;
+      cache->count -= IOB_CACHE_BATCH;
+    }
+
+  spin_unlock(&cache->lock);
+  up_irq_restore(flags);
+
+  if (drain != NULL)
+    {
+      iob_free_global(drain);
+    }
+
+  return true;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: iob_free_global
+ *
+ * Description:
+ *   Return a list of I/O buffers linked through io_flink to the free list,
+ *   handing them over to the tasks waiting for an IOB first.
+ *
+ ****************************************************************************/
+
+void iob_free_global(FAR struct iob_s *iob)
+{
+  FAR struct iob_s *next;
+  irqstate_t flags;
+  int npost = 0;
+#if CONFIG_IOB_THROTTLE > 0
+  int nthrottle = 0;
+#endif
+
+  /* Free the I/O buffers by adding them to the head of the free or the
+   * committed list. We don't know what context we are called from so
+   * we use extreme measures to protect the free list:  We disable
+   * interrupts very briefly.
+   */
+
+  flags = spin_lock_irqsave(&g_iob_lock);
+
+  for (; iob != NULL; iob = next)
+    {
+      next = iob->io_flink;
+
+      /* Which list?  If there is a task waiting for an IOB, then put
+       * the IOB on either the free list or on the committed list where
+       * it is reserved for that allocation (and not available to
+       * iob_tryalloc()). This is true for both throttled and non-throttled
+       * cases.
+       */
+
+#if CONFIG_IOB_THROTTLE > 0
+      if ((g_iob_count < 0) ||
+          ((g_iob_count >= CONFIG_IOB_THROTTLE) &&
+           (g_throttle_count < 0)))
+#else
+      if (g_iob_count < 0)
+#endif
+        {
+          iob->io_flink   = g_iob_committed;
+          g_iob_committed = iob;
+
+#if CONFIG_IOB_THROTTLE > 0
+          if (g_iob_count < 0)
+            {
+              g_iob_count++;
+              npost++;
+            }
+          else
+            {
+              g_throttle_count++;
+              nthrottle++;
+            }
+#else
+          g_iob_count++;
+          npost++;
+#endif
+        }
+      else
+        {
+          g_iob_count++;
+#if CONFIG_IOB_THROTTLE > 0
+          if (g_iob_count > CONFIG_IOB_THROTTLE)
+            {
+              g_throttle_count++;
+            }
+#endif
+
+          iob->io_flink   = g_iob_freelist;
+          g_iob_freelist  = iob;
+        }
+    }
+
+  spin_unlock_irqrestore(&g_iob_lock, flags);
+
+  /* Wake up the waiters the buffers were committed to */
+
+  while (npost-- > 0)
+    {
+      nxsem_post(&g_iob_sem);
+    }
+
+#if CONFIG_IOB_THROTTLE > 0
+  while (nthrottle-- > 0)
+    {
+      nxsem_post(&g_throttle_sem);
+    }
+#endif
+
+  DEBUGASSERT(g_iob_count <= CONFIG_IOB_NBUFFERS);
+
+#if CONFIG_IOB_THROTTLE > 0
+  DEBUGASSERT(g_throttle_count <=
+              (CONFIG_IOB_NBUFFERS - CONFIG_IOB_THROTTLE));
+#endif
+}
+
+#if CONFIG_IOB_NCACHE > 0
+/****************************************************************************
+ * Name: iob_cache_flush
+ *
+ * Description:
+ *   Return the contents of all per-CPU caches to the free list.
+ *
+ ****************************************************************************/
+
+void iob_cache_flush(void)
+{
+  FAR struct iob_cache_s *cache;
+  FAR struct iob_s *iob;
+  irqstate_t flags;
+  int cpu;
+
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      cache = &g_iob_cache[cpu];
+
+      flags = spin_lock_irqsave(&cache->lock);
+      iob = cache->head;
+      cache->head  = NULL;
+      cache->count = 0;
+      spin_unlock_irqrestore(&cache->lock, flags);
+
+      if (iob != NULL)
+        {
+          iob_free_global(iob);
+        }
+    }
+}
+#endif
+
 /****************************************************************************
  * Name: iob_free
  *
@@ -79,7 +286,6 @@
 FAR struct iob_s *iob_free(FAR struct iob_s *iob)
 {
   FAR struct iob_s *next = iob->io_flink;
-  irqstate_t flags;
 #ifdef CONFIG_IOB_NOTIFIER
   int16_t navail;
 #endif
@@ -126,74 +332,14 @@ FAR struct iob_s *iob_free(FAR struct iob_s *iob)
     }
 #endif
 
-  /* Free the I/O buffer by adding it to the head of the free or the
-   * committed list. We don't know what context we are called from so
-   * we use extreme measures to protect the free list:  We disable
-   * interrupts very briefly.
-   */
-
-  flags = spin_lock_irqsave(&g_iob_lock);
-
-  /* Which list?  If there is a task waiting for an IOB, then put
-   * the IOB on either the free list or on the committed list where
-   * it is reserved for that allocation (and not available to
-   * iob_tryalloc()). This is true for both throttled and non-throttled
-   * cases.
-   */
-
-#if CONFIG_IOB_THROTTLE > 0
-  if ((g_iob_count < 0) ||
-      ((g_iob_count >= CONFIG_IOB_THROTTLE) &&
-       (g_throttle_count < 0)))
-#else
-  if (g_iob_count < 0)
-#endif
-    {
-      FAR sem_t *sem;
-
-      iob->io_flink   = g_iob_committed;
-      g_iob_committed = iob;
-
-#if CONFIG_IOB_THROTTLE > 0
-      if (g_iob_count < 0)
-        {
-          g_iob_count++;
-          sem = &g_iob_sem;
-        }
-      else
-        {
-          g_throttle_count++;
-          sem = &g_throttle_sem;
-        }
-#else
-      g_iob_count++;
-      sem = &g_iob_sem;
+#if CONFIG_IOB_NCACHE > 0
+  if (!iob_cache_free(iob))
 #endif
-      spin_unlock_irqrestore(&g_iob_lock, flags);
-      nxsem_post(sem);
-    }
-  else
     {
-      g_iob_count++;
-#if CONFIG_IOB_THROTTLE > 0
-      if (g_iob_count > CONFIG_IOB_THROTTLE)
-        {
-          g_throttle_count++;
-        }
-#endif
-
-      iob->io_flink   = g_iob_freelist;
-      g_iob_freelist  = iob;
-      spin_unlock_irqrestore(&g_iob_lock, flags);
+      iob->io_flink = NULL;
+      iob_free_global(iob);
     }
 
-  DEBUGASSERT(g_iob_count <= CONFIG_IOB_NBUFFERS);
-
-#if CONFIG_IOB_THROTTLE > 0
-  DEBUGASSERT(g_throttle_count <=
-              (CONFIG_IOB_NBUFFERS - CONFIG_IOB_THROTTLE));
-#endif
-
 #ifdef CONFIG_IOB_NOTIFIER
   /* Check if the IOB was claimed by a thread that is blocked waiting
    * for an IOB.
@@ -117,6 +117,12 @@ volatile int16_t g_qentry_count = CONFIG_IOB_NCHAINS;
 
 volatile spinlock_t g_iob_lock = SP_UNLOCKED;
 
+#if CONFIG_IOB_NCACHE > 0
+/* Per-CPU caches of free I/O buffers */
+
+struct iob_cache_s g_iob_cache[CONFIG_SMP_NCPUS];
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -50,6 +50,9 @@ int iob_navail(bool throttled)
 
 #if CONFIG_IOB_NBUFFERS > 0
   ret = g_iob_count;
+#if CONFIG_IOB_NCACHE > 0
+  ret += iob_cache_navail();
+#endif
 
 #if CONFIG_IOB_THROTTLE > 0
   /* Subtract the throttle value is so requested */
@@ -72,6 +75,29 @@ int iob_navail(bool throttled)
   return ret;
 }
 
+#if CONFIG_IOB_NCACHE > 0
+/****************************************************************************
+ * Name: iob_cache_navail
+ *
+ * Description:
+ *   Return the number of I/O buffers held by the per-CPU caches.
+ *
+ ****************************************************************************/
+
+int iob_cache_navail(void)
+{
+  int ret = 0;
+  int cpu;
+
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      ret += g_iob_cache[cpu].count;
+    }
+
+  return ret;
+}
+#endif
+
 /****************************************************************************
  * Name: iob_qentry_navail
  *
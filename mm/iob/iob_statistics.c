@@ -67,6 +67,12 @@ void iob_getstats(FAR struct iob_stats_s *stats)
       stats->nwait = 0;
     }
 
+#if CONFIG_IOB_NCACHE > 0
+  /* Buffers in the per-CPU caches are free as well */
+
+  stats->nfree += iob_cache_navail();
+#endif
+
 #if CONFIG_IOB_THROTTLE > 0
   stats->nthrottle = g_throttle_count;
   if (stats->nthrottle < 0)
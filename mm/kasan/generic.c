@@ -26,6 +26,7 @@
 
 #include <nuttx/nuttx.h>
 #include <nuttx/mm/kasan.h>
+#include <nuttx/atomic.h>
 #include <nuttx/compiler.h>
 #include <nuttx/spinlock.h>
 
@@ -51,6 +52,9 @@
 #define KASAN_REGION_SIZE(size) \
   (sizeof(struct kasan_region_s) + KASAN_SHADOW_SIZE(size))
 
+static_assert(sizeof(uintptr_t) == sizeof(unsigned long),
+              "The shadow words are updated as atomic_ulong");
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -146,11 +150,34 @@ kasan_is_poisoned(FAR const void *addr, size_t size)
   return false;
 }
 
+/* Update the shadow bits of 'mask' in one word.  The words at both ends of
+ * a range may be shared with other ranges, so partial words are updated
+ * atomically instead of under a lock.
+ */
+
+static inline_function void kasan_set_shadow(FAR uintptr_t *p,
+                                             uintptr_t mask, bool poisoned)
+{
+  if (mask == UINTPTR_MAX)
+    {
+      *p = poisoned ? UINTPTR_MAX : 0;
+    }
+  else if (poisoned)
+    {
+      atomic_fetch_or_explicit((FAR atomic_ulong *)p, mask,
+                               memory_order_relaxed);
+    }
+  else
+    {
+      atomic_fetch_and_explicit((FAR atomic_ulong *)p, ~mask,
+                                memory_order_relaxed);
+    }
+}
+
 static void kasan_set_poison(FAR const void *addr, size_t size,
                              bool poisoned)
 {
   FAR uintptr_t *p;
-  irqstate_t flags;
   unsigned int bit;
   unsigned int nbit;
   uintptr_t mask;
@@ -165,17 +192,9 @@ static void kasan_set_poison(FAR const void *addr, size_t size,
   mask = KASAN_FIRST_WORD_MASK(bit);
   size /= KASAN_SHADOW_SCALE;
 
-  flags = spin_lock_irqsave(&g_lock);
   while (size >= nbit)
     {
-      if (poisoned)
-        {
-          *p++ |= mask;
-        }
-      else
-        {
-          *p++ &= ~mask;
-        }
+      kasan_set_shadow(p++, mask, poisoned);
 
       bit  += nbit;
       size -= nbit;
@@ -187,17 +206,8 @@ static void kasan_set_poison(FAR const void *addr, size_t size,
   if (size)
     {
       mask &= KASAN_LAST_WORD_MASK(bit + size);
-      if (poisoned)
-        {
-          *p |= mask;
-        }
-      else
-        {
-          *p &= ~mask;
-        }
+      kasan_set_shadow(p, mask, poisoned);
     }
-
-  spin_unlock_irqrestore(&g_lock, flags);
 }
 
 /****************************************************************************
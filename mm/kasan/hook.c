@@ -40,6 +40,8 @@
 
 #ifdef CONFIG_MM_KASAN_GENERIC
 #  include "generic.c"
+#elif defined(CONFIG_MM_KASAN_INLINE)
+#  include "inline.c"
 #elif defined(CONFIG_MM_KASAN_SW_TAGS)
 #  include "sw_tags.c"
 #else
@@ -53,11 +55,11 @@
 #define DEFINE_ASAN_LOAD_STORE(size) \
   void __asan_report_load##size##_noabort(FAR void *addr) \
   { \
-    kasan_report(addr, size, false, return_address(0)); \
+    kasan_inline_report(addr, size, false, return_address(0)); \
   } \
   void __asan_report_store##size##_noabort(FAR void *addr) \
   { \
-    kasan_report(addr, size, true, return_address(0)); \
+    kasan_inline_report(addr, size, true, return_address(0)); \
   } \
   void __asan_load##size##_noabort(FAR void *addr) \
   { \
@@ -253,6 +255,24 @@ static inline void kasan_check_report(FAR const void *addr, size_t size,
 #endif
 }
 
+/* The compiler calls __asan_report_*() directly when a check it inlined
+ * into the caller fails.  Those checks run before kasan_start() too, so
+ * the reports are gated like kasan_check_report().
+ */
+
+static void kasan_inline_report(FAR const void *addr, size_t size,
+                                bool is_write, FAR void *return_address)
+{
+#ifdef CONFIG_MM_KASAN
+  if (predict_false(size == 0 || g_region_init != KASAN_INIT_VALUE))
+    {
+      return;
+    }
+#endif
+
+  kasan_report(addr, size, is_write, return_address);
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -370,12 +390,12 @@ void __sanitizer_annotate_contiguous_container(FAR const void *beg,
 
 void __asan_report_load_n_noabort(FAR void *addr, size_t size)
 {
-  kasan_report(addr, size, false, return_address(0));
+  kasan_inline_report(addr, size, false, return_address(0));
 }
 
 void __asan_report_store_n_noabort(FAR void *addr, size_t size)
 {
-  kasan_report(addr, size, true, return_address(0));
+  kasan_inline_report(addr, size, true, return_address(0));
 }
 
 void __asan_loadN_noabort(FAR void *addr, size_t size)
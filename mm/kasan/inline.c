@@ -0,0 +1,232 @@
+/****************************************************************************
+ * mm/kasan/inline.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+
+/* Generic KASan with a fixed shadow offset.
+ *
+ * The shadow uses the layout of the compiler: the shadow byte of 'addr' is
+ * at (addr >> 3) + CONFIG_MM_KASAN_SHADOW_OFFSET.  Zero means all eight
+ * bytes of the granule are accessible, 1 to 7 that only that many leading
+ * bytes are, and a negative value that none is.  Since the mapping is a
+ * constant, the compiler can emit the checks inline and only call
+ * __asan_report_*() on error, and the out-of-line hooks need no region
+ * lookup.  Granules covered entirely by a range are written with a single
+ * byte store, and a granule shared with a neighbouring object, which may
+ * be poisoned concurrently, is updated with a compare-and-swap, so
+ * poisoning needs no lock.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/nuttx.h>
+#include <nuttx/atomic.h>
+#include <nuttx/mm/kasan.h>
+#include <nuttx/compiler.h>
+
+#include <assert.h>
+#include <stdint.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define KASAN_SHADOW_SHIFT   3
+#define KASAN_SHADOW_SCALE   (1 << KASAN_SHADOW_SHIFT)
+#define KASAN_SHADOW_MASK    (KASAN_SHADOW_SCALE - 1)
+
+#define KASAN_POISON_VALUE   ((int8_t)0xff)
+
+/* The memory covered by the shadow */
+
+#define KASAN_MEM_START      ((uintptr_t)CONFIG_MM_KASAN_SHADOW_START)
+#define KASAN_MEM_END        (KASAN_MEM_START + CONFIG_MM_KASAN_SHADOW_SIZE)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static inline_function FAR volatile int8_t *
+kasan_mem_to_shadow(uintptr_t addr)
+{
+  return (FAR volatile int8_t *)
+    ((addr >> KASAN_SHADOW_SHIFT) + CONFIG_MM_KASAN_SHADOW_OFFSET);
+}
+
+static inline_function bool
+kasan_is_poisoned(FAR const void *addr, size_t size)
+{
+  FAR volatile int8_t *p;
+  FAR volatile int8_t *last;
+  uintptr_t start = (uintptr_t)addr;
+  uintptr_t end = start + size;
+
+  if (start < KASAN_MEM_START || end > KASAN_MEM_END)
+    {
+      return kasan_global_is_poisoned(addr, size);
+    }
+
+  /* All granules but the last one must be fully accessible */
+
+  p    = kasan_mem_to_shadow(start);
+  last = kasan_mem_to_shadow(end - 1);
+
+  for (; p < last; p++)
+    {
+      if (*p != 0)
+        {
+          return true;
+        }
+    }
+
+  return *p != 0 && (int8_t)((end - 1) & KASAN_SHADOW_MASK) >= *p;
+}
+
+/* Mark bytes [lo, hi) of the granule behind shadow byte 'p' poisoned or
+ * accessible.  The shadow can only describe an accessible prefix, so the
+ * update is conservative: it may miss a bad access, but never reports a
+ * good one.
+ */
+
+static void kasan_set_granule(FAR volatile int8_t *p, int8_t lo,
+                              int8_t hi, bool poisoned)
+{
+  FAR atomic_schar *shadow = (FAR atomic_schar *)p;
+  signed char value;
+  signed char newvalue;
+  int8_t prefix;
+
+  value = atomic_load(shadow);
+  do
+    {
+      /* Length of the accessible prefix of the granule */
+
+      prefix = value == 0 ? KASAN_SHADOW_SCALE : value < 0 ? 0 : value;
+
+      if (poisoned)
+        {
+          if (prefix <= lo || prefix > hi)
+            {
+              return;
+            }
+
+          prefix = lo;
+        }
+      else
+        {
+          if (prefix >= hi)
+            {
+              return;
+            }
+
+          prefix = hi;
+        }
+
+      newvalue = prefix == KASAN_SHADOW_SCALE ? 0 :
+                 prefix == 0 ? KASAN_POISON_VALUE : prefix;
+    }
+  while (!atomic_compare_exchange_weak(shadow, &value, newvalue));
+}
+
+static void kasan_set_poison(FAR const void *addr, size_t size,
+                             bool poisoned)
+{
+  FAR volatile int8_t *p;
+  FAR volatile int8_t *last;
+  uintptr_t start = (uintptr_t)addr;
+  uintptr_t end = start + size;
+  int8_t value;
+  int8_t off;
+
+  if (size == 0 || start < KASAN_MEM_START || end > KASAN_MEM_END)
+    {
+      return;
+    }
+
+  p    = kasan_mem_to_shadow(start);
+  last = kasan_mem_to_shadow(end);
+
+  off = start & KASAN_SHADOW_MASK;
+  if (off != 0)
+    {
+      if (p == last)
+        {
+          /* The range lies within one granule */
+
+          kasan_set_granule(p, off, end & KASAN_SHADOW_MASK, poisoned);
+          return;
+        }
+
+      kasan_set_granule(p, off, KASAN_SHADOW_SCALE, poisoned);
+      p++;
+    }
+
+  /* The granules in between belong to this range only */
+
+  value = poisoned ? KASAN_POISON_VALUE : 0;
+  while (p < last)
+    {
+      *p++ = value;
+    }
+
+  off = end & KASAN_SHADOW_MASK;
+  if (off != 0)
+    {
+      kasan_set_granule(p, 0, off, poisoned);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+FAR void *kasan_reset_tag(FAR const void *addr)
+{
+  return (FAR void *)addr;
+}
+
+void kasan_poison(FAR const void *addr, size_t size)
+{
+  kasan_set_poison(addr, size, true);
+}
+
+FAR void *kasan_unpoison(FAR const void *addr, size_t size)
+{
+  kasan_set_poison(addr, size, false);
+  return (FAR void *)addr;
+}
+
+void kasan_register(FAR void *addr, FAR size_t *size)
+{
+  /* The shadow is reserved at link time, the region keeps its size */
+
+  DEBUGASSERT((uintptr_t)addr >= KASAN_MEM_START &&
+              (uintptr_t)addr + *size <= KASAN_MEM_END);
+
+  kasan_start();
+  kasan_poison(addr, *size);
+}
+
+void kasan_unregister(FAR void *addr)
+{
+}
@@ -0,0 +1,457 @@
+/****************************************************************************
+ * mm/kmem_cache/kmem_cache.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* Object caches.
+ *
+ * A cache is a mempool whose expansion blocks are the slabs.  The free
+ * list link of the mempool lives in the first word of each block, so the
+ * object starts at the next aligned offset and keeps its constructed
+ * state while it is free.  Every new slab starts at a different cache line
+ * offset (its colour), taken from the space the slab leaves unused, so
+ * that the objects of different slabs do not all compete for the same
+ * cache sets.  Each CPU keeps a short LIFO of recently freed, cache hot
+ * objects in front of the pool.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+#include <debug.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/param.h>
+
+#include <nuttx/cache.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/nuttx.h>
+#include <nuttx/sched.h>
+#include <nuttx/spinlock.h>
+#include <nuttx/mm/kasan.h>
+#include <nuttx/mm/kmem_cache.h>
+#include <nuttx/mm/mempool.h>
+#include <nuttx/mm/shrinker.h>
+
+#if defined(CONFIG_MM_KMEM_CACHE) && \
+    (defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__))
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define KMEM_CACHE_HOTLIST CONFIG_MM_KMEM_CACHE_HOTLIST
+
+/* The mempool appends the backtrace record to each block */
+
+#if CONFIG_MM_BACKTRACE >= 0
+#  define KMEM_CACHE_BTSIZE sizeof(struct mempool_backtrace_s)
+#else
+#  define KMEM_CACHE_BTSIZE 0
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+#if KMEM_CACHE_HOTLIST > 0
+struct kmem_cache_hot_s
+{
+  spinlock_t     lock;
+  unsigned int   count;
+  FAR void      *objs[KMEM_CACHE_HOTLIST];
+};
+#endif
+
+struct kmem_cache_s
+{
+  struct mempool_s  pool;       /* The slabs */
+  kmem_cache_ctor_t ctor;       /* The object constructor */
+  size_t            objsize;    /* The size of an object */
+  size_t            offset;     /* The offset of the object in a block */
+  size_t            align;      /* The alignment of the objects */
+  size_t            colour;     /* The colour of the next slab */
+  size_t            colourstep; /* The distance between two colours */
+  size_t            maxcolour;  /* The largest colour */
+#ifdef CONFIG_MM_SHRINKER
+  struct mm_shrinker_s shrinker;
+#endif
+#if KMEM_CACHE_HOTLIST > 0
+  struct kmem_cache_hot_s hot[CONFIG_SMP_NCPUS];
+#endif
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: kmem_cache_slab_alloc
+ *
+ * Description:
+ *   The mempool alloc callback.  Allocate a slab at the next colour and
+ *   construct its objects.  The address of the heap chunk is saved just
+ *   below the slab.
+ *
+ ****************************************************************************/
+
+static FAR void *kmem_cache_slab_alloc(FAR struct mempool_s *pool,
+                                       size_t size)
+{
+  FAR struct kmem_cache_s *cache = pool->priv;
+  size_t blocksize = MEMPOOL_REALBLOCKSIZE(pool);
+  FAR char *base;
+  FAR void *mem;
+  size_t colour;
+  size_t i;
+
+  /* Racing expansions may get the same colour, that is harmless */
+
+  colour = cache->colour;
+  cache->colour = colour < cache->maxcolour ?
+                  colour + cache->colourstep : 0;
+
+  mem = kmm_memalign(cache->align, cache->align + colour + size);
+  if (mem == NULL)
+    {
+      return NULL;
+    }
+
+  base = (FAR char *)mem + cache->align + colour;
+  ((FAR void **)base)[-1] = mem;
+
+  if (cache->ctor != NULL)
+    {
+      for (i = 0; i < size / blocksize; i++)
+        {
+          cache->ctor(base + i * blocksize + cache->offset);
+        }
+    }
+
+  return base;
+}
+
+/****************************************************************************
+ * Name: kmem_cache_slab_free
+ ****************************************************************************/
+
+static void kmem_cache_slab_free(FAR struct mempool_s *pool,
+                                 FAR void *addr)
+{
+  kmm_free(((FAR void **)addr)[-1]);
+}
+
+/****************************************************************************
+ * Name: kmem_cache_check
+ ****************************************************************************/
+
+static void kmem_cache_check(FAR struct mempool_s *pool, FAR void *blk)
+{
+  FAR struct kmem_cache_s *cache = pool->priv;
+
+  DEBUGASSERT(((uintptr_t)kasan_reset_tag(blk) & (cache->align - 1)) == 0);
+  UNUSED(cache);
+}
+
+/****************************************************************************
+ * Name: kmem_cache_drain
+ *
+ * Description:
+ *   Give the objects of all the hot lists back to the pool.
+ *
+ ****************************************************************************/
+
+static void kmem_cache_drain(FAR struct kmem_cache_s *cache)
+{
+#if KMEM_CACHE_HOTLIST > 0
+  FAR struct kmem_cache_hot_s *hot;
+  irqstate_t flags;
+  FAR void *obj;
+  int cpu;
+
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      hot = &cache->hot[cpu];
+
+      flags = spin_lock_irqsave(&hot->lock);
+      while (hot->count > 0)
+        {
+          obj = hot->objs[--hot->count];
+          obj = kasan_unpoison(obj, cache->objsize);
+          mempool_release(&cache->pool, (FAR char *)obj - cache->offset);
+        }
+
+      spin_unlock_irqrestore(&hot->lock, flags);
+    }
+#endif
+}
+
+/****************************************************************************
+ * Name: kmem_cache_shrinker_count
+ ****************************************************************************/
+
+#ifdef CONFIG_MM_SHRINKER
+static size_t kmem_cache_shrinker_count(FAR struct mm_shrinker_s *shrinker)
+{
+  FAR struct kmem_cache_s *cache = shrinker->priv;
+  struct mempoolinfo_s info;
+  size_t count;
+  int cpu;
+
+  mempool_info(&cache->pool, &info);
+  count = info.ordblks;
+
+#if KMEM_CACHE_HOTLIST > 0
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      count += cache->hot[cpu].count;
+    }
+#else
+  UNUSED(cpu);
+#endif
+
+  return count * MEMPOOL_REALBLOCKSIZE(&cache->pool);
+}
+
+/****************************************************************************
+ * Name: kmem_cache_shrinker_scan
+ ****************************************************************************/
+
+static size_t kmem_cache_shrinker_scan(FAR struct mm_shrinker_s *shrinker,
+                                       size_t nbytes)
+{
+  return kmem_cache_shrink(shrinker->priv);
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: kmem_cache_create
+ ****************************************************************************/
+
+FAR struct kmem_cache_s *kmem_cache_create(FAR const char *name,
+                                           size_t size, size_t align,
+                                           kmem_cache_ctor_t ctor)
+{
+  FAR struct kmem_cache_s *cache;
+  size_t blocksize;
+  size_t leftover;
+  size_t nobjs;
+  int cpu;
+
+  DEBUGASSERT(size > 0 && (align & (align - 1)) == 0);
+
+  cache = kmm_zalloc(sizeof(struct kmem_cache_s));
+  if (cache == NULL)
+    {
+      return NULL;
+    }
+
+  /* Lay out a block so that the whole of it, including the mempool's
+   * backtrace record, is a multiple of the alignment.
+   */
+
+  cache->align   = MAX(align, MEMPOOL_ALIGN);
+  cache->objsize = size;
+  cache->offset  = ALIGN_UP(sizeof(sq_entry_t), cache->align);
+  cache->ctor    = ctor;
+
+  blocksize = ALIGN_UP(cache->offset + size + KMEM_CACHE_BTSIZE,
+                       cache->align);
+  nobjs     = CONFIG_MM_KMEM_CACHE_SLABSIZE > blocksize ?
+              (CONFIG_MM_KMEM_CACHE_SLABSIZE - sizeof(sq_entry_t)) /
+              blocksize : 1;
+
+  cache->pool.blocksize  = blocksize - KMEM_CACHE_BTSIZE;
+  cache->pool.expandsize = nobjs * blocksize + sizeof(sq_entry_t);
+  cache->pool.priv       = cache;
+  cache->pool.alloc      = kmem_cache_slab_alloc;
+  cache->pool.free       = kmem_cache_slab_free;
+  cache->pool.check      = kmem_cache_check;
+
+  /* Colour the slabs with the space they leave unused.  Without a data
+   * cache there is nothing to gain.
+   */
+
+  cache->colourstep = MAX(up_get_dcache_linesize(), cache->align);
+  if (up_get_dcache_linesize() > 0 &&
+      CONFIG_MM_KMEM_CACHE_SLABSIZE > cache->pool.expandsize)
+    {
+      leftover = CONFIG_MM_KMEM_CACHE_SLABSIZE - cache->pool.expandsize;
+      cache->maxcolour = ALIGN_DOWN(leftover, cache->colourstep);
+    }
+
+#if KMEM_CACHE_HOTLIST > 0
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      spin_lock_init(&cache->hot[cpu].lock);
+    }
+#else
+  UNUSED(cpu);
+#endif
+
+  if (mempool_init(&cache->pool, name) < 0)
+    {
+      kmm_free(cache);
+      return NULL;
+    }
+
+#ifdef CONFIG_MM_SHRINKER
+  cache->shrinker.name  = name;
+  cache->shrinker.cost  = MM_SHRINKER_COST_FREE;
+  cache->shrinker.priv  = cache;
+  cache->shrinker.count = kmem_cache_shrinker_count;
+  cache->shrinker.scan  = kmem_cache_shrinker_scan;
+  mm_register_shrinker(&cache->shrinker);
+#endif
+
+  return cache;
+}
+
+/****************************************************************************
+ * Name: kmem_cache_destroy
+ ****************************************************************************/
+
+int kmem_cache_destroy(FAR struct kmem_cache_s *cache)
+{
+  int ret;
+
+  mm_unregister_shrinker(&cache->shrinker);
+
+  kmem_cache_drain(cache);
+  ret = mempool_deinit(&cache->pool);
+  if (ret < 0)
+    {
+      mm_register_shrinker(&cache->shrinker);
+      return ret;
+    }
+
+  kmm_free(cache);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: kmem_cache_alloc
+ ****************************************************************************/
+
+FAR void *kmem_cache_alloc(FAR struct kmem_cache_s *cache)
+{
+  FAR char *blk;
+  FAR void *obj;
+
+#if KMEM_CACHE_HOTLIST > 0
+  /* Migrating between picking the hot list and locking it only costs the
+   * locality, the list is locked either way.
+   */
+
+  FAR struct kmem_cache_hot_s *hot = &cache->hot[this_cpu()];
+  irqstate_t flags;
+
+  flags = spin_lock_irqsave(&hot->lock);
+  if (hot->count > 0)
+    {
+      obj = hot->objs[--hot->count];
+      spin_unlock_irqrestore(&hot->lock, flags);
+      return kasan_unpoison(obj, cache->objsize);
+    }
+
+  spin_unlock_irqrestore(&hot->lock, flags);
+#endif
+
+  blk = mempool_allocate(&cache->pool);
+  if (blk == NULL)
+    {
+      return NULL;
+    }
+
+  obj = blk + cache->offset;
+
+#ifdef CONFIG_MM_FILL_ALLOCATIONS
+  /* The pool has overwritten the constructed state */
+
+  if (cache->ctor != NULL)
+    {
+      cache->ctor(obj);
+    }
+#endif
+
+  return obj;
+}
+
+/****************************************************************************
+ * Name: kmem_cache_zalloc
+ ****************************************************************************/
+
+FAR void *kmem_cache_zalloc(FAR struct kmem_cache_s *cache)
+{
+  FAR void *obj = kmem_cache_alloc(cache);
+
+  if (obj != NULL)
+    {
+      memset(obj, 0, cache->objsize);
+    }
+
+  return obj;
+}
+
+/****************************************************************************
+ * Name: kmem_cache_free
+ ****************************************************************************/
+
+void kmem_cache_free(FAR struct kmem_cache_s *cache, FAR void *obj)
+{
+#if KMEM_CACHE_HOTLIST > 0
+  FAR struct kmem_cache_hot_s *hot = &cache->hot[this_cpu()];
+  irqstate_t flags;
+
+  flags = spin_lock_irqsave(&hot->lock);
+  if (hot->count < KMEM_CACHE_HOTLIST)
+    {
+      kasan_poison(obj, cache->objsize);
+      hot->objs[hot->count++] = obj;
+      spin_unlock_irqrestore(&hot->lock, flags);
+      return;
+    }
+
+  spin_unlock_irqrestore(&hot->lock, flags);
+#endif
+
+  mempool_release(&cache->pool, (FAR char *)obj - cache->offset);
+}
+
+/****************************************************************************
+ * Name: kmem_cache_shrink
+ ****************************************************************************/
+
+size_t kmem_cache_shrink(FAR struct kmem_cache_s *cache)
+{
+  kmem_cache_drain(cache);
+  return mempool_shrink(&cache->pool) *
+         (cache->pool.expandsize + cache->align);
+}
+
+#endif /* CONFIG_MM_KMEM_CACHE && (CONFIG_BUILD_FLAT || __KERNEL__) */
@@ -29,6 +29,7 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <syslog.h>
+#include <sys/param.h>
 
 #include <nuttx/kmalloc.h>
 #include <nuttx/mm/kasan.h>
@@ -595,6 +596,194 @@ void mempool_memdump(FAR struct mempool_s *pool,
 #endif
 }
 
+/****************************************************************************
+ * Name: mempool_shrink
+ *
+ * Description:
+ *   Give the expansion blocks of the pool whose blocks are all free back
+ *   to the pool's free function.  The initial block and the interrupt
+ *   blocks are kept.
+ *
+ * Input Parameters:
+ *   pool    - Address of the memory pool to be used.
+ *
+ * Returned Value:
+ *   The number of expansion blocks released.
+ ****************************************************************************/
+
+size_t mempool_shrink(FAR struct mempool_s *pool)
+{
+  size_t blocksize = MEMPOOL_REALBLOCKSIZE(pool);
+  FAR sq_entry_t *entry;
+  FAR sq_entry_t *prev;
+  FAR sq_entry_t *last;
+  FAR sq_entry_t *blk;
+  FAR sq_entry_t *tmp;
+  irqstate_t flags;
+  FAR char *base;
+  size_t nexpand;
+  size_t index = 0;
+  size_t nfree;
+  size_t ret = 0;
+  size_t i;
+
+  if (pool->expandsize < blocksize + sizeof(sq_entry_t))
+    {
+      return 0;
+    }
+
+  nexpand = (pool->expandsize - sizeof(sq_entry_t)) / blocksize;
+
+  /* The initial block, if any, is the first of the expand queue */
+
+  if (pool->initialsize >= blocksize + sizeof(sq_entry_t))
+    {
+      index = 1;
+    }
+
+  /* Each expansion is checked with the lock held on its own, so that the
+   * interrupts are only disabled for one scan of the free queue at a time.
+   * The expand queue may change in between and is walked again each time;
+   * at worst an expansion is missed until the next call.
+   */
+
+  for (; ; )
+    {
+      flags = spin_lock_irqsave(&pool->lock);
+
+      /* Not worth scanning unless at least one expansion block is free */
+
+      if (sq_count(&pool->queue) < nexpand)
+        {
+          spin_unlock_irqrestore(&pool->lock, flags);
+          break;
+        }
+
+      prev  = NULL;
+      entry = sq_peek(&pool->equeue);
+      for (i = 0; entry != NULL && i < index; i++)
+        {
+          prev  = entry;
+          entry = sq_next(entry);
+        }
+
+      if (entry == NULL)
+        {
+          spin_unlock_irqrestore(&pool->lock, flags);
+          break;
+        }
+
+      base  = (FAR char *)entry - nexpand * blocksize;
+      nfree = 0;
+
+      sq_for_every(&pool->queue, blk)
+        {
+          if ((FAR char *)blk >= base && (FAR char *)blk < (FAR char *)entry)
+            {
+              nfree++;
+            }
+        }
+
+      if (nfree < nexpand)
+        {
+          spin_unlock_irqrestore(&pool->lock, flags);
+          index++;
+          continue;
+        }
+
+      /* All blocks are free, take them off the free queue */
+
+      for (blk = sq_peek(&pool->queue), last = NULL; blk != NULL; blk = tmp)
+        {
+          tmp = sq_next(blk);
+          if ((FAR char *)blk < base || (FAR char *)blk >= (FAR char *)entry)
+            {
+              last = blk;
+            }
+          else if (last == NULL)
+            {
+              sq_remfirst(&pool->queue);
+            }
+          else
+            {
+              sq_remafter(last, &pool->queue);
+            }
+        }
+
+      if (prev == NULL)
+        {
+          sq_remfirst(&pool->equeue);
+        }
+      else
+        {
+          sq_remafter(prev, &pool->equeue);
+        }
+
+      spin_unlock_irqrestore(&pool->lock, flags);
+
+      /* The next expansion has moved up to the same index */
+
+      base = kasan_unpoison(base, nexpand * blocksize + sizeof(sq_entry_t));
+      pool->free(pool, base);
+      ret++;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: mempool_shrink_count
+ *
+ * Description:
+ *   Estimate how much memory mempool_shrink() can give back.  The free
+ *   blocks of the initial block are never released and only whole
+ *   expansions are, so the initial block is assumed to be entirely free
+ *   and the rest is rounded down to whole expansions.  The estimate
+ *   never exceeds what the expansions of the pool add up to.
+ *
+ * Input Parameters:
+ *   pool    - Address of the memory pool to be used.
+ *
+ * Returned Value:
+ *   The number of bytes that mempool_shrink() may release.
+ ****************************************************************************/
+
+size_t mempool_shrink_count(FAR struct mempool_s *pool)
+{
+  size_t blocksize = MEMPOOL_REALBLOCKSIZE(pool);
+  size_t ninitial = 0;
+  size_t nexpand;
+  size_t nfree;
+  size_t count;
+  irqstate_t flags;
+
+  if (pool->expandsize < blocksize + sizeof(sq_entry_t))
+    {
+      return 0;
+    }
+
+  nexpand = (pool->expandsize - sizeof(sq_entry_t)) / blocksize;
+  if (pool->initialsize >= blocksize + sizeof(sq_entry_t))
+    {
+      ninitial = (pool->initialsize - sizeof(sq_entry_t)) / blocksize;
+    }
+
+  flags = spin_lock_irqsave(&pool->lock);
+  nfree = sq_count(&pool->queue);
+  count = sq_count(&pool->equeue);
+  spin_unlock_irqrestore(&pool->lock, flags);
+
+  if (ninitial > 0 && count > 0)
+    {
+      count--;
+    }
+
+  nfree = nfree > ninitial ? (nfree - ninitial) / nexpand : 0;
+  count = MIN(count, nfree);
+
+  return count * (nexpand * blocksize + sizeof(sq_entry_t));
+}
+
 /****************************************************************************
  * Name: mempool_deinit
  *
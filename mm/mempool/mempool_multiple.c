@@ -34,6 +34,20 @@
 #include <nuttx/kmalloc.h>
 #include <nuttx/mm/mempool.h>
 #include <nuttx/mm/kasan.h>
+#include <nuttx/mm/shrinker.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#if defined(CONFIG_MM_SHRINKER) && \
+    (defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__))
+#  define MEMPOOL_MULTIPLE_SHRINKER
+#endif
+
+/* End of the list of free dictionary entries */
+
+#define MPOOL_DICT_NONE SIZE_MAX
 
 /****************************************************************************
  * Private Types
@@ -93,6 +107,14 @@ struct mempool_multiple_s
   size_t                        dict_col_num_log2;
   size_t                        dict_row_num;
   FAR struct mpool_dict_s     **dict;
+
+  /* The entries of released expansions are linked through their size */
+
+  size_t                        dict_free;
+
+#ifdef MEMPOOL_MULTIPLE_SHRINKER
+  struct mm_shrinker_s          shrinker;
+#endif
 };
 
 /****************************************************************************
@@ -204,13 +226,15 @@ mempool_multiple_free_chunk(FAR struct mempool_multiple_s *mpool,
   FAR struct mpool_chunk_s *chunk;
   FAR sq_entry_t *entry;
 
+  nxrmutex_lock(&mpool->lock);
   if (mpool->chunk_size < mpool->expandsize)
     {
+      mpool->alloced -= mpool->alloc_size(mpool->arg, ptr);
       mpool->free(mpool->arg, ptr);
+      nxrmutex_unlock(&mpool->lock);
       return;
     }
 
-  nxrmutex_lock(&mpool->lock);
   sq_for_every(&mpool->chunk_queue, entry)
     {
       chunk = (FAR struct mpool_chunk_s *)entry;
@@ -219,6 +243,7 @@ mempool_multiple_free_chunk(FAR struct mempool_multiple_s *mpool,
           if (--chunk->used == 0)
             {
               sq_rem(&chunk->entry, &mpool->chunk_queue);
+              mpool->alloced -= mpool->alloc_size(mpool->arg, chunk->start);
               mpool->free(mpool->arg, chunk->start);
             }
 
@@ -234,6 +259,7 @@ static FAR void *mempool_multiple_alloc_callback(FAR struct mempool_s *pool,
 {
   FAR struct mempool_multiple_s *mpool = pool->priv;
   FAR void *ret;
+  size_t index;
   size_t row;
   size_t col;
 
@@ -246,26 +272,41 @@ static FAR void *mempool_multiple_alloc_callback(FAR struct mempool_s *pool,
       return NULL;
     }
 
-  row = mpool->dict_used >> mpool->dict_col_num_log2;
+  if (mpool->dict_free != MPOOL_DICT_NONE)
+    {
+      /* Reuse the entry of an expansion given back by mempool_shrink() */
 
-  /* There is no new pointer address to store the dictionaries */
+      index = mpool->dict_free;
+      row = index >> mpool->dict_col_num_log2;
+      col = index - (row << mpool->dict_col_num_log2);
+      mpool->dict_free = mpool->dict[row][col].size;
+    }
+  else
+    {
+      index = mpool->dict_used;
+      row = index >> mpool->dict_col_num_log2;
 
-  DEBUGASSERT(mpool->dict_row_num > row);
+      /* There is no new pointer address to store the dictionaries */
 
-  col = mpool->dict_used - (row << mpool->dict_col_num_log2);
+      DEBUGASSERT(mpool->dict_row_num > row);
 
-  if (mpool->dict[row] == NULL)
-    {
-      mpool->dict[row] =
-        mempool_multiple_alloc_chunk(mpool, sizeof(uintptr_t),
-                                     (1 << mpool->dict_col_num_log2)
-                                     * sizeof(struct mpool_dict_s));
+      col = index - (row << mpool->dict_col_num_log2);
+
+      if (mpool->dict[row] == NULL)
+        {
+          mpool->dict[row] =
+            mempool_multiple_alloc_chunk(mpool, sizeof(uintptr_t),
+                                         (1 << mpool->dict_col_num_log2)
+                                         * sizeof(struct mpool_dict_s));
+        }
+
+      mpool->dict_used++;
     }
 
   mpool->dict[row][col].pool = pool;
   mpool->dict[row][col].addr = ret;
   mpool->dict[row][col].size = mpool->minpoolsize + size;
-  *(FAR size_t *)ret = mpool->dict_used++;
+  *(FAR size_t *)ret = index;
   nxrmutex_unlock(&mpool->lock);
   return (FAR char *)ret + mpool->minpoolsize;
 }
@@ -274,11 +315,60 @@ static void mempool_multiple_free_callback(FAR struct mempool_s *pool,
                                            FAR void *addr)
 {
   FAR struct mempool_multiple_s *mpool = pool->priv;
+  FAR char *base = (FAR char *)addr - mpool->minpoolsize;
+  size_t index;
+  size_t row;
+  size_t col;
+
+  /* Forget the expansion before its memory can be reused by the heap */
+
+  nxrmutex_lock(&mpool->lock);
+  index = *(FAR size_t *)base;
+  row = index >> mpool->dict_col_num_log2;
+  col = index - (row << mpool->dict_col_num_log2);
+
+  mpool->dict[row][col].pool = NULL;
+  mpool->dict[row][col].addr = NULL;
+  mpool->dict[row][col].size = mpool->dict_free;
+  mpool->dict_free = index;
+
+  mempool_multiple_free_chunk(mpool, base);
+  nxrmutex_unlock(&mpool->lock);
+}
+
+#ifdef MEMPOOL_MULTIPLE_SHRINKER
+static size_t
+mempool_multiple_shrink_count(FAR struct mm_shrinker_s *shrinker)
+{
+  FAR struct mempool_multiple_s *mpool = shrinker->priv;
+  size_t count = 0;
+  size_t i;
+
+  for (i = 0; i < mpool->npools; i++)
+    {
+      count += mempool_shrink_count(mpool->pools + i);
+    }
 
-  mempool_multiple_free_chunk(mpool,
-                              (FAR char *)addr - mpool->minpoolsize);
+  return count;
 }
 
+static size_t
+mempool_multiple_shrink_scan(FAR struct mm_shrinker_s *shrinker,
+                             size_t nbytes)
+{
+  FAR struct mempool_multiple_s *mpool = shrinker->priv;
+  size_t alloced = mpool->alloced;
+  size_t i;
+
+  for (i = 0; i < mpool->npools && alloced - mpool->alloced < nbytes; i++)
+    {
+      mempool_shrink(mpool->pools + i);
+    }
+
+  return alloced - mpool->alloced;
+}
+#endif
+
 /****************************************************************************
  * Name: mempool_multiple_get_dict
  *
@@ -452,6 +542,8 @@ mempool_multiple_init(FAR const char *name,
   mpool->npools = npools;
   mpool->minpoolsize = minpoolsize;
   mpool->delta = 0;
+  mpool->dict_free = MPOOL_DICT_NONE;
+  nxrmutex_init(&mpool->lock);
 
   for (i = 0; i < npools; i++)
     {
@@ -500,7 +592,15 @@ mempool_multiple_init(FAR const char *name,
 
   memset(mpool->dict, 0,
          mpool->dict_row_num * sizeof(FAR struct mpool_dict_s *));
-  nxrmutex_init(&mpool->lock);
+
+#ifdef MEMPOOL_MULTIPLE_SHRINKER
+  mpool->shrinker.name  = name;
+  mpool->shrinker.cost  = MM_SHRINKER_COST_FREE;
+  mpool->shrinker.priv  = mpool;
+  mpool->shrinker.count = mempool_multiple_shrink_count;
+  mpool->shrinker.scan  = mempool_multiple_shrink_scan;
+  mm_register_shrinker(&mpool->shrinker);
+#endif
 
   return mpool;
 
@@ -870,6 +970,10 @@ void mempool_multiple_deinit(FAR struct mempool_multiple_s *mpool)
       return;
     }
 
+#ifdef MEMPOOL_MULTIPLE_SHRINKER
+  mm_unregister_shrinker(&mpool->shrinker);
+#endif
+
   for (i = 0; i < mpool->npools; i++)
     {
       DEBUGVERIFY(mempool_deinit(mpool->pools + i));
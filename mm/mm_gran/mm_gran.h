@@ -44,8 +44,11 @@
 
 #define SIZEOF_GAT(n) \
   ((n + 31) >> 5)
+#define SIZEOF_GATS(n) \
+  ((SIZEOF_GAT(n) + 31) >> 5)
 #define SIZEOF_GRAN_S(n) \
-  (sizeof(struct gran_s) + sizeof(uint32_t) * (SIZEOF_GAT(n) - 1))
+  (sizeof(struct gran_s) + \
+   sizeof(uint32_t) * (SIZEOF_GAT(n) + SIZEOF_GATS(n) - 1))
 
 /* Debug */
 
@@ -78,6 +81,10 @@ struct gran_s
 #endif
   uintptr_t  heapstart; /* The aligned start of the granule heap */
   uint32_t   gat[1];    /* Start of the granule allocation table */
+
+  /* The GAT is followed by its summary, one bit per GAT cell which is set
+   * when all granules of the cell are allocated.  See GATS().
+   */
 };
 
 /****************************************************************************
@@ -29,6 +29,7 @@
 #include <assert.h>
 #include <errno.h>
 #include <strings.h>
+#include <sys/param.h>
 #include <debug.h>
 
 #include <nuttx/bits.h>
@@ -90,7 +91,31 @@ uint32_t lsb_mask(uint32_t n)
   return (-n & n) & GATCFULL;
 }
 
-/* set or clear a GAT cell with given bit mask */
+/* return LSB(n), the number of trailing zeros */
+
+static inline uint32_t lsb_index(uint32_t n)
+{
+  DEBUGASSERT(n);
+#ifdef CONFIG_HAVE_BUILTIN_CTZ
+  return __builtin_ctz(n);
+#else
+  return DEBRUJIN_LUT[(uint32_t)(lsb_mask(n) * DEBRUJIN_NUM) >> 27];
+#endif
+}
+
+/* return MSB(n), the index of the highest set bit */
+
+static inline uint32_t msb_index(uint32_t n)
+{
+  DEBUGASSERT(n);
+#ifdef CONFIG_HAVE_BUILTIN_CLZ
+  return 31 - __builtin_clz(n);
+#else
+  return DEBRUJIN_LUT[(uint32_t)(msb_mask(n) * DEBRUJIN_NUM) >> 27];
+#endif
+}
+
+/* set or clear a GAT cell with given bit mask, updating the summary */
 
 static void cell_set(gran_t *gran, uint32_t cell, uint32_t mask, bool val)
 {
@@ -102,6 +127,36 @@ static void cell_set(gran_t *gran, uint32_t cell, uint32_t mask, bool val)
     {
       gran->gat[cell] &= ~mask;
     }
+
+  if (gran->gat[cell] == GATCFULL)
+    {
+      GATS(gran)[cell >> 5] |= BIT(cell & 31);
+    }
+  else
+    {
+      GATS(gran)[cell >> 5] &= ~BIT(cell & 31);
+    }
+}
+
+/* returns the first GAT cell from 'cell' on which is not full */
+
+static uint32_t cell_next(const gran_t *gran, uint32_t cell)
+{
+  uint32_t ncells = GATC_NUM(gran);
+  uint32_t v;
+
+  while (cell < ncells)
+    {
+      v = ~GATS(gran)[cell >> 5] & (GATCFULL << (cell & 31));
+      if (v)
+        {
+          return (cell & ~31) + lsb_index(v);
+        }
+
+      cell = (cell & ~31) + 32;
+    }
+
+  return ncells;
 }
 
 /* set or clear a range of GAT bits */
@@ -241,24 +296,83 @@ failure:
 
 int gran_search(const gran_t *gran, size_t size)
 {
-  int ret = -EINVAL;
+  uint32_t ncells;
+  uint32_t c;   /* cell index */
+  uint32_t v;   /* used bits of the cell */
+  uint32_t f;   /* free run bitmap of the cell */
+  uint32_t b;   /* free granules at the bottom of the cell, shift */
+  uint32_t n;   /* run length represented by f */
+  size_t   posi = 0;
+  size_t   run = 0;
 
   if (gran == NULL || gran->ngranules < size)
     {
-      return ret;
+      return -EINVAL;
     }
 
-  ret = -ENOMEM;
-  for (size_t i = 0; i <= gran->ngranules - size; i++)
+  ncells = GATC_NUM(gran);
+  for (c = cell_next(gran, 0); c < ncells; c = cell_next(gran, c + 1))
     {
-      if (gran_match(gran, i, size, 0, &i))
+      /* A skipped full cell breaks the run carried from below */
+
+      if (run && posi + run != c * 32)
+        {
+          run = 0;
+        }
+
+      v = gran->gat[c];
+      if (c == ncells - 1 && (gran->ngranules & 31))
+        {
+          /* Granules past the end of the heap are never free */
+
+          v |= GATCFULL << (gran->ngranules & 31);
+        }
+
+      if (run == 0)
         {
-          ret = i;
-          break;
+          posi = c * 32;
         }
+
+      /* Free granules at the bottom of the cell extend the current run */
+
+      b = v ? lsb_index(v) : 32;
+      if (run + b >= size)
+        {
+          return posi;
+        }
+
+      if (b == 32)
+        {
+          run += 32;
+          continue;
+        }
+
+      /* Look for a run within the cell: after the loop, bit i of f is set
+       * if granules i to i + size - 1 of the cell are all free.
+       */
+
+      if (size < 32)
+        {
+          f = ~v;
+          for (n = 1; n < size && f; n += b)
+            {
+              b = MIN(n, size - n);
+              f &= f >> b;
+            }
+
+          if (f)
+            {
+              return c * 32 + lsb_index(f);
+            }
+        }
+
+      /* Carry on the free granules at the top of the cell */
+
+      run  = 31 - msb_index(v);
+      posi = c * 32 + 32 - run;
     }
 
-  return ret;
+  return -ENOMEM;
 }
 
 /* set a range of granules */
@@ -58,6 +58,11 @@
 /* GAT table related */
 
 #define GATC_BITS(g)        (sizeof(g->gat[0]) << 3)
+#define GATC_NUM(g)         SIZEOF_GAT(g->ngranules)
+
+/* GAT summary, a bitmap of full GAT cells stored after the GAT */
+
+#define GATS(g)             (&g->gat[GATC_NUM(g)])
 
 /****************************************************************************
  * Public Types
@@ -129,7 +134,9 @@ bool gran_match(const gran_t *gran, size_t posi, size_t size, bool used,
  * Name: gran_search
  *
  * Description:
- *   search for continuous range of free granules
+ *   search for continuous range of free granules.  Full GAT cells are
+ *   skipped using the GAT summary and the others are scanned a cell at a
+ *   time, so the cost does not depend on the number of granules in use.
  *
  * Input Parameters:
  *   gran - Pointer to the gran state
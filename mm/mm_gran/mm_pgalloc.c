@@ -100,6 +100,10 @@ void mm_pginitialize(FAR void *heap_start, size_t heap_size)
 {
   g_pgalloc = gran_initialize(heap_start, heap_size, MM_PGSHIFT, MM_PGSHIFT);
   DEBUGASSERT(g_pgalloc != NULL);
+
+#ifdef CONFIG_MM_PGREF
+  mm_pgref_initialize(heap_start, heap_size);
+#endif
 }
 
 /****************************************************************************
@@ -0,0 +1,570 @@
+/****************************************************************************
+ * mm/mm_gran/mm_pgbuddy.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* Binary buddy page allocator.
+ *
+ * The free pages are kept in blocks of 2^order pages, aligned to their size
+ * in physical memory, on one free list per order.  The buddy of the block
+ * at page frame number pfn is the block at pfn ^ (1 << order); when both
+ * are free they are merged into one block of the next order.  Requests are
+ * rounded up to a power of two, served from the smallest non-empty order
+ * and the unused tail is freed again, so that only the pages asked for are
+ * consumed.
+ *
+ * The state of each page lives in a small descriptor array allocated from
+ * the kernel heap.  Only the first page of a free block is marked, the
+ * other pages are found by searching for the block that contains them.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+#include <debug.h>
+#include <strings.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/pgalloc.h>
+#include <nuttx/spinlock.h>
+
+#ifdef CONFIG_MM_PGALLOC_BUDDY
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Debug */
+
+#ifdef CONFIG_DEBUG_PGALLOC
+#  define pgaerr                    _err
+#  define pgawarn                   _warn
+#  define pgainfo                   _info
+#else
+#  define pgaerr                    merr
+#  define pgawarn                   mwarn
+#  define pgainfo                   minfo
+#endif
+
+#define PGBUDDY_MAXORDER            CONFIG_MM_PGALLOC_MAXORDER
+
+/* Page indices are 16 bits wide, like the counts of struct pginfo_s */
+
+#define PGBUDDY_NIL                 0xffff
+#define PGBUDDY_MAXPAGES            0xffff
+
+#define PGBUDDY_FREE                0x01  /* First page of a free block */
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Per-page descriptor.  The links and order are only valid in the first
+ * page of a free block.
+ */
+
+struct pgbuddy_page_s
+{
+  uint16_t flink;                 /* Next free block of the same order */
+  uint16_t blink;                 /* Previous free block of the same order */
+  uint8_t  order;                 /* Order of the free block */
+  uint8_t  flags;                 /* See PGBUDDY_* definitions */
+};
+
+struct pgbuddy_s
+{
+  uintptr_t basepfn;              /* Page frame number of page 0 */
+  uint16_t  npages;               /* Number of pages managed */
+  uint16_t  nfree;                /* Number of free pages */
+  uint32_t  orders;               /* Bit n set: free list n not empty */
+  FAR struct pgbuddy_page_s *pages;
+  uint16_t  head[PGBUDDY_MAXORDER + 1];
+  uint16_t  nblocks[PGBUDDY_MAXORDER + 1];
+  spinlock_t lock;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The state of the page allocator */
+
+static struct pgbuddy_s g_pgbuddy;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: pgbuddy_buddy
+ *
+ * Description:
+ *   Return the index of the buddy of the block of 'order' at 'index', or
+ *   PGBUDDY_NIL if the buddy lies outside of the page pool.
+ *
+ ****************************************************************************/
+
+static inline unsigned int pgbuddy_buddy(unsigned int index,
+                                         unsigned int order)
+{
+  uintptr_t pfn = (g_pgbuddy.basepfn + index) ^ ((uintptr_t)1 << order);
+
+  if (pfn < g_pgbuddy.basepfn ||
+      pfn - g_pgbuddy.basepfn >= g_pgbuddy.npages)
+    {
+      return PGBUDDY_NIL;
+    }
+
+  return pfn - g_pgbuddy.basepfn;
+}
+
+/****************************************************************************
+ * Name: pgbuddy_push
+ ****************************************************************************/
+
+static void pgbuddy_push(unsigned int index, unsigned int order)
+{
+  FAR struct pgbuddy_page_s *page = &g_pgbuddy.pages[index];
+  uint16_t head = g_pgbuddy.head[order];
+
+  page->flink = head;
+  page->blink = PGBUDDY_NIL;
+  page->order = order;
+  page->flags = PGBUDDY_FREE;
+
+  if (head != PGBUDDY_NIL)
+    {
+      g_pgbuddy.pages[head].blink = index;
+    }
+
+  g_pgbuddy.head[order] = index;
+  g_pgbuddy.nblocks[order]++;
+  g_pgbuddy.orders |= 1u << order;
+}
+
+/****************************************************************************
+ * Name: pgbuddy_remove
+ ****************************************************************************/
+
+static void pgbuddy_remove(unsigned int index)
+{
+  FAR struct pgbuddy_page_s *page = &g_pgbuddy.pages[index];
+  unsigned int order = page->order;
+
+  DEBUGASSERT(page->flags & PGBUDDY_FREE);
+
+  if (page->blink != PGBUDDY_NIL)
+    {
+      g_pgbuddy.pages[page->blink].flink = page->flink;
+    }
+  else
+    {
+      g_pgbuddy.head[order] = page->flink;
+    }
+
+  if (page->flink != PGBUDDY_NIL)
+    {
+      g_pgbuddy.pages[page->flink].blink = page->blink;
+    }
+
+  page->flags = 0;
+  if (--g_pgbuddy.nblocks[order] == 0)
+    {
+      g_pgbuddy.orders &= ~(1u << order);
+    }
+}
+
+/****************************************************************************
+ * Name: pgbuddy_freeblock
+ *
+ * Description:
+ *   Free a naturally aligned block, merging it with its buddies.
+ *
+ ****************************************************************************/
+
+static void pgbuddy_freeblock(unsigned int index, unsigned int order)
+{
+  unsigned int buddy;
+
+  while (order < PGBUDDY_MAXORDER)
+    {
+      buddy = pgbuddy_buddy(index, order);
+      if (buddy == PGBUDDY_NIL ||
+          !(g_pgbuddy.pages[buddy].flags & PGBUDDY_FREE) ||
+          g_pgbuddy.pages[buddy].order != order)
+        {
+          break;
+        }
+
+      pgbuddy_remove(buddy);
+      if (buddy < index)
+        {
+          index = buddy;
+        }
+
+      order++;
+    }
+
+  pgbuddy_push(index, order);
+}
+
+/****************************************************************************
+ * Name: pgbuddy_freerange
+ *
+ * Description:
+ *   Free an arbitrary run of pages by splitting it into the largest
+ *   naturally aligned blocks.
+ *
+ ****************************************************************************/
+
+static void pgbuddy_freerange(unsigned int index, unsigned int npages)
+{
+  unsigned int order;
+  uintptr_t pfn;
+
+  while (npages > 0)
+    {
+      pfn   = g_pgbuddy.basepfn + index;
+      order = fls(npages) - 1;
+
+      if (pfn != 0 && ffsl(pfn) - 1 < order)
+        {
+          order = ffsl(pfn) - 1;
+        }
+
+      if (order > PGBUDDY_MAXORDER)
+        {
+          order = PGBUDDY_MAXORDER;
+        }
+
+      pgbuddy_freeblock(index, order);
+      index  += 1u << order;
+      npages -= 1u << order;
+    }
+}
+
+/****************************************************************************
+ * Name: pgbuddy_block
+ *
+ * Description:
+ *   Return the first page of the free block containing page 'index', or
+ *   PGBUDDY_NIL if the page is allocated.
+ *
+ ****************************************************************************/
+
+static unsigned int pgbuddy_block(unsigned int index)
+{
+  FAR struct pgbuddy_page_s *page;
+  uintptr_t pfn = g_pgbuddy.basepfn + index;
+  uintptr_t head;
+  unsigned int order;
+
+  for (order = 0; order <= PGBUDDY_MAXORDER; order++)
+    {
+      head = pfn & ~(((uintptr_t)1 << order) - 1);
+      if (head < g_pgbuddy.basepfn)
+        {
+          break;
+        }
+
+      page = &g_pgbuddy.pages[head - g_pgbuddy.basepfn];
+      if ((page->flags & PGBUDDY_FREE) && page->order >= order)
+        {
+          return head - g_pgbuddy.basepfn;
+        }
+    }
+
+  return PGBUDDY_NIL;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_pginitialize
+ *
+ * Description:
+ *   Initialize the page allocator.
+ *
+ * Input Parameters:
+ *   heap_start - The physical address of the start of memory region that
+ *                will be used for the page allocator heap
+ *   heap_size  - The size (in bytes) of the memory region that will be used
+ *                for the page allocator heap.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void mm_pginitialize(FAR void *heap_start, size_t heap_size)
+{
+  uintptr_t start = MM_PGALIGNUP(heap_start);
+  uintptr_t end = MM_PGALIGNDOWN((uintptr_t)heap_start + heap_size);
+  size_t npages = (end - start) >> MM_PGSHIFT;
+  unsigned int i;
+
+  DEBUGASSERT(end > start);
+
+  if (npages > PGBUDDY_MAXPAGES)
+    {
+      pgawarn("WARNING: Only %u of %zu pages are managed\n",
+              PGBUDDY_MAXPAGES, npages);
+      npages = PGBUDDY_MAXPAGES;
+    }
+
+  g_pgbuddy.pages = kmm_zalloc(npages * sizeof(struct pgbuddy_page_s));
+  DEBUGASSERT(g_pgbuddy.pages != NULL);
+
+  g_pgbuddy.basepfn = start >> MM_PGSHIFT;
+  g_pgbuddy.npages  = npages;
+  g_pgbuddy.nfree   = npages;
+
+  for (i = 0; i <= PGBUDDY_MAXORDER; i++)
+    {
+      g_pgbuddy.head[i] = PGBUDDY_NIL;
+    }
+
+  spin_lock_init(&g_pgbuddy.lock);
+  pgbuddy_freerange(0, npages);
+
+#ifdef CONFIG_MM_PGREF
+  mm_pgref_initialize(heap_start, heap_size);
+#endif
+}
+
+/****************************************************************************
+ * Name: mm_pgreserve
+ *
+ * Description:
+ *   Reserve memory in the page memory pool.  This will reserve the pages
+ *   that contain the start and end addresses plus all of the pages
+ *   in between.  This should be done early in the initialization sequence
+ *   before any other allocations are made.
+ *
+ *   Reserved memory can never be allocated (it can be freed however which
+ *   essentially unreserves the memory).
+ *
+ * Input Parameters:
+ *   start  - The address of the beginning of the region to be reserved.
+ *   size   - The size of the region to be reserved
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void mm_pgreserve(uintptr_t start, size_t size)
+{
+  uintptr_t first = start >> MM_PGSHIFT;
+  uintptr_t last = (start + size + MM_PGMASK) >> MM_PGSHIFT;
+  unsigned int index;
+  unsigned int block;
+  unsigned int bend;
+  unsigned int end;
+  irqstate_t flags;
+
+  /* Clip the range to the page pool */
+
+  if (first < g_pgbuddy.basepfn)
+    {
+      first = g_pgbuddy.basepfn;
+    }
+
+  if (last > g_pgbuddy.basepfn + g_pgbuddy.npages)
+    {
+      last = g_pgbuddy.basepfn + g_pgbuddy.npages;
+    }
+
+  if (first >= last)
+    {
+      return;
+    }
+
+  index = first - g_pgbuddy.basepfn;
+  end   = last - g_pgbuddy.basepfn;
+
+  flags = spin_lock_irqsave(&g_pgbuddy.lock);
+
+  while (index < end)
+    {
+      block = pgbuddy_block(index);
+      if (block == PGBUDDY_NIL)
+        {
+          index++;
+          continue;
+        }
+
+      /* Take the whole block and give back what is outside of the range */
+
+      bend = block + (1u << g_pgbuddy.pages[block].order);
+      pgbuddy_remove(block);
+      pgbuddy_freerange(block, index - block);
+
+      if (bend > end)
+        {
+          pgbuddy_freerange(end, bend - end);
+          bend = end;
+        }
+
+      g_pgbuddy.nfree -= bend - index;
+      index = bend;
+    }
+
+  spin_unlock_irqrestore(&g_pgbuddy.lock, flags);
+}
+
+/****************************************************************************
+ * Name: mm_pgalloc
+ *
+ * Description:
+ *   Allocate page memory from the page memory pool.
+ *
+ * Input Parameters:
+ *   npages - The number of pages to allocate, each of size CONFIG_MM_PGSIZE.
+ *
+ * Returned Value:
+ *   On success, a non-zero, physical address of the allocated page memory
+ *   is returned.  Zero is returned on failure.  NOTE:  This is an unmapped
+ *   physical address and cannot be used until it is appropriately mapped.
+ *
+ ****************************************************************************/
+
+uintptr_t mm_pgalloc(unsigned int npages)
+{
+  unsigned int index;
+  unsigned int order;
+  unsigned int avail;
+  irqstate_t flags;
+
+  if (npages == 0 || npages > (1u << PGBUDDY_MAXORDER))
+    {
+      return 0;
+    }
+
+  order = fls(npages - 1);
+
+  flags = spin_lock_irqsave(&g_pgbuddy.lock);
+
+  /* Take the first block of the smallest order that fits */
+
+  avail = g_pgbuddy.orders & ~((1u << order) - 1);
+  if (avail == 0)
+    {
+      spin_unlock_irqrestore(&g_pgbuddy.lock, flags);
+      pgawarn("WARNING: No block of %u pages\n", npages);
+      return 0;
+    }
+
+  avail = ffs(avail) - 1;
+  index = g_pgbuddy.head[avail];
+  pgbuddy_remove(index);
+
+  /* Split it down to the requested order */
+
+  while (avail > order)
+    {
+      avail--;
+      pgbuddy_push(index + (1u << avail), avail);
+    }
+
+  /* And give back the tail of the last power of two */
+
+  pgbuddy_freerange(index + npages, (1u << order) - npages);
+  g_pgbuddy.nfree -= npages;
+
+  spin_unlock_irqrestore(&g_pgbuddy.lock, flags);
+
+  return (g_pgbuddy.basepfn + index) << MM_PGSHIFT;
+}
+
+/****************************************************************************
+ * Name: mm_pgfree
+ *
+ * Description:
+ *   Return page memory to the page memory pool.
+ *
+ * Input Parameters:
+ *   paddr  - A physical address to a page in the page memory pool previously
+ *            allocated by mm_pgalloc.
+ *   npages - The number of contiguous pages to be return to the page memory
+ *            pool, beginning with the page at paddr;
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void mm_pgfree(uintptr_t paddr, unsigned int npages)
+{
+  uintptr_t pfn = paddr >> MM_PGSHIFT;
+  irqstate_t flags;
+
+  DEBUGASSERT(MM_ISALIGNED(paddr) && pfn >= g_pgbuddy.basepfn &&
+              pfn - g_pgbuddy.basepfn + npages <= g_pgbuddy.npages);
+
+  flags = spin_lock_irqsave(&g_pgbuddy.lock);
+  pgbuddy_freerange(pfn - g_pgbuddy.basepfn, npages);
+  g_pgbuddy.nfree += npages;
+  spin_unlock_irqrestore(&g_pgbuddy.lock, flags);
+}
+
+/****************************************************************************
+ * Name: mm_pginfo
+ *
+ * Description:
+ *   Return information about the page allocator.
+ *
+ * Input Parameters:
+ *   info   - Memory location to return the page allocator info.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void mm_pginfo(FAR struct pginfo_s *info)
+{
+  irqstate_t flags;
+  unsigned int i;
+
+  DEBUGASSERT(info != NULL);
+
+  flags = spin_lock_irqsave(&g_pgbuddy.lock);
+
+  info->ntotal = g_pgbuddy.npages;
+  info->nfree  = g_pgbuddy.nfree;
+  info->mxfree = g_pgbuddy.orders ?
+                 1u << (fls(g_pgbuddy.orders) - 1) : 0;
+
+  for (i = 0; i <= PGBUDDY_MAXORDER; i++)
+    {
+      info->nblocks[i] = g_pgbuddy.nblocks[i];
+    }
+
+  spin_unlock_irqrestore(&g_pgbuddy.lock, flags);
+}
+
+#endif /* CONFIG_MM_PGALLOC_BUDDY */
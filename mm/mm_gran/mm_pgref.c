@@ -0,0 +1,147 @@
+/****************************************************************************
+ * mm/mm_gran/mm_pgref.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* Pages that are mapped by more than one address environment, such as the
+ * pages a fork()ed child shares copy-on-write with its parent, are freed
+ * when the last mapping goes away.  A 16 bit count per page in the pool
+ * records the references beyond the first, so that pages nobody shares
+ * stay at zero and mm_pgalloc()/mm_pgfree() need not know about it.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+#include <stdint.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/pgalloc.h>
+#include <nuttx/spinlock.h>
+
+#ifdef CONFIG_MM_PGREF
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct pgref_s
+{
+  spinlock_t lock;
+  uintptr_t basepfn;
+  size_t npages;
+  FAR uint16_t *extra;  /* References beyond the first, one per page */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct pgref_s g_pgref;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static inline size_t pgref_index(uintptr_t paddr)
+{
+  size_t index = (paddr >> MM_PGSHIFT) - g_pgref.basepfn;
+
+  DEBUGASSERT(index < g_pgref.npages);
+  return index;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_pgref_initialize
+ ****************************************************************************/
+
+void mm_pgref_initialize(FAR void *heap_start, size_t heap_size)
+{
+  uintptr_t start = MM_PGALIGNUP(heap_start);
+  uintptr_t end = MM_PGALIGNDOWN((uintptr_t)heap_start + heap_size);
+
+  g_pgref.basepfn = start >> MM_PGSHIFT;
+  g_pgref.npages  = (end - start) >> MM_PGSHIFT;
+  g_pgref.extra   = kmm_zalloc(g_pgref.npages * sizeof(uint16_t));
+  DEBUGASSERT(g_pgref.extra != NULL);
+
+  spin_lock_init(&g_pgref.lock);
+}
+
+/****************************************************************************
+ * Name: mm_pgget
+ ****************************************************************************/
+
+void mm_pgget(uintptr_t paddr)
+{
+  size_t index = pgref_index(paddr);
+  irqstate_t flags;
+
+  flags = spin_lock_irqsave(&g_pgref.lock);
+  DEBUGASSERT(g_pgref.extra[index] < UINT16_MAX);
+  g_pgref.extra[index]++;
+  spin_unlock_irqrestore(&g_pgref.lock, flags);
+}
+
+/****************************************************************************
+ * Name: mm_pgput
+ ****************************************************************************/
+
+bool mm_pgput(uintptr_t paddr)
+{
+  size_t index = pgref_index(paddr);
+  irqstate_t flags;
+  bool last;
+
+  flags = spin_lock_irqsave(&g_pgref.lock);
+  last = g_pgref.extra[index] == 0;
+  if (!last)
+    {
+      g_pgref.extra[index]--;
+    }
+
+  spin_unlock_irqrestore(&g_pgref.lock, flags);
+
+  if (last)
+    {
+      mm_pgfree(paddr, 1);
+    }
+
+  return last;
+}
+
+/****************************************************************************
+ * Name: mm_pgrefs
+ ****************************************************************************/
+
+unsigned int mm_pgrefs(uintptr_t paddr)
+{
+  return g_pgref.extra[pgref_index(paddr)] + 1;
+}
+
+#endif /* CONFIG_MM_PGREF */
@@ -29,6 +29,7 @@
 
 #include <nuttx/config.h>
 
+#include <nuttx/atomic.h>
 #include <nuttx/mutex.h>
 #include <nuttx/sched.h>
 #include <nuttx/fs/procfs.h>
@@ -108,12 +109,40 @@
 #  define MM_ADD_BACKTRACE(heap, ptr)
 #endif
 
+#ifdef CONFIG_MM_HEAP_PROFILE
+#  define MM_HEAPPROF_FREE(node) \
+     do \
+       { \
+         if (((node)->size & MM_SAMPLED_BIT) != 0) \
+           { \
+             (node)->size &= ~MM_SAMPLED_BIT; \
+             mm_heapprof_free((FAR char *)(node) + MM_SIZEOF_ALLOCNODE); \
+           } \
+       } \
+     while (0)
+#else
+#  define MM_HEAPPROF_FREE(node)
+#endif
+
 /* All other definitions derive from these two */
 
 #define MM_MIN_CHUNK     (1 << MM_MIN_SHIFT)
 #define MM_MAX_CHUNK     (1 << MM_MAX_SHIFT)
 #define MM_NNODES        (MM_MAX_SHIFT - MM_MIN_SHIFT + 1)
 
+/* Free chunks are kept in segregated lists indexed by a two-level bitmap.
+ * The first level splits the sizes into powers of two (one per MM_NNODES),
+ * the second level splits each power of two linearly into MM_SL_COUNT
+ * classes.  Finding a free chunk of a given class is then two bit scans.
+ */
+
+#ifdef CONFIG_MM_SMALL
+#  define MM_SL_SHIFT    (2)
+#else
+#  define MM_SL_SHIFT    (3)
+#endif
+#define MM_SL_COUNT      (1 << MM_SL_SHIFT)
+
 #if CONFIG_MM_DEFAULT_ALIGNMENT == 0
 #  define MM_ALIGN       (2 * sizeof(uintptr_t))
 #else
@@ -131,7 +160,16 @@
 
 #define MM_ALLOC_BIT     0x1
 #define MM_PREVFREE_BIT  0x2
-#define MM_MASK_BIT      (MM_ALLOC_BIT | MM_PREVFREE_BIT)
+#ifdef CONFIG_MM_HEAP_PROFILE
+/* Bit 2 marks the allocated chunks sampled by the heap profiler, this
+ * requires MM_ALIGN of at least 8.
+ */
+
+#  define MM_SAMPLED_BIT 0x4
+#  define MM_MASK_BIT    (MM_ALLOC_BIT | MM_PREVFREE_BIT | MM_SAMPLED_BIT)
+#else
+#  define MM_MASK_BIT    (MM_ALLOC_BIT | MM_PREVFREE_BIT)
+#endif
 #ifdef CONFIG_MM_SMALL
 #  define MMSIZE_MAX     UINT16_MAX
 #else
@@ -208,6 +246,13 @@ struct mm_freenode_s
 static_assert(MM_SIZEOF_ALLOCNODE <= MM_MIN_CHUNK,
               "Error size for struct mm_allocnode_s\n");
 
+#ifdef CONFIG_MM_HEAP_PROFILE
+static_assert(MM_ALIGN >= 8, "Error no room for MM_SAMPLED_BIT\n");
+#endif
+
+static_assert(MM_NNODES <= 32 && MM_SL_SHIFT <= MM_MIN_SHIFT,
+              "Error free list bitmap size\n");
+
 static_assert(MM_ALIGN >= sizeof(uintptr_t) &&
               (MM_ALIGN & MM_GRAN_MASK) == 0,
               "Error memory alignment\n");
@@ -246,12 +291,14 @@ struct mm_heap_s
   int mm_nregions;
 #endif
 
-  /* All free nodes are maintained in a doubly linked list.  This
-   * array provides some hooks into the list at various points to
-   * speed up searching of free nodes.
+  /* Free nodes are maintained in doubly linked, segregated lists.  A bit
+   * is set in mm_slbitmap[fl] for each non-empty list of mm_freelist[fl],
+   * and in mm_flbitmap for each non-zero mm_slbitmap[fl].
    */
 
-  struct mm_freenode_s mm_nodelist[MM_NNODES];
+  uint32_t mm_flbitmap;
+  uint32_t mm_slbitmap[MM_NNODES];
+  FAR struct mm_freenode_s *mm_freelist[MM_NNODES][MM_SL_COUNT];
 
   /* Free delay list, as sometimes we can't do free immdiately. */
 
@@ -268,6 +315,21 @@ struct mm_heap_s
   FAR struct mempool_multiple_s *mm_mpool;
 #endif
 
+#ifdef CONFIG_MM_HEAP_PROFILE
+  /* Bytes left to allocate before the next sample */
+
+  ssize_t mm_profcount;
+#endif
+
+#ifdef CONFIG_MM_HEAP_ARENA
+  /* The per-CPU arenas carved from this heap.  In an arena, the chunks
+   * freed by other CPUs waiting to be merged back.
+   */
+
+  FAR struct mm_heap_s *mm_arena[CONFIG_SMP_NCPUS];
+  atomic_ulong mm_remote;
+#endif
+
 #if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_MEMINFO)
   struct procfs_meminfo_entry_s mm_procfs;
 #endif
@@ -301,55 +363,159 @@ void mm_foreach(FAR struct mm_heap_s *heap, mm_node_handler_t handler,
 
 void mm_delayfree(FAR struct mm_heap_s *heap, FAR void *mem, bool delay);
 
+/* Functions contained in mm_heapprof.c *************************************/
+
+#ifdef CONFIG_MM_HEAP_PROFILE
+ssize_t mm_heapprof_interval(void);
+void mm_heapprof_alloc(FAR void *mem, size_t size);
+void mm_heapprof_free(FAR void *mem);
+void mm_heapprof_realloc(FAR void *oldmem, FAR void *newmem, size_t size);
+#endif
+
+/* Functions contained in mm_arena.c ****************************************/
+
+#ifdef CONFIG_MM_HEAP_ARENA
+void mm_arena_initialize(FAR struct mm_heap_s *heap);
+void mm_arena_uninitialize(FAR struct mm_heap_s *heap);
+FAR struct mm_heap_s *mm_arena_owner(FAR struct mm_heap_s *heap,
+                                     FAR void *mem);
+FAR void *mm_arena_malloc(FAR struct mm_heap_s *heap, size_t size);
+bool mm_arena_free(FAR struct mm_heap_s *heap, FAR void *mem);
+FAR void *mm_arena_realloc(FAR struct mm_heap_s *heap,
+                           FAR struct mm_heap_s *arena,
+                           FAR void *oldmem, size_t size);
+void mm_arena_mallinfo(FAR struct mm_heap_s *heap,
+                       FAR struct mallinfo *info);
+#endif
+
 /****************************************************************************
  * Inline Functions
  ****************************************************************************/
 
-static inline_function int mm_size2ndx(size_t size)
+/****************************************************************************
+ * Name: mm_mapping
+ *
+ * Description:
+ *   Convert a chunk size into its first and second level free list index.
+ *   All sizes of MM_MAX_CHUNK and above share the last first level list,
+ *   sizes of twice MM_MAX_CHUNK and above the last list of that.
+ *
+ ****************************************************************************/
+
+static inline_function void mm_mapping(size_t size, FAR int *fl,
+                                       FAR int *sl)
 {
+  int shift;
+
   DEBUGASSERT(size >= MM_MIN_CHUNK);
-  if (size >= MM_MAX_CHUNK)
+
+  shift = flsl(size) - 1;
+  if (shift > MM_MAX_SHIFT)
+    {
+      *fl = MM_NNODES - 1;
+      *sl = MM_SL_COUNT - 1;
+    }
+  else
+    {
+      *fl = shift - MM_MIN_SHIFT;
+      *sl = (size >> (shift - MM_SL_SHIFT)) & (MM_SL_COUNT - 1);
+    }
+}
+
+#ifdef CONFIG_MM_HEAP_PROFILE
+/****************************************************************************
+ * Name: mm_heapprof_tick
+ *
+ * Description:
+ *   Account an allocation of 'size' bytes and return true if it is to be
+ *   sampled.  Called with the heap locked.
+ *
+ ****************************************************************************/
+
+static inline_function bool mm_heapprof_tick(FAR struct mm_heap_s *heap,
+                                             size_t size)
+{
+  heap->mm_profcount -= (ssize_t)size;
+  if (heap->mm_profcount > 0)
     {
-      return MM_NNODES - 1;
+      return false;
     }
 
-  size >>= MM_MIN_SHIFT;
-  return flsl(size) - 1;
+  heap->mm_profcount = mm_heapprof_interval();
+  return true;
 }
+#endif
+
+/****************************************************************************
+ * Name: mm_addfreechunk
+ *
+ * Description:
+ *   Push a free chunk onto the head of the list of its size class.
+ *
+ ****************************************************************************/
 
 static inline_function void mm_addfreechunk(FAR struct mm_heap_s *heap,
                                             FAR struct mm_freenode_s *node)
 {
   FAR struct mm_freenode_s *next;
-  FAR struct mm_freenode_s *prev;
-  size_t nodesize = MM_SIZEOF_NODE(node);
-  int ndx;
+  int fl;
+  int sl;
 
-  DEBUGASSERT(nodesize >= MM_MIN_CHUNK);
   DEBUGASSERT(MM_NODE_IS_FREE(node));
 
-  /* Convert the size to a nodelist index */
+  mm_mapping(MM_SIZEOF_NODE(node), &fl, &sl);
 
-  ndx = mm_size2ndx(nodesize);
+  next        = heap->mm_freelist[fl][sl];
+  node->flink = next;
+  node->blink = NULL;
+  if (next)
+    {
+      next->blink = node;
+    }
 
-  /* Now put the new node into the next */
+  heap->mm_freelist[fl][sl] = node;
+  heap->mm_slbitmap[fl]    |= 1u << sl;
+  heap->mm_flbitmap        |= 1u << fl;
+}
 
-  for (prev = &heap->mm_nodelist[ndx],
-       next = heap->mm_nodelist[ndx].flink;
-       next && next->size && MM_SIZEOF_NODE(next) < nodesize;
-       prev = next, next = next->flink);
+/****************************************************************************
+ * Name: mm_delfreechunk
+ *
+ * Description:
+ *   Remove a free chunk from the list of its size class.  The size of the
+ *   chunk must not have been changed since it was added.
+ *
+ ****************************************************************************/
 
-  /* Does it go in mid next or at the end? */
+static inline_function void mm_delfreechunk(FAR struct mm_heap_s *heap,
+                                            FAR struct mm_freenode_s *node)
+{
+  int fl;
+  int sl;
 
-  prev->flink = node;
-  node->blink = prev;
-  node->flink = next;
+  mm_mapping(MM_SIZEOF_NODE(node), &fl, &sl);
 
-  if (next)
+  if (node->flink)
     {
-      /* The new node goes between prev and next */
+      node->flink->blink = node->blink;
+    }
 
-      next->blink = node;
+  if (node->blink)
+    {
+      node->blink->flink = node->flink;
+    }
+  else
+    {
+      DEBUGASSERT(heap->mm_freelist[fl][sl] == node);
+      heap->mm_freelist[fl][sl] = node->flink;
+      if (node->flink == NULL)
+        {
+          heap->mm_slbitmap[fl] &= ~(1u << sl);
+          if (heap->mm_slbitmap[fl] == 0)
+            {
+              heap->mm_flbitmap &= ~(1u << fl);
+            }
+        }
     }
 }
 
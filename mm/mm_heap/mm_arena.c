@@ -0,0 +1,393 @@
+/****************************************************************************
+ * mm/mm_heap/mm_arena.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* Per-CPU heap arenas.
+ *
+ * Each arena is a complete heap instance living in one chunk of its parent
+ * heap.  malloc() on CPU n is served by arena n under the arena's own
+ * mutex, which is only contended by threads running on the same CPU.
+ * Chunks freed on another CPU (or from an interrupt handler) are pushed on
+ * a lock-free list of the owning arena and merged back by the owner on its
+ * next allocation or free.  Whatever does not fit in an arena falls back to
+ * the parent heap.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+#include <debug.h>
+#include <string.h>
+#include <sys/param.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/mm/kasan.h>
+#include <nuttx/mm/mm.h>
+#include <nuttx/sched_note.h>
+
+#include "mm_heap/mm.h"
+
+#ifdef CONFIG_MM_HEAP_ARENA
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_arena_local
+ *
+ * Description:
+ *   Return the arena of the calling CPU, or NULL if the caller must use
+ *   the parent heap.  The caller may be migrated to another CPU as soon
+ *   as this returns, so the result is only a locality hint: every arena
+ *   is protected by its own mutex and may safely be used from any CPU.
+ *
+ ****************************************************************************/
+
+static FAR struct mm_heap_s *mm_arena_local(FAR struct mm_heap_s *heap)
+{
+  if (up_interrupt_context())
+    {
+      return NULL;
+    }
+
+  return heap->mm_arena[this_cpu()];
+}
+
+/****************************************************************************
+ * Name: mm_arena_push
+ *
+ * Description:
+ *   Queue a chunk freed by another CPU on the remote free list of its
+ *   arena.  The link is stored in the chunk itself, as for the delay list.
+ *
+ ****************************************************************************/
+
+static void mm_arena_push(FAR struct mm_heap_s *arena, FAR void *mem)
+{
+  FAR struct mm_delaynode_s *tmp = mem;
+  unsigned long head;
+
+#ifdef CONFIG_DEBUG_ASSERTIONS
+  FAR struct mm_freenode_s *node;
+
+  node = (FAR struct mm_freenode_s *)((FAR char *)mem - MM_SIZEOF_ALLOCNODE);
+  DEBUGASSERT(MM_NODE_IS_ALLOC(node));
+#endif
+
+  head = atomic_load_explicit(&arena->mm_remote, memory_order_relaxed);
+  do
+    {
+      tmp->flink = (FAR struct mm_delaynode_s *)head;
+    }
+  while (!atomic_compare_exchange_weak_explicit(&arena->mm_remote, &head,
+                                                (unsigned long)tmp,
+                                                memory_order_release,
+                                                memory_order_relaxed));
+}
+
+/****************************************************************************
+ * Name: mm_arena_drain
+ *
+ * Description:
+ *   Take back all chunks freed remotely since the last call.
+ *
+ ****************************************************************************/
+
+static void mm_arena_drain(FAR struct mm_heap_s *arena)
+{
+  FAR struct mm_delaynode_s *tmp;
+
+  if (atomic_load_explicit(&arena->mm_remote, memory_order_relaxed) == 0)
+    {
+      return;
+    }
+
+  tmp = (FAR struct mm_delaynode_s *)
+    atomic_exchange_explicit(&arena->mm_remote, 0, memory_order_acquire);
+
+  while (tmp)
+    {
+      FAR void *address = tmp;
+
+      tmp = tmp->flink;
+      mm_delayfree(arena, address, false);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_arena_initialize
+ *
+ * Description:
+ *   Carve one arena per CPU out of a newly initialized heap.  Heaps too
+ *   small to spare CONFIG_MM_HEAP_ARENA_SIZE bytes per CPU are left alone.
+ *
+ ****************************************************************************/
+
+void mm_arena_initialize(FAR struct mm_heap_s *heap)
+{
+  FAR struct mm_heap_s *arena;
+  int cpu;
+
+  if (heap->mm_heapsize <
+      4 * CONFIG_SMP_NCPUS * (size_t)CONFIG_MM_HEAP_ARENA_SIZE)
+    {
+      return;
+    }
+
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      arena = mm_malloc(heap, CONFIG_MM_HEAP_ARENA_SIZE);
+      if (arena == NULL)
+        {
+          break;
+        }
+
+#if CONFIG_MM_BACKTRACE >= 0
+      /* Account the arena like a mempool chunk, not as a leak of the
+       * task that happened to initialize the heap.
+       */
+
+      ((FAR struct mm_allocnode_s *)
+       ((FAR char *)arena - MM_SIZEOF_ALLOCNODE))->pid = PID_MM_MEMPOOL;
+#endif
+
+      memset(arena, 0, sizeof(struct mm_heap_s));
+      nxmutex_init(&arena->mm_lock);
+
+#if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_MEMINFO)
+#  if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
+      arena->mm_procfs.name = heap->mm_procfs.name;
+#  endif
+#endif
+
+      arena->mm_curused = sizeof(struct mm_heap_s);
+      mm_addregion(arena, arena + 1,
+                   CONFIG_MM_HEAP_ARENA_SIZE - sizeof(struct mm_heap_s));
+
+      heap->mm_arena[cpu] = arena;
+    }
+}
+
+/****************************************************************************
+ * Name: mm_arena_uninitialize
+ *
+ * Description:
+ *   Take back the chunks still queued on the arenas and return the arena
+ *   memory to the parent heap.
+ *
+ ****************************************************************************/
+
+void mm_arena_uninitialize(FAR struct mm_heap_s *heap)
+{
+  FAR struct mm_heap_s *arena;
+  int cpu;
+
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      arena = heap->mm_arena[cpu];
+      if (arena == NULL)
+        {
+          continue;
+        }
+
+      mm_arena_drain(arena);
+      mm_free_delaylist(arena);
+
+      kasan_unregister(arena->mm_heapstart[0]);
+      sched_note_heap(NOTE_HEAP_REMOVE, arena, arena->mm_heapstart[0],
+                      (uintptr_t)arena->mm_heapend[0] -
+                      (uintptr_t)arena->mm_heapstart[0],
+                      arena->mm_curused);
+
+      nxmutex_destroy(&arena->mm_lock);
+
+      /* Detach the arena first, so that freeing it goes to the parent */
+
+      heap->mm_arena[cpu] = NULL;
+      mm_free(heap, arena);
+    }
+}
+
+/****************************************************************************
+ * Name: mm_arena_owner
+ *
+ * Description:
+ *   Return the arena that 'mem' was allocated from, or NULL if it belongs
+ *   to the parent heap.
+ *
+ ****************************************************************************/
+
+FAR struct mm_heap_s *mm_arena_owner(FAR struct mm_heap_s *heap,
+                                     FAR void *mem)
+{
+  FAR struct mm_heap_s *arena;
+  int cpu;
+
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      arena = heap->mm_arena[cpu];
+      if (arena != NULL &&
+          mem > (FAR void *)arena->mm_heapstart[0] &&
+          mem < (FAR void *)arena->mm_heapend[0])
+        {
+          return arena;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: mm_arena_malloc
+ *
+ * Description:
+ *   Allocate from the arena of the calling CPU.  Returns NULL if there is
+ *   no such arena or it is exhausted, the caller then uses the parent.
+ *
+ ****************************************************************************/
+
+FAR void *mm_arena_malloc(FAR struct mm_heap_s *heap, size_t size)
+{
+  FAR struct mm_heap_s *arena = mm_arena_local(heap);
+
+  if (arena == NULL)
+    {
+      return NULL;
+    }
+
+  mm_arena_drain(arena);
+  return mm_malloc(arena, size);
+}
+
+/****************************************************************************
+ * Name: mm_arena_free
+ *
+ * Description:
+ *   Free a chunk if it belongs to one of the arenas of the heap.  Returns
+ *   false if the chunk belongs to the parent heap.
+ *
+ ****************************************************************************/
+
+bool mm_arena_free(FAR struct mm_heap_s *heap, FAR void *mem)
+{
+  FAR struct mm_heap_s *arena = mm_arena_owner(heap, mem);
+
+  if (arena == NULL)
+    {
+      return false;
+    }
+
+  if (arena == mm_arena_local(heap))
+    {
+      mm_arena_drain(arena);
+      mm_delayfree(arena, mem, CONFIG_MM_FREE_DELAYCOUNT_MAX > 0);
+    }
+  else
+    {
+      mm_arena_push(arena, mem);
+    }
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: mm_arena_realloc
+ *
+ * Description:
+ *   Reallocate a chunk owned by 'arena'.  The chunk is resized in place
+ *   only by its owner, otherwise it is moved.
+ *
+ ****************************************************************************/
+
+FAR void *mm_arena_realloc(FAR struct mm_heap_s *heap,
+                           FAR struct mm_heap_s *arena,
+                           FAR void *oldmem, size_t size)
+{
+  FAR void *newmem;
+
+  if (arena == mm_arena_local(heap))
+    {
+      newmem = mm_realloc(arena, oldmem, size);
+      if (newmem != NULL)
+        {
+          return newmem;
+        }
+    }
+
+  newmem = mm_malloc(heap, size);
+  if (newmem != NULL)
+    {
+      memcpy(newmem, oldmem, MIN(size, mm_malloc_size(arena, oldmem)));
+      mm_arena_free(heap, oldmem);
+    }
+
+  return newmem;
+}
+
+/****************************************************************************
+ * Name: mm_arena_mallinfo
+ *
+ * Description:
+ *   Add the contents of the arenas to the heap information.  The parent
+ *   sees each arena as one allocated chunk, so the free space inside it is
+ *   moved from the used to the free count.
+ *
+ ****************************************************************************/
+
+void mm_arena_mallinfo(FAR struct mm_heap_s *heap,
+                       FAR struct mallinfo *info)
+{
+  struct mallinfo ainfo;
+  int cpu;
+
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      if (heap->mm_arena[cpu] == NULL)
+        {
+          continue;
+        }
+
+      /* Count chunks freed from other CPUs as free */
+
+      mm_arena_drain(heap->mm_arena[cpu]);
+      ainfo = mm_mallinfo(heap->mm_arena[cpu]);
+
+      info->uordblks -= ainfo.fordblks;
+      info->fordblks += ainfo.fordblks;
+      info->aordblks += ainfo.aordblks;
+      info->ordblks  += ainfo.ordblks;
+      if (ainfo.mxordblk > info->mxordblk)
+        {
+          info->mxordblk = ainfo.mxordblk;
+        }
+    }
+}
+
+#endif /* CONFIG_MM_HEAP_ARENA */
@@ -53,13 +53,10 @@ static void checkcorruption_handler(FAR struct mm_allocnode_s *node,
       FAR struct mm_freenode_s *fnode = (FAR void *)node;
 
       ASSERT(nodesize >= MM_MIN_CHUNK);
-      ASSERT(fnode->blink->flink == fnode);
-      ASSERT(MM_SIZEOF_NODE(fnode->blink) <= nodesize);
+      ASSERT(fnode->blink == NULL ||
+             fnode->blink->flink == fnode);
       ASSERT(fnode->flink == NULL ||
              fnode->flink->blink == fnode);
-      ASSERT(fnode->flink == NULL ||
-             MM_SIZEOF_NODE(fnode->flink) == 0 ||
-             MM_SIZEOF_NODE(fnode->flink) >= nodesize);
     }
 }
 
@@ -77,5 +74,17 @@ static void checkcorruption_handler(FAR struct mm_allocnode_s *node,
 
 void mm_checkcorruption(FAR struct mm_heap_s *heap)
 {
+#ifdef CONFIG_MM_HEAP_ARENA
+  int cpu;
+
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      if (heap->mm_arena[cpu] != NULL)
+        {
+          mm_foreach(heap->mm_arena[cpu], checkcorruption_handler, NULL);
+        }
+    }
+#endif
+
   mm_foreach(heap, checkcorruption_handler, NULL);
 }
@@ -135,6 +135,7 @@ void mm_delayfree(FAR struct mm_heap_s *heap, FAR void *mem, bool delay)
 
   DEBUGASSERT(MM_NODE_IS_ALLOC(node));
 
+  MM_HEAPPROF_FREE(node);
   node->size &= ~MM_ALLOC_BIT;
 
   /* Update heap statistics */
@@ -160,16 +161,9 @@ void mm_delayfree(FAR struct mm_heap_s *heap, FAR void *mem, bool delay)
       DEBUGASSERT(MM_PREVNODE_IS_FREE(andbeyond) &&
                   andbeyond->preceding == nextsize);
 
-      /* Remove the next node.  There must be a predecessor,
-       * but there may not be a successor node.
-       */
+      /* Remove the next node from its free list */
 
-      DEBUGASSERT(next->blink);
-      next->blink->flink = next->flink;
-      if (next->flink)
-        {
-          next->flink->blink = next->blink;
-        }
+      mm_delfreechunk(heap, next);
 
       /* Then merge the two chunks */
 
@@ -195,16 +189,9 @@ void mm_delayfree(FAR struct mm_heap_s *heap, FAR void *mem, bool delay)
       prevsize = MM_SIZEOF_NODE(prev);
       DEBUGASSERT(MM_NODE_IS_FREE(prev) && node->preceding == prevsize);
 
-      /* Remove the node.  There must be a predecessor, but there may
-       * not be a successor node.
-       */
+      /* Remove the node from its free list */
 
-      DEBUGASSERT(prev->blink);
-      prev->blink->flink = prev->flink;
-      if (prev->flink)
-        {
-          prev->flink->blink = prev->blink;
-        }
+      mm_delfreechunk(heap, prev);
 
       /* Then merge the two chunks */
 
@@ -252,5 +239,12 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
     }
 #endif
 
+#ifdef CONFIG_MM_HEAP_ARENA
+  if (mm_arena_free(heap, mem))
+    {
+      return;
+    }
+#endif
+
   mm_delayfree(heap, mem, CONFIG_MM_FREE_DELAYCOUNT_MAX > 0);
 }
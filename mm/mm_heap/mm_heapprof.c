@@ -0,0 +1,399 @@
+/****************************************************************************
+ * mm/mm_heap/mm_heapprof.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* Sampling heap profiler.
+ *
+ * Instead of recording a backtrace in every chunk like CONFIG_MM_BACKTRACE,
+ * one allocation is sampled on average every CONFIG_MM_HEAP_PROFILE_RATE
+ * bytes.  Sampled chunks are marked with MM_SAMPLED_BIT, so that free only
+ * looks the profiler up for them.  The backtraces of the samples are
+ * aggregated per call site in a fixed size hash table; a second table maps
+ * the live samples to their site.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <sched.h>
+#include <string.h>
+
+#include <nuttx/mm/mm.h>
+#include <nuttx/spinlock.h>
+
+#include "mm_heap/mm.h"
+
+#ifdef CONFIG_MM_HEAP_PROFILE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define HEAPPROF_NSITES     CONFIG_MM_HEAP_PROFILE_NSITES
+#define HEAPPROF_NSAMPLES   CONFIG_MM_HEAP_PROFILE_NSAMPLES
+
+/* Keep the sample table at most 3/4 full so that probes stay short */
+
+#define HEAPPROF_MAXSAMPLES (HEAPPROF_NSAMPLES / 4 * 3)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct heapprof_sample_s
+{
+  FAR void                  *mem;   /* Sampled chunk, NULL if unused */
+  size_t                     size;  /* Size of the chunk */
+  FAR struct mm_heapprof_site_s *site;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct mm_heapprof_site_s g_heapprof_sites[HEAPPROF_NSITES];
+static uint32_t g_heapprof_hash[HEAPPROF_NSITES];
+static struct heapprof_sample_s g_heapprof_samples[HEAPPROF_NSAMPLES];
+static size_t g_heapprof_nsamples;
+static spinlock_t g_heapprof_lock = SP_UNLOCKED;
+static uint32_t g_heapprof_seed = 2463534242u;
+
+static_assert((HEAPPROF_NSITES & (HEAPPROF_NSITES - 1)) == 0 &&
+              (HEAPPROF_NSAMPLES & (HEAPPROF_NSAMPLES - 1)) == 0,
+              "Heap profiler table sizes must be powers of two");
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: heapprof_slot
+ ****************************************************************************/
+
+static inline size_t heapprof_slot(FAR void *mem)
+{
+  return ((uintptr_t)mem >> MM_MIN_SHIFT) * 2654435761u &
+         (HEAPPROF_NSAMPLES - 1);
+}
+
+/****************************************************************************
+ * Name: heapprof_getsite
+ *
+ * Description:
+ *   Find or create the call site of a backtrace.  Returns NULL if the
+ *   site table is full.
+ *
+ ****************************************************************************/
+
+static FAR struct mm_heapprof_site_s *
+heapprof_getsite(FAR void **pc, int depth)
+{
+  FAR struct mm_heapprof_site_s *site;
+  uint32_t hash = 2166136261u;
+  size_t i;
+  size_t n;
+  int j;
+
+  for (j = 0; j < depth; j++)
+    {
+      hash = (hash ^ (uint32_t)(uintptr_t)pc[j]) * 16777619u;
+    }
+
+  /* Zero marks an unused entry */
+
+  hash = hash ? hash : 1;
+
+  for (i = hash, n = 0; n < HEAPPROF_NSITES; i++, n++)
+    {
+      i &= HEAPPROF_NSITES - 1;
+      site = &g_heapprof_sites[i];
+
+      if (g_heapprof_hash[i] == 0)
+        {
+          g_heapprof_hash[i] = hash;
+          site->depth = depth;
+          memcpy(site->pc, pc, depth * sizeof(FAR void *));
+          return site;
+        }
+
+      if (g_heapprof_hash[i] == hash && site->depth == depth &&
+          memcmp(site->pc, pc, depth * sizeof(FAR void *)) == 0)
+        {
+          return site;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: heapprof_delsample
+ *
+ * Description:
+ *   Remove an entry of the sample table, moving back the entries of the
+ *   same probe sequence so that lookups need no tombstones.
+ *
+ ****************************************************************************/
+
+static void heapprof_delsample(size_t i)
+{
+  size_t j = i;
+  size_t k;
+
+  for (; ; )
+    {
+      g_heapprof_samples[i].mem = NULL;
+
+      do
+        {
+          j = (j + 1) & (HEAPPROF_NSAMPLES - 1);
+          if (g_heapprof_samples[j].mem == NULL)
+            {
+              return;
+            }
+
+          k = heapprof_slot(g_heapprof_samples[j].mem);
+        }
+      while (i <= j ? (i < k && k <= j) : (i < k || k <= j));
+
+      g_heapprof_samples[i] = g_heapprof_samples[j];
+      i = j;
+    }
+}
+
+/****************************************************************************
+ * Name: heapprof_remove
+ ****************************************************************************/
+
+static void heapprof_remove(FAR void *mem)
+{
+  FAR struct heapprof_sample_s *sample;
+  size_t i;
+
+  for (i = heapprof_slot(mem); ; i = (i + 1) & (HEAPPROF_NSAMPLES - 1))
+    {
+      sample = &g_heapprof_samples[i];
+      if (sample->mem == NULL)
+        {
+          /* Not recorded, the tables were full when it was sampled */
+
+          return;
+        }
+
+      if (sample->mem == mem)
+        {
+          sample->site->inuse_objs--;
+          sample->site->inuse_bytes -= sample->size;
+          heapprof_delsample(i);
+          g_heapprof_nsamples--;
+          return;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: heapprof_insert
+ ****************************************************************************/
+
+static void heapprof_insert(FAR void *mem, size_t size,
+                            FAR void **pc, int depth)
+{
+  FAR struct mm_heapprof_site_s *site;
+  size_t i;
+
+  if (g_heapprof_nsamples >= HEAPPROF_MAXSAMPLES)
+    {
+      return;
+    }
+
+  site = heapprof_getsite(pc, depth);
+  if (site == NULL)
+    {
+      return;
+    }
+
+  site->inuse_objs++;
+  site->inuse_bytes += size;
+  site->alloc_objs++;
+  site->alloc_bytes += size;
+
+  for (i = heapprof_slot(mem); g_heapprof_samples[i].mem != NULL;
+       i = (i + 1) & (HEAPPROF_NSAMPLES - 1));
+
+  g_heapprof_samples[i].mem  = mem;
+  g_heapprof_samples[i].size = size;
+  g_heapprof_samples[i].site = site;
+  g_heapprof_nsamples++;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_heapprof_interval
+ *
+ * Description:
+ *   Return the number of bytes to allocate before the next sample.  The
+ *   interval is drawn uniformly from [rate / 2, rate * 3 / 2) so that
+ *   periodic allocation patterns are not aliased.
+ *
+ ****************************************************************************/
+
+ssize_t mm_heapprof_interval(void)
+{
+  uint32_t x = g_heapprof_seed;
+
+  /* xorshift32, the races between heaps only add more randomness */
+
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  g_heapprof_seed = x;
+
+  return CONFIG_MM_HEAP_PROFILE_RATE / 2 +
+         x % CONFIG_MM_HEAP_PROFILE_RATE;
+}
+
+/****************************************************************************
+ * Name: mm_heapprof_alloc
+ *
+ * Description:
+ *   Record a sampled allocation.  Called without the heap locked, before
+ *   the chunk is returned to the caller.
+ *
+ ****************************************************************************/
+
+void mm_heapprof_alloc(FAR void *mem, size_t size)
+{
+  FAR void *pc[CONFIG_MM_HEAP_PROFILE_DEPTH];
+  irqstate_t flags;
+  int depth;
+
+  depth = sched_backtrace(_SCHED_GETTID(), pc, CONFIG_MM_HEAP_PROFILE_DEPTH,
+                          CONFIG_MM_HEAP_PROFILE_SKIP);
+  if (depth < 0)
+    {
+      depth = 0;
+    }
+
+  flags = spin_lock_irqsave(&g_heapprof_lock);
+  heapprof_insert(mem, size, pc, depth);
+  spin_unlock_irqrestore(&g_heapprof_lock, flags);
+}
+
+/****************************************************************************
+ * Name: mm_heapprof_free
+ *
+ * Description:
+ *   Forget a sampled chunk.  Called with the heap locked, so that the
+ *   chunk cannot be handed out again before it is removed.
+ *
+ ****************************************************************************/
+
+void mm_heapprof_free(FAR void *mem)
+{
+  irqstate_t flags;
+
+  flags = spin_lock_irqsave(&g_heapprof_lock);
+  heapprof_remove(mem);
+  spin_unlock_irqrestore(&g_heapprof_lock, flags);
+}
+
+/****************************************************************************
+ * Name: mm_heapprof_realloc
+ *
+ * Description:
+ *   Move a sample whose chunk was resized in place, attributing it to the
+ *   caller of realloc().
+ *
+ ****************************************************************************/
+
+void mm_heapprof_realloc(FAR void *oldmem, FAR void *newmem, size_t size)
+{
+  mm_heapprof_free(oldmem);
+  mm_heapprof_alloc(newmem, size);
+}
+
+/****************************************************************************
+ * Name: mm_heapprof_site
+ *
+ * Description:
+ *   Copy the call site at or after 'index' into 'site'.
+ *
+ * Returned Value:
+ *   The index to pass to get the next site, or -ENOENT when there are no
+ *   more sites.
+ *
+ ****************************************************************************/
+
+int mm_heapprof_site(int index, FAR struct mm_heapprof_site_s *site)
+{
+  irqstate_t flags;
+
+  flags = spin_lock_irqsave(&g_heapprof_lock);
+  for (; index < HEAPPROF_NSITES; index++)
+    {
+      if (g_heapprof_hash[index] != 0)
+        {
+          memcpy(site, &g_heapprof_sites[index], sizeof(*site));
+          spin_unlock_irqrestore(&g_heapprof_lock, flags);
+          return index + 1;
+        }
+    }
+
+  spin_unlock_irqrestore(&g_heapprof_lock, flags);
+  return -ENOENT;
+}
+
+/****************************************************************************
+ * Name: mm_heapprof_total
+ *
+ * Description:
+ *   Sum the counts of all call sites.
+ *
+ ****************************************************************************/
+
+void mm_heapprof_total(FAR struct mm_heapprof_site_s *total)
+{
+  irqstate_t flags;
+  int i;
+
+  memset(total, 0, sizeof(*total));
+
+  flags = spin_lock_irqsave(&g_heapprof_lock);
+  for (i = 0; i < HEAPPROF_NSITES; i++)
+    {
+      total->inuse_objs  += g_heapprof_sites[i].inuse_objs;
+      total->inuse_bytes += g_heapprof_sites[i].inuse_bytes;
+      total->alloc_objs  += g_heapprof_sites[i].alloc_objs;
+      total->alloc_bytes += g_heapprof_sites[i].alloc_bytes;
+    }
+
+  spin_unlock_irqrestore(&g_heapprof_lock, flags);
+}
+
+#endif /* CONFIG_MM_HEAP_PROFILE */
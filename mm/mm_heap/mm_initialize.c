@@ -235,7 +235,6 @@ FAR struct mm_heap_s *mm_initialize(FAR const char *name,
 {
   FAR struct mm_heap_s *heap;
   uintptr_t             heap_adj;
-  int                   i;
 
   minfo("Heap: name=%s, start=%p size=%zu\n", name, heapstart, heapsize);
 
@@ -253,18 +252,10 @@ FAR struct mm_heap_s *mm_initialize(FAR const char *name,
 
   DEBUGASSERT(MM_MIN_CHUNK >= MM_SIZEOF_ALLOCNODE);
 
-  /* Set up global variables */
+  /* Set up global variables, this also leaves all free lists empty */
 
   memset(heap, 0, sizeof(struct mm_heap_s));
 
-  /* Initialize the node array */
-
-  for (i = 1; i < MM_NNODES; i++)
-    {
-      heap->mm_nodelist[i - 1].flink = &heap->mm_nodelist[i];
-      heap->mm_nodelist[i].blink     = &heap->mm_nodelist[i - 1];
-    }
-
   /* Initialize the malloc mutex to one (to support one-at-
    * a-time access to private data sets).
    */
@@ -286,6 +277,10 @@ FAR struct mm_heap_s *mm_initialize(FAR const char *name,
   heap->mm_curused = sizeof(struct mm_heap_s);
   mm_addregion(heap, heapstart, heapsize);
 
+#ifdef CONFIG_MM_HEAP_ARENA
+  mm_arena_initialize(heap);
+#endif
+
 #if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_MEMINFO)
 #  if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
   procfs_register_meminfo(&heap->mm_procfs);
@@ -375,6 +370,10 @@ void mm_uninitialize(FAR struct mm_heap_s *heap)
   mempool_multiple_deinit(heap->mm_mpool);
 #endif
 
+#ifdef CONFIG_MM_HEAP_ARENA
+  mm_arena_uninitialize(heap);
+#endif
+
   for (i = 0; i < CONFIG_MM_REGIONS; i++)
     {
       kasan_unregister(heap->mm_heapstart[i]);
@@ -28,6 +28,7 @@
 
 #include <assert.h>
 #include <debug.h>
+#include <sys/param.h>
 
 #include <nuttx/mm/mm.h>
 
@@ -69,13 +70,10 @@ static void mallinfo_handler(FAR struct mm_allocnode_s *node, FAR void *arg)
       FAR struct mm_freenode_s *fnode = (FAR void *)node;
 
       DEBUGASSERT(nodesize >= MM_MIN_CHUNK);
-      DEBUGASSERT(fnode->blink->flink == fnode);
-      DEBUGASSERT(MM_SIZEOF_NODE(fnode->blink) <= nodesize);
+      DEBUGASSERT(fnode->blink == NULL ||
+                  fnode->blink->flink == fnode);
       DEBUGASSERT(fnode->flink == NULL ||
                   fnode->flink->blink == fnode);
-      DEBUGASSERT(fnode->flink == NULL ||
-                  MM_SIZEOF_NODE(fnode->flink) == 0 ||
-                  MM_SIZEOF_NODE(fnode->flink) >= nodesize);
 
       info->ordblks++;
       info->fordblks += nodesize;
@@ -146,6 +144,10 @@ struct mallinfo mm_mallinfo(FAR struct mm_heap_s *heap)
   info.fordblks += poolinfo.fordblks;
 #endif
 
+#ifdef CONFIG_MM_HEAP_ARENA
+  mm_arena_mallinfo(heap, &info);
+#endif
+
   DEBUGASSERT(info.uordblks + info.fordblks == info.arena);
 
   return info;
@@ -168,6 +170,10 @@ struct mallinfo_task mm_mallinfo_task(FAR struct mm_heap_s *heap,
     {
       0, 0
     };
+#ifdef CONFIG_MM_HEAP_ARENA
+  struct mallinfo_task ainfo;
+  int cpu;
+#endif
 
 #ifdef CONFIG_MM_HEAP_MEMPOOL
   info = mempool_multiple_info_task(heap->mm_mpool, task);
@@ -177,6 +183,18 @@ struct mallinfo_task mm_mallinfo_task(FAR struct mm_heap_s *heap,
   handle.info = &info;
   mm_foreach(heap, mallinfo_task_handler, &handle);
 
+#ifdef CONFIG_MM_HEAP_ARENA
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      if (heap->mm_arena[cpu] != NULL)
+        {
+          ainfo = mm_mallinfo_task(heap->mm_arena[cpu], task);
+          info.aordblks += ainfo.aordblks;
+          info.uordblks += ainfo.uordblks;
+        }
+    }
+#endif
+
   return info;
 }
 
@@ -190,7 +208,20 @@ struct mallinfo_task mm_mallinfo_task(FAR struct mm_heap_s *heap,
 
 size_t mm_heapfree(FAR struct mm_heap_s *heap)
 {
-  return heap->mm_heapsize - heap->mm_curused;
+  size_t free = heap->mm_heapsize - heap->mm_curused;
+#ifdef CONFIG_MM_HEAP_ARENA
+  int cpu;
+
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      if (heap->mm_arena[cpu] != NULL)
+        {
+          free += mm_heapfree(heap->mm_arena[cpu]);
+        }
+    }
+#endif
+
+  return free;
 }
 
 /****************************************************************************
@@ -204,15 +235,40 @@ size_t mm_heapfree(FAR struct mm_heap_s *heap)
 size_t mm_heapfree_largest(FAR struct mm_heap_s *heap)
 {
   FAR struct mm_freenode_s *node;
-  for (node = heap->mm_nodelist[MM_NNODES - 1].blink; node;
-       node = node->blink)
+  size_t largest = 0;
+  int fl;
+  int sl;
+#ifdef CONFIG_MM_HEAP_ARENA
+  int cpu;
+
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      if (heap->mm_arena[cpu] != NULL)
+        {
+          largest = MAX(largest, mm_heapfree_largest(heap->mm_arena[cpu]));
+        }
+    }
+#endif
+
+  if (heap->mm_flbitmap == 0)
+    {
+      return largest;
+    }
+
+  /* The largest chunk is in the highest non-empty list, which is not
+   * sorted by size.
+   */
+
+  fl = fls(heap->mm_flbitmap) - 1;
+  sl = fls(heap->mm_slbitmap[fl]) - 1;
+  for (node = heap->mm_freelist[fl][sl]; node; node = node->flink)
     {
       size_t nodesize = MM_SIZEOF_NODE(node);
-      if (nodesize != 0)
+      if (nodesize > largest)
         {
-          return nodesize;
+          largest = nodesize;
         }
     }
 
-  return 0;
+  return largest;
 }
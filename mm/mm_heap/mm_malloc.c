@@ -33,6 +33,7 @@
 #include <nuttx/arch.h>
 #include <nuttx/mm/mm.h>
 #include <nuttx/mm/kasan.h>
+#include <nuttx/mm/shrinker.h>
 #include <nuttx/sched.h>
 #include <nuttx/sched_note.h>
 
@@ -109,6 +110,95 @@ static bool free_delaylist(FAR struct mm_heap_s *heap, bool force)
   return ret;
 }
 
+/****************************************************************************
+ * Name: mm_searchlist
+ *
+ * Description:
+ *   Return the first chunk of a free list that is at least 'size' bytes.
+ *
+ ****************************************************************************/
+
+static FAR struct mm_freenode_s *
+mm_searchlist(FAR struct mm_freenode_s *node, size_t size)
+{
+  for (; node; node = node->flink)
+    {
+      DEBUGASSERT(node->blink == NULL || node->blink->flink == node);
+      if (MM_SIZEOF_NODE(node) >= size)
+        {
+          break;
+        }
+    }
+
+  return node;
+}
+
+/****************************************************************************
+ * Name: mm_findfreechunk
+ *
+ * Description:
+ *   Find a free chunk of at least 'size' bytes.  The request is rounded up
+ *   to the next size class, so that the head of any non-empty list at or
+ *   above that class fits and is found with two bit scans.  Only if all of
+ *   these are empty is the list of the request's own class searched.
+ *
+ ****************************************************************************/
+
+static FAR struct mm_freenode_s *
+mm_findfreechunk(FAR struct mm_heap_s *heap, size_t size)
+{
+  FAR struct mm_freenode_s *node;
+  uint32_t flmap;
+  uint32_t slmap;
+  int shift;
+  int fl;
+  int sl;
+
+  mm_mapping(size, &fl, &sl);
+
+  shift = flsl(size) - 1;
+  if (shift <= MM_MAX_SHIFT &&
+      (size & ((1 << (shift - MM_SL_SHIFT)) - 1)) != 0)
+    {
+      if (++sl >= MM_SL_COUNT)
+        {
+          sl = 0;
+          fl++;
+        }
+    }
+
+  if (fl < MM_NNODES)
+    {
+      slmap = heap->mm_slbitmap[fl] & (~0u << sl);
+      if (slmap == 0)
+        {
+          flmap = heap->mm_flbitmap & ~((2u << fl) - 1);
+          if (flmap != 0)
+            {
+              fl    = ffs(flmap) - 1;
+              slmap = heap->mm_slbitmap[fl];
+            }
+        }
+
+      if (slmap != 0)
+        {
+          /* Only the last list, which holds all sizes above the largest
+           * class, may need more than one node visited.
+           */
+
+          sl   = ffs(slmap) - 1;
+          node = mm_searchlist(heap->mm_freelist[fl][sl], size);
+          if (node)
+            {
+              return node;
+            }
+        }
+    }
+
+  mm_mapping(size, &fl, &sl);
+  return mm_searchlist(heap->mm_freelist[fl][sl], size);
+}
+
 #if CONFIG_MM_BACKTRACE >= 0
 void mm_dump_handler(FAR struct tcb_s *tcb, FAR void *arg)
 {
@@ -160,7 +250,7 @@ void mm_free_delaylist(FAR struct mm_heap_s *heap)
  * Name: mm_malloc
  *
  * Description:
- *  Find the smallest chunk that satisfies the request. Take the memory from
+ *  Find a free chunk that satisfies the request. Take the memory from
  *  that chunk, save the remaining, smaller chunk (if any).
  *
  *  8-byte alignment of the allocated data is assured.
@@ -173,7 +263,12 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
   size_t alignsize;
   size_t nodesize;
   FAR void *ret = NULL;
-  int ndx;
+#ifdef CONFIG_MM_HEAP_PROFILE
+  bool sampled = false;
+#endif
+#ifdef CONFIG_MM_SHRINKER
+  int retries = 0;
+#endif
 
   /* Free the delay list first */
 
@@ -190,6 +285,14 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
     }
 #endif
 
+#ifdef CONFIG_MM_HEAP_ARENA
+  ret = mm_arena_malloc(heap, size);
+  if (ret != NULL)
+    {
+      return ret;
+    }
+#endif
+
   /* Adjust the size to account for (1) the size of the allocated node and
    * (2) to make sure that it is aligned with MM_ALIGN and its size is at
    * least MM_MIN_CHUNK.
@@ -210,33 +313,19 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 
   DEBUGASSERT(alignsize >= MM_ALIGN);
 
+#ifdef CONFIG_MM_SHRINKER
+retry:
+#endif
+
   /* We need to hold the MM mutex while we muck with the nodelist. */
 
   DEBUGVERIFY(mm_lock(heap));
 
-  /* Convert the request size into a nodelist index */
+  /* Search for a large enough chunk in the free lists */
 
-  ndx = mm_size2ndx(alignsize);
+  node = mm_findfreechunk(heap, alignsize);
 
-  /* Search for a large enough chunk in the list of nodes. This list is
-   * ordered by size, but will have occasional zero sized nodes as we visit
-   * other mm_nodelist[] entries.
-   */
-
-  for (node = heap->mm_nodelist[ndx].flink; node; node = node->flink)
-    {
-      DEBUGASSERT(node->blink->flink == node);
-      nodesize = MM_SIZEOF_NODE(node);
-      if (nodesize >= alignsize)
-        {
-          break;
-        }
-    }
-
-  /* If we found a node with non-zero size, then this is one to use. Since
-   * the list is ordered, we know that it must be the best fitting chunk
-   * available.
-   */
+  /* If we found a node, then this is one to use */
 
   if (node)
     {
@@ -244,16 +333,10 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
       FAR struct mm_freenode_s *next;
       size_t remaining;
 
-      /* Remove the node.  There must be a predecessor, but there may not be
-       * a successor node.
-       */
+      /* Remove the node from its free list */
 
-      DEBUGASSERT(node->blink);
-      node->blink->flink = node->flink;
-      if (node->flink)
-        {
-          node->flink->blink = node->blink;
-        }
+      nodesize = MM_SIZEOF_NODE(node);
+      mm_delfreechunk(heap, node);
 
       /* Get a pointer to the next node in physical memory */
 
@@ -318,6 +401,14 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 
       node->size |= MM_ALLOC_BIT;
       ret = (FAR void *)((FAR char *)node + MM_SIZEOF_ALLOCNODE);
+
+#ifdef CONFIG_MM_HEAP_PROFILE
+      sampled = mm_heapprof_tick(heap, nodesize);
+      if (sampled)
+        {
+          node->size |= MM_SAMPLED_BIT;
+        }
+#endif
     }
 
   DEBUGASSERT(ret == NULL || mm_heapmember(heap, ret));
@@ -333,12 +424,25 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
   if (ret)
     {
       MM_ADD_BACKTRACE(heap, node);
+#ifdef CONFIG_MM_HEAP_PROFILE
+      if (sampled)
+        {
+          mm_heapprof_alloc(ret, nodesize - MM_ALLOCNODE_OVERHEAD);
+        }
+#endif
+
       ret = kasan_unpoison(ret, nodesize - MM_ALLOCNODE_OVERHEAD);
 #ifdef CONFIG_MM_FILL_ALLOCATIONS
       memset(ret, MM_ALLOC_MAGIC, alignsize - MM_ALLOCNODE_OVERHEAD);
 #endif
 #ifdef CONFIG_DEBUG_MM
       minfo("Allocated %p, size %zu\n", ret, alignsize);
+#endif
+#if CONFIG_MM_SHRINKER_LOWATER > 0
+      if (MM_INTERNAL_HEAP(heap))
+        {
+          mm_shrink_notify(heap);
+        }
 #endif
     }
 
@@ -351,6 +455,16 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
     }
 #endif
 
+#ifdef CONFIG_MM_SHRINKER
+  /* Try again after the caches gave memory back */
+
+  else if (MM_INTERNAL_HEAP(heap) && retries++ < MM_SHRINK_RETRIES &&
+           mm_shrink(alignsize) > 0)
+    {
+      goto retry;
+    }
+#endif
+
 #ifdef CONFIG_DEBUG_MM
   else if (MM_INTERNAL_HEAP(heap))
     {
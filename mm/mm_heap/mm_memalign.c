@@ -61,6 +61,9 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
   size_t mask;
   size_t allocsize;
   size_t newsize;
+#ifdef CONFIG_MM_HEAP_PROFILE
+  bool sampled;
+#endif
 
   /* Make sure that alignment is less than half max size_t */
 
@@ -157,6 +160,13 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
   node = (FAR struct mm_allocnode_s *)(rawchunk - MM_SIZEOF_ALLOCNODE);
   heap->mm_curused -= MM_SIZEOF_NODE(node);
 
+#ifdef CONFIG_MM_HEAP_PROFILE
+  /* The raw chunk is split below, move its sample to the aligned one */
+
+  sampled = (node->size & MM_SAMPLED_BIT) != 0;
+  MM_HEAPPROF_FREE(node);
+#endif
+
   /* Find the aligned subregion */
 
   alignedchunk = (rawchunk + mask) & ~mask;
@@ -209,16 +219,9 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
           FAR struct mm_freenode_s *prev =
             (FAR struct mm_freenode_s *)((FAR char *)node - node->preceding);
 
-          /* Remove the node.  There must be a predecessor, but there may
-           * not be a successor node.
-           */
+          /* Remove the node from its free list */
 
-          DEBUGASSERT(prev->blink);
-          prev->blink->flink = prev->flink;
-          if (prev->flink)
-            {
-              prev->flink->blink = prev->blink;
-            }
+          mm_delfreechunk(heap, prev);
 
           precedingsize += MM_SIZEOF_NODE(prev);
           node = (FAR struct mm_allocnode_s *)prev;
@@ -281,10 +284,25 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
   sched_note_heap(NOTE_HEAP_ALLOC, heap, (FAR void *)alignedchunk, size,
                   heap->mm_curused);
 
+#ifdef CONFIG_MM_HEAP_PROFILE
+  if (sampled)
+    {
+      node->size |= MM_SAMPLED_BIT;
+    }
+#endif
+
   mm_unlock(heap);
 
   MM_ADD_BACKTRACE(heap, node);
 
+#ifdef CONFIG_MM_HEAP_PROFILE
+  if (sampled)
+    {
+      mm_heapprof_alloc((FAR void *)alignedchunk,
+                        size - MM_ALLOCNODE_OVERHEAD);
+    }
+#endif
+
   alignedchunk = (uintptr_t)kasan_unpoison((FAR const void *)alignedchunk,
                                            size - MM_ALLOCNODE_OVERHEAD);
   DEBUGASSERT(alignedchunk % alignment == 0);
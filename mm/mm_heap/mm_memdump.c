@@ -192,13 +192,10 @@ static void memdump_handler(FAR struct mm_allocnode_s *node, FAR void *arg)
       FAR struct mm_freenode_s *fnode = (FAR void *)node;
 
       DEBUGASSERT(nodesize >= MM_MIN_CHUNK);
-      DEBUGASSERT(fnode->blink->flink == fnode);
-      DEBUGASSERT(MM_SIZEOF_NODE(fnode->blink) <= nodesize);
+      DEBUGASSERT(fnode->blink == NULL ||
+                  fnode->blink->flink == fnode);
       DEBUGASSERT(fnode->flink == NULL ||
                   fnode->flink->blink == fnode);
-      DEBUGASSERT(fnode->flink == NULL ||
-                  MM_SIZEOF_NODE(fnode->flink) == 0 ||
-                  MM_SIZEOF_NODE(fnode->flink) >= nodesize);
 
       priv->info.aordblks++;
       priv->info.uordblks += nodesize;
@@ -228,6 +225,9 @@ void mm_memdump(FAR struct mm_heap_s *heap,
 {
   struct mm_memdump_priv_s priv;
   pid_t pid = dump->pid;
+#ifdef CONFIG_MM_HEAP_ARENA
+  int cpu;
+#endif
 
   memset(&priv, 0, sizeof(struct mm_memdump_priv_s));
   priv.dump = dump;
@@ -298,6 +298,16 @@ void mm_memdump(FAR struct mm_heap_s *heap,
 
   mm_foreach(heap, memdump_handler, &priv);
 
+#ifdef CONFIG_MM_HEAP_ARENA
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      if (heap->mm_arena[cpu] != NULL)
+        {
+          mm_foreach(heap->mm_arena[cpu], memdump_handler, &priv);
+        }
+    }
+#endif
+
 #if CONFIG_MM_HEAP_BIGGEST_COUNT > 0
   if (pid == PID_MM_BIGGEST)
     {
@@ -76,6 +76,12 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
   size_t prevsize = 0;
   size_t nextsize = 0;
   FAR void *newmem;
+#ifdef CONFIG_MM_HEAP_PROFILE
+  bool sampled;
+#endif
+#ifdef CONFIG_MM_HEAP_ARENA
+  FAR struct mm_heap_s *arena;
+#endif
 
   /* If oldmem is NULL, then realloc is equivalent to malloc */
 
@@ -110,6 +116,14 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
     }
 #endif
 
+#ifdef CONFIG_MM_HEAP_ARENA
+  arena = mm_arena_owner(heap, oldmem);
+  if (arena != NULL)
+    {
+      return mm_arena_realloc(heap, arena, oldmem, size);
+    }
+#endif
+
   /* Adjust the size to account for (1) the size of the allocated node and
    * (2) to make sure that it is aligned with MM_ALIGN and its size is at
    * least MM_MIN_CHUNK.
@@ -139,6 +153,10 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
   DEBUGVERIFY(mm_lock(heap));
   DEBUGASSERT(MM_NODE_IS_ALLOC(oldnode));
 
+#ifdef CONFIG_MM_HEAP_PROFILE
+  sampled = (oldnode->size & MM_SAMPLED_BIT) != 0;
+#endif
+
   /* Check if this is a request to reduce the size of the allocation. */
 
   oldsize = MM_SIZEOF_NODE(oldnode);
@@ -161,6 +179,16 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
       mm_unlock(heap);
       MM_ADD_BACKTRACE(heap, oldnode);
 
+#ifdef CONFIG_MM_HEAP_PROFILE
+      if (sampled)
+        {
+          mm_heapprof_realloc(kasan_reset_tag(oldmem),
+                              kasan_reset_tag(oldmem),
+                              MM_SIZEOF_NODE(oldnode) -
+                              MM_ALLOCNODE_OVERHEAD);
+        }
+#endif
+
       return oldmem;
     }
 
@@ -252,16 +280,9 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
         {
           FAR struct mm_allocnode_s *newnode;
 
-          /* Remove the previous node.  There must be a predecessor, but
-           * there may not be a successor node.
-           */
+          /* Remove the previous node from its free list */
 
-          DEBUGASSERT(prev && prev->blink);
-          prev->blink->flink = prev->flink;
-          if (prev->flink)
-            {
-              prev->flink->blink = prev->blink;
-            }
+          mm_delfreechunk(heap, prev);
 
           /* Make sure the new previous node has enough space */
 
@@ -326,16 +347,9 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
           andbeyond = (FAR struct mm_allocnode_s *)
                       ((FAR char *)next + nextsize);
 
-          /* Remove the next node.  There must be a predecessor, but there
-           * may not be a successor node.
-           */
+          /* Remove the next node from its free list */
 
-          DEBUGASSERT(next->blink);
-          next->blink->flink = next->flink;
-          if (next->flink)
-            {
-              next->flink->blink = next->blink;
-            }
+          mm_delfreechunk(heap, next);
 
           /* Make sure the new next node has enough space */
 
@@ -387,9 +401,29 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
                       heap->mm_curused - newsize);
       sched_note_heap(NOTE_HEAP_ALLOC, heap, newmem, newsize,
                       heap->mm_curused);
+
+#ifdef CONFIG_MM_HEAP_PROFILE
+      /* The chunk may have moved down into the previous one */
+
+      if (sampled)
+        {
+          oldnode->size |= MM_SAMPLED_BIT;
+        }
+#endif
+
       mm_unlock(heap);
       MM_ADD_BACKTRACE(heap, (FAR char *)newmem - MM_SIZEOF_ALLOCNODE);
 
+#ifdef CONFIG_MM_HEAP_PROFILE
+      if (sampled)
+        {
+          mm_heapprof_realloc(kasan_reset_tag(oldmem),
+                              (FAR char *)oldnode + MM_SIZEOF_ALLOCNODE,
+                              MM_SIZEOF_NODE(oldnode) -
+                              MM_ALLOCNODE_OVERHEAD);
+        }
+#endif
+
       newmem = kasan_unpoison(newmem, MM_SIZEOF_NODE(oldnode) -
                               MM_ALLOCNODE_OVERHEAD);
       if (kasan_reset_tag(newmem) != kasan_reset_tag(oldmem))
@@ -0,0 +1,212 @@
+/****************************************************************************
+ * mm/shrinker/mm_shrinker.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* Memory pressure driven cache reclamation.
+ *
+ * Subsystems that keep memory around for speed register a shrinker.  When
+ * an allocation from the kernel heap fails, the heap asks the shrinkers,
+ * cheapest first, for the missing bytes and retries.  Optionally the caches
+ * are also shrunk in the background, on the low priority work queue, as
+ * soon as free memory drops below a low watermark.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+#include <debug.h>
+#include <sys/param.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/mutex.h>
+#include <nuttx/nuttx.h>
+#include <nuttx/wqueue.h>
+#include <nuttx/mm/mm.h>
+#include <nuttx/mm/shrinker.h>
+
+#if defined(CONFIG_MM_SHRINKER) && \
+    (defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__))
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#if CONFIG_MM_SHRINKER_LOWATER > 0 && !defined(CONFIG_SCHED_LPWORK)
+#  error CONFIG_MM_SHRINKER_LOWATER requires CONFIG_SCHED_LPWORK
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The registered shrinkers, by increasing cost.  The lock is held while
+ * the callbacks run, so that a shrinker cannot go away under them.
+ */
+
+static sq_queue_t g_shrinkers;
+static mutex_t g_shrinker_lock = NXMUTEX_INITIALIZER;
+
+#if CONFIG_MM_SHRINKER_LOWATER > 0
+static struct work_s g_shrinker_work;
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_shrink_worker
+ ****************************************************************************/
+
+#if CONFIG_MM_SHRINKER_LOWATER > 0
+static void mm_shrink_worker(FAR void *arg)
+{
+  FAR struct mm_heap_s *heap = arg;
+  size_t nfree = mm_heapfree(heap);
+
+  if (nfree < CONFIG_MM_SHRINKER_HIWATER)
+    {
+      mm_shrink(CONFIG_MM_SHRINKER_HIWATER - nfree);
+    }
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_register_shrinker
+ ****************************************************************************/
+
+void mm_register_shrinker(FAR struct mm_shrinker_s *shrinker)
+{
+  FAR sq_entry_t *prev = NULL;
+  FAR sq_entry_t *entry;
+
+  DEBUGASSERT(shrinker != NULL && shrinker->count != NULL &&
+              shrinker->scan != NULL);
+
+  nxmutex_lock(&g_shrinker_lock);
+
+  sq_for_every(&g_shrinkers, entry)
+    {
+      if (container_of(entry, struct mm_shrinker_s, entry)->cost >
+          shrinker->cost)
+        {
+          break;
+        }
+
+      prev = entry;
+    }
+
+  if (prev == NULL)
+    {
+      sq_addfirst(&shrinker->entry, &g_shrinkers);
+    }
+  else
+    {
+      sq_addafter(prev, &shrinker->entry, &g_shrinkers);
+    }
+
+  nxmutex_unlock(&g_shrinker_lock);
+}
+
+/****************************************************************************
+ * Name: mm_unregister_shrinker
+ ****************************************************************************/
+
+void mm_unregister_shrinker(FAR struct mm_shrinker_s *shrinker)
+{
+  nxmutex_lock(&g_shrinker_lock);
+  sq_rem(&shrinker->entry, &g_shrinkers);
+  nxmutex_unlock(&g_shrinker_lock);
+}
+
+/****************************************************************************
+ * Name: mm_shrink
+ ****************************************************************************/
+
+size_t mm_shrink(size_t nbytes)
+{
+  FAR struct mm_shrinker_s *shrinker;
+  FAR sq_entry_t *entry;
+  size_t freed = 0;
+  size_t avail;
+  size_t ret;
+
+  /* Shrinkers free memory, which needs the heap lock, and may sleep.
+   * Never wait for another reclamation: that thread may be waiting for a
+   * lock held by the caller.
+   */
+
+  if (up_interrupt_context() || nxmutex_trylock(&g_shrinker_lock) < 0)
+    {
+      return 0;
+    }
+
+  sq_for_every(&g_shrinkers, entry)
+    {
+      shrinker = container_of(entry, struct mm_shrinker_s, entry);
+
+      avail = shrinker->count(shrinker);
+      if (avail == 0)
+        {
+          continue;
+        }
+
+      ret = shrinker->scan(shrinker, MIN(avail, nbytes - freed));
+      shrinker->nscans++;
+      shrinker->nfreed += ret;
+      freed += ret;
+
+      minfo("%s: freed %zu of %zu\n", shrinker->name, ret, avail);
+
+      if (freed >= nbytes)
+        {
+          break;
+        }
+    }
+
+  nxmutex_unlock(&g_shrinker_lock);
+  return freed;
+}
+
+/****************************************************************************
+ * Name: mm_shrink_notify
+ ****************************************************************************/
+
+#if CONFIG_MM_SHRINKER_LOWATER > 0
+void mm_shrink_notify(FAR struct mm_heap_s *heap)
+{
+  if (mm_heapfree(heap) < CONFIG_MM_SHRINKER_LOWATER &&
+      work_available(&g_shrinker_work))
+    {
+      work_queue(LPWORK, &g_shrinker_work, mm_shrink_worker, heap, 0);
+    }
+}
+#endif
+
+#endif /* CONFIG_MM_SHRINKER && (CONFIG_BUILD_FLAT || __KERNEL__) */
@@ -42,6 +42,7 @@
 #include <nuttx/mm/mm.h>
 #include <nuttx/mm/kasan.h>
 #include <nuttx/mm/mempool.h>
+#include <nuttx/mm/shrinker.h>
 #include <nuttx/sched_note.h>
 
 #include "tlsf/tlsf.h"
@@ -1303,6 +1304,9 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 {
   size_t nodesize;
   FAR void *ret;
+#ifdef CONFIG_MM_SHRINKER
+  int retries = 0;
+#endif
 
   /* In case of zero-length allocations allocate the minimum size object */
 
@@ -1326,6 +1330,10 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 
   free_delaylist(heap, false);
 
+#ifdef CONFIG_MM_SHRINKER
+retry:
+#endif
+
   /* Allocate from the tlsf pool */
 
   DEBUGVERIFY(mm_lock(heap));
@@ -1363,6 +1371,12 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 
 #ifdef CONFIG_MM_FILL_ALLOCATIONS
       memset(ret, MM_ALLOC_MAGIC, nodesize);
+#endif
+#if CONFIG_MM_SHRINKER_LOWATER > 0
+      if (MM_INTERNAL_HEAP(heap))
+        {
+          mm_shrink_notify(heap);
+        }
 #endif
     }
 
@@ -1375,6 +1389,16 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
     }
 #endif
 
+#ifdef CONFIG_MM_SHRINKER
+  /* Try again after the caches gave memory back */
+
+  else if (MM_INTERNAL_HEAP(heap) && retries++ < MM_SHRINK_RETRIES &&
+           mm_shrink(size) > 0)
+    {
+      goto retry;
+    }
+#endif
+
   return ret;
 }
 
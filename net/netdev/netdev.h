@@ -32,6 +32,7 @@
 #include <sys/types.h>
 #include <stdbool.h>
 
+#include <nuttx/rcu.h>
 #include <nuttx/net/ip.h>
 #include <nuttx/net/netdev.h>
 
@@ -39,6 +40,24 @@
 #  include <nuttx/wqueue.h>
 #endif
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Lookups that only walk g_netdevices do not need the network lock when
+ * RCU is available:  Devices are linked and unlinked with
+ * rcu_assign_pointer() and netdev_unregister() waits for a grace period
+ * before the device may be reused.
+ */
+
+#ifdef CONFIG_RCU
+#  define netdev_list_lock()    rcu_read_lock()
+#  define netdev_list_unlock()  rcu_read_unlock()
+#else
+#  define netdev_list_lock()    net_lock()
+#  define netdev_list_unlock()  net_unlock()
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -53,7 +72,8 @@ extern "C"
 #endif
 
 /* List of registered Ethernet device drivers.  You must have the network
- * locked in order to access this list.
+ * locked in order to modify this list, or to access it other than through
+ * netdev_list_lock().
  *
  * NOTE that this duplicates a declaration in net/tcp/tcp.h
  */
@@ -63,8 +63,9 @@ FAR struct net_driver_s *netdev_default(void)
 
   /* Examine each registered network device */
 
-  net_lock();
-  for (dev = g_netdevices; dev; dev = dev->flink)
+  netdev_list_lock();
+  for (dev = rcu_dereference(g_netdevices); dev;
+       dev = rcu_dereference(dev->flink))
     {
       /* Is the interface in the "up" state? */
 
@@ -84,6 +85,6 @@ FAR struct net_driver_s *netdev_default(void)
         }
     }
 
-  net_unlock();
+  netdev_list_unlock();
   return ret;
 }
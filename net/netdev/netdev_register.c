@@ -462,9 +462,10 @@ int netdev_register(FAR struct net_driver_s *dev, enum net_lltype_e lltype)
           last = &((*last)->flink);
         }
 
-      *last = dev;
+      /* Lockless readers may follow the new link at once */
 
       dev->flink = NULL;
+      rcu_assign_pointer(*last, dev);
 
 #ifdef CONFIG_NET_IGMP
       /* Configure the device for IGMP support */
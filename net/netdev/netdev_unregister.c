@@ -135,16 +135,18 @@ int netdev_unregister(FAR struct net_driver_s *dev)
             {
               /* The entry was in the middle or at the end of the list */
 
-              prev->flink = curr->flink;
+              rcu_assign_pointer(prev->flink, curr->flink);
             }
           else
             {
               /* The entry was at the beginning of the list */
 
-              g_netdevices = curr->flink;
+              rcu_assign_pointer(g_netdevices, curr->flink);
             }
 
+#ifndef CONFIG_RCU
           curr->flink = NULL;
+#endif
         }
 
 #ifdef CONFIG_NETDEV_IFINDEX
@@ -152,6 +154,18 @@ int netdev_unregister(FAR struct net_driver_s *dev)
 #endif
       net_unlock();
 
+#ifdef CONFIG_RCU
+      /* Lockless readers may still be walking through the device.  Its
+       * link can only be cleared once they have all finished.
+       */
+
+      synchronize_rcu();
+      if (curr)
+        {
+          curr->flink = NULL;
+        }
+#endif
+
 #if CONFIG_NETDEV_STATISTICS_LOG_PERIOD > 0
       work_cancel_sync(NETDEV_STATISTICS_WORK, &dev->d_statistics.logwork);
 #endif
@@ -58,6 +58,7 @@
 
 #include <nuttx/clock.h>
 #include <nuttx/kmalloc.h>
+#include <nuttx/mm/kmem_cache.h>
 #include <nuttx/net/netconfig.h>
 #include <nuttx/net/net.h>
 #include <nuttx/net/netdev.h>
@@ -73,6 +74,24 @@
 #include "netdev/netdev.h"
 #include "utils/utils.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Allocate TCP connections past the preallocated ones from a kmem cache */
+
+#if defined(CONFIG_MM_KMEM_CACHE) && CONFIG_NET_TCP_ALLOC_CONNS > 0
+#  define TCP_CONN_CACHE
+#endif
+
+#if CONFIG_NET_TCP_PREALLOC_CONNS > 0
+#  define TCP_CONN_PREALLOCATED(c) \
+     ((c) >= g_tcp_connections && \
+      (c) < g_tcp_connections + CONFIG_NET_TCP_PREALLOC_CONNS)
+#else
+#  define TCP_CONN_PREALLOCATED(c) false
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -91,6 +110,10 @@ static dq_queue_t g_free_tcp_connections;
 
 static dq_queue_t g_active_tcp_connections;
 
+#ifdef TCP_CONN_CACHE
+static FAR struct kmem_cache_s *g_tcp_conn_cache;
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -497,6 +520,22 @@ static inline int tcp_ipv6_bind(FAR struct tcp_conn_s *conn,
 }
 #endif /* CONFIG_NET_IPv6 */
 
+/****************************************************************************
+ * Name: tcp_conn_ctor
+ *
+ * Description:
+ *   Construct a connection of the cache.  Free connections of the cache
+ *   are kept zeroed, see tcp_free(), so tcp_alloc() need not clear them.
+ *
+ ****************************************************************************/
+
+#ifdef TCP_CONN_CACHE
+static void tcp_conn_ctor(FAR void *obj)
+{
+  memset(obj, 0, sizeof(struct tcp_conn_s));
+}
+#endif
+
 /****************************************************************************
  * Name: tcp_alloc_conn
  *
@@ -505,7 +544,19 @@ static inline int tcp_ipv6_bind(FAR struct tcp_conn_s *conn,
  *
  ****************************************************************************/
 
-#if CONFIG_NET_TCP_ALLOC_CONNS > 0
+#ifdef TCP_CONN_CACHE
+static FAR struct tcp_conn_s *tcp_alloc_conn(void)
+{
+#if CONFIG_NET_TCP_MAX_CONNS > 0
+  if (dq_count(&g_active_tcp_connections) >= CONFIG_NET_TCP_MAX_CONNS)
+    {
+      return NULL;
+    }
+#endif
+
+  return kmem_cache_alloc(g_tcp_conn_cache);
+}
+#elif CONFIG_NET_TCP_ALLOC_CONNS > 0
 static FAR struct tcp_conn_s *tcp_alloc_conn(void)
 {
   FAR struct tcp_conn_s *conn;
@@ -661,6 +712,12 @@ void tcp_initialize(void)
       dq_addlast(&g_tcp_connections[i].sconn.node, &g_free_tcp_connections);
     }
 #endif
+
+#ifdef TCP_CONN_CACHE
+  g_tcp_conn_cache = kmem_cache_create("tcp", sizeof(struct tcp_conn_s),
+                                       0, tcp_conn_ctor);
+  DEBUGASSERT(g_tcp_conn_cache != NULL);
+#endif
 }
 
 /****************************************************************************
@@ -781,7 +838,15 @@ FAR struct tcp_conn_s *tcp_alloc(uint8_t domain)
 
   if (conn)
     {
-      memset(conn, 0, sizeof(struct tcp_conn_s));
+#ifdef TCP_CONN_CACHE
+      /* Connections of the cache are already zeroed */
+
+      if (TCP_CONN_PREALLOCATED(conn))
+#endif
+        {
+          memset(conn, 0, sizeof(struct tcp_conn_s));
+        }
+
       conn->sconn.s_ttl   = IP_TTL_DEFAULT;
       conn->tcpstateflags = TCP_ALLOCATED;
 #if defined(CONFIG_NET_IPv4) && defined(CONFIG_NET_IPv6)
@@ -976,7 +1041,14 @@ void tcp_free(FAR struct tcp_conn_s *conn)
    * the free connections list. Else free it.
    */
 
-#if CONFIG_NET_TCP_ALLOC_CONNS == 1
+#ifdef TCP_CONN_CACHE
+  if (!TCP_CONN_PREALLOCATED(conn))
+    {
+      memset(conn, 0, sizeof(*conn));
+      kmem_cache_free(g_tcp_conn_cache, conn);
+    }
+  else
+#elif CONFIG_NET_TCP_ALLOC_CONNS == 1
   if (conn < g_tcp_connections || conn >= (g_tcp_connections +
       CONFIG_NET_TCP_PREALLOC_CONNS))
     {
@@ -59,6 +59,7 @@
 #include <nuttx/clock.h>
 #include <nuttx/kmalloc.h>
 #include <nuttx/mutex.h>
+#include <nuttx/mm/kmem_cache.h>
 #include <nuttx/net/netconfig.h>
 #include <nuttx/net/net.h>
 #include <nuttx/net/netdev.h>
@@ -74,6 +75,24 @@
 #include "udp/udp.h"
 #include "utils/utils.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Allocate UDP connections past the preallocated ones from a kmem cache */
+
+#if defined(CONFIG_MM_KMEM_CACHE) && CONFIG_NET_UDP_ALLOC_CONNS > 0
+#  define UDP_CONN_CACHE
+#endif
+
+#if CONFIG_NET_UDP_PREALLOC_CONNS > 0
+#  define UDP_CONN_PREALLOCATED(c) \
+     ((c) >= g_udp_connections && \
+      (c) < g_udp_connections + CONFIG_NET_UDP_PREALLOC_CONNS)
+#else
+#  define UDP_CONN_PREALLOCATED(c) false
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -93,6 +112,10 @@ static mutex_t g_free_lock = NXMUTEX_INITIALIZER;
 
 static dq_queue_t g_active_udp_connections;
 
+#ifdef UDP_CONN_CACHE
+static FAR struct kmem_cache_s *g_udp_conn_cache;
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -460,6 +483,22 @@ udp_ipv6_active(FAR struct net_driver_s *dev, FAR struct udp_conn_s *conn,
 }
 #endif /* CONFIG_NET_IPv6 */
 
+/****************************************************************************
+ * Name: udp_conn_ctor
+ *
+ * Description:
+ *   Construct a connection of the cache.  Free connections are kept
+ *   zeroed, see udp_free().
+ *
+ ****************************************************************************/
+
+#ifdef UDP_CONN_CACHE
+static void udp_conn_ctor(FAR void *obj)
+{
+  memset(obj, 0, sizeof(struct udp_conn_s));
+}
+#endif
+
 /****************************************************************************
  * Name: udp_alloc_conn
  *
@@ -468,7 +507,19 @@ udp_ipv6_active(FAR struct net_driver_s *dev, FAR struct udp_conn_s *conn,
  *
  ****************************************************************************/
 
-#if CONFIG_NET_UDP_ALLOC_CONNS > 0
+#ifdef UDP_CONN_CACHE
+static FAR struct udp_conn_s *udp_alloc_conn(void)
+{
+#if CONFIG_NET_UDP_MAX_CONNS > 0
+  if (dq_count(&g_active_udp_connections) >= CONFIG_NET_UDP_MAX_CONNS)
+    {
+      return NULL;
+    }
+#endif
+
+  return kmem_cache_alloc(g_udp_conn_cache);
+}
+#elif CONFIG_NET_UDP_ALLOC_CONNS > 0
 static FAR struct udp_conn_s *udp_alloc_conn(void)
 {
   FAR struct udp_conn_s *conn;
@@ -604,6 +655,12 @@ void udp_initialize(void)
       dq_addlast(&g_udp_connections[i].sconn.node, &g_free_udp_connections);
     }
 #endif
+
+#ifdef UDP_CONN_CACHE
+  g_udp_conn_cache = kmem_cache_create("udp", sizeof(struct udp_conn_s),
+                                       0, udp_conn_ctor);
+  DEBUGASSERT(g_udp_conn_cache != NULL);
+#endif
 }
 
 /****************************************************************************
@@ -717,7 +774,14 @@ void udp_free(FAR struct udp_conn_s *conn)
    * the free connections list. Else free it.
    */
 
-#if CONFIG_NET_UDP_ALLOC_CONNS == 1
+#ifdef UDP_CONN_CACHE
+  if (!UDP_CONN_PREALLOCATED(conn))
+    {
+      memset(conn, 0, sizeof(*conn));
+      kmem_cache_free(g_udp_conn_cache, conn);
+    }
+  else
+#elif CONFIG_NET_UDP_ALLOC_CONNS == 1
   if (conn < g_udp_connections || conn >= (g_udp_connections +
       CONFIG_NET_UDP_PREALLOC_CONNS))
     {
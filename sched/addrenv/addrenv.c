@@ -27,6 +27,7 @@
 #include <nuttx/config.h>
 
 #include <assert.h>
+#include <errno.h>
 #include <debug.h>
 
 #include <nuttx/addrenv.h>
@@ -300,6 +301,50 @@ int addrenv_join(FAR struct tcb_s *ptcb, FAR struct tcb_s *tcb)
   return OK;
 }
 
+/****************************************************************************
+ * Name: addrenv_fork
+ *
+ * Description:
+ *   Move a child created by fork() from the address environment it joined
+ *   to a copy-on-write duplicate of that address environment.
+ *
+ * Input Parameters:
+ *   tcb  - The tcb of the child process
+ *
+ * Returned Value:
+ *   This is a NuttX internal function so it follows the convention that
+ *   0 (OK) is returned on success and a negated errno is returned on
+ *   failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_ARCH_ADDRENV_COW
+int addrenv_fork(FAR struct tcb_s *tcb)
+{
+  FAR struct addrenv_s *addrenv;
+  int ret;
+
+  addrenv = addrenv_allocate();
+  if (addrenv == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  ret = up_addrenv_fork(&tcb->addrenv_own->addrenv, &addrenv->addrenv);
+  if (ret < 0)
+    {
+      berr("ERROR: up_addrenv_fork failed: %d\n", ret);
+      kmm_free(addrenv);
+      return ret;
+    }
+
+  /* Drop the shared address environment and take the duplicate */
+
+  addrenv_leave(tcb);
+  return addrenv_attach(tcb, addrenv);
+}
+#endif
+
 /****************************************************************************
  * Name: addrenv_leave
  *
@@ -77,7 +77,8 @@ int clock_systime_timespec(FAR struct timespec *ts)
       ts->tv_sec = 0;
       ts->tv_nsec = 0;
     }
-#elif defined(CONFIG_SCHED_TICKLESS_TICK_ARGUMENT)
+#elif defined(CONFIG_SCHED_TICKLESS_TICK_ARGUMENT) && \
+      !defined(CONFIG_HRTIMER)
   clock_t ticks = 0;
 
   up_timer_gettick(&ticks);
@@ -0,0 +1,741 @@
+/****************************************************************************
+ * sched/futex/futex.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <limits.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/param.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/atomic.h>
+#include <nuttx/clock.h>
+#include <nuttx/futex.h>
+#include <nuttx/nuttx.h>
+#include <nuttx/queue.h>
+#include <nuttx/sched.h>
+#include <nuttx/semaphore.h>
+#include <nuttx/spinlock.h>
+
+#if defined(CONFIG_ARCH_ADDRENV) && defined(CONFIG_MM_KMAP)
+#  include <nuttx/addrenv.h>
+#  include <nuttx/pgalloc.h>
+#endif
+
+#include "sched/sched.h"
+
+#ifdef CONFIG_FUTEX
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Multiplicative hash of the futex key onto the wait table */
+
+#define FUTEX_HASH(k) \
+  ((((uintptr_t)(k)->mm ^ (k)->addr) >> 2) * 2654435761u % \
+   CONFIG_FUTEX_NHASH)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* A futex is identified by (mm, addr).  Private futexes use the task group
+ * and the virtual address; shared futexes use a NULL mm and the physical
+ * address where it can be determined.
+ */
+
+struct futex_key_s
+{
+  FAR void *mm;
+  uintptr_t addr;
+};
+
+/* One hash bucket of the wait table */
+
+struct futex_bucket_s
+{
+  spinlock_t lock;                    /* Protects the waiter list */
+  dq_queue_t waiters;                 /* Queue of struct futex_waiter_s */
+};
+
+/* A blocked thread.  This lives on the waiter's (kernel) stack and is only
+ * referenced through the bucket while the thread is queued.
+ */
+
+struct futex_waiter_s
+{
+  dq_entry_t node;                    /* Link in bucket->waiters */
+  struct futex_key_s key;             /* The futex we are waiting on */
+  FAR struct futex_bucket_s *bucket;  /* Bucket we are queued on or NULL */
+  uint32_t bitset;                    /* FUTEX_WAIT_BITSET mask */
+  sem_t sem;                          /* Posted when woken */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct futex_bucket_s g_futex_table[CONFIG_FUTEX_NHASH];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: futex_get_key
+ *
+ * Description:
+ *   Resolve a user address to the key that identifies the futex.
+ *
+ ****************************************************************************/
+
+static int futex_get_key(FAR uint32_t *uaddr, int op,
+                         FAR struct futex_key_s *key)
+{
+  FAR struct tcb_s *rtcb = this_task();
+  uintptr_t va = (uintptr_t)uaddr;
+
+  if (uaddr == NULL || (va & (sizeof(uint32_t) - 1)) != 0)
+    {
+      return -EINVAL;
+    }
+
+  if ((op & FUTEX_PRIVATE_FLAG) != 0)
+    {
+      key->mm   = rtcb->group;
+      key->addr = va;
+      return OK;
+    }
+
+  key->mm   = NULL;
+  key->addr = va;
+
+#if defined(CONFIG_ARCH_ADDRENV) && defined(CONFIG_MM_KMAP)
+  /* Processes may map a shared page at different virtual addresses, so
+   * use the physical page to find the other side.
+   */
+
+  if (rtcb->addrenv_curr != NULL)
+    {
+      uintptr_t page;
+
+      page = up_addrenv_find_page(&rtcb->addrenv_curr->addrenv,
+                                  va & ~MM_PGMASK);
+      if (page == 0)
+        {
+          return -EFAULT;
+        }
+
+      key->addr = page | (va & MM_PGMASK);
+    }
+#endif
+
+  return OK;
+}
+
+static inline bool futex_match(FAR const struct futex_key_s *k1,
+                               FAR const struct futex_key_s *k2)
+{
+  return k1->mm == k2->mm && k1->addr == k2->addr;
+}
+
+static inline FAR struct futex_bucket_s *
+futex_bucket(FAR const struct futex_key_s *key)
+{
+  return &g_futex_table[FUTEX_HASH(key)];
+}
+
+/****************************************************************************
+ * Name: futex_lock_pair / futex_unlock_pair
+ *
+ * Description:
+ *   Lock two buckets in a consistent (address) order for requeue.
+ *
+ ****************************************************************************/
+
+static irqstate_t futex_lock_pair(FAR struct futex_bucket_s *b1,
+                                  FAR struct futex_bucket_s *b2)
+{
+  irqstate_t flags;
+
+  if (b1 > b2)
+    {
+      FAR struct futex_bucket_s *tmp = b1;
+      b1 = b2;
+      b2 = tmp;
+    }
+
+  flags = spin_lock_irqsave(&b1->lock);
+  if (b1 != b2)
+    {
+      spin_lock(&b2->lock);
+    }
+
+  return flags;
+}
+
+static void futex_unlock_pair(FAR struct futex_bucket_s *b1,
+                              FAR struct futex_bucket_s *b2,
+                              irqstate_t flags)
+{
+  if (b1 != b2)
+    {
+      spin_unlock(&b2->lock);
+    }
+
+  spin_unlock_irqrestore(&b1->lock, flags);
+}
+
+/****************************************************************************
+ * Name: futex_wake_waiter
+ *
+ * Description:
+ *   Dequeue and wake one waiter.  Called with the bucket locked and the
+ *   scheduler locked, so that the woken thread can not run (and release
+ *   its stack) before the post completes.
+ *
+ ****************************************************************************/
+
+static void futex_wake_waiter(FAR struct futex_bucket_s *bucket,
+                              FAR struct futex_waiter_s *waiter)
+{
+  dq_rem(&waiter->node, &bucket->waiters);
+  nxsem_post(&waiter->sem);
+
+  /* Clear the bucket last: a waiter that timed out concurrently treats a
+   * NULL bucket as "woken" and may release the semaphore immediately.
+   */
+
+  waiter->bucket = NULL;
+}
+
+/****************************************************************************
+ * Name: futex_wake_locked
+ *
+ * Description:
+ *   Wake up to nwake waiters of key whose bitset intersects bitset.
+ *
+ ****************************************************************************/
+
+static int futex_wake_locked(FAR struct futex_bucket_s *bucket,
+                             FAR const struct futex_key_s *key,
+                             int nwake, uint32_t bitset)
+{
+  FAR dq_entry_t *curr;
+  FAR dq_entry_t *next;
+  int nwoken = 0;
+
+  for (curr = dq_peek(&bucket->waiters);
+       curr != NULL && nwoken < nwake;
+       curr = next)
+    {
+      FAR struct futex_waiter_s *waiter =
+        container_of(curr, struct futex_waiter_s, node);
+
+      next = dq_next(curr);
+      if (futex_match(&waiter->key, key) &&
+          (waiter->bitset & bitset) != 0)
+        {
+          futex_wake_waiter(bucket, waiter);
+          nwoken++;
+        }
+    }
+
+  return nwoken;
+}
+
+/****************************************************************************
+ * Name: futex_wait
+ ****************************************************************************/
+
+static int futex_wait(FAR uint32_t *uaddr, int op, uint32_t val,
+                      FAR const struct timespec *timeout, uint32_t bitset)
+{
+  FAR struct futex_bucket_s *bucket;
+  struct futex_waiter_s waiter;
+  struct timespec ts;
+  irqstate_t flags;
+  int ret;
+
+  if (bitset == 0)
+    {
+      return -EINVAL;
+    }
+
+  ret = futex_get_key(uaddr, op, &waiter.key);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  /* Copy the timeout out of user memory before we queue anything */
+
+  if (timeout != NULL)
+    {
+      ts = *timeout;
+      if (ts.tv_sec < 0 || ts.tv_nsec < 0 || ts.tv_nsec >= NSEC_PER_SEC)
+        {
+          return -EINVAL;
+        }
+    }
+
+  nxsem_init(&waiter.sem, 0, 0);
+  waiter.bitset = bitset;
+  bucket = futex_bucket(&waiter.key);
+
+  /* Check the futex word and queue ourselves atomically with respect to
+   * the wakers; a waker that changes the word after this point will find
+   * us on the queue.
+   */
+
+  flags = spin_lock_irqsave(&bucket->lock);
+
+  if (atomic_load((FAR atomic_uint *)uaddr) != val)
+    {
+      spin_unlock_irqrestore(&bucket->lock, flags);
+      nxsem_destroy(&waiter.sem);
+      return -EAGAIN;
+    }
+
+  waiter.bucket = bucket;
+  dq_addlast(&waiter.node, &bucket->waiters);
+  spin_unlock_irqrestore(&bucket->lock, flags);
+
+  if (timeout == NULL)
+    {
+      ret = nxsem_wait(&waiter.sem);
+    }
+  else if ((op & FUTEX_CMD_MASK) == FUTEX_WAIT)
+    {
+      clock_t ticks = clock_time2ticks(&ts);
+
+      ret = nxsem_tickwait(&waiter.sem, ticks >= UINT32_MAX ?
+                                        UINT32_MAX - 1 : (uint32_t)ticks);
+    }
+  else
+    {
+      ret = nxsem_clockwait(&waiter.sem,
+                            (op & FUTEX_CLOCK_REALTIME) != 0 ?
+                            CLOCK_REALTIME : CLOCK_MONOTONIC, &ts);
+    }
+
+  if (ret < 0)
+    {
+      /* Timed out or interrupted.  If we were woken (or requeued and then
+       * woken) in the meantime, the wakeup wins.  A requeue may move us to
+       * another bucket, so re-check the bucket after locking it.
+       */
+
+      for (; ; )
+        {
+          bucket = waiter.bucket;
+          if (bucket == NULL)
+            {
+              ret = OK;
+              break;
+            }
+
+          flags = spin_lock_irqsave(&bucket->lock);
+          if (waiter.bucket == bucket)
+            {
+              dq_rem(&waiter.node, &bucket->waiters);
+              waiter.bucket = NULL;
+              spin_unlock_irqrestore(&bucket->lock, flags);
+              break;
+            }
+
+          spin_unlock_irqrestore(&bucket->lock, flags);
+        }
+    }
+
+  nxsem_destroy(&waiter.sem);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: futex_wake
+ ****************************************************************************/
+
+static int futex_wake(FAR uint32_t *uaddr, int op, int nwake,
+                      uint32_t bitset)
+{
+  FAR struct futex_bucket_s *bucket;
+  struct futex_key_s key;
+  irqstate_t flags;
+  int ret;
+
+  if (bitset == 0)
+    {
+      return -EINVAL;
+    }
+
+  ret = futex_get_key(uaddr, op, &key);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  bucket = futex_bucket(&key);
+
+  sched_lock();
+  flags = spin_lock_irqsave(&bucket->lock);
+  ret = futex_wake_locked(bucket, &key, nwake, bitset);
+  spin_unlock_irqrestore(&bucket->lock, flags);
+  sched_unlock();
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: futex_requeue
+ *
+ * Description:
+ *   Wake up to nwake waiters on uaddr and move up to nrequeue of the
+ *   remaining ones to uaddr2 without waking them.  This lets a condition
+ *   variable broadcast hand the waiters to the mutex one at a time instead
+ *   of waking them all just to contend on the mutex.
+ *
+ ****************************************************************************/
+
+static int futex_requeue(FAR uint32_t *uaddr, int op, int nwake,
+                         int nrequeue, FAR uint32_t *uaddr2,
+                         FAR const uint32_t *cmpval)
+{
+  FAR struct futex_bucket_s *bucket1;
+  FAR struct futex_bucket_s *bucket2;
+  FAR dq_entry_t *curr;
+  FAR dq_entry_t *next;
+  struct futex_key_s key1;
+  struct futex_key_s key2;
+  irqstate_t flags;
+  int nwoken = 0;
+  int nmoved = 0;
+  int ret;
+
+  if (nwake < 0 || nrequeue < 0)
+    {
+      return -EINVAL;
+    }
+
+  ret = futex_get_key(uaddr, op, &key1);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ret = futex_get_key(uaddr2, op, &key2);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  bucket1 = futex_bucket(&key1);
+  bucket2 = futex_bucket(&key2);
+
+  sched_lock();
+  flags = futex_lock_pair(bucket1, bucket2);
+
+  if (cmpval != NULL &&
+      atomic_load((FAR atomic_uint *)uaddr) != *cmpval)
+    {
+      ret = -EAGAIN;
+      goto out;
+    }
+
+  for (curr = dq_peek(&bucket1->waiters); curr != NULL; curr = next)
+    {
+      FAR struct futex_waiter_s *waiter =
+        container_of(curr, struct futex_waiter_s, node);
+
+      next = dq_next(curr);
+      if (!futex_match(&waiter->key, &key1))
+        {
+          continue;
+        }
+
+      if (nwoken < nwake)
+        {
+          futex_wake_waiter(bucket1, waiter);
+          nwoken++;
+        }
+      else if (nmoved < nrequeue)
+        {
+          dq_rem(&waiter->node, &bucket1->waiters);
+          waiter->key    = key2;
+          waiter->bucket = bucket2;
+          dq_addlast(&waiter->node, &bucket2->waiters);
+          nmoved++;
+        }
+      else
+        {
+          break;
+        }
+    }
+
+  ret = nwoken + nmoved;
+
+out:
+  futex_unlock_pair(bucket1, bucket2, flags);
+  sched_unlock();
+  return ret;
+}
+
+/****************************************************************************
+ * Name: futex_atomic_op
+ *
+ * Description:
+ *   Apply the FUTEX_WAKE_OP operation to *uaddr and return the old value.
+ *
+ ****************************************************************************/
+
+static int futex_atomic_op(FAR uint32_t *uaddr, uint32_t encoded,
+                           FAR uint32_t *oldval)
+{
+  int op = (encoded >> 28) & 0xf;
+  int32_t sarg = (int32_t)(encoded << 8) >> 20; /* Signed 12-bit oparg */
+  uint32_t oparg;
+  uint32_t oval;
+  uint32_t nval;
+
+  if ((op & FUTEX_OP_OPARG_SHIFT) != 0)
+    {
+      if (sarg < 0 || sarg > 31)
+        {
+          return -EINVAL;
+        }
+
+      oparg = 1u << sarg;
+      op &= ~FUTEX_OP_OPARG_SHIFT;
+    }
+  else
+    {
+      oparg = (uint32_t)sarg;
+    }
+
+  oval = atomic_load((FAR atomic_uint *)uaddr);
+  do
+    {
+      switch (op)
+        {
+          case FUTEX_OP_SET:
+            nval = oparg;
+            break;
+
+          case FUTEX_OP_ADD:
+            nval = oval + oparg;
+            break;
+
+          case FUTEX_OP_OR:
+            nval = oval | oparg;
+            break;
+
+          case FUTEX_OP_ANDN:
+            nval = oval & ~oparg;
+            break;
+
+          case FUTEX_OP_XOR:
+            nval = oval ^ oparg;
+            break;
+
+          default:
+            return -ENOSYS;
+        }
+    }
+  while (!atomic_compare_exchange_weak((FAR atomic_uint *)uaddr,
+                                       (FAR unsigned int *)&oval, nval));
+
+  *oldval = oval;
+  return OK;
+}
+
+static bool futex_atomic_cmp(uint32_t encoded, uint32_t oldval)
+{
+  int cmp = (encoded >> 24) & 0xf;
+  int32_t cmparg = (int32_t)(encoded << 20) >> 20; /* Signed 12 bits */
+  int32_t val = (int32_t)oldval;
+
+  switch (cmp)
+    {
+      case FUTEX_OP_CMP_EQ:
+        return val == cmparg;
+
+      case FUTEX_OP_CMP_NE:
+        return val != cmparg;
+
+      case FUTEX_OP_CMP_LT:
+        return val < cmparg;
+
+      case FUTEX_OP_CMP_LE:
+        return val <= cmparg;
+
+      case FUTEX_OP_CMP_GT:
+        return val > cmparg;
+
+      case FUTEX_OP_CMP_GE:
+        return val >= cmparg;
+
+      default:
+        return false;
+    }
+}
+
+/****************************************************************************
+ * Name: futex_wake_op
+ *
+ * Description:
+ *   Atomically modify *uaddr2, wake up to nwake waiters on uaddr and, if
+ *   the old value of *uaddr2 satisfies the comparison, up to nwake2
+ *   waiters on uaddr2.
+ *
+ ****************************************************************************/
+
+static int futex_wake_op(FAR uint32_t *uaddr, int op, int nwake,
+                         int nwake2, FAR uint32_t *uaddr2, uint32_t val3)
+{
+  FAR struct futex_bucket_s *bucket1;
+  FAR struct futex_bucket_s *bucket2;
+  struct futex_key_s key1;
+  struct futex_key_s key2;
+  irqstate_t flags;
+  uint32_t oldval;
+  int ret;
+
+  ret = futex_get_key(uaddr, op, &key1);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ret = futex_get_key(uaddr2, op, &key2);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  bucket1 = futex_bucket(&key1);
+  bucket2 = futex_bucket(&key2);
+
+  sched_lock();
+  flags = futex_lock_pair(bucket1, bucket2);
+
+  ret = futex_atomic_op(uaddr2, val3, &oldval);
+  if (ret >= 0)
+    {
+      ret = futex_wake_locked(bucket1, &key1, nwake,
+                              FUTEX_BITSET_MATCH_ANY);
+      if (futex_atomic_cmp(val3, oldval))
+        {
+          ret += futex_wake_locked(bucket2, &key2, nwake2,
+                                   FUTEX_BITSET_MATCH_ANY);
+        }
+    }
+
+  futex_unlock_pair(bucket1, bucket2, flags);
+  sched_unlock();
+  return ret;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: futex
+ *
+ * Description:
+ *   See include/nuttx/futex.h
+ *
+ ****************************************************************************/
+
+int futex(FAR uint32_t *uaddr, int op, uint32_t val,
+          FAR const struct timespec *timeout, FAR uint32_t *uaddr2,
+          uint32_t val3)
+{
+  /* The requeue and wake-op operations pass a second count in place of
+   * the timeout, as Linux does.
+   */
+
+  int val2 = (int)(uintptr_t)timeout;
+  int ret;
+
+  switch (op & FUTEX_CMD_MASK)
+    {
+      case FUTEX_WAIT:
+        if ((op & FUTEX_CLOCK_REALTIME) != 0)
+          {
+            ret = -ENOSYS;
+            break;
+          }
+
+        ret = futex_wait(uaddr, op, val, timeout, FUTEX_BITSET_MATCH_ANY);
+        break;
+
+      case FUTEX_WAIT_BITSET:
+        ret = futex_wait(uaddr, op, val, timeout, val3);
+        break;
+
+      case FUTEX_WAKE:
+        ret = futex_wake(uaddr, op, (int)MIN(val, INT_MAX),
+                         FUTEX_BITSET_MATCH_ANY);
+        break;
+
+      case FUTEX_WAKE_BITSET:
+        ret = futex_wake(uaddr, op, (int)MIN(val, INT_MAX), val3);
+        break;
+
+      case FUTEX_REQUEUE:
+        ret = futex_requeue(uaddr, op, (int)MIN(val, INT_MAX), val2,
+                            uaddr2, NULL);
+        break;
+
+      case FUTEX_CMP_REQUEUE:
+        ret = futex_requeue(uaddr, op, (int)MIN(val, INT_MAX), val2,
+                            uaddr2, &val3);
+        break;
+
+      case FUTEX_WAKE_OP:
+        ret = futex_wake_op(uaddr, op, (int)MIN(val, INT_MAX), val2,
+                            uaddr2, val3);
+        break;
+
+      default:
+        ret = -ENOSYS;
+        break;
+    }
+
+  if (ret < 0)
+    {
+      set_errno(-ret);
+      ret = ERROR;
+    }
+
+  return ret;
+}
+
+#endif /* CONFIG_FUTEX */
@@ -250,7 +250,7 @@ void group_drop(FAR struct task_group_s *group)
 
       if (tcb->cmn.flags & TCB_FLAG_FREE_TCB)
         {
-          kmm_free(tcb);
+          nxsched_free_tcb(&tcb->cmn);
         }
     }
 }
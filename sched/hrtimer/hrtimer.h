@@ -0,0 +1,118 @@
+/****************************************************************************
+ * sched/hrtimer/hrtimer.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+
+#ifndef __SCHED_HRTIMER_HRTIMER_H
+#define __SCHED_HRTIMER_HRTIMER_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+
+#include <nuttx/hrtimer.h>
+#include <nuttx/list.h>
+#include <nuttx/spinlock.h>
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* The timer whose callback a CPU is running, if any.  'cancelled' is set
+ * by hrtimer_cancel() so that the callback's reload request is ignored.
+ */
+
+struct hrtimer_running_s
+{
+  FAR struct hrtimer_s *timer;
+  bool cancelled;
+};
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/* The list of active high resolution timers ordered by expiration time
+ * and the lock that protects it.
+ */
+
+extern struct list_node g_hrtimer_list;
+extern spinlock_t g_hrtimer_lock;
+
+/* The callbacks being run by each CPU, protected by g_hrtimer_lock */
+
+extern struct hrtimer_running_s g_hrtimer_running[CONFIG_SMP_NCPUS];
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: hrtimer_insert
+ *
+ * Description:
+ *   Insert the timer into g_hrtimer_list according to timer->expired.
+ *   Timers with the same expiration time expire in the order in which
+ *   they were started.
+ *
+ * Returned Value:
+ *   True if the timer became the head of the list and the timer hardware
+ *   has to be reprogrammed.
+ *
+ * Assumptions:
+ *   g_hrtimer_lock is held.
+ *
+ ****************************************************************************/
+
+bool hrtimer_insert(FAR struct hrtimer_s *timer);
+
+/****************************************************************************
+ * Name: hrtimer_reprogram
+ *
+ * Description:
+ *   Program the timer hardware for the expiration of the timer at the head
+ *   of g_hrtimer_list, or stop it if the list is empty.
+ *
+ * Assumptions:
+ *   g_hrtimer_lock is held.
+ *
+ ****************************************************************************/
+
+void hrtimer_reprogram(void);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SCHED_HRTIMER_HRTIMER_H */
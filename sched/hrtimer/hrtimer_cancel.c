@@ -0,0 +1,168 @@
+/****************************************************************************
+ * sched/hrtimer/hrtimer_cancel.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <errno.h>
+
+#include <nuttx/hrtimer.h>
+#include <nuttx/sched.h>
+#include <nuttx/spinlock.h>
+
+#include "hrtimer/hrtimer.h"
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: hrtimer_running
+ *
+ * Description:
+ *   Return true if another CPU is running the callback of the timer.  The
+ *   callback of this CPU can not be waited for: either we are called from
+ *   it or it is not running.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SMP
+static bool hrtimer_running(FAR struct hrtimer_s *timer)
+{
+  irqstate_t flags;
+  bool running = false;
+  int cpu;
+
+  flags = spin_lock_irqsave(&g_hrtimer_lock);
+
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      if (cpu != this_cpu() && g_hrtimer_running[cpu].timer == timer)
+        {
+          running = true;
+          break;
+        }
+    }
+
+  spin_unlock_irqrestore(&g_hrtimer_lock, flags);
+  return running;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: hrtimer_cancel
+ *
+ * Description:
+ *   Remove a high resolution timer from the active timer list.
+ *
+ * Input Parameters:
+ *   timer - The timer to be cancelled
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success; a negated errno value is returned on
+ *   failure.
+ *
+ ****************************************************************************/
+
+int hrtimer_cancel(FAR struct hrtimer_s *timer)
+{
+  irqstate_t flags;
+  int cpu;
+
+  if (timer == NULL)
+    {
+      return -EINVAL;
+    }
+
+  flags = spin_lock_irqsave(&g_hrtimer_lock);
+
+  /* A callback that is running now must not reload the timer */
+
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      if (g_hrtimer_running[cpu].timer == timer)
+        {
+          g_hrtimer_running[cpu].cancelled = true;
+        }
+    }
+
+  if (HRTIMER_ISACTIVE(timer))
+    {
+      bool head = list_is_head(&g_hrtimer_list, &timer->node);
+
+      list_delete(&timer->node);
+
+      /* Move the hardware expiration out if the earliest timer went away */
+
+      if (head)
+        {
+          hrtimer_reprogram();
+        }
+    }
+
+  spin_unlock_irqrestore(&g_hrtimer_lock, flags);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: hrtimer_cancel_sync
+ *
+ * Description:
+ *   Cancel a high resolution timer and wait until its callback is no
+ *   longer running on another CPU, so that the timer may be freed.
+ *
+ * Input Parameters:
+ *   timer - The timer to be cancelled
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success; a negated errno value is returned on
+ *   failure.
+ *
+ ****************************************************************************/
+
+int hrtimer_cancel_sync(FAR struct hrtimer_s *timer)
+{
+  int ret;
+
+  ret = hrtimer_cancel(timer);
+
+#ifdef CONFIG_SMP
+  if (ret >= 0)
+    {
+      while (hrtimer_running(timer))
+        {
+          SP_RELAX();
+        }
+    }
+#endif
+
+  return ret;
+}
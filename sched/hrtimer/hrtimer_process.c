@@ -0,0 +1,114 @@
+/****************************************************************************
+ * sched/hrtimer/hrtimer_process.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+
+#include <nuttx/hrtimer.h>
+#include <nuttx/irq.h>
+
+#include "hrtimer/hrtimer.h"
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: hrtimer_process
+ *
+ * Description:
+ *   Run the callbacks of all timers that have expired at 'now' and program
+ *   the next expiration.
+ *
+ * Input Parameters:
+ *   now - The current time in nanoseconds
+ *
+ * Assumptions:
+ *   Called from interrupt handler logic.
+ *
+ ****************************************************************************/
+
+void hrtimer_process(uint64_t now)
+{
+  FAR struct hrtimer_running_s *running;
+  FAR struct hrtimer_s *timer;
+  irqstate_t flags;
+  uint64_t expired;
+  uint64_t period;
+
+  /* Like watchdog callbacks, hrtimer callbacks run in the critical
+   * section.  A thread that holds it can therefore never see a callback
+   * running on another CPU, so hrtimer_cancel_sync() does not deadlock
+   * when it is called from the critical section.
+   */
+
+  flags = enter_critical_section();
+  spin_lock(&g_hrtimer_lock);
+
+  running = &g_hrtimer_running[this_cpu()];
+
+  while (!list_is_empty(&g_hrtimer_list))
+    {
+      timer = list_first_entry(&g_hrtimer_list, struct hrtimer_s, node);
+      if (timer->expired > now)
+        {
+          break;
+        }
+
+      list_delete(&timer->node);
+      expired = timer->expired;
+
+      running->timer     = timer;
+      running->cancelled = false;
+
+      /* The callback may start or cancel timers (including this one), so
+       * run it without holding the lock.
+       */
+
+      spin_unlock(&g_hrtimer_lock);
+      period = timer->func(timer, expired);
+      spin_lock(&g_hrtimer_lock);
+
+      /* Do not touch the timer unless asked to reload it: a one-shot timer
+       * may already have been released by the task it woke up.  A timer
+       * cancelled while its callback ran is not reloaded either.
+       */
+
+      if (period != 0 && !running->cancelled && !HRTIMER_ISACTIVE(timer))
+        {
+          timer->expired = expired + period;
+          hrtimer_insert(timer);
+        }
+
+      running->timer = NULL;
+    }
+
+  hrtimer_reprogram();
+  spin_unlock(&g_hrtimer_lock);
+  leave_critical_section(flags);
+}
@@ -0,0 +1,229 @@
+/****************************************************************************
+ * sched/hrtimer/hrtimer_start.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <assert.h>
+#include <errno.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+#include <nuttx/hrtimer.h>
+
+#include "hrtimer/hrtimer.h"
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+struct list_node g_hrtimer_list = LIST_INITIAL_VALUE(g_hrtimer_list);
+spinlock_t g_hrtimer_lock = SP_UNLOCKED;
+struct hrtimer_running_s g_hrtimer_running[CONFIG_SMP_NCPUS];
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: hrtimer_insert
+ *
+ * Description:
+ *   Insert the timer into g_hrtimer_list according to timer->expired.
+ *
+ ****************************************************************************/
+
+bool hrtimer_insert(FAR struct hrtimer_s *timer)
+{
+  FAR struct hrtimer_s *curr;
+
+  list_for_every_entry(&g_hrtimer_list, curr, struct hrtimer_s, node)
+    {
+      if (curr->expired > timer->expired)
+        {
+          break;
+        }
+    }
+
+  list_add_before(&curr->node, &timer->node);
+  return list_is_head(&g_hrtimer_list, &timer->node);
+}
+
+/****************************************************************************
+ * Name: hrtimer_reprogram
+ *
+ * Description:
+ *   Program the timer hardware for the head of g_hrtimer_list.
+ *
+ ****************************************************************************/
+
+void hrtimer_reprogram(void)
+{
+  FAR struct hrtimer_s *head;
+
+  if (list_is_empty(&g_hrtimer_list))
+    {
+      up_hrtimer_start(UINT64_MAX);
+    }
+  else
+    {
+      head = list_first_entry(&g_hrtimer_list, struct hrtimer_s, node);
+      up_hrtimer_start(head->expired);
+    }
+}
+
+/****************************************************************************
+ * Name: hrtimer_init
+ *
+ * Description:
+ *   Initialize a high resolution timer before its first use.
+ *
+ ****************************************************************************/
+
+void hrtimer_init(FAR struct hrtimer_s *timer, hrtimer_cb func,
+                  FAR void *arg)
+{
+  DEBUGASSERT(timer != NULL);
+
+  list_clear_node(&timer->node);
+  timer->func    = func;
+  timer->arg     = arg;
+  timer->expired = 0;
+}
+
+/****************************************************************************
+ * Name: hrtimer_start
+ *
+ * Description:
+ *   Add a high resolution timer to the active timer list, replacing any
+ *   pending expiration.
+ *
+ * Input Parameters:
+ *   timer - The timer to be started
+ *   ns    - Expiration time in nanoseconds
+ *   mode  - HRTIMER_MODE_ABS or HRTIMER_MODE_REL
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success; a negated errno value is returned on
+ *   failure.
+ *
+ ****************************************************************************/
+
+int hrtimer_start(FAR struct hrtimer_s *timer, uint64_t ns,
+                  enum hrtimer_mode_e mode)
+{
+  irqstate_t flags;
+  bool reprogram = false;
+
+  if (timer == NULL || timer->func == NULL)
+    {
+      return -EINVAL;
+    }
+
+  if (mode == HRTIMER_MODE_REL)
+    {
+      uint64_t now = hrtimer_gettime();
+
+      /* UINT64_MAX is reserved to tell the platform that no timer is
+       * active, saturate one below it.
+       */
+
+      ns = ns < UINT64_MAX - 1 - now ? now + ns : UINT64_MAX - 1;
+    }
+
+  flags = spin_lock_irqsave(&g_hrtimer_lock);
+
+  if (HRTIMER_ISACTIVE(timer))
+    {
+      reprogram = list_is_head(&g_hrtimer_list, &timer->node);
+      list_delete(&timer->node);
+    }
+
+  timer->expired = ns;
+  if (hrtimer_insert(timer) || reprogram)
+    {
+      hrtimer_reprogram();
+    }
+
+  spin_unlock_irqrestore(&g_hrtimer_lock, flags);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: hrtimer_gettime
+ *
+ * Description:
+ *   Return the current CLOCK_MONOTONIC time in nanoseconds.
+ *
+ ****************************************************************************/
+
+uint64_t hrtimer_gettime(void)
+{
+  struct timespec ts;
+
+  up_timer_gettime(&ts);
+  return clock_time2nsec(&ts);
+}
+
+/****************************************************************************
+ * Name: hrtimer_abstime2nsec
+ *
+ * Description:
+ *   Convert an absolute time on the clock 'clockid' to CLOCK_MONOTONIC
+ *   nanoseconds.
+ *
+ ****************************************************************************/
+
+uint64_t hrtimer_abstime2nsec(clockid_t clockid,
+                              FAR const struct timespec *abstime)
+{
+  struct timespec ts;
+  uint64_t expired;
+  uint64_t clock;
+  uint64_t now;
+
+  if (abstime->tv_sec < 0)
+    {
+      return hrtimer_gettime();
+    }
+
+  expired = clock_time2nsec(abstime);
+  if (clockid == CLOCK_MONOTONIC)
+    {
+      return expired;
+    }
+
+  /* Other clocks may be stepped, so the time is converted with the offset
+   * in effect now, as is done for watchdog timers.
+   */
+
+  nxclock_gettime(clockid, &ts);
+  now   = hrtimer_gettime();
+  clock = clock_time2nsec(&ts);
+
+  return expired > clock ? now + (expired - clock) : now;
+}
@@ -87,6 +87,10 @@ void nx_idle_trampoline(void)
 
   for (; ; )
     {
+      /* The IDLE loop is a quiescent state for RCU */
+
+      nxsched_rcu_quiescent();
+
       /* Perform any processor-specific idle state operations */
 
       up_idle();
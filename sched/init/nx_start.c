@@ -49,6 +49,10 @@
 #include <nuttx/init.h>
 #include <nuttx/lib/math32.h>
 
+#ifdef CONFIG_SCHED_PERF_EVENTS
+#  include <nuttx/perf.h>
+#endif
+
 #include "task/task.h"
 #include "sched/sched.h"
 #include "signal/signal.h"
@@ -161,6 +165,14 @@ dq_queue_t g_waitingforfill;
 dq_queue_t g_stoppedtasks;
 #endif
 
+#ifdef CONFIG_SCHED_DEADLINE
+/* This is the list of all SCHED_DEADLINE threads that have exhausted their
+ * budget and wait for the next period
+ */
+
+dq_queue_t g_throttledtasks;
+#endif
+
 /* This list of all tasks that have been initialized, but not yet
  * activated. NOTE:  This is the only list that is not prioritized.
  */
@@ -181,6 +193,12 @@ volatile pid_t g_lastpid;
 FAR struct tcb_s **g_pidhash;
 volatile int g_npidhash;
 
+#ifdef CONFIG_RCU
+/* Odd while nxtask_assign_pid() replaces g_pidhash and g_npidhash */
+
+volatile unsigned int g_pidhash_seq;
+#endif
+
 /* This is a table of task lists.  This table is indexed by the task state
  * enumeration type (tstate_t) and provides a pointer to the associated
  * static task list (if there is one) as well as a set of attribute flags
@@ -330,6 +348,15 @@ static void tasklist_initialize(void)
   tlist[TSTATE_TASK_STOPPED].list = list_stoppedtasks();
   tlist[TSTATE_TASK_STOPPED].attr = 0;
 
+#endif
+
+#ifdef CONFIG_SCHED_DEADLINE
+
+  /* TSTATE_TASK_THROTTLED */
+
+  tlist[TSTATE_TASK_THROTTLED].list = list_throttledtasks();
+  tlist[TSTATE_TASK_THROTTLED].attr = 0;
+
 #endif
 }
 
@@ -632,6 +659,10 @@ void nx_start(void)
 
   g_nx_initstate = OSINIT_MEMORY;
 
+  /* Initialize the cache of dynamically allocated TCBs */
+
+  nxsched_initialize_tcbcache();
+
   /* Initialize tasking data structures */
 
   task_initialize();
@@ -678,6 +709,12 @@ void nx_start(void)
   binfmt_initialize();
 #endif
 
+#ifdef CONFIG_SCHED_PERF_EVENTS
+  /* Initialize the perf event subsystem before the PMU drivers register */
+
+  perf_event_init();
+#endif
+
   /* Initialize Hardware Facilities *****************************************/
 
   /* The processor specific details of running the operating system
@@ -773,6 +810,10 @@ void nx_start(void)
 #ifndef CONFIG_DISABLE_IDLE_LOOP
   for (; ; )
     {
+      /* The IDLE loop is a quiescent state for RCU */
+
+      nxsched_rcu_quiescent();
+
       /* Perform any processor-specific idle state operations */
 
       up_idle();
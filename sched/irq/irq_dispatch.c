@@ -127,6 +127,12 @@ void irq_dispatch(int irq, FAR void *context)
     }
 #endif
 
+#ifdef CONFIG_SCHED_LATENCYMON
+  /* Threads woken up by this interrupt measure their latency from here */
+
+  g_latency_irqstart[this_cpu()] = perf_gettime();
+#endif
+
 #ifdef CONFIG_CRYPTO_RANDOM_POOL_COLLECT_IRQ_RANDOMNESS
   /* Add interrupt timing randomness to entropy pool */
 
@@ -68,6 +68,15 @@ int nxmq_alloc_msgq(FAR struct mq_attr *attr,
                     FAR struct mqueue_inode_s **pmsgq)
 {
   FAR struct mqueue_inode_s *msgq;
+  size_t size = sizeof(struct mqueue_inode_s);
+#ifdef CONFIG_MQ_PERQUEUE_MSGS
+  FAR uint8_t *buffer;
+  int16_t maxmsgs;
+  int16_t msgsize;
+#endif
+#if defined(CONFIG_MQ_PRIO_BUCKETS) || defined(CONFIG_MQ_PERQUEUE_MSGS)
+  int i;
+#endif
 
   /* Check if the caller is attempting to allocate a message for messages
    * larger than the configured maximum message size.
@@ -79,16 +88,45 @@ int nxmq_alloc_msgq(FAR struct mq_attr *attr,
       return -EINVAL;
     }
 
+#ifdef CONFIG_MQ_PERQUEUE_MSGS
+  /* Allocate the message buffers of the queue in the same chunk */
+
+  maxmsgs = attr ? attr->mq_maxmsg : MQ_MAX_MSGS;
+  msgsize = attr ? attr->mq_msgsize : MQ_MAX_BYTES;
+  size   += maxmsgs * MQ_QUEUE_MSG_SIZE(msgsize);
+#endif
+
   /* Allocate memory for the new message queue. */
 
-  msgq = (FAR struct mqueue_inode_s *)
-    kmm_zalloc(sizeof(struct mqueue_inode_s));
+  msgq = (FAR struct mqueue_inode_s *)kmm_zalloc(size);
 
   if (msgq)
     {
       /* Initialize the new named message queue */
 
+#ifdef CONFIG_MQ_PRIO_BUCKETS
+      for (i = 0; i < MQ_PRIO_NBUCKETS; i++)
+        {
+          list_initialize(&msgq->msglist[i]);
+        }
+#else
       list_initialize(&msgq->msglist);
+#endif
+
+#ifdef CONFIG_MQ_PERQUEUE_MSGS
+      list_initialize(&msgq->msgfree);
+      buffer = (FAR uint8_t *)(msgq + 1);
+      for (i = 0; i < maxmsgs; i++)
+        {
+          FAR struct mqueue_msg_s *mqmsg =
+            (FAR struct mqueue_msg_s *)buffer;
+
+          mqmsg->type = MQ_ALLOC_QUEUE;
+          list_add_tail(&msgq->msgfree, &mqmsg->node);
+          buffer += MQ_QUEUE_MSG_SIZE(msgsize);
+        }
+#endif
+
       if (attr)
         {
           msgq->maxmsgs    = (int16_t)attr->mq_maxmsg;
@@ -55,18 +55,30 @@
 void nxmq_free_msgq(FAR struct mqueue_inode_s *msgq)
 {
   FAR struct mqueue_msg_s *entry;
-  FAR struct mqueue_msg_s *tmp;
+#ifdef CONFIG_MQ_PRIO_BUCKETS
+  int i;
+#endif
 
-  /* Deallocate any stranded messages in the message queue. */
+  /* Deallocate any stranded messages in the message queue.  Messages
+   * allocated with the message queue go away with it below.
+   */
 
-  list_for_every_entry_safe(&msgq->msglist, entry,
-                            tmp, struct mqueue_msg_s, node)
+#ifdef CONFIG_MQ_PRIO_BUCKETS
+  for (i = 0; i < MQ_PRIO_NBUCKETS; i++)
     {
-      /* Deallocate the message structure. */
-
-      list_delete(&entry->node);
-      nxmq_free_msg(entry);
+      while ((entry = (FAR struct mqueue_msg_s *)
+                      list_remove_head(&msgq->msglist[i])) != NULL)
+        {
+          nxmq_free_msg(msgq, entry);
+        }
+    }
+#else
+  while ((entry = (FAR struct mqueue_msg_s *)
+                  list_remove_head(&msgq->msglist)) != NULL)
+    {
+      nxmq_free_msg(msgq, entry);
     }
+#endif
 
   /* Then deallocate the message queue itself */
 
@@ -104,6 +104,82 @@ static int nxmq_verify_receive(FAR struct file *mq,
 }
 #endif
 
+/****************************************************************************
+ * Name: nxmq_get_msg
+ *
+ * Description:
+ *   This is internal, common logic shared by the copying and the
+ *   zero-copy receive functions.  It removes the oldest of the highest
+ *   priority messages from the message queue, waiting for one if the
+ *   message queue is empty and O_NONBLOCK is not set.
+ *
+ * Input Parameters:
+ *   mq      - Message Queue Descriptor
+ *   rcvmsg  - The location to return the message
+ *   abstime - the absolute time to wait until a timeout is declared.
+ *   ticks   - Ticks to wait from the start time, if abstime is NULL.
+ *
+ * Returned Value:
+ *   Zero (OK) on success, or a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+static int nxmq_get_msg(FAR struct file *mq,
+                        FAR struct mqueue_msg_s **rcvmsg,
+                        FAR const struct timespec *abstime,
+                        sclock_t ticks)
+{
+  FAR struct mqueue_inode_s *msgq = mq->f_inode->i_private;
+  FAR struct mqueue_msg_s *mqmsg;
+  irqstate_t flags;
+  int ret;
+
+  /* Furthermore, nxmq_wait_receive() expects to have interrupts disabled
+   * because messages can be sent from interrupt level.
+   */
+
+  flags = enter_critical_section();
+
+  /* Get the message from the message queue */
+
+  mqmsg = nxmq_remove_head(msgq);
+  if (mqmsg == NULL)
+    {
+      if ((mq->f_oflags & O_NONBLOCK) != 0)
+        {
+          leave_critical_section(flags);
+          return -EAGAIN;
+        }
+
+      /* Wait & get the message from the message queue */
+
+      ret = nxmq_wait_receive(msgq, &mqmsg, abstime, ticks);
+      if (ret < 0)
+        {
+          leave_critical_section(flags);
+          return ret;
+        }
+    }
+
+  /* If we got message, then decrement the number of messages in
+   * the queue while we are still in the critical section
+   */
+
+  if (msgq->nmsgs-- == msgq->maxmsgs)
+    {
+      nxmq_pollnotify(msgq, POLLOUT);
+    }
+
+  /* Notify all threads waiting for a message in the message queue */
+
+  nxmq_notify_receive(msgq);
+
+  leave_critical_section(flags);
+
+  *rcvmsg = mqmsg;
+  return OK;
+}
+
 /****************************************************************************
  * Name: file_mq_timedreceive_internal
  *
@@ -140,9 +216,7 @@ ssize_t file_mq_timedreceive_internal(FAR struct file *mq, FAR char *msg,
                                       FAR const struct timespec *abstime,
                                       sclock_t ticks)
 {
-  FAR struct mqueue_inode_s *msgq;
   FAR struct mqueue_msg_s *mqmsg;
-  irqstate_t flags;
   ssize_t ret = 0;
 
   DEBUGASSERT(up_interrupt_context() == false);
@@ -171,50 +245,12 @@ ssize_t file_mq_timedreceive_internal(FAR struct file *mq, FAR char *msg,
     }
 #endif
 
-  msgq = mq->f_inode->i_private;
-
-  /* Furthermore, nxmq_wait_receive() expects to have interrupts disabled
-   * because messages can be sent from interrupt level.
-   */
-
-  flags = enter_critical_section();
-
-  /* Get the message from the message queue */
-
-  mqmsg = (FAR struct mqueue_msg_s *)list_remove_head(&msgq->msglist);
-  if (mqmsg == NULL)
-    {
-      if ((mq->f_oflags & O_NONBLOCK) != 0)
-        {
-          leave_critical_section(flags);
-          return -EAGAIN;
-        }
-
-      /* Wait & get the message from the message queue */
-
-      ret = nxmq_wait_receive(msgq, &mqmsg, abstime, ticks);
-      if (ret < 0)
-        {
-          leave_critical_section(flags);
-          return ret;
-        }
-    }
-
-  /* If we got message, then decrement the number of messages in
-   * the queue while we are still in the critical section
-   */
-
-  if (msgq->nmsgs-- == msgq->maxmsgs)
+  ret = nxmq_get_msg(mq, &mqmsg, abstime, ticks);
+  if (ret < 0)
     {
-      nxmq_pollnotify(msgq, POLLOUT);
+      return ret;
     }
 
-  /* Notify all threads waiting for a message in the message queue */
-
-  nxmq_notify_receive(msgq);
-
-  leave_critical_section(flags);
-
   /* Return the message to the caller */
 
   if (prio)
@@ -227,7 +263,7 @@ ssize_t file_mq_timedreceive_internal(FAR struct file *mq, FAR char *msg,
 
   /* Free the message structure */
 
-  nxmq_free_msg(mqmsg);
+  nxmq_free_msg(mq->f_inode->i_private, mqmsg);
 
   return ret;
 }
@@ -324,6 +360,100 @@ ssize_t file_mq_tickreceive(FAR struct file *mq, FAR char *msg,
   return file_mq_timedreceive_internal(mq, msg, msglen, prio, NULL, ticks);
 }
 
+/****************************************************************************
+ * Name: file_mq_borrow
+ *
+ * Description:
+ *   This function receives the oldest of the highest priority messages from
+ *   the message queue specified by "mq" like file_mq_timedreceive(), but
+ *   returns a reference to the message buffer instead of copying the
+ *   message out of it.  The buffer must be given back with
+ *   file_mq_release() before the message queue is closed.
+ *
+ * Input Parameters:
+ *   mq      - Message Queue Descriptor
+ *   msg     - The location to return the message data
+ *   prio    - If not NULL, the location to store message priority.
+ *   abstime - the absolute time to wait until a timeout is declared.
+ *
+ * Returned Value:
+ *   On success, the length of the selected message in bytes is returned.
+ *   A negated errno value is returned on failure (see mq_timedreceive()
+ *   for the list of valid return values).
+ *
+ ****************************************************************************/
+
+ssize_t file_mq_borrow(FAR struct file *mq, FAR char **msg,
+                       FAR unsigned int *prio,
+                       FAR const struct timespec *abstime)
+{
+  FAR struct mqueue_msg_s *mqmsg;
+  int ret;
+
+  DEBUGASSERT(up_interrupt_context() == false);
+
+  /* Verify the input parameters */
+
+  if (abstime && (abstime->tv_nsec < 0 || abstime->tv_nsec >= 1000000000))
+    {
+      return -EINVAL;
+    }
+
+  if (mq == NULL || msg == NULL)
+    {
+      return -EINVAL;
+    }
+
+#ifdef CONFIG_DEBUG_FEATURES
+  /* Borrowing needs no buffer, so no minimum message size to check */
+
+  ret = nxmq_verify_receive(mq, (FAR char *)msg, SIZE_MAX);
+  if (ret < 0)
+    {
+      return ret;
+    }
+#endif
+
+  ret = nxmq_get_msg(mq, &mqmsg, abstime, -1);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  /* Lend the message to the caller */
+
+  if (prio)
+    {
+      *prio = mqmsg->priority;
+    }
+
+  *msg = mqmsg->mail;
+  return mqmsg->msglen;
+}
+
+/****************************************************************************
+ * Name: file_mq_release
+ *
+ * Description:
+ *   Give back a message buffer obtained with file_mq_borrow().
+ *
+ * Input Parameters:
+ *   mq  - Message Queue Descriptor the message was borrowed from
+ *   msg - The message data returned by file_mq_borrow()
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void file_mq_release(FAR struct file *mq, FAR char *msg)
+{
+  DEBUGASSERT(mq != NULL && msg != NULL);
+
+  nxmq_free_msg(mq->f_inode->i_private,
+                container_of(msg, struct mqueue_msg_s, mail));
+}
+
 /****************************************************************************
  * Name: nxmq_timedreceive
  *
@@ -110,8 +110,9 @@ static int nxmq_verify_send(FAR FAR struct file *mq, FAR const char *msg,
  *
  * Description:
  *   The nxmq_alloc_msg function will get a free message for use by the
- *   operating system.  The message will be allocated from the g_msgfree
- *   list.
+ *   operating system.  The message will be allocated from the free list
+ *   of the message queue, if CONFIG_MQ_PERQUEUE_MSGS is enabled, or from
+ *   the g_msgfree list.
  *
  *   If the list is empty AND the message is NOT being allocated from the
  *   interrupt level, then the message will be allocated.  If a message
@@ -124,7 +125,8 @@ static int nxmq_verify_send(FAR FAR struct file *mq, FAR const char *msg,
  *   handler will be notified.
  *
  * Input Parameters:
- *   None
+ *   msgq    - The message queue the message will be sent to
+ *   msgsize - The length of the message in bytes
  *
  * Returned Value:
  *   A reference to the allocated msg structure.  On a failure to allocate,
@@ -132,15 +134,26 @@ static int nxmq_verify_send(FAR FAR struct file *mq, FAR const char *msg,
  *
  ****************************************************************************/
 
-static FAR struct mqueue_msg_s *nxmq_alloc_msg(uint16_t msgsize)
+static FAR struct mqueue_msg_s *
+nxmq_alloc_msg(FAR struct mqueue_inode_s *msgq, uint16_t msgsize)
 {
   FAR struct mqueue_msg_s *mqmsg;
   irqstate_t flags;
 
-  /* Try to get the message from the generally available free list. */
-
   flags = spin_lock_irqsave(NULL);
-  mqmsg = (FAR struct mqueue_msg_s *)list_remove_head(&g_msgfree);
+
+#ifdef CONFIG_MQ_PERQUEUE_MSGS
+  /* Try to get the message from the messages of the queue first */
+
+  mqmsg = (FAR struct mqueue_msg_s *)list_remove_head(&msgq->msgfree);
+  if (mqmsg == NULL)
+#endif
+    {
+      /* Try to get the message from the generally available free list. */
+
+      mqmsg = (FAR struct mqueue_msg_s *)list_remove_head(&g_msgfree);
+    }
+
   spin_unlock_irqrestore(NULL, flags);
   if (mqmsg == NULL)
     {
@@ -207,36 +220,32 @@ static void nxmq_add_queue(FAR struct mqueue_inode_s *msgq,
                            FAR struct mqueue_msg_s *mqmsg,
                            unsigned int prio)
 {
-  FAR struct mqueue_msg_s *prev = NULL;
-  FAR struct mqueue_msg_s *next;
+  FAR struct list_node *list = MQ_MSGLIST(msgq, prio);
+  FAR struct list_node *prev;
 
   /* Insert the new message in the message queue
-   * Search the message list to find the location to insert the new
-   * message. Each is list is maintained in ascending priority order.
+   * Search the message list backward for the last message with the same
+   * or a higher priority, and insert the new message after it.  Each list
+   * is maintained in descending priority order, and FIFO order within a
+   * priority, so a message of the lowest priority queued so far goes to
+   * the tail without walking the list.
    */
 
-  list_for_every_entry(&msgq->msglist, next, struct mqueue_msg_s, node)
+  for (prev = list->prev; prev != list; prev = prev->prev)
     {
-      if (prio > next->priority)
+      if (container_of(prev, struct mqueue_msg_s, node)->priority >= prio)
         {
           break;
         }
-      else
-        {
-          prev = next;
-        }
     }
 
   /* Add the message at the right place */
 
-  if (prev)
-    {
-      list_add_after(&prev->node, &mqmsg->node);
-    }
-  else
-    {
-      list_add_head(&msgq->msglist, &mqmsg->node);
-    }
+  list_add_after(prev, &mqmsg->node);
+
+#ifdef CONFIG_MQ_PRIO_BUCKETS
+  msgq->msgmap |= UINT32_C(1) << MQ_PRIO_BUCKET(prio);
+#endif
 }
 
 /****************************************************************************
@@ -308,7 +317,7 @@ int file_mq_timedsend_internal(FAR struct file *mq, FAR const char *msg,
 
   /* Pre-allocate a message structure */
 
-  mqmsg = nxmq_alloc_msg(msglen);
+  mqmsg = nxmq_alloc_msg(msgq, msglen);
   if (!mqmsg)
     {
       return -ENOMEM;
@@ -363,7 +372,7 @@ out:
 
   if (ret < 0)
     {
-      nxmq_free_msg(mqmsg);
+      nxmq_free_msg(msgq, mqmsg);
     }
 
   return ret;
@@ -32,11 +32,13 @@
 
 #include <sys/types.h>
 #include <stdint.h>
+#include <strings.h>
 #include <stdbool.h>
 #include <limits.h>
 #include <mqueue.h>
 #include <sched.h>
 
+#include <nuttx/nuttx.h>
 #include <nuttx/mqueue.h>
 
 #if defined(CONFIG_MQ_MAXMSGSIZE) && CONFIG_MQ_MAXMSGSIZE > 0
@@ -51,6 +53,19 @@
 
 #define MQ_MSG_SIZE(n) (sizeof(struct mqueue_msg_s) + (n) - 1)
 
+/* Size of one message buffer allocated along with a message queue */
+
+#define MQ_QUEUE_MSG_SIZE(n) ALIGN_UP(MQ_MSG_SIZE(n), sizeof(uintptr_t))
+
+/* List of the messages with priority 'prio' */
+
+#ifdef CONFIG_MQ_PRIO_BUCKETS
+#  define MQ_PRIO_BUCKET(prio) ((prio) / MQ_PRIO_BUCKET_WIDTH)
+#  define MQ_MSGLIST(msgq, prio) (&(msgq)->msglist[MQ_PRIO_BUCKET(prio)])
+#else
+#  define MQ_MSGLIST(msgq, prio) (&(msgq)->msglist)
+#endif
+
 /****************************************************************************
  * Public Type Definitions
  ****************************************************************************/
@@ -59,7 +74,8 @@ enum mqalloc_e
 {
   MQ_ALLOC_FIXED = 0,  /* Pre-allocated; never freed */
   MQ_ALLOC_DYN,        /* Dynamically allocated; free when unused */
-  MQ_ALLOC_IRQ         /* Preallocated, reserved for interrupt handling */
+  MQ_ALLOC_IRQ,        /* Preallocated, reserved for interrupt handling */
+  MQ_ALLOC_QUEUE       /* Allocated with the message queue (msgfree) */
 };
 
 /* This structure describes one buffered POSIX message. */
@@ -101,6 +117,46 @@ EXTERN struct list_node g_msgfree;
 
 EXTERN struct list_node g_msgfreeirq;
 
+/****************************************************************************
+ * Inline Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxmq_remove_head
+ *
+ * Description:
+ *   Remove and return the oldest of the highest priority messages of a
+ *   message queue, or NULL if the message queue is empty.  Must be called
+ *   within a critical section.
+ *
+ ****************************************************************************/
+
+static inline FAR struct mqueue_msg_s *
+nxmq_remove_head(FAR struct mqueue_inode_s *msgq)
+{
+#ifdef CONFIG_MQ_PRIO_BUCKETS
+  FAR struct mqueue_msg_s *mqmsg;
+  int bucket;
+
+  if (msgq->msgmap == 0)
+    {
+      return NULL;
+    }
+
+  bucket = fls(msgq->msgmap) - 1;
+  mqmsg  = (FAR struct mqueue_msg_s *)
+           list_remove_head(&msgq->msglist[bucket]);
+  if (list_is_empty(&msgq->msglist[bucket]))
+    {
+      msgq->msgmap &= ~(UINT32_C(1) << bucket);
+    }
+
+  return mqmsg;
+#else
+  return (FAR struct mqueue_msg_s *)list_remove_head(&msgq->msglist);
+#endif
+}
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -114,7 +170,8 @@ void nxmq_initialize(void);
 
 /* mq_msgfree.c *************************************************************/
 
-void nxmq_free_msg(FAR struct mqueue_msg_s *mqmsg);
+void nxmq_free_msg(FAR struct mqueue_inode_s *msgq,
+                   FAR struct mqueue_msg_s *mqmsg);
 
 /* mq_waitirq.c *************************************************************/
 
@@ -0,0 +1,105 @@
+/****************************************************************************
+ * sched/pthread/pthread_mutexbreaklock.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <pthread.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/pthread.h>
+
+#include "pthread/pthread.h"
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nx_pthread_mutex_breaklock
+ *
+ * Description:
+ *   Release a kernel mutex held by the caller completely, however many
+ *   times it was locked, and return that count in nlocks.  This is used
+ *   by the futex-based pthread_cond_clockwait() before it goes to sleep.
+ *
+ * Input Parameters:
+ *   mutex  - The mutex held by the caller
+ *   nlocks - Location to return the number of times it was locked
+ *
+ * Returned Value:
+ *   0 on success or an errno value on failure.
+ *
+ ****************************************************************************/
+
+int nx_pthread_mutex_breaklock(FAR pthread_mutex_t *mutex,
+                               FAR unsigned int *nlocks)
+{
+  sinfo("mutex=%p\n", mutex);
+
+  if (mutex == NULL || nlocks == NULL)
+    {
+      return EINVAL;
+    }
+
+  /* Make sure that the caller holds the mutex */
+
+  if (!mutex_is_hold(&mutex->mutex))
+    {
+      return EPERM;
+    }
+
+  return pthread_mutex_breaklock(mutex, nlocks);
+}
+
+/****************************************************************************
+ * Name: nx_pthread_mutex_restorelock
+ *
+ * Description:
+ *   Reacquire a mutex released by nx_pthread_mutex_breaklock(), restoring
+ *   its lock count.
+ *
+ * Input Parameters:
+ *   mutex  - The mutex to reacquire
+ *   nlocks - The count returned by nx_pthread_mutex_breaklock()
+ *
+ * Returned Value:
+ *   0 on success or an errno value on failure.
+ *
+ ****************************************************************************/
+
+int nx_pthread_mutex_restorelock(FAR pthread_mutex_t *mutex,
+                                 unsigned int nlocks)
+{
+  sinfo("mutex=%p nlocks=%u\n", mutex, nlocks);
+
+  if (mutex == NULL)
+    {
+      return EINVAL;
+    }
+
+  return pthread_mutex_restorelock(mutex, nlocks);
+}
@@ -69,6 +69,17 @@ int pthread_mutex_destroy(FAR pthread_mutex_t *mutex)
     {
       pid_t pid;
 
+#ifdef CONFIG_FUTEX
+      /* A futex mutex is locked in user space and has no holder here */
+
+      if (mutex->futex != _PTHREAD_MFUTEX_NONE &&
+          mutex->futex != _PTHREAD_MFUTEX_UNLOCKED)
+        {
+          sinfo("Returning %d\n", EBUSY);
+          return EBUSY;
+        }
+#endif
+
       pid = mutex_get_holder(&mutex->mutex);
 
       /* Is the mutex available? */
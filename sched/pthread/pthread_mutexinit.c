@@ -113,5 +113,52 @@ int pthread_mutex_init(FAR pthread_mutex_t *mutex,
     }
 #endif
 
+#ifdef CONFIG_FUTEX
+  /* Default, non-robust mutexes without a priority protocol do not need
+   * the kernel unless they are contended.  Let libc lock them in user
+   * space.  Process-shared mutexes stay in the kernel, so that futex
+   * mutexes can always use process-private futexes.
+   */
+
+  mutex->futex = _PTHREAD_MFUTEX_NONE;
+
+  if (attr != NULL && attr->pshared == PTHREAD_PROCESS_SHARED)
+    {
+      return 0;
+    }
+
+#  ifdef CONFIG_PTHREAD_MUTEX_TYPES
+  if (mutex->type != PTHREAD_MUTEX_NORMAL)
+    {
+      return 0;
+    }
+#  endif
+
+#  ifdef CONFIG_PTHREAD_MUTEX_BOTH
+  if ((mutex->flags & _PTHREAD_MFLAGS_ROBUST) != 0)
+    {
+      return 0;
+    }
+#  elif !defined(CONFIG_PTHREAD_MUTEX_UNSAFE)
+  return 0;
+#  endif
+
+#  if defined(CONFIG_PRIORITY_INHERITANCE)
+  /* mutex_init() made the mutex priority inheriting by default */
+
+  if (attr == NULL || attr->proto != PTHREAD_PRIO_NONE)
+    {
+      return 0;
+    }
+#  elif defined(CONFIG_PRIORITY_PROTECT)
+  if (attr != NULL && attr->proto != PTHREAD_PRIO_NONE)
+    {
+      return 0;
+    }
+#  endif
+
+  mutex->futex = _PTHREAD_MFUTEX_UNLOCKED;
+#endif
+
   return 0;
 }
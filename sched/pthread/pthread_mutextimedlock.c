@@ -58,6 +58,9 @@
  *   abs_timeout), or if the absolute time specified by abs_timeout
  *   has already been passed at the time of the call.
  *
+ *   With CONFIG_FUTEX, this is nx_pthread_mutex_timedlock(): libc handles
+ *   futex mutexes in user space and calls here for kernel mutexes.
+ *
  * Input Parameters:
  *   mutex - A reference to the mutex to be locked.
  *   abs_timeout - max wait time (NULL wait forever)
@@ -77,8 +80,13 @@
  *
  ****************************************************************************/
 
+#ifdef CONFIG_FUTEX
+int nx_pthread_mutex_timedlock(FAR pthread_mutex_t *mutex,
+                               FAR const struct timespec *abs_timeout)
+#else
 int pthread_mutex_timedlock(FAR pthread_mutex_t *mutex,
                             FAR const struct timespec *abs_timeout)
+#endif
 {
   int ret = EINVAL;
 
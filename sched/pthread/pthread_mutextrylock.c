@@ -52,6 +52,9 @@
  *   from the signal handler the thread resumes waiting for the mutex as if
  *   it was not interrupted.
  *
+ *   With CONFIG_FUTEX, this is nx_pthread_mutex_trylock(): libc handles
+ *   futex mutexes in user space and calls here for kernel mutexes.
+ *
  * Input Parameters:
  *   mutex - A reference to the mutex to be locked.
  *
@@ -68,7 +71,11 @@
  *
  ****************************************************************************/
 
+#ifdef CONFIG_FUTEX
+int nx_pthread_mutex_trylock(FAR pthread_mutex_t *mutex)
+#else
 int pthread_mutex_trylock(FAR pthread_mutex_t *mutex)
+#endif
 {
   int status;
   int ret = EINVAL;
@@ -57,6 +57,9 @@
  *   from the signal handler the thread resumes waiting for the mutex as if
  *   it was not interrupted.
  *
+ *   With CONFIG_FUTEX, this is nx_pthread_mutex_unlock(): libc handles
+ *   futex mutexes in user space and calls here for kernel mutexes.
+ *
  * Input Parameters:
  *   None
  *
@@ -67,7 +70,11 @@
  *
  ****************************************************************************/
 
+#ifdef CONFIG_FUTEX
+int nx_pthread_mutex_unlock(FAR pthread_mutex_t *mutex)
+#else
 int pthread_mutex_unlock(FAR pthread_mutex_t *mutex)
+#endif
 {
   int ret = EPERM;
 
@@ -0,0 +1,293 @@
+/****************************************************************************
+ * sched/rcu/rcu.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+#include <nuttx/init.h>
+#include <nuttx/irq.h>
+#include <nuttx/rcu.h>
+#include <nuttx/sched.h>
+#include <nuttx/signal.h>
+#include <nuttx/spinlock.h>
+#include <nuttx/wqueue.h>
+
+#include "sched/sched.h"
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct rcu_cpu_s
+{
+  uint32_t          nesting;     /* Read-side critical section nesting */
+  irqstate_t        flags;       /* Saved by the outermost rcu_read_lock() */
+#ifdef CONFIG_SMP
+  volatile uint32_t qs;          /* Count of quiescent states passed */
+#endif
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct rcu_cpu_s g_rcu_cpu[CONFIG_SMP_NCPUS];
+
+/* Callbacks queued by call_rcu() waiting for the next grace period */
+
+static FAR struct rcu_head *g_rcu_head;
+static FAR struct rcu_head **g_rcu_tail = &g_rcu_head;
+static spinlock_t g_rcu_lock = SP_UNLOCKED;
+static struct work_s g_rcu_work;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: rcu_quiescent_ipi
+ *
+ * Description:
+ *   Called on a CPU that has not passed a quiescent state on its own.
+ *   Read-side critical sections run with interrupts disabled, so taking
+ *   this interrupt is itself a quiescent state.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SMP
+static int rcu_quiescent_ipi(FAR void *arg)
+{
+  nxsched_rcu_quiescent();
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: rcu_worker
+ *
+ * Description:
+ *   Wait for a grace period and invoke the callbacks queued before it.
+ *
+ ****************************************************************************/
+
+static void rcu_worker(FAR void *arg)
+{
+  FAR struct rcu_head *head;
+  FAR struct rcu_head *next;
+  irqstate_t flags;
+
+  flags = spin_lock_irqsave(&g_rcu_lock);
+  head = g_rcu_head;
+  g_rcu_head = NULL;
+  g_rcu_tail = &g_rcu_head;
+  spin_unlock_irqrestore(&g_rcu_lock, flags);
+
+  /* Callbacks queued from now on start a new batch */
+
+  synchronize_rcu();
+
+  for (; head != NULL; head = next)
+    {
+      next = head->next;
+      head->func(head);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxsched_rcu_quiescent
+ *
+ * Description:
+ *   Report a quiescent state of this CPU.  Called on every context switch
+ *   and from the IDLE loop, neither can happen inside a read-side critical
+ *   section.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SMP
+void nxsched_rcu_quiescent(void)
+{
+  g_rcu_cpu[this_cpu()].qs++;
+}
+#endif
+
+/****************************************************************************
+ * Name: rcu_read_lock
+ *
+ * Description:
+ *   Enter an RCU read-side critical section.
+ *
+ ****************************************************************************/
+
+void rcu_read_lock(void)
+{
+  FAR struct rcu_cpu_s *rcpu;
+  irqstate_t flags;
+
+  flags = up_irq_save();
+  rcpu  = &g_rcu_cpu[this_cpu()];
+
+  if (rcpu->nesting++ == 0)
+    {
+      rcpu->flags = flags;
+    }
+}
+
+/****************************************************************************
+ * Name: rcu_read_unlock
+ *
+ * Description:
+ *   Leave an RCU read-side critical section.
+ *
+ ****************************************************************************/
+
+void rcu_read_unlock(void)
+{
+  FAR struct rcu_cpu_s *rcpu = &g_rcu_cpu[this_cpu()];
+
+  DEBUGASSERT(rcpu->nesting > 0);
+
+  if (--rcpu->nesting == 0)
+    {
+      up_irq_restore(rcpu->flags);
+    }
+}
+
+/****************************************************************************
+ * Name: synchronize_rcu
+ *
+ * Description:
+ *   Wait until every RCU read-side critical section that was in progress
+ *   when synchronize_rcu() was called has completed.
+ *
+ ****************************************************************************/
+
+void synchronize_rcu(void)
+{
+#ifdef CONFIG_SMP
+  uint32_t snap[CONFIG_SMP_NCPUS];
+  cpu_set_t cpuset;
+  int cpu;
+#endif
+
+  DEBUGASSERT(!up_interrupt_context() &&
+              g_rcu_cpu[this_cpu()].nesting == 0);
+
+  /* On a single CPU the caller running with interrupts enabled already
+   * means that no reader is in progress.
+   */
+
+#ifdef CONFIG_SMP
+  /* The other CPUs do not run anything before the IDLE loop is reached */
+
+  if (!OSINIT_IDLELOOP())
+    {
+      return;
+    }
+
+  /* Make the removal visible before the grace period starts */
+
+  SP_DSB();
+
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      snap[cpu] = g_rcu_cpu[cpu].qs;
+    }
+
+  /* Give the other CPUs a tick to switch context or go idle, which is
+   * usually enough on a busy system.
+   */
+
+  nxsig_usleep(USEC_PER_TICK);
+
+  /* The current CPU is quiescent since it runs this thread.  Interrupt the
+   * CPUs that are still running the same task or sleep in the IDLE loop.
+   */
+
+  CPU_ZERO(&cpuset);
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      if (cpu != this_cpu() && g_rcu_cpu[cpu].qs == snap[cpu])
+        {
+          CPU_SET(cpu, &cpuset);
+        }
+    }
+
+  if (CPU_COUNT(&cpuset) > 0)
+    {
+      DEBUGVERIFY(nxsched_smp_call(cpuset, rcu_quiescent_ipi, NULL));
+    }
+#endif
+
+  SP_DMB();
+}
+
+/****************************************************************************
+ * Name: call_rcu
+ *
+ * Description:
+ *   Call 'func' from the low priority work queue once a grace period has
+ *   elapsed.
+ *
+ ****************************************************************************/
+
+void call_rcu(FAR struct rcu_head *head, rcu_callback_t func)
+{
+  irqstate_t flags;
+  bool empty;
+
+  DEBUGASSERT(head != NULL && func != NULL);
+
+  head->next = NULL;
+  head->func = func;
+
+  flags = spin_lock_irqsave(&g_rcu_lock);
+
+  empty = g_rcu_head == NULL;
+  *g_rcu_tail = head;
+  g_rcu_tail = &head->next;
+
+  spin_unlock_irqrestore(&g_rcu_lock, flags);
+
+  /* The worker drains the whole list, it only has to be queued when the
+   * first callback of a batch arrives.
+   */
+
+  if (empty)
+    {
+      work_queue(LPWORK, &g_rcu_work, rcu_worker, NULL, 0);
+    }
+}
@@ -57,6 +57,7 @@
 #define list_waitingforsignal()  (&g_waitingforsignal)
 #define list_waitingforfill()    (&g_waitingforfill)
 #define list_stoppedtasks()      (&g_stoppedtasks)
+#define list_throttledtasks()    (&g_throttledtasks)
 #define list_inactivetasks()     (&g_inactivetasks)
 #define list_assignedtasks(cpu)  (&g_assignedtasks[cpu])
 
@@ -223,6 +224,14 @@ extern dq_queue_t g_waitingforfill;
 extern dq_queue_t g_stoppedtasks;
 #endif
 
+/* This is the list of all SCHED_DEADLINE threads that have exhausted their
+ * budget and wait for the next period
+ */
+
+#ifdef CONFIG_SCHED_DEADLINE
+extern dq_queue_t g_throttledtasks;
+#endif
+
 /* This the list of all tasks that have been initialized, but not yet
  * activated. NOTE:  This is the only list that is not prioritized.
  */
@@ -243,6 +252,14 @@ extern volatile pid_t g_lastpid;
 extern FAR struct tcb_s **g_pidhash;
 extern volatile int g_npidhash;
 
+#ifdef CONFIG_RCU
+/* nxsched_get_tcb() reads g_pidhash and g_npidhash without a lock.  This
+ * count is odd while nxtask_assign_pid() replaces the pair.
+ */
+
+extern volatile unsigned int g_pidhash_seq;
+#endif
+
 /* This is a table of task lists.  This table is indexed by the task stat
  * enumeration type (tstate_t) and provides a pointer to the associated
  * static task list (if there is one) as well as a a set of attribute flags
@@ -260,6 +277,14 @@ extern struct tasklist_s g_tasklisttable[NUM_TASK_STATES];
 extern volatile clock_t g_cpuload_total;
 #endif
 
+#ifdef CONFIG_SCHED_LATENCYMON
+/* Declared in sched_latencymon.c.  The time of the entry of the last
+ * interrupt on each CPU, used to measure IRQ-to-thread latency.
+ */
+
+extern clock_t g_latency_irqstart[CONFIG_SMP_NCPUS];
+#endif
+
 /* Declared in sched_lock.c *************************************************/
 
 /* Pre-emption is disabled via the interface sched_lock(). sched_lock()
@@ -354,6 +379,15 @@ uint32_t nxsched_process_sporadic(FAR struct tcb_s *tcb, uint32_t ticks,
 void nxsched_sporadic_lowpriority(FAR struct tcb_s *tcb);
 #endif
 
+#ifdef CONFIG_SCHED_DEADLINE
+int  nxsched_start_deadline(FAR struct tcb_s *tcb, clock_t runtime,
+                            clock_t deadline, clock_t period);
+int  nxsched_stop_deadline(FAR struct tcb_s *tcb);
+void nxsched_wakeup_deadline(FAR struct tcb_s *tcb);
+void nxsched_resume_deadline(FAR struct tcb_s *tcb);
+void nxsched_suspend_deadline(FAR struct tcb_s *tcb);
+#endif
+
 #ifdef CONFIG_SIG_SIGSTOP_ACTION
 void nxsched_suspend(FAR struct tcb_s *tcb);
 #endif
@@ -422,10 +456,32 @@ void nxsched_critmon_csection(FAR struct tcb_s *tcb, bool state,
                               FAR void *caller);
 #endif
 
+/* Scheduling latency histograms */
+
+#ifdef CONFIG_SCHED_LATENCYMON
+void nxsched_wakeup_latencymon(FAR struct tcb_s *tcb);
+void nxsched_resume_latencymon(FAR struct tcb_s *tcb);
+void nxsched_csection_latencymon(FAR struct tcb_s *tcb, clock_t elapsed);
+#endif
+
+/* RCU quiescent state reporting */
+
+#if defined(CONFIG_RCU) && defined(CONFIG_SMP)
+void nxsched_rcu_quiescent(void);
+#else
+#  define nxsched_rcu_quiescent()
+#endif
+
 /* TCB operations */
 
 bool nxsched_verify_tcb(FAR struct tcb_s *tcb);
 
+#ifdef CONFIG_MM_KMEM_CACHE
+void nxsched_initialize_tcbcache(void);
+#else
+#  define nxsched_initialize_tcbcache()
+#endif
+
 /* Obtain TLS from kernel */
 
 struct tls_info_s; /* Forward declare */
@@ -436,6 +492,25 @@ FAR char **nxsched_get_stackargs(FAR struct tcb_s *tcb);
  * Inline functions
  ****************************************************************************/
 
+/* Earliest deadline first: SCHED_DEADLINE threads all run at the same
+ * priority and are ordered among themselves by their absolute deadline.
+ * Returns true if tcb1 must be placed ahead of tcb2 of equal priority.
+ */
+
+#ifdef CONFIG_SCHED_DEADLINE
+static inline_function bool nxsched_edf_before(FAR struct tcb_s *tcb1,
+                                               FAR struct tcb_s *tcb2)
+{
+  return tcb1->sched_priority == tcb2->sched_priority &&
+         (tcb1->flags & TCB_FLAG_POLICY_MASK) == TCB_FLAG_SCHED_DEADLINE &&
+         (tcb2->flags & TCB_FLAG_POLICY_MASK) == TCB_FLAG_SCHED_DEADLINE &&
+         (sclock_t)(tcb1->deadline->abs_deadline -
+                    tcb2->deadline->abs_deadline) < 0;
+}
+#else
+#  define nxsched_edf_before(tcb1, tcb2) false
+#endif
+
 static inline_function bool nxsched_add_prioritized(FAR struct tcb_s *tcb,
                                                     DSEG dq_queue_t *list)
 {
@@ -453,7 +528,8 @@ static inline_function bool nxsched_add_prioritized(FAR struct tcb_s *tcb,
    */
 
   for (next = (FAR struct tcb_s *)list->head;
-       (next && sched_priority <= next->sched_priority);
+       (next && sched_priority <= next->sched_priority &&
+        !nxsched_edf_before(tcb, next));
        next = next->flink);
 
   /* Add the tcb to the spot found in the list.  Check if the tcb
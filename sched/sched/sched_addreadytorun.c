@@ -71,13 +71,38 @@ bool nxsched_add_readytorun(FAR struct tcb_s *btcb)
   FAR struct tcb_s *rtcb = this_task();
   bool ret;
 
+#ifdef CONFIG_SCHED_DEADLINE
+  /* A deadline thread returning from a wait starts a new job and may need
+   * a new deadline.  Activation and SIGSTOP/SIGCONT go through
+   * nxsched_remove_blocked() first, which leaves the thread in
+   * TSTATE_TASK_INVALID, and do not start a new job.
+   */
+
+  if (btcb->task_state > TSTATE_TASK_INACTIVE &&
+      (btcb->flags & TCB_FLAG_POLICY_MASK) == TCB_FLAG_SCHED_DEADLINE)
+    {
+      nxsched_wakeup_deadline(btcb);
+    }
+#endif
+
+#ifdef CONFIG_SCHED_LATENCYMON
+  /* Only threads returning from a wait, not activation or SIGCONT */
+
+  if (btcb->task_state > TSTATE_TASK_INACTIVE)
+    {
+      nxsched_wakeup_latencymon(btcb);
+    }
+#endif
+
   /* Check if pre-emption is disabled for the current running task and if
    * the new ready-to-run task would cause the current running task to be
    * pre-empted.  NOTE that IRQs disabled implies that pre-emption is
    * also disabled.
    */
 
-  if (rtcb->lockcount > 0 && rtcb->sched_priority < btcb->sched_priority)
+  if (rtcb->lockcount > 0 &&
+      (rtcb->sched_priority < btcb->sched_priority ||
+       nxsched_edf_before(btcb, rtcb)))
     {
       /* Yes.  Preemption would occur!  Add the new ready-to-run task to the
        * g_pendingtasks task list for now.
@@ -161,6 +186,29 @@ bool nxsched_add_readytorun(FAR struct tcb_s *btcb)
   int cpu;
   int me;
 
+#ifdef CONFIG_SCHED_DEADLINE
+  /* A deadline thread returning from a wait starts a new job and may need
+   * a new deadline.  Activation and SIGSTOP/SIGCONT go through
+   * nxsched_remove_blocked() first, which leaves the thread in
+   * TSTATE_TASK_INVALID, and do not start a new job.
+   */
+
+  if (btcb->task_state > TSTATE_TASK_INACTIVE &&
+      (btcb->flags & TCB_FLAG_POLICY_MASK) == TCB_FLAG_SCHED_DEADLINE)
+    {
+      nxsched_wakeup_deadline(btcb);
+    }
+#endif
+
+#ifdef CONFIG_SCHED_LATENCYMON
+  /* Only threads returning from a wait, not activation or SIGCONT */
+
+  if (btcb->task_state > TSTATE_TASK_INACTIVE)
+    {
+      nxsched_wakeup_latencymon(btcb);
+    }
+#endif
+
   cpu = nxsched_select_cpu(btcb->affinity);
 
   /* Get the task currently running on the CPU (may be the IDLE task) */
@@ -173,7 +221,8 @@ bool nxsched_add_readytorun(FAR struct tcb_s *btcb)
    * required.
    */
 
-  if (rtcb->sched_priority < btcb->sched_priority)
+  if (rtcb->sched_priority < btcb->sched_priority ||
+      nxsched_edf_before(btcb, rtcb))
     {
       task_state = TSTATE_TASK_RUNNING;
     }
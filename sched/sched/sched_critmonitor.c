@@ -257,6 +257,10 @@ void nxsched_critmon_csection(FAR struct tcb_s *tcb, bool state,
         {
           g_crit_max[cpu] = elapsed;
         }
+
+#ifdef CONFIG_SCHED_LATENCYMON
+      nxsched_csection_latencymon(tcb, elapsed);
+#endif
     }
 }
 #endif /* CONFIG_SCHED_CRITMONITOR_MAXTIME_CSECTION >= 0 */
@@ -0,0 +1,639 @@
+/****************************************************************************
+ * sched/sched/sched_deadline.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <debug.h>
+#include <errno.h>
+
+#include <nuttx/sched.h>
+#include <nuttx/arch.h>
+#include <nuttx/wdog.h>
+#include <nuttx/clock.h>
+#include <nuttx/kmalloc.h>
+
+#include "sched/sched.h"
+
+#ifdef CONFIG_SCHED_DEADLINE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Bandwidth (runtime / period) is kept in 12.20 fixed point */
+
+#define DEADLINE_BW_SHIFT 20
+#define DEADLINE_BW(q, p) \
+  ((uint32_t)(((uint64_t)(q) << DEADLINE_BW_SHIFT) / (p)))
+
+#ifdef CONFIG_SMP
+#  define DEADLINE_NCPUS  CONFIG_SMP_NCPUS
+#else
+#  define DEADLINE_NCPUS  1
+#endif
+
+#define DEADLINE_BW_LIMIT \
+  ((uint64_t)DEADLINE_NCPUS * \
+   (((uint64_t)CONFIG_SCHED_DEADLINE_MAXUTIL << DEADLINE_BW_SHIFT) / 100))
+
+/****************************************************************************
+ * Private Type Declarations
+ ****************************************************************************/
+
+#ifdef CONFIG_SMP
+struct deadline_arg_s
+{
+  pid_t pid;
+  cpu_set_t saved_affinity;
+  uint16_t saved_flags;
+  bool need_restore;
+};
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Total bandwidth reserved by all deadline threads */
+
+static uint64_t g_deadline_bw;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: deadline_preempted
+ *
+ * Description:
+ *   Return true if a ready-to-run thread of the same priority now has an
+ *   earlier deadline than the running deadline thread tcb.
+ *
+ ****************************************************************************/
+
+static bool deadline_preempted(FAR struct tcb_s *tcb)
+{
+  FAR struct tcb_s *next;
+
+  /* On SMP the running thread is not in the ready-to-run list; skip the
+   * higher priority threads that could not run on its CPU.
+   */
+
+#ifdef CONFIG_SMP
+  next = (FAR struct tcb_s *)list_readytorun()->head;
+#else
+  next = tcb->flink;
+#endif
+
+  while (next != NULL && next->sched_priority > tcb->sched_priority)
+    {
+      next = next->flink;
+    }
+
+  return next != NULL && nxsched_edf_before(next, tcb);
+}
+
+#ifdef CONFIG_SMP
+/****************************************************************************
+ * Name: deadline_throttle_handler
+ *
+ * Description:
+ *   Throttle a deadline thread that is running on this CPU on behalf of
+ *   deadline_throttle() on another CPU.
+ *
+ ****************************************************************************/
+
+static int deadline_throttle_handler(FAR void *cookie)
+{
+  FAR struct deadline_arg_s *arg = cookie;
+  FAR struct tcb_s *tcb;
+  irqstate_t flags;
+
+  flags = enter_critical_section();
+  tcb = nxsched_get_tcb(arg->pid);
+
+  if (!tcb || tcb->task_state != TSTATE_TASK_RUNNING ||
+      (tcb->flags & TCB_FLAG_EXIT_PROCESSING) != 0)
+    {
+      leave_critical_section(flags);
+      return OK;
+    }
+
+  if (arg->need_restore)
+    {
+      tcb->affinity = arg->saved_affinity;
+      tcb->flags = arg->saved_flags;
+    }
+
+  nxsched_remove_readytorun(tcb);
+
+  tcb->task_state = TSTATE_TASK_THROTTLED;
+  dq_addlast((FAR dq_entry_t *)tcb, list_throttledtasks());
+
+  leave_critical_section(flags);
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: deadline_throttle
+ *
+ * Description:
+ *   Take a running deadline thread that has exhausted its budget off the
+ *   CPU and block it in the throttled state.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+static void deadline_throttle(FAR struct tcb_s *tcb)
+{
+  FAR struct tcb_s *rtcb = this_task();
+  bool switch_needed;
+
+  DEBUGASSERT(tcb->task_state == TSTATE_TASK_RUNNING);
+
+#ifdef CONFIG_SMP
+  if (tcb->cpu != this_cpu())
+    {
+      struct deadline_arg_s arg;
+
+      arg.pid = tcb->pid;
+      if ((tcb->flags & TCB_FLAG_CPU_LOCKED) != 0)
+        {
+          arg.need_restore = false;
+        }
+      else
+        {
+          arg.saved_flags = tcb->flags;
+          arg.saved_affinity = tcb->affinity;
+          arg.need_restore = true;
+
+          tcb->flags |= TCB_FLAG_CPU_LOCKED;
+          CPU_SET(tcb->cpu, &tcb->affinity);
+        }
+
+      nxsched_smp_call_single(tcb->cpu, deadline_throttle_handler, &arg);
+      return;
+    }
+#endif
+
+  switch_needed = nxsched_remove_readytorun(tcb);
+
+  if (list_pendingtasks()->head)
+    {
+      switch_needed |= nxsched_merge_pending();
+    }
+
+  tcb->task_state = TSTATE_TASK_THROTTLED;
+  dq_addlast((FAR dq_entry_t *)tcb, list_throttledtasks());
+
+  if (switch_needed)
+    {
+      up_switch_context(this_task(), rtcb);
+    }
+}
+
+/****************************************************************************
+ * Name: deadline_unthrottle
+ *
+ * Description:
+ *   Make a throttled deadline thread ready-to-run again.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+static void deadline_unthrottle(FAR struct tcb_s *tcb)
+{
+  FAR struct tcb_s *rtcb = this_task();
+
+  DEBUGASSERT(tcb->task_state == TSTATE_TASK_THROTTLED);
+
+  /* nxsched_remove_blocked() leaves the thread in TSTATE_TASK_INVALID, so
+   * nxsched_add_readytorun() does not apply the CBS wake-up rule: the
+   * thread already has the budget and deadline of its new period.
+   */
+
+  nxsched_remove_blocked(tcb);
+  if (nxsched_add_readytorun(tcb))
+    {
+      up_switch_context(tcb, rtcb);
+    }
+}
+
+/****************************************************************************
+ * Name: deadline_replenish
+ *
+ * Description:
+ *   The next period of a throttled thread has begun.  Refill its budget
+ *   and make it ready-to-run again.  Its deadline was already set to that
+ *   of the new period when it was throttled.
+ *
+ * Input Parameters:
+ *   Standard watchdog parameters
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+static void deadline_replenish(wdparm_t arg)
+{
+  FAR struct deadline_s *deadline = (FAR struct deadline_s *)arg;
+  FAR struct tcb_s *tcb;
+  irqstate_t flags;
+
+  DEBUGASSERT(deadline != NULL && deadline->tcb != NULL);
+  tcb = deadline->tcb;
+
+  flags = enter_critical_section();
+
+  deadline->budget = deadline->runtime;
+
+  /* The thread may have been stopped by SIGSTOP meanwhile, SIGCONT will
+   * then resume it with the new budget.
+   */
+
+  if (tcb->task_state == TSTATE_TASK_THROTTLED)
+    {
+      deadline_unthrottle(tcb);
+    }
+
+  leave_critical_section(flags);
+}
+
+/****************************************************************************
+ * Name: deadline_budget_expire
+ *
+ * Description:
+ *   The running thread has used up the runtime of its current period.
+ *   Following the constant bandwidth server rules, it is throttled until
+ *   its next period begins, then continues with a fresh budget and the
+ *   deadline of that period.  An overrunning thread can thus only consume
+ *   its own bandwidth.
+ *
+ *   If the next period has already begun, or the thread has locked the
+ *   scheduler, it is not throttled: its deadline is postponed by one
+ *   period and the budget refilled at once.
+ *
+ * Input Parameters:
+ *   Standard watchdog parameters
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+static void deadline_budget_expire(wdparm_t arg)
+{
+  FAR struct deadline_s *deadline = (FAR struct deadline_s *)arg;
+  FAR struct tcb_s *tcb;
+  irqstate_t flags;
+  clock_t release;
+  clock_t now;
+
+  DEBUGASSERT(deadline != NULL && deadline->tcb != NULL);
+  tcb = deadline->tcb;
+
+  flags = enter_critical_section();
+
+  now     = clock_systime_ticks();
+  release = deadline->abs_deadline - deadline->deadline + deadline->period;
+
+  deadline->noverruns++;
+  deadline->abs_deadline += deadline->period;
+
+  if ((sclock_t)(release - now) > 0 && !nxsched_islocked_tcb(tcb))
+    {
+      /* Block the thread until the next period begins.  It is no longer
+       * running, so nxsched_suspend_deadline() leaves the timer alone.
+       */
+
+      deadline->budget = 0;
+      deadline_throttle(tcb);
+      wd_start_abstick(&deadline->timer, release,
+                       deadline_replenish, (wdparm_t)deadline);
+      leave_critical_section(flags);
+      return;
+    }
+
+  deadline->budget    = deadline->runtime;
+  deadline->eventtime = now;
+
+  /* Keep charging while the thread continues to run; a context switch
+   * below will cancel the timer through nxsched_suspend_deadline().
+   */
+
+  wd_start(&deadline->timer, deadline->budget,
+           deadline_budget_expire, (wdparm_t)deadline);
+
+  /* Re-sort the thread in the ready-to-run list by its new deadline, but
+   * only if another thread's deadline is now earlier: re-setting the same
+   * priority yields to the next thread of that priority whatever its
+   * deadline.  If the scheduler is locked, this happens when the thread
+   * next blocks.
+   */
+
+  if (!nxsched_islocked_tcb(this_task()) && deadline_preempted(tcb))
+    {
+      nxsched_set_priority(tcb, tcb->sched_priority);
+    }
+
+  leave_critical_section(flags);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxsched_start_deadline
+ *
+ * Description:
+ *   Assign (or change) the SCHED_DEADLINE parameters of a thread, subject
+ *   to admission control.  On success, the caller is responsible for
+ *   stopping any sporadic scheduling of the thread and for moving it to
+ *   CONFIG_SCHED_DEADLINE_PRIORITY afterwards.
+ *
+ * Input Parameters:
+ *   tcb      - The TCB of the thread
+ *   runtime  - Budget per period in clock ticks
+ *   deadline - Relative deadline in clock ticks
+ *   period   - Period in clock ticks
+ *
+ * Returned Value:
+ *   Returns zero (OK) on success or a negated errno value on failure:
+ *
+ *   EINVAL - The parameters do not satisfy runtime <= deadline <= period
+ *   EBUSY  - Admitting the thread would exceed the bandwidth limit
+ *   ENOMEM - Failed to allocate the deadline state
+ *
+ ****************************************************************************/
+
+int nxsched_start_deadline(FAR struct tcb_s *tcb, clock_t runtime,
+                           clock_t deadline, clock_t period)
+{
+  FAR struct deadline_s *dl;
+  irqstate_t flags;
+  uint32_t bw;
+  uint64_t total;
+  clock_t now;
+
+  if (runtime == 0 || runtime > deadline || deadline > period)
+    {
+      return -EINVAL;
+    }
+
+  bw = DEADLINE_BW(runtime, period);
+
+  /* Allocate the add-on outside of the critical section */
+
+  dl = tcb->deadline;
+  if (dl == NULL)
+    {
+      dl = kmm_zalloc(sizeof(struct deadline_s));
+      if (dl == NULL)
+        {
+          serr("ERROR: Failed to allocate deadline data structure\n");
+          return -ENOMEM;
+        }
+
+      dl->tcb = tcb;
+    }
+
+  flags = enter_critical_section();
+
+  /* Admission control: the thread's previous reservation, if any, is
+   * replaced by the new one.
+   */
+
+  total = g_deadline_bw + bw;
+  if (tcb->deadline != NULL)
+    {
+      total -= tcb->deadline->bandwidth;
+    }
+
+  if (total > DEADLINE_BW_LIMIT)
+    {
+      leave_critical_section(flags);
+      if (tcb->deadline == NULL)
+        {
+          kmm_free(dl);
+        }
+
+      return -EBUSY;
+    }
+
+  g_deadline_bw = total;
+
+  wd_cancel(&dl->timer);
+
+  now              = clock_systime_ticks();
+  dl->runtime      = runtime;
+  dl->deadline     = deadline;
+  dl->period       = period;
+  dl->bandwidth    = bw;
+  dl->abs_deadline = now + deadline;
+  dl->budget       = runtime;
+  dl->eventtime    = now;
+
+  tcb->deadline    = dl;
+  tcb->flags       = (tcb->flags & ~TCB_FLAG_POLICY_MASK) |
+                     TCB_FLAG_SCHED_DEADLINE;
+
+  /* If the thread is already running, start charging it now.  Otherwise
+   * nxsched_resume_deadline() will do that when it is next scheduled.
+   */
+
+  if (tcb->task_state == TSTATE_TASK_RUNNING)
+    {
+      wd_start(&dl->timer, runtime, deadline_budget_expire, (wdparm_t)dl);
+    }
+  else if (tcb->task_state == TSTATE_TASK_THROTTLED)
+    {
+      /* The new parameters come with a fresh budget */
+
+      deadline_unthrottle(tcb);
+    }
+
+  leave_critical_section(flags);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxsched_stop_deadline
+ *
+ * Description:
+ *   Stop deadline scheduling of a thread, release its bandwidth and free
+ *   the deadline state.  The thread reverts to SCHED_FIFO and, if it was
+ *   throttled, becomes ready-to-run again.  Called when the thread exits
+ *   or another policy is selected.
+ *
+ * Input Parameters:
+ *   tcb - The TCB of the thread
+ *
+ * Returned Value:
+ *   Returns zero (OK) on success or a negated errno value on failure.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+int nxsched_stop_deadline(FAR struct tcb_s *tcb)
+{
+  FAR struct deadline_s *dl = tcb->deadline;
+
+  DEBUGASSERT(dl != NULL);
+
+  wd_cancel(&dl->timer);
+  g_deadline_bw -= dl->bandwidth;
+
+  if (tcb->task_state == TSTATE_TASK_THROTTLED &&
+      (tcb->flags & TCB_FLAG_EXIT_PROCESSING) == 0)
+    {
+      deadline_unthrottle(tcb);
+    }
+
+  tcb->flags    = (tcb->flags & ~TCB_FLAG_POLICY_MASK) |
+                  TCB_FLAG_SCHED_FIFO;
+  tcb->deadline = NULL;
+
+  kmm_free(dl);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxsched_wakeup_deadline
+ *
+ * Description:
+ *   Called when a deadline thread returns from a wait (not on activation
+ *   or SIGCONT), before it is added to the ready-to-run list.  If the
+ *   remaining budget can not be consumed before the current deadline
+ *   without exceeding the reserved bandwidth, a new period starts: the
+ *   deadline is set relative to now and the budget is refilled.  This is
+ *   the CBS wake-up rule.
+ *
+ * Input Parameters:
+ *   tcb - The TCB of the thread that is waking up
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void nxsched_wakeup_deadline(FAR struct tcb_s *tcb)
+{
+  FAR struct deadline_s *dl = tcb->deadline;
+  clock_t now = clock_systime_ticks();
+  sclock_t left;
+
+  DEBUGASSERT(dl != NULL);
+
+  /* budget / left > runtime / deadline, computed without division */
+
+  left = (sclock_t)(dl->abs_deadline - now);
+  if (left <= 0 ||
+      (uint64_t)dl->budget * dl->deadline > (uint64_t)left * dl->runtime)
+    {
+      dl->abs_deadline = now + dl->deadline;
+      dl->budget       = dl->runtime;
+    }
+}
+
+/****************************************************************************
+ * Name: nxsched_resume_deadline
+ *
+ * Description:
+ *   Called when a deadline thread is given the CPU.  Start the timer that
+ *   fires when its remaining budget is exhausted.
+ *
+ * Input Parameters:
+ *   tcb - The TCB of the thread that is about to run
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void nxsched_resume_deadline(FAR struct tcb_s *tcb)
+{
+  FAR struct deadline_s *dl = tcb->deadline;
+
+  DEBUGASSERT(dl != NULL);
+
+  dl->eventtime = clock_systime_ticks();
+  wd_start(&dl->timer, dl->budget > 0 ? dl->budget : 1,
+           deadline_budget_expire, (wdparm_t)dl);
+}
+
+/****************************************************************************
+ * Name: nxsched_suspend_deadline
+ *
+ * Description:
+ *   Called when a deadline thread gives up the CPU.  Charge the time it
+ *   ran to its budget.  If it blocked (i.e. completed its job) after its
+ *   deadline, count a deadline miss.  Nothing is done for a thread that is
+ *   being throttled: its budget is spent and the timer now waits for its
+ *   next period.
+ *
+ * Input Parameters:
+ *   tcb - The TCB of the thread that is being suspended
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void nxsched_suspend_deadline(FAR struct tcb_s *tcb)
+{
+  FAR struct deadline_s *dl = tcb->deadline;
+  clock_t now = clock_systime_ticks();
+
+  DEBUGASSERT(dl != NULL);
+
+  if (tcb->task_state == TSTATE_TASK_THROTTLED)
+    {
+      return;
+    }
+
+  wd_cancel(&dl->timer);
+  dl->budget -= (sclock_t)(now - dl->eventtime);
+
+  if (tcb->task_state >= FIRST_BLOCKED_STATE &&
+      (sclock_t)(now - dl->abs_deadline) > 0)
+    {
+      dl->nmisses++;
+    }
+}
+
+#endif /* CONFIG_SCHED_DEADLINE */
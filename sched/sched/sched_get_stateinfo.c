@@ -61,6 +61,9 @@ static FAR const char * const g_statenames[] =
 #ifdef CONFIG_SIG_SIGSTOP_ACTION
   , "Stopped"
 #endif
+#ifdef CONFIG_SCHED_DEADLINE
+  , "Throttled"
+#endif
 };
 
 /****************************************************************************
@@ -0,0 +1,114 @@
+/****************************************************************************
+ * sched/sched/sched_getattr.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sched.h>
+#include <string.h>
+#include <errno.h>
+
+#include <nuttx/sched.h>
+#include <nuttx/irq.h>
+#include <nuttx/clock.h>
+
+#include "sched/sched.h"
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_getattr
+ *
+ * Description:
+ *   sched_getattr() returns the scheduling policy and attributes of the
+ *   thread identified by pid (zero for the calling thread).
+ *
+ * Input Parameters:
+ *   pid   - The thread ID, or zero for the calling thread
+ *   attr  - Location to return the attributes
+ *   size  - Size of the caller's struct sched_attr
+ *   flags - Reserved, must be zero
+ *
+ * Returned Value:
+ *   On success, sched_getattr() returns OK (zero).  On error, ERROR (-1)
+ *   is returned, and errno is set appropriately:
+ *
+ *   EINVAL attr is NULL, size is too small or flags is not zero.
+ *   ESRCH  The thread whose ID is pid could not be found.
+ *
+ ****************************************************************************/
+
+int sched_getattr(pid_t pid, FAR struct sched_attr *attr,
+                  unsigned int size, unsigned int flags)
+{
+  FAR struct tcb_s *tcb;
+  irqstate_t irqflags;
+  int ret = OK;
+
+  if (attr == NULL || size < sizeof(struct sched_attr) || flags != 0)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  irqflags = enter_critical_section();
+
+  tcb = pid == 0 ? this_task() : nxsched_get_tcb(pid);
+  if (tcb == NULL)
+    {
+      ret = -ESRCH;
+      goto out;
+    }
+
+  memset(attr, 0, sizeof(struct sched_attr));
+  attr->size           = sizeof(struct sched_attr);
+  attr->sched_policy   = nxsched_get_scheduler(tcb->pid);
+  attr->sched_priority = tcb->sched_priority;
+
+#ifdef CONFIG_SCHED_DEADLINE
+  if ((tcb->flags & TCB_FLAG_POLICY_MASK) == TCB_FLAG_SCHED_DEADLINE)
+    {
+      FAR struct deadline_s *dl = tcb->deadline;
+
+      attr->sched_runtime  = TICK2NSEC((uint64_t)dl->runtime);
+      attr->sched_deadline = TICK2NSEC((uint64_t)dl->deadline);
+      attr->sched_period   = TICK2NSEC((uint64_t)dl->period);
+    }
+#endif
+
+out:
+  leave_critical_section(irqflags);
+
+  if (ret < 0)
+    {
+      set_errno(-ret);
+      ret = ERROR;
+    }
+
+  return ret;
+}
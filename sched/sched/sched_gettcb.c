@@ -30,6 +30,10 @@
 
 #include "nuttx/irq.h"
 
+#ifdef CONFIG_RCU
+#  include <nuttx/rcu.h>
+#endif
+
 #include "sched/sched.h"
 
 /****************************************************************************
@@ -50,11 +54,59 @@
  *   should establish the critical section BEFORE calling this function and
  *   hold that critical section as long as necessary.
  *
+ *   With CONFIG_RCU the lookup takes no lock at all and TCBs are freed
+ *   only after an RCU grace period, so callers may instead hold
+ *   rcu_read_lock() while using the TCB.
+ *
  ****************************************************************************/
 
 FAR struct tcb_s *nxsched_get_tcb(pid_t pid)
 {
   FAR struct tcb_s *ret = NULL;
+#ifdef CONFIG_RCU
+  FAR struct tcb_s **pidhash;
+  FAR struct tcb_s *tcb;
+  unsigned int seq;
+  int npidhash;
+
+  if (pid < 0)
+    {
+      return NULL;
+    }
+
+  rcu_read_lock();
+
+  /* Retry if nxtask_assign_pid() replaced the table while it was being
+   * read.  It publishes the new table before its size, and the size is
+   * read here before the table, so the index is always within the table
+   * that is read.
+   */
+
+  do
+    {
+      seq = g_pidhash_seq;
+      SP_DMB();
+
+      npidhash = g_npidhash;
+      SP_DMB();
+      pidhash  = rcu_dereference(g_pidhash);
+      ret      = NULL;
+
+      if (pidhash != NULL)
+        {
+          tcb = rcu_dereference(pidhash[pid & (npidhash - 1)]);
+          if (tcb != NULL && tcb->pid == pid)
+            {
+              ret = tcb;
+            }
+        }
+
+      SP_DMB();
+    }
+  while ((seq & 1) != 0 || seq != g_pidhash_seq);
+
+  rcu_read_unlock();
+#else
   irqstate_t flags;
   int hash_ndx;
 
@@ -87,6 +139,7 @@ FAR struct tcb_s *nxsched_get_tcb(pid_t pid)
     }
 
   leave_critical_section(flags);
+#endif
 
   /* Return the TCB. */
 
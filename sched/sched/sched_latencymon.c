@@ -0,0 +1,555 @@
+/****************************************************************************
+ * sched/sched/sched_latencymon.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/stat.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <debug.h>
+#include <errno.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/irq.h>
+#include <nuttx/clock.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
+#include <nuttx/lib/math32.h>
+
+#include "sched/sched.h"
+
+#ifdef CONFIG_SCHED_LATENCYMON
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Bucket n counts latencies below 2^n perf_gettime() units */
+
+#define LATENCY_NBUCKETS  32
+
+/* Priorities are grouped in bands of 32 */
+
+#define LATENCY_BANDSHIFT 5
+#define LATENCY_NBANDS    ((SCHED_PRIORITY_MAX >> LATENCY_BANDSHIFT) + 1)
+#define LATENCY_BAND(p)   ((p) >> LATENCY_BANDSHIFT)
+
+/* Each non-empty histogram is output as one line:
+ *
+ *   <type> <cpu> <priority band> <count> <max> <bound>:<count> ...
+ *
+ * where the times are in nanoseconds and <bound> is the exclusive upper
+ * bound of a bucket.  The last bucket is open-ended and is printed as
+ * >=<bound>:<count> with its inclusive lower bound.  Empty buckets are
+ * omitted.
+ */
+
+#define LATENCY_LINELEN   (64 + LATENCY_NBUCKETS * 24)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+enum latency_type_e
+{
+  LATENCY_NONE = 0,                   /* Nothing to record */
+  LATENCY_WAKEUP,                     /* Woken up by a thread */
+  LATENCY_IRQ,                        /* Woken up by an interrupt */
+  LATENCY_CSECTION,                   /* Critical section length */
+  LATENCY_NTYPES
+};
+
+struct latency_hist_s
+{
+  uint32_t count;                     /* Number of samples */
+  clock_t  max;                       /* Largest sample */
+  uint32_t buckets[LATENCY_NBUCKETS];
+};
+
+/* This structure describes one open "file" */
+
+struct latency_file_s
+{
+  struct procfs_file_s base;          /* Base open file structure */
+  FAR char *buffer;                   /* User provided buffer */
+  size_t remaining;                   /* Number of available characters */
+  size_t ncopied;                     /* Number of characters in buffer */
+  off_t offset;                       /* Current file offset */
+  char line[LATENCY_LINELEN];         /* Buffer for formatted lines */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS)
+static int     latency_open(FAR struct file *filep, FAR const char *relpath,
+                            int oflags, mode_t mode);
+static int     latency_close(FAR struct file *filep);
+static ssize_t latency_read(FAR struct file *filep, FAR char *buffer,
+                            size_t buflen);
+static ssize_t latency_write(FAR struct file *filep,
+                             FAR const char *buffer, size_t buflen);
+static int     latency_dup(FAR const struct file *oldp,
+                           FAR struct file *newp);
+static int     latency_stat(FAR const char *relpath, FAR struct stat *buf);
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The histograms of a CPU are only updated by that CPU with interrupts
+ * disabled, so no lock is needed to record a sample.
+ */
+
+static struct latency_hist_s
+g_latency_hist[CONFIG_SMP_NCPUS][LATENCY_NTYPES - 1][LATENCY_NBANDS];
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS)
+static FAR const char * const g_latency_names[LATENCY_NTYPES - 1] =
+{
+  "wakeup",
+  "irq",
+  "csection"
+};
+#endif
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* Time of the entry of the last interrupt on each CPU */
+
+clock_t g_latency_irqstart[CONFIG_SMP_NCPUS];
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS)
+
+/* See fs_mount.c -- this structure is explicitly extern'ed there.
+ * We use the old-fashioned kind of initializers so that this will compile
+ * with any compiler.
+ */
+
+const struct procfs_operations g_latency_operations =
+{
+  latency_open,   /* open */
+  latency_close,  /* close */
+  latency_read,   /* read */
+  latency_write,  /* write */
+  NULL,           /* poll */
+
+  latency_dup,    /* dup */
+
+  NULL,           /* opendir */
+  NULL,           /* closedir */
+  NULL,           /* readdir */
+  NULL,           /* rewinddir */
+
+  latency_stat    /* stat */
+};
+
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: latency_record
+ *
+ * Description:
+ *   Add one sample to the histogram of the current CPU.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+static void latency_record(int type, FAR struct tcb_s *tcb,
+                           clock_t elapsed)
+{
+  FAR struct latency_hist_s *hist;
+  int bucket;
+
+  hist = &g_latency_hist[this_cpu()][type - 1]
+                        [LATENCY_BAND(tcb->sched_priority)];
+
+  bucket = elapsed > 0 ? flsx(elapsed) : 0;
+  if (bucket >= LATENCY_NBUCKETS)
+    {
+      bucket = LATENCY_NBUCKETS - 1;
+    }
+
+  hist->buckets[bucket]++;
+  hist->count++;
+
+  if (elapsed > hist->max)
+    {
+      hist->max = elapsed;
+    }
+}
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS)
+
+/****************************************************************************
+ * Name: latency_nsec
+ ****************************************************************************/
+
+static uint64_t latency_nsec(clock_t elapsed)
+{
+  struct timespec ts;
+
+  perf_convert(elapsed, &ts);
+  return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+/****************************************************************************
+ * Name: latency_format
+ *
+ * Description:
+ *   Format one histogram.  The histogram may change while it is read; that
+ *   only makes the output slightly inconsistent.
+ *
+ ****************************************************************************/
+
+static size_t latency_format(FAR struct latency_file_s *latency,
+                             int cpu, int type, int band)
+{
+  FAR struct latency_hist_s *hist = &g_latency_hist[cpu][type][band];
+  FAR char *line = latency->line;
+  size_t len = LATENCY_LINELEN;
+  size_t n;
+  int i;
+
+  n = snprintf(line, len, "%-8s %3d %3d-%-3d %10" PRIu32 " %10" PRIu64,
+               g_latency_names[type], cpu,
+               band << LATENCY_BANDSHIFT,
+               ((band + 1) << LATENCY_BANDSHIFT) - 1,
+               hist->count, latency_nsec(hist->max));
+
+  for (i = 0; i < LATENCY_NBUCKETS && n < len; i++)
+    {
+      if (hist->buckets[i] == 0)
+        {
+          continue;
+        }
+
+      if (i == LATENCY_NBUCKETS - 1)
+        {
+          n += snprintf(line + n, len - n, " >=%" PRIu64 ":%" PRIu32,
+                        latency_nsec((clock_t)1 << (i - 1)),
+                        hist->buckets[i]);
+        }
+      else
+        {
+          n += snprintf(line + n, len - n, " %" PRIu64 ":%" PRIu32,
+                        latency_nsec((clock_t)1 << i), hist->buckets[i]);
+        }
+    }
+
+  if (n < len)
+    {
+      n += snprintf(line + n, len - n, "\n");
+    }
+
+  return n < len ? n : len - 1;
+}
+
+/****************************************************************************
+ * Name: latency_output
+ ****************************************************************************/
+
+static int latency_output(FAR struct latency_file_s *latency,
+                          size_t linesize)
+{
+  size_t copysize;
+
+  copysize = procfs_memcpy(latency->line, linesize, latency->buffer,
+                           latency->remaining, &latency->offset);
+
+  latency->ncopied   += copysize;
+  latency->buffer    += copysize;
+  latency->remaining -= copysize;
+
+  /* Return a non-zero value to stop if the user-provided buffer is full */
+
+  return latency->remaining > 0 ? 0 : 1;
+}
+
+/****************************************************************************
+ * Name: latency_open
+ ****************************************************************************/
+
+static int latency_open(FAR struct file *filep, FAR const char *relpath,
+                        int oflags, mode_t mode)
+{
+  FAR struct latency_file_s *latency;
+
+  finfo("Open '%s'\n", relpath);
+
+  /* Allocate a container to hold the file attributes */
+
+  latency = kmm_zalloc(sizeof(struct latency_file_s));
+  if (latency == NULL)
+    {
+      ferr("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* Save the attributes as the open-specific state in filep->f_priv */
+
+  filep->f_priv = latency;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: latency_close
+ ****************************************************************************/
+
+static int latency_close(FAR struct file *filep)
+{
+  FAR struct latency_file_s *latency = filep->f_priv;
+
+  DEBUGASSERT(latency != NULL);
+
+  kmm_free(latency);
+  filep->f_priv = NULL;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: latency_read
+ ****************************************************************************/
+
+static ssize_t latency_read(FAR struct file *filep, FAR char *buffer,
+                            size_t buflen)
+{
+  FAR struct latency_file_s *latency = filep->f_priv;
+  int cpu;
+  int type;
+  int band;
+
+  DEBUGASSERT(latency != NULL);
+
+  latency->offset    = filep->f_pos;
+  latency->buffer    = buffer;
+  latency->remaining = buflen;
+  latency->ncopied   = 0;
+
+  if (latency_output(latency,
+                     snprintf(latency->line, LATENCY_LINELEN,
+                              "%-8s %3s %-7s %10s %10s %s\n",
+                              "TYPE", "CPU", "PRIO", "COUNT", "MAX(ns)",
+                              "HISTOGRAM(<ns:count)")) != 0)
+    {
+      goto out;
+    }
+
+  for (type = 0; type < LATENCY_NTYPES - 1; type++)
+    {
+      for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+        {
+          for (band = 0; band < LATENCY_NBANDS; band++)
+            {
+              if (g_latency_hist[cpu][type][band].count != 0 &&
+                  latency_output(latency,
+                                 latency_format(latency, cpu, type,
+                                                band)) != 0)
+                {
+                  goto out;
+                }
+            }
+        }
+    }
+
+out:
+  filep->f_pos += latency->ncopied;
+  return latency->ncopied;
+}
+
+/****************************************************************************
+ * Name: latency_write
+ *
+ * Description:
+ *   Writing "reset" clears all histograms.
+ *
+ ****************************************************************************/
+
+static ssize_t latency_write(FAR struct file *filep,
+                             FAR const char *buffer, size_t buflen)
+{
+  irqstate_t flags;
+
+  if (buflen < 5 || strncmp(buffer, "reset", 5) != 0)
+    {
+      return -EINVAL;
+    }
+
+  flags = enter_critical_section();
+  memset(g_latency_hist, 0, sizeof(g_latency_hist));
+  leave_critical_section(flags);
+
+  return buflen;
+}
+
+/****************************************************************************
+ * Name: latency_dup
+ *
+ * Description:
+ *   Duplicate open file data in the new file structure.
+ *
+ ****************************************************************************/
+
+static int latency_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+  FAR struct latency_file_s *oldattr = oldp->f_priv;
+  FAR struct latency_file_s *newattr;
+
+  DEBUGASSERT(oldattr != NULL);
+
+  newattr = kmm_malloc(sizeof(struct latency_file_s));
+  if (newattr == NULL)
+    {
+      ferr("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  memcpy(newattr, oldattr, sizeof(struct latency_file_s));
+  newp->f_priv = newattr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: latency_stat
+ *
+ * Description: Return information about a file or directory
+ *
+ ****************************************************************************/
+
+static int latency_stat(FAR const char *relpath, FAR struct stat *buf)
+{
+  memset(buf, 0, sizeof(struct stat));
+  buf->st_mode = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR | S_IWUSR;
+  return OK;
+}
+
+#endif /* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS */
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxsched_wakeup_latencymon
+ *
+ * Description:
+ *   Called when a thread returning from a wait is made ready-to-run.
+ *   Task activation and SIGSTOP/SIGCONT are not wakeups and are not
+ *   recorded.  Remember when that happened; if it happened in an interrupt
+ *   handler, the latency is measured from the entry of the interrupt
+ *   instead.
+ *
+ * Input Parameters:
+ *   tcb - The TCB of the thread that is woken up
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+void nxsched_wakeup_latencymon(FAR struct tcb_s *tcb)
+{
+  if (up_interrupt_context())
+    {
+      tcb->wake_start = g_latency_irqstart[this_cpu()];
+      tcb->wake_type  = LATENCY_IRQ;
+    }
+  else
+    {
+      tcb->wake_start = perf_gettime();
+      tcb->wake_type  = LATENCY_WAKEUP;
+    }
+}
+
+/****************************************************************************
+ * Name: nxsched_resume_latencymon
+ *
+ * Description:
+ *   Called when a thread is given the CPU.  If it was woken up since it
+ *   last ran, record the time it took to get here.
+ *
+ * Input Parameters:
+ *   tcb - The TCB of the thread that is about to run
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+void nxsched_resume_latencymon(FAR struct tcb_s *tcb)
+{
+  if (tcb->wake_type != LATENCY_NONE)
+    {
+      latency_record(tcb->wake_type, tcb, perf_gettime() - tcb->wake_start);
+      tcb->wake_type = LATENCY_NONE;
+    }
+}
+
+/****************************************************************************
+ * Name: nxsched_csection_latencymon
+ *
+ * Description:
+ *   Called by the critical section monitor when a thread leaves a critical
+ *   section.
+ *
+ * Input Parameters:
+ *   tcb     - The TCB of the thread that left the critical section
+ *   elapsed - The time spent in the critical section
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+void nxsched_csection_latencymon(FAR struct tcb_s *tcb, clock_t elapsed)
+{
+  latency_record(LATENCY_CSECTION, tcb, elapsed);
+}
+
+#endif /* CONFIG_SCHED_LATENCYMON */
@@ -107,7 +107,8 @@ bool nxsched_merge_pending(void)
            */
 
           for (;
-               (rtcb && ptcb->sched_priority <= rtcb->sched_priority);
+               (rtcb && ptcb->sched_priority <= rtcb->sched_priority &&
+                !nxsched_edf_before(ptcb, rtcb));
                rtcb = rtcb->flink)
             {
             }
@@ -50,7 +50,7 @@
  * Private Types
  ****************************************************************************/
 
-typedef int (*perf_func_t)(FAR struct perf_event_s *event);
+typedef CODE int (*perf_func_t)(FAR void *arg);
 
 struct swevent_manger_s
 {
@@ -262,7 +262,6 @@ static int perf_event_data_overflow(FAR struct perf_event_s *event,
     }
 
   space = circbuf_space(&(event->buf->rb));
-  event->count++;
   header.size = perf_prepare_sample(data, event, ip);
   header.type = PERF_RECORD_SAMPLE;
 
@@ -500,6 +499,7 @@ perf_get_context(FAR struct perf_event_s *event,
       if (ctx == NULL)
         {
           serr("task perf event alloc fail\n");
+          nxmutex_unlock(&tcb->perf_event_mutex);
           return NULL;
         }
 
@@ -1328,12 +1328,12 @@ static int perf_event_do_disable(FAR void *arg)
 
 static int perf_task_function_call(FAR struct tcb_s *tcb,
                                    FAR struct perf_event_s *event,
-                                   nxsched_smp_call_t func)
+                                   perf_func_t func)
 {
 #ifdef CONFIG_SMP
   if (tcb->cpu != this_cpu())
     {
-      return nxsched_smp_call_single(tcb->cpu, func, event, true);
+      return nxsched_smp_call_single(tcb->cpu, func, event);
     }
 #endif
 
@@ -1358,12 +1358,12 @@ static int perf_task_function_call(FAR struct tcb_s *tcb,
  ****************************************************************************/
 
 static int perf_cpu_function_call(int cpu, FAR struct perf_event_s *event,
-                                  nxsched_smp_call_t func)
+                                  perf_func_t func)
 {
 #ifdef CONFIG_SMP
   if (cpu != this_cpu())
     {
-      return nxsched_smp_call_single(cpu, func, event, true);
+      return nxsched_smp_call_single(cpu, func, event);
     }
 #endif
 
@@ -1388,7 +1388,7 @@ static int perf_cpu_function_call(int cpu, FAR struct perf_event_s *event,
  ****************************************************************************/
 
 static int perf_function_call(FAR struct perf_event_s *event,
-                              nxsched_smp_call_t func)
+                              perf_func_t func)
 {
   FAR struct perf_event_context_s *ctx = event->ctx;
 
@@ -1495,7 +1495,7 @@ static int perf_event_reset(FAR void *arg)
  ****************************************************************************/
 
 static int perf_event_for_child(FAR struct perf_event_s *event,
-                                nxsched_smp_call_t func)
+                                perf_func_t func)
 {
   FAR struct perf_event_s *child_event;
   int ret;
@@ -1538,7 +1538,7 @@ static int perf_event_for_child(FAR struct perf_event_s *event,
  ****************************************************************************/
 
 static int perf_event_for_group(FAR struct perf_event_s *event,
-                                nxsched_smp_call_t func)
+                                perf_func_t func)
 {
   FAR struct perf_event_s *sub_event;
   int ret;
@@ -1970,7 +1970,7 @@ static int perf_setup_task_context(FAR struct tcb_s *tcb)
   FAR struct perf_event_context_s *parent_ctx = parent->perf_event_ctx;
   FAR struct perf_event_s *group_leader;
   irqstate_t flags;
-  int ret;
+  int ret = OK;
 
   /* Inherit parent event if it has */
 
@@ -2086,7 +2086,7 @@ static ssize_t perf_read(FAR struct file *filep, FAR char *buffer,
 static int perf_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 {
   FAR struct perf_event_s *event = filep->f_priv;
-  nxsched_smp_call_t func = NULL;
+  perf_func_t func = NULL;
   int ret = OK;
 
   ASSERT(event != NULL);
@@ -2115,14 +2115,9 @@ static int perf_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
             }
 
           out_event = out_filep->f_priv;
-
-          if (!out_event->buf)
-            {
-              return -EINVAL;
-            }
-
-          perf_buffer_set_output(event, out_event);
-          return OK;
+          ret = perf_buffer_set_output(event, out_event) < 0 ? -EINVAL : OK;
+          fs_putfilep(out_filep);
+          return ret;
         }
 
       case PERF_EVENT_IOC_ID:
@@ -2179,7 +2174,7 @@ static int perf_poll(FAR struct file *filep, FAR struct pollfd *fds,
       return -EDEADLK;
     }
 
-  if (!event && !event->buf)
+  if (event == NULL || event->buf == NULL)
     {
       return -EINVAL;
     }
@@ -2346,7 +2341,18 @@ static void perf_cpuclock_event_del(FAR struct perf_event_s *event,
 static int perf_cpuclock_event_start(FAR struct perf_event_s *event,
                                      int flags)
 {
-  sclock_t period = event->attr.sample_period;
+  sclock_t period;
+
+  event->hw.prev_count = perf_gettime();
+
+  /* Counting events only need the timestamp, sampling events also need
+   * a buffer to put the samples in.
+   */
+
+  if (event->attr.sample_period == 0 || event->buf == NULL)
+    {
+      return 0;
+    }
 
   period = (PERF_DEFAULT_PERIOD > event->attr.sample_period) ?
            PERF_DEFAULT_PERIOD : event->attr.sample_period;
@@ -2375,6 +2381,12 @@ static int perf_cpuclock_event_stop(FAR struct perf_event_s *event,
                                     int flags)
 {
   wd_cancel_irq(&event->hw.waitdog);
+
+  if ((flags & PERF_EF_UPDATE) != 0)
+    {
+      perf_cpuclock_event_read(event);
+    }
+
   return 0;
 }
 
@@ -2394,12 +2406,25 @@ static int perf_cpuclock_event_stop(FAR struct perf_event_s *event,
 
 static int perf_cpuclock_event_read(FAR struct perf_event_s *event)
 {
+  clock_t now = perf_gettime();
+  struct timespec ts;
+
+  /* The count is in nanoseconds, like on Linux */
+
+  perf_convert(now - (clock_t)event->hw.prev_count, &ts);
+  event->hw.prev_count = now;
+  event->count += (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
   return 0;
 }
 
 static int perf_cpuclock_event_match(FAR struct perf_event_s *event)
 {
-  if (event->attr.config == PERF_COUNT_SW_CPU_CLOCK)
+  /* Per-task contexts only run while the task runs, so the same clock
+   * gives the task clock.
+   */
+
+  if (event->attr.config == PERF_COUNT_SW_CPU_CLOCK ||
+      event->attr.config == PERF_COUNT_SW_TASK_CLOCK)
     {
       return 0;
     }
@@ -2473,6 +2498,15 @@ static int perf_swevent_match(FAR struct perf_event_s *event)
 
 int perf_event_overflow(FAR struct perf_event_s *event)
 {
+#ifdef CONFIG_SCHED_PROFILE_SAMPLER
+  /* Counter overflows of sampling events also feed the system profiler */
+
+  if (event->attr.sample_period != 0)
+    {
+      nxsched_profile_sample();
+    }
+#endif
+
   return 0;
 }
 
@@ -2492,7 +2526,14 @@ void perf_swevent(uint32_t event_id, uintptr_t ip)
       if (node->attr.type == PERF_TYPE_SOFTWARE &&
           node->attr.config == event_id && node->hw.state == 1)
         {
-          perf_event_data_overflow(node, &data, ip);
+          node->count++;
+
+          /* Record a sample too if the event has a buffer mapped */
+
+          if (node->buf != NULL)
+            {
+              perf_event_data_overflow(node, &data, ip);
+            }
         }
     }
 
@@ -2535,10 +2576,11 @@ int perf_event_init(void)
 }
 
 /****************************************************************************
- * Name: perf_event_open
+ * Name: nxperf_event_open
  *
  * Description:
- *   Create and open a perf event
+ *   Create and open a perf event.  This is the internal version of
+ *   perf_event_open() that does not modify errno.
  *
  * Input Parameters:
  *   attr     - Perf event attribute
@@ -2548,12 +2590,12 @@ int perf_event_init(void)
  *   flags    - Perf event flags
  *
  * Returned Value:
- *   Perf event fd
+ *   Perf event fd on success; a negated errno value on failure.
  *
  ****************************************************************************/
 
-int perf_event_open(FAR struct perf_event_attr_s *attr, pid_t pid,
-                    int cpu, int group_fd, unsigned long flags)
+int nxperf_event_open(FAR struct perf_event_attr_s *attr, pid_t pid,
+                      int cpu, int group_fd, unsigned long flags)
 {
   FAR struct perf_event_s *group_leader = NULL;
   FAR struct perf_event_s *event;
@@ -2682,6 +2724,40 @@ err_with_event:
   return ret;
 }
 
+/****************************************************************************
+ * Name: perf_event_open
+ *
+ * Description:
+ *   Create and open a perf event.  Reading the returned file descriptor
+ *   gives the current count; mapping it gives a ring buffer of samples.
+ *
+ * Input Parameters:
+ *   attr     - Perf event attribute
+ *   pid      - Task to measure: 0 for the caller, -1 for all tasks on cpu
+ *   cpu      - CPU to measure, or -1 for any CPU the task runs on
+ *   group_fd - Perf event fd of the group leader, or -1
+ *   flags    - Perf event flags
+ *
+ * Returned Value:
+ *   Perf event fd on success; -1 (ERROR) with errno set on failure.
+ *
+ ****************************************************************************/
+
+int perf_event_open(FAR struct perf_event_attr_s *attr, pid_t pid,
+                    int cpu, int group_fd, unsigned long flags)
+{
+  int ret;
+
+  ret = nxperf_event_open(attr, pid, cpu, group_fd, flags);
+  if (ret < 0)
+    {
+      set_errno(-ret);
+      return ERROR;
+    }
+
+  return ret;
+}
+
 /****************************************************************************
  * Name: perf_pmu_register
  *
@@ -2797,7 +2873,11 @@ void perf_event_task_exit(FAR struct tcb_s *tcb)
         {
           perf_context_detach(event, ctx);
 
-          if (event->buf->ref_count > 1)
+          /* Inherited events have no file descriptor of their own, the
+           * others are freed by perf_close().
+           */
+
+          if (event->parent_event != NULL)
             {
               perf_free_event(event);
             }
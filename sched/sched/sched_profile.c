@@ -0,0 +1,734 @@
+/****************************************************************************
+ * sched/sched/sched_profile.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/stat.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <assert.h>
+#include <debug.h>
+#include <errno.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/irq.h>
+#include <nuttx/wdog.h>
+#include <nuttx/spinlock.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/allsyms.h>
+#include <nuttx/symtab.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
+
+#include "sched/sched.h"
+
+#ifdef CONFIG_SCHED_PROFILE_SAMPLER
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define PROFILE_TICK \
+  NSEC2TICK(NSEC_PER_SEC / CONFIG_SCHED_PROFILE_TICKSPERSEC)
+
+/* The unwound stack starts with the frames of the sampling interrupt.
+ * Unwind a few more frames than are kept so that they can be dropped.
+ */
+
+#define PROFILE_DEPTH     CONFIG_SCHED_PROFILE_SAMPLER_DEPTH
+#define PROFILE_MAXDEPTH  (2 * PROFILE_DEPTH)
+#define PROFILE_NENTRIES  CONFIG_SCHED_PROFILE_SAMPLER_NENTRIES
+
+/* Give up probing the hash table after this many collisions and count
+ * the sample as dropped.
+ */
+
+#define PROFILE_MAXPROBE  16
+
+/* Output is in the "folded stack" format understood by flamegraph.pl and
+ * speedscope: one line per unique stack, frames from the outermost to the
+ * innermost separated by ';', followed by the number of samples:
+ *
+ *   <name>-<pid>;<frame>;...;<frame> <count>
+ *
+ * Frames are printed as symbol names when CONFIG_ALLSYMS is enabled and as
+ * addresses otherwise.
+ */
+
+#define PROFILE_SYMLEN    48
+#define PROFILE_LINELEN \
+  (CONFIG_TASK_NAME_SIZE + 32 + PROFILE_DEPTH * (PROFILE_SYMLEN + 2))
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One unique (thread, stack) pair and the number of times it was seen */
+
+struct profile_entry_s
+{
+  uint32_t  hash;                     /* Hash of pid and stack, 0 if free */
+  uint32_t  count;                    /* Number of samples */
+  pid_t     pid;                      /* Thread that was running */
+  uint8_t   depth;                    /* Number of valid frames */
+  FAR void *stack[PROFILE_DEPTH];     /* Innermost frame first */
+};
+
+/* Samples are aggregated per CPU so that the sampling interrupts of
+ * different CPUs never contend.  The lock only serializes the sampler
+ * against the reader.
+ */
+
+struct profile_cpu_s
+{
+  spinlock_t lock;
+  uint32_t   ndropped;                /* Samples lost to a full table */
+  struct profile_entry_s entries[PROFILE_NENTRIES];
+};
+
+/* This structure describes one open "file" */
+
+struct profile_file_s
+{
+  struct procfs_file_s base;          /* Base open file structure */
+  FAR char *buffer;                   /* User provided buffer */
+  size_t remaining;                   /* Number of available characters */
+  size_t ncopied;                     /* Number of characters in buffer */
+  off_t offset;                       /* Current file offset */
+  struct profile_entry_s entry;       /* Snapshot of the current entry */
+  char line[PROFILE_LINELEN];         /* Buffer for formatted lines */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+#ifdef CONFIG_SMP
+static int profile_sample_cpu(FAR void *arg);
+#endif
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS)
+static int     profile_open(FAR struct file *filep, FAR const char *relpath,
+                            int oflags, mode_t mode);
+static int     profile_close(FAR struct file *filep);
+static ssize_t profile_read(FAR struct file *filep, FAR char *buffer,
+                            size_t buflen);
+static ssize_t profile_write(FAR struct file *filep,
+                             FAR const char *buffer, size_t buflen);
+static int     profile_dup(FAR const struct file *oldp,
+                           FAR struct file *newp);
+static int     profile_stat(FAR const char *relpath, FAR struct stat *buf);
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct profile_cpu_s g_profile_cpu[CONFIG_SMP_NCPUS];
+static struct wdog_s g_profile_timer;
+static volatile bool g_profile_active;
+
+#ifdef CONFIG_SMP
+static struct smp_call_data_s g_profile_call_data =
+SMP_CALL_INITIALIZER(profile_sample_cpu, NULL);
+#endif
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS)
+
+/* See fs_mount.c -- this structure is explicitly extern'ed there.
+ * We use the old-fashioned kind of initializers so that this will compile
+ * with any compiler.
+ */
+
+const struct procfs_operations g_profile_operations =
+{
+  profile_open,   /* open */
+  profile_close,  /* close */
+  profile_read,   /* read */
+  profile_write,  /* write */
+  NULL,           /* poll */
+
+  profile_dup,    /* dup */
+
+  NULL,           /* opendir */
+  NULL,           /* closedir */
+  NULL,           /* readdir */
+  NULL,           /* rewinddir */
+
+  profile_stat    /* stat */
+};
+
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: profile_hash
+ *
+ * Description:
+ *   FNV-1a hash of the thread ID and the return addresses of a stack.
+ *   Zero is reserved to mark free entries.
+ *
+ ****************************************************************************/
+
+static uint32_t profile_hash_word(uint32_t hash, uintptr_t word)
+{
+  size_t i;
+
+  for (i = 0; i < sizeof(uintptr_t); i++)
+    {
+      hash ^= (uint8_t)(word >> (8 * i));
+      hash *= 16777619u;
+    }
+
+  return hash;
+}
+
+static uint32_t profile_hash(pid_t pid, FAR void **stack, int depth)
+{
+  uint32_t hash = profile_hash_word(2166136261u, (uintptr_t)pid);
+  int i;
+
+  for (i = 0; i < depth; i++)
+    {
+      hash = profile_hash_word(hash, (uintptr_t)stack[i]);
+    }
+
+  return hash != 0 ? hash : 1;
+}
+
+/****************************************************************************
+ * Name: profile_record
+ *
+ * Description:
+ *   Account one sample to the hash table of the current CPU.
+ *
+ ****************************************************************************/
+
+static void profile_record(FAR struct profile_cpu_s *cpu, pid_t pid,
+                           FAR void **stack, int depth)
+{
+  FAR struct profile_entry_s *entry;
+  uint32_t hash = profile_hash(pid, stack, depth);
+  unsigned int idx = hash % PROFILE_NENTRIES;
+  int probe;
+
+  for (probe = 0; probe < PROFILE_MAXPROBE; probe++)
+    {
+      entry = &cpu->entries[idx];
+
+      if (entry->hash == 0)
+        {
+          entry->pid   = pid;
+          entry->depth = depth;
+          entry->count = 1;
+          memcpy(entry->stack, stack, depth * sizeof(FAR void *));
+
+          /* Publish the entry last so a reader never sees it half done */
+
+          entry->hash  = hash;
+          return;
+        }
+
+      if (entry->hash == hash && entry->pid == pid &&
+          entry->depth == depth &&
+          memcmp(entry->stack, stack, depth * sizeof(FAR void *)) == 0)
+        {
+          entry->count++;
+          return;
+        }
+
+      if (++idx >= PROFILE_NENTRIES)
+        {
+          idx = 0;
+        }
+    }
+
+  cpu->ndropped++;
+}
+
+/****************************************************************************
+ * Name: profile_sample_cpu
+ *
+ * Description:
+ *   Take one sample on the current CPU.  On SMP this is also the handler
+ *   of the cross-CPU call that makes the other CPUs sample.
+ *
+ ****************************************************************************/
+
+static int profile_sample_cpu(FAR void *arg)
+{
+  nxsched_profile_sample();
+  return OK;
+}
+
+/****************************************************************************
+ * Name: profile_timer
+ *
+ * Description:
+ *   The sampling timer.  It runs on one CPU and asks all of the others to
+ *   sample as well.
+ *
+ ****************************************************************************/
+
+static void profile_timer(wdparm_t arg)
+{
+#ifdef CONFIG_SMP
+  cpu_set_t cpus = (1 << CONFIG_SMP_NCPUS) - 1;
+
+  CPU_CLR(this_cpu(), &cpus);
+  nxsched_smp_call_async(cpus, &g_profile_call_data);
+#endif
+
+  profile_sample_cpu(NULL);
+
+  if (g_profile_active)
+    {
+      wd_start(&g_profile_timer, PROFILE_TICK, profile_timer, arg);
+    }
+}
+
+/****************************************************************************
+ * Name: profile_reset
+ ****************************************************************************/
+
+static void profile_reset(void)
+{
+  irqstate_t flags;
+  int cpu;
+
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      flags = spin_lock_irqsave(&g_profile_cpu[cpu].lock);
+      memset(g_profile_cpu[cpu].entries, 0,
+             sizeof(g_profile_cpu[cpu].entries));
+      g_profile_cpu[cpu].ndropped = 0;
+      spin_unlock_irqrestore(&g_profile_cpu[cpu].lock, flags);
+    }
+}
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS)
+
+/****************************************************************************
+ * Name: profile_output
+ ****************************************************************************/
+
+static int profile_output(FAR struct profile_file_s *profile,
+                          size_t linesize)
+{
+  size_t copysize;
+
+  copysize = procfs_memcpy(profile->line, linesize, profile->buffer,
+                           profile->remaining, &profile->offset);
+
+  profile->ncopied   += copysize;
+  profile->buffer    += copysize;
+  profile->remaining -= copysize;
+
+  /* Return a non-zero value to stop if the user-provided buffer is full */
+
+  return profile->remaining > 0 ? 0 : 1;
+}
+
+/****************************************************************************
+ * Name: profile_format
+ *
+ * Description:
+ *   Format one entry as a folded stack line.
+ *
+ ****************************************************************************/
+
+static size_t profile_format(FAR struct profile_file_s *profile)
+{
+  FAR struct profile_entry_s *entry = &profile->entry;
+  FAR char *line = profile->line;
+  size_t len = PROFILE_LINELEN;
+  size_t n = 0;
+  int i;
+
+#if CONFIG_TASK_NAME_SIZE > 0
+  FAR struct tcb_s *tcb;
+  irqstate_t flags;
+
+  flags = enter_critical_section();
+  tcb = nxsched_get_tcb(entry->pid);
+  if (tcb != NULL)
+    {
+      n = snprintf(line, len, "%s-", tcb->name);
+    }
+
+  leave_critical_section(flags);
+#endif
+
+  n += snprintf(line + n, len - n, "%d", (int)entry->pid);
+
+  for (i = entry->depth - 1; i >= 0 && n < len; i--)
+    {
+#ifdef CONFIG_ALLSYMS
+      FAR const struct symtab_s *sym;
+
+      sym = allsyms_findbyvalue(entry->stack[i], NULL);
+      if (sym != NULL)
+        {
+          n += snprintf(line + n, len - n, ";%.*s",
+                        PROFILE_SYMLEN, sym->sym_name);
+          continue;
+        }
+#endif
+
+      n += snprintf(line + n, len - n, ";%p", entry->stack[i]);
+    }
+
+  if (n < len)
+    {
+      n += snprintf(line + n, len - n, " %" PRIu32 "\n", entry->count);
+    }
+
+  return n < len ? n : len - 1;
+}
+
+/****************************************************************************
+ * Name: profile_open
+ ****************************************************************************/
+
+static int profile_open(FAR struct file *filep, FAR const char *relpath,
+                        int oflags, mode_t mode)
+{
+  FAR struct profile_file_s *profile;
+
+  finfo("Open '%s'\n", relpath);
+
+  /* Allocate a container to hold the file attributes */
+
+  profile = kmm_zalloc(sizeof(struct profile_file_s));
+  if (profile == NULL)
+    {
+      ferr("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* Save the attributes as the open-specific state in filep->f_priv */
+
+  filep->f_priv = profile;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: profile_close
+ ****************************************************************************/
+
+static int profile_close(FAR struct file *filep)
+{
+  FAR struct profile_file_s *profile = filep->f_priv;
+
+  DEBUGASSERT(profile != NULL);
+
+  kmm_free(profile);
+  filep->f_priv = NULL;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: profile_read
+ *
+ * Description:
+ *   Emit all entries of all CPUs.  The same stack may appear once for each
+ *   CPU it was seen on; the folded format tools add these up.
+ *
+ *   Like the other procfs files that are regenerated on every read, the
+ *   output may be inconsistent if new stacks are recorded while it is read
+ *   in several pieces.  Stop the profiler first for an exact snapshot.
+ *
+ ****************************************************************************/
+
+static ssize_t profile_read(FAR struct file *filep, FAR char *buffer,
+                            size_t buflen)
+{
+  FAR struct profile_file_s *profile = filep->f_priv;
+  FAR struct profile_cpu_s *cpu;
+  irqstate_t flags;
+  uint32_t ndropped = 0;
+  int i;
+  int j;
+
+  DEBUGASSERT(profile != NULL);
+
+  profile->offset    = filep->f_pos;
+  profile->buffer    = buffer;
+  profile->remaining = buflen;
+  profile->ncopied   = 0;
+
+  for (i = 0; i < CONFIG_SMP_NCPUS; i++)
+    {
+      cpu = &g_profile_cpu[i];
+      ndropped += cpu->ndropped;
+
+      for (j = 0; j < PROFILE_NENTRIES; j++)
+        {
+          flags = spin_lock_irqsave(&cpu->lock);
+          memcpy(&profile->entry, &cpu->entries[j],
+                 sizeof(struct profile_entry_s));
+          spin_unlock_irqrestore(&cpu->lock, flags);
+
+          if (profile->entry.hash != 0 &&
+              profile_output(profile, profile_format(profile)) != 0)
+            {
+              goto out;
+            }
+        }
+    }
+
+  /* Lost samples are reported as a stack of their own */
+
+  if (ndropped > 0)
+    {
+      profile_output(profile,
+                     snprintf(profile->line, PROFILE_LINELEN,
+                              "[dropped] %" PRIu32 "\n", ndropped));
+    }
+
+out:
+  filep->f_pos += profile->ncopied;
+  return profile->ncopied;
+}
+
+/****************************************************************************
+ * Name: profile_write
+ *
+ * Description:
+ *   Control the profiler:  "start" starts sampling, "stop" stops it and
+ *   "reset" discards the samples collected so far.
+ *
+ ****************************************************************************/
+
+static ssize_t profile_write(FAR struct file *filep,
+                             FAR const char *buffer, size_t buflen)
+{
+  int ret;
+
+  if (buflen >= 5 && strncmp(buffer, "start", 5) == 0)
+    {
+      ret = nxsched_profile_start();
+    }
+  else if (buflen >= 4 && strncmp(buffer, "stop", 4) == 0)
+    {
+      ret = nxsched_profile_stop();
+    }
+  else if (buflen >= 5 && strncmp(buffer, "reset", 5) == 0)
+    {
+      profile_reset();
+      ret = OK;
+    }
+  else
+    {
+      ret = -EINVAL;
+    }
+
+  return ret < 0 ? ret : buflen;
+}
+
+/****************************************************************************
+ * Name: profile_dup
+ *
+ * Description:
+ *   Duplicate open file data in the new file structure.
+ *
+ ****************************************************************************/
+
+static int profile_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+  FAR struct profile_file_s *oldattr = oldp->f_priv;
+  FAR struct profile_file_s *newattr;
+
+  DEBUGASSERT(oldattr != NULL);
+
+  newattr = kmm_malloc(sizeof(struct profile_file_s));
+  if (newattr == NULL)
+    {
+      ferr("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  memcpy(newattr, oldattr, sizeof(struct profile_file_s));
+  newp->f_priv = newattr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: profile_stat
+ *
+ * Description: Return information about a file or directory
+ *
+ ****************************************************************************/
+
+static int profile_stat(FAR const char *relpath, FAR struct stat *buf)
+{
+  memset(buf, 0, sizeof(struct stat));
+  buf->st_mode = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR | S_IWUSR;
+  return OK;
+}
+
+#endif /* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS */
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxsched_profile_sample
+ *
+ * Description:
+ *   Record the running thread and its call stack on the current CPU.  This
+ *   is called from the profiler's own timer, but may also be called from
+ *   any other periodic interrupt, e.g. a PMU counter overflow, to sample
+ *   on hardware events instead of time.
+ *
+ * Input Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called from interrupt context.
+ *
+ ****************************************************************************/
+
+void nxsched_profile_sample(void)
+{
+  FAR struct profile_cpu_s *cpu;
+  FAR struct tcb_s *tcb;
+  FAR void *stack[PROFILE_MAXDEPTH];
+  FAR void *pc = NULL;
+  irqstate_t flags;
+  int start = 0;
+  int depth;
+
+  if (!g_profile_active)
+    {
+      return;
+    }
+
+  tcb   = this_task();
+  depth = sched_backtrace(tcb->pid, stack, PROFILE_MAXDEPTH, 0);
+
+  /* Drop the frames of the sampling interrupt, i.e. everything before the
+   * interrupted PC.  Architectures whose unwinder does not report that PC
+   * keep the whole stack.
+   */
+
+  if (up_interrupt_context() && up_current_regs() != NULL)
+    {
+      pc = (FAR void *)up_getusrpc(NULL);
+
+      for (start = 0; start < depth; start++)
+        {
+          if (stack[start] == pc)
+            {
+              break;
+            }
+        }
+
+      if (start >= depth)
+        {
+          start = 0;
+        }
+    }
+
+  depth -= start;
+  if (depth > PROFILE_DEPTH)
+    {
+      depth = PROFILE_DEPTH;
+    }
+  else if (depth <= 0)
+    {
+      /* No unwinder, fall back to a flat PC profile */
+
+      stack[0] = pc;
+      start    = 0;
+      depth    = pc != NULL ? 1 : 0;
+    }
+
+  cpu   = &g_profile_cpu[this_cpu()];
+  flags = spin_lock_irqsave(&cpu->lock);
+  profile_record(cpu, tcb->pid, &stack[start], depth);
+  spin_unlock_irqrestore(&cpu->lock, flags);
+}
+
+/****************************************************************************
+ * Name: nxsched_profile_start
+ *
+ * Description:
+ *   Start sampling all CPUs CONFIG_SCHED_PROFILE_TICKSPERSEC times per
+ *   second.  Samples accumulate until nxsched_profile_stop() is called;
+ *   previously collected samples are kept.
+ *
+ * Returned Value:
+ *   Zero (OK) on success or a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int nxsched_profile_start(void)
+{
+  if (g_profile_active)
+    {
+      return -EBUSY;
+    }
+
+  g_profile_active = true;
+  return wd_start(&g_profile_timer, PROFILE_TICK, profile_timer, 0);
+}
+
+/****************************************************************************
+ * Name: nxsched_profile_stop
+ *
+ * Description:
+ *   Stop sampling.  The collected samples remain available for reading.
+ *
+ * Returned Value:
+ *   Zero (OK) on success or a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int nxsched_profile_stop(void)
+{
+  g_profile_active = false;
+  wd_cancel(&g_profile_timer);
+  return OK;
+}
+
+#endif /* CONFIG_SCHED_PROFILE_SAMPLER */
@@ -200,7 +200,7 @@ int nxsched_release_tcb(FAR struct tcb_s *tcb, uint8_t ttype)
 
       if (tcb->flags & TCB_FLAG_FREE_TCB)
         {
-          kmm_free(tcb);
+          nxsched_free_tcb(tcb);
         }
     }
 
@@ -33,6 +33,7 @@
 #include <nuttx/sched.h>
 
 #include "sched/sched.h"
+#include "semaphore/semaphore.h"
 
 #ifdef CONFIG_PRIORITY_INHERITANCE
 
@@ -84,6 +85,18 @@ int nxsched_reprioritize(FAR struct tcb_s *tcb, int sched_priority)
       /* Discard priority boost as well */
 
       tcb->boost_priority = 0;
+
+#ifdef CONFIG_SEM_PI_WAITERS
+      /* But keep the priority inherited from the threads waiting for the
+       * semaphores held by the thread.
+       */
+
+      sched_priority = nxsem_inherited_priority(tcb);
+      if (sched_priority != tcb->sched_priority)
+        {
+          ret = nxsched_set_priority(tcb, sched_priority);
+        }
+#endif
     }
 
   return ret;
@@ -72,11 +72,23 @@ void nxsched_resume_scheduler(FAR struct tcb_s *tcb)
     }
 #endif
 
+#ifdef CONFIG_SCHED_DEADLINE
+  if ((tcb->flags & TCB_FLAG_POLICY_MASK) == TCB_FLAG_SCHED_DEADLINE)
+    {
+      /* Start charging the budget of the deadline server */
+
+      nxsched_resume_deadline(tcb);
+    }
+#endif
+
   /* Indicate the task has been resumed */
 
 #ifdef CONFIG_SCHED_CRITMONITOR
   nxsched_resume_critmon(tcb);
 #endif
+#ifdef CONFIG_SCHED_LATENCYMON
+  nxsched_resume_latencymon(tcb);
+#endif
 #ifdef CONFIG_SCHED_INSTRUMENTATION
   sched_note_resume(tcb);
 #endif
@@ -84,6 +96,10 @@ void nxsched_resume_scheduler(FAR struct tcb_s *tcb)
 #ifdef CONFIG_SCHED_PERF_EVENTS
   perf_event_task_sched_in(tcb);
 #endif
+
+  /* A context switch is a quiescent state for RCU */
+
+  nxsched_rcu_quiescent();
 }
 
 #endif /* CONFIG_SCHED_RESUMESCHEDULER */
@@ -0,0 +1,185 @@
+/****************************************************************************
+ * sched/sched/sched_setattr.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sched.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+
+#include <nuttx/sched.h>
+#include <nuttx/irq.h>
+#include <nuttx/clock.h>
+
+#include "sched/sched.h"
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_DEADLINE
+static clock_t nsec2ticks(uint64_t nsec)
+{
+  return (clock_t)((nsec + NSEC_PER_TICK - 1) / NSEC_PER_TICK);
+}
+
+/****************************************************************************
+ * Name: nxsched_set_deadline
+ *
+ * Description:
+ *   Switch the thread identified by pid to SCHED_DEADLINE.
+ *
+ ****************************************************************************/
+
+static int nxsched_set_deadline(pid_t pid,
+                                FAR const struct sched_attr *attr)
+{
+  FAR struct tcb_s *tcb;
+  uint64_t deadline;
+  uint64_t period;
+#ifdef CONFIG_SCHED_SPORADIC
+  bool sporadic;
+#endif
+  int ret;
+
+  /* As on Linux, the deadline must not be zero and a zero period defaults
+   * to the deadline.
+   */
+
+  if (attr->sched_deadline == 0)
+    {
+      return -EINVAL;
+    }
+
+  deadline = attr->sched_deadline;
+  period   = attr->sched_period != 0 ? attr->sched_period : deadline;
+
+  if (pid == 0)
+    {
+      pid = nxsched_gettid();
+    }
+
+  tcb = nxsched_get_tcb(pid);
+  if (tcb == NULL)
+    {
+      return -ESRCH;
+    }
+
+  sched_lock();
+
+#ifdef CONFIG_SCHED_SPORADIC
+  sporadic = (tcb->flags & TCB_FLAG_POLICY_MASK) == TCB_FLAG_SCHED_SPORADIC;
+#endif
+
+  /* The parameters are checked and admitted first, so that a thread that
+   * is refused keeps its current policy.
+   */
+
+  ret = nxsched_start_deadline(tcb, nsec2ticks(attr->sched_runtime),
+                               nsec2ticks(deadline), nsec2ticks(period));
+  if (ret >= 0)
+    {
+#ifdef CONFIG_SCHED_SPORADIC
+      if (sporadic)
+        {
+          irqstate_t flags = enter_critical_section();
+          DEBUGVERIFY(nxsched_stop_sporadic(tcb));
+          leave_critical_section(flags);
+        }
+#endif
+
+#if CONFIG_RR_INTERVAL > 0 || defined(CONFIG_SCHED_SPORADIC)
+      tcb->timeslice = 0;
+#endif
+      ret = nxsched_reprioritize(tcb, CONFIG_SCHED_DEADLINE_PRIORITY);
+    }
+
+  sched_unlock();
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_setattr
+ *
+ * Description:
+ *   sched_setattr() sets the scheduling policy and attributes of the
+ *   thread identified by pid (zero for the calling thread).  It extends
+ *   sched_setscheduler() with the SCHED_DEADLINE runtime, deadline and
+ *   period, which are given in nanoseconds and rounded up to clock ticks.
+ *
+ * Input Parameters:
+ *   pid   - The thread ID, or zero for the calling thread
+ *   attr  - The new scheduling policy and attributes
+ *   flags - Reserved, must be zero
+ *
+ * Returned Value:
+ *   On success, sched_setattr() returns OK (zero).  On error, ERROR (-1)
+ *   is returned, and errno is set appropriately:
+ *
+ *   EINVAL The policy or its attributes are invalid.
+ *   EBUSY  SCHED_DEADLINE admission control failed.
+ *   ESRCH  The thread whose ID is pid could not be found.
+ *
+ ****************************************************************************/
+
+int sched_setattr(pid_t pid, FAR const struct sched_attr *attr,
+                  unsigned int flags)
+{
+  struct sched_param param;
+  int ret;
+
+  if (attr == NULL || flags != 0 || attr->sched_flags != 0)
+    {
+      ret = -EINVAL;
+    }
+#ifdef CONFIG_SCHED_DEADLINE
+  else if (attr->sched_policy == SCHED_DEADLINE)
+    {
+      ret = nxsched_set_deadline(pid, attr);
+    }
+#endif
+  else
+    {
+      memset(&param, 0, sizeof(param));
+      param.sched_priority = attr->sched_priority;
+      ret = nxsched_set_scheduler(pid, attr->sched_policy, &param);
+    }
+
+  if (ret < 0)
+    {
+      set_errno(-ret);
+      ret = ERROR;
+    }
+
+  return ret;
+}
@@ -131,6 +131,16 @@ int nxsched_set_scheduler(pid_t pid, int policy,
   /* Further, disable timer interrupts while we set up scheduling policy. */
 
   flags = enter_critical_section();
+
+#ifdef CONFIG_SCHED_DEADLINE
+  /* Leaving SCHED_DEADLINE releases the thread's bandwidth reservation */
+
+  if ((tcb->flags & TCB_FLAG_POLICY_MASK) == TCB_FLAG_SCHED_DEADLINE)
+    {
+      DEBUGVERIFY(nxsched_stop_deadline(tcb));
+    }
+#endif
+
   tcb->flags &= ~TCB_FLAG_POLICY_MASK;
   switch (policy)
     {
@@ -34,6 +34,10 @@
 #include <nuttx/clock.h>
 #include <nuttx/sched_note.h>
 
+#ifdef CONFIG_SCHED_PERF_EVENTS
+#  include <nuttx/perf.h>
+#endif
+
 #include "clock/clock.h"
 #include "sched/sched.h"
 
@@ -77,6 +81,15 @@ void nxsched_suspend_scheduler(FAR struct tcb_s *tcb)
     }
 #endif
 
+#ifdef CONFIG_SCHED_DEADLINE
+  /* Charge the time used to the budget of the deadline server */
+
+  if ((tcb->flags & TCB_FLAG_POLICY_MASK) == TCB_FLAG_SCHED_DEADLINE)
+    {
+      nxsched_suspend_deadline(tcb);
+    }
+#endif
+
   /* Indicate that the task has been suspended */
 
 #ifdef CONFIG_SCHED_CRITMONITOR
@@ -85,6 +98,10 @@ void nxsched_suspend_scheduler(FAR struct tcb_s *tcb)
 #ifdef CONFIG_SCHED_INSTRUMENTATION
   sched_note_suspend(tcb);
 #endif
+
+#ifdef CONFIG_SCHED_PERF_EVENTS
+  perf_event_task_sched_out(tcb);
+#endif
 }
 
 #endif /* CONFIG_SCHED_SUSPENDSCHEDULER */
@@ -0,0 +1,164 @@
+/****************************************************************************
+ * sched/sched/sched_tcbcache.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+#include <string.h>
+#include <sys/param.h>
+
+#include <nuttx/nuttx.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/rcu.h>
+#include <nuttx/sched.h>
+#include <nuttx/mm/kmem_cache.h>
+
+#include "sched/sched.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* One cache serves all kinds of TCBs */
+
+#define TCBCACHE_SIZE MAX(sizeof(struct task_tcb_s), \
+                          sizeof(struct pthread_tcb_s))
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifdef CONFIG_MM_KMEM_CACHE
+static FAR struct kmem_cache_s *g_tcbcache;
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxsched_tcb_ctor
+ *
+ * Description:
+ *   Construct a TCB of the cache.  Cached TCBs are kept zeroed, so that
+ *   nxsched_alloc_tcb() can hand them out without touching them.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MM_KMEM_CACHE
+static void nxsched_tcb_ctor(FAR void *obj)
+{
+  memset(obj, 0, TCBCACHE_SIZE);
+}
+#endif
+
+/****************************************************************************
+ * Name: nxsched_release_tcbmem
+ ****************************************************************************/
+
+static void nxsched_release_tcbmem(FAR struct tcb_s *tcb)
+{
+#ifdef CONFIG_MM_KMEM_CACHE
+  /* Restore the constructed state.  Only the part that this type of TCB
+   * can have written needs to be cleared, a pthread TCB is much smaller
+   * than a task TCB with its group.
+   */
+
+  if ((tcb->flags & TCB_FLAG_TTYPE_MASK) == TCB_FLAG_TTYPE_PTHREAD)
+    {
+      memset(tcb, 0, sizeof(struct pthread_tcb_s));
+    }
+  else
+    {
+      memset(tcb, 0, sizeof(struct task_tcb_s));
+    }
+
+  kmem_cache_free(g_tcbcache, tcb);
+#else
+  kmm_free(tcb);
+#endif
+}
+
+/****************************************************************************
+ * Name: nxsched_free_tcb_rcu
+ *
+ * Description:
+ *   call_rcu() callback releasing a TCB once no reader can still hold it.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_RCU
+static void nxsched_free_tcb_rcu(FAR struct rcu_head *head)
+{
+  nxsched_release_tcbmem(container_of(head, struct tcb_s, rcu));
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+#ifdef CONFIG_MM_KMEM_CACHE
+
+/****************************************************************************
+ * Name: nxsched_initialize_tcbcache
+ *
+ * Description:
+ *   Create the TCB cache.  Called once by nx_start() as soon as the kernel
+ *   heap is available.
+ *
+ ****************************************************************************/
+
+void nxsched_initialize_tcbcache(void)
+{
+  g_tcbcache = kmem_cache_create("tcb", TCBCACHE_SIZE, 0,
+                                 nxsched_tcb_ctor);
+  DEBUGASSERT(g_tcbcache != NULL);
+}
+
+/****************************************************************************
+ * Name: nxsched_alloc_tcb
+ ****************************************************************************/
+
+FAR void *nxsched_alloc_tcb(size_t size)
+{
+  DEBUGASSERT(size <= TCBCACHE_SIZE);
+  return kmem_cache_alloc(g_tcbcache);
+}
+#endif /* CONFIG_MM_KMEM_CACHE */
+
+/****************************************************************************
+ * Name: nxsched_free_tcb
+ ****************************************************************************/
+
+void nxsched_free_tcb(FAR struct tcb_s *tcb)
+{
+#ifdef CONFIG_RCU
+  call_rcu(&tcb->rcu, nxsched_free_tcb_rcu);
+#else
+  nxsched_release_tcbmem(tcb);
+#endif
+}
@@ -26,6 +26,7 @@
 
 #include <nuttx/config.h>
 
+#include <sys/param.h>
 #include <sched.h>
 #include <assert.h>
 #include <debug.h>
@@ -38,10 +39,6 @@
 
 #ifdef CONFIG_PRIORITY_INHERITANCE
 
-/****************************************************************************
- * Pre-processor Definitions
- ****************************************************************************/
-
 /****************************************************************************
  * Private Type Declarations
  ****************************************************************************/
@@ -49,17 +46,86 @@
 typedef int (*holderhandler_t)(FAR struct semholder_s *pholder,
                                FAR sem_t *sem, FAR void *arg);
 
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+#ifdef CONFIG_SEM_PI_WAITERS
+static void nxsem_propagate_priority(FAR sem_t *sem, int waitprio,
+                                     int depth);
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
 
-/* Preallocated holder structures */
+/* Preallocated holder structures.  With CONFIG_SEM_PI_WAITERS, the holder
+ * records are part of the TCB of each holder instead.
+ */
 
-#if CONFIG_SEM_PREALLOCHOLDERS > 0
+#if CONFIG_SEM_PREALLOCHOLDERS > 0 && !defined(CONFIG_SEM_PI_WAITERS)
 static struct semholder_s g_holderalloc[CONFIG_SEM_PREALLOCHOLDERS];
 static FAR struct semholder_s *g_freeholders;
 #endif
 
+/****************************************************************************
+ * Name: nxsem_pi_compare
+ *
+ * Description:
+ *   Sort the pi_waiters tree of a thread by descending priority of the
+ *   top waiter, so that RB_MIN() is the holder that inherits the highest
+ *   priority.  The tree does not take duplicate keys, holders with the
+ *   same priority are ordered by address.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SEM_PI_WAITERS
+static int nxsem_pi_compare(FAR struct semholder_s *a,
+                            FAR struct semholder_s *b)
+{
+  if (a->pi_prio != b->pi_prio)
+    {
+      return b->pi_prio - a->pi_prio;
+    }
+
+  return a < b ? -1 : a > b;
+}
+
+/****************************************************************************
+ * Name: RB_GENERATE_STATIC
+ ****************************************************************************/
+
+RB_GENERATE_STATIC(semholder_tree_s, semholder_s, pi_node,
+                   nxsem_pi_compare);
+#endif
+
+/****************************************************************************
+ * Name: nxsem_tcbholder
+ *
+ * Description:
+ *   Return the holder record of htcb for the semaphore, or a free record of
+ *   htcb if sem is NULL.
+ *
+ ****************************************************************************/
+
+#if CONFIG_SEM_PREALLOCHOLDERS > 0 && defined(CONFIG_SEM_PI_WAITERS)
+static FAR struct semholder_s *
+nxsem_tcbholder(FAR struct tcb_s *htcb, FAR sem_t *sem)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_SEM_TCBHOLDERS; i++)
+    {
+      if (htcb->holders[i].sem == sem)
+        {
+          return &htcb->holders[i];
+        }
+    }
+
+  return NULL;
+}
+#endif
+
 /****************************************************************************
  * Name: nxsem_allocholder
  ****************************************************************************/
@@ -75,14 +141,24 @@ nxsem_allocholder(FAR sem_t *sem, FAR struct tcb_s *htcb)
    */
 
 #if CONFIG_SEM_PREALLOCHOLDERS > 0
+#  ifdef CONFIG_SEM_PI_WAITERS
+  /* Take a free record of the holder thread */
+
+  pholder = nxsem_tcbholder(htcb, NULL);
+#  else
+  /* Remove the holder from the free list */
+
   pholder = g_freeholders;
   if (pholder != NULL)
     {
-      /* Remove the holder from the free list and
-       * put it into the semaphore's holder list
-       */
+      g_freeholders = pholder->flink;
+    }
+#  endif
+
+  if (pholder != NULL)
+    {
+      /* Put it into the semaphore's holder list */
 
-      g_freeholders  = pholder->flink;
       pholder->flink = sem->hhead;
       sem->hhead     = pholder;
     }
@@ -107,6 +183,10 @@ nxsem_allocholder(FAR sem_t *sem, FAR struct tcb_s *htcb)
   pholder->tlink  = htcb->holdsem;
   htcb->holdsem   = pholder;
 
+#ifdef CONFIG_SEM_PI_WAITERS
+  pholder->pi_prio = 0;
+#endif
+
   return pholder;
 }
 
@@ -115,7 +195,8 @@ nxsem_allocholder(FAR sem_t *sem, FAR struct tcb_s *htcb)
  *
  * NOTE: htcb may be used only as a look-up key.  It certain cases, the task
  * may have exited and htcb may refer to a stale memory.  It must not be
- * dereferenced.
+ * dereferenced, except with CONFIG_SEM_PI_WAITERS where the holder records
+ * are part of htcb and htcb must be valid.
  *
  ****************************************************************************/
 
@@ -124,7 +205,15 @@ nxsem_findholder(FAR sem_t *sem, FAR struct tcb_s *htcb)
 {
   FAR struct semholder_s *pholder;
 
-#if CONFIG_SEM_PREALLOCHOLDERS > 0
+#if CONFIG_SEM_PREALLOCHOLDERS > 0 && defined(CONFIG_SEM_PI_WAITERS)
+  /* Look for the holder among the holder records of the thread */
+
+  pholder = nxsem_tcbholder(htcb, sem);
+  if (pholder != NULL)
+    {
+      return pholder;
+    }
+#elif CONFIG_SEM_PREALLOCHOLDERS > 0
   /* Try to find the holder in the list of holders associated with this
    * semaphore
    */
@@ -194,6 +283,16 @@ static inline void nxsem_freeholder(FAR sem_t *sem,
         }
     }
 
+#ifdef CONFIG_SEM_PI_WAITERS
+  /* Waiters for the semaphore no longer boost this holder */
+
+  if (pholder->pi_prio != 0)
+    {
+      RB_REMOVE(semholder_tree_s, &pholder->htcb->pi_waiters, pholder);
+      pholder->pi_prio = 0;
+    }
+#endif
+
   /* Release the holder and counts */
 
   pholder->tlink  = NULL;
@@ -215,10 +314,12 @@ static inline void nxsem_freeholder(FAR sem_t *sem,
         }
     }
 
+#  ifndef CONFIG_SEM_PI_WAITERS
   /* And put it in the free list */
 
   pholder->flink = g_freeholders;
   g_freeholders  = pholder;
+#  endif
 #endif
 }
 
@@ -302,6 +403,7 @@ static int nxsem_recoverholders(FAR struct semholder_s *pholder,
  * Name: nxsem_boostholderprio
  ****************************************************************************/
 
+#ifndef CONFIG_SEM_PI_WAITERS
 static int nxsem_boostholderprio(FAR struct semholder_s *pholder,
                                  FAR sem_t *sem, FAR void *arg)
 {
@@ -326,6 +428,7 @@ static int nxsem_boostholderprio(FAR struct semholder_s *pholder,
 
   return 0;
 }
+#endif
 
 /****************************************************************************
  * Name: nxsem_verifyholder
@@ -374,6 +477,155 @@ static int nxsem_dumpholder(FAR struct semholder_s *pholder, FAR sem_t *sem,
 }
 #endif
 
+/****************************************************************************
+ * Name: nxsem_top_waiter
+ *
+ * Description:
+ *   Return the priority of the highest priority thread waiting for the
+ *   semaphore, ignoring stcb, or -1 if there is no such thread.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SEM_PI_WAITERS
+static int nxsem_top_waiter(FAR sem_t *sem, FAR struct tcb_s *stcb)
+{
+  FAR struct tcb_s *wtcb;
+
+  /* The wait list is prioritized, so this is the head or, if the head is
+   * the ignored thread, the next one.
+   */
+
+  wtcb = (FAR struct tcb_s *)dq_peek(SEM_WAITLIST(sem));
+  if (wtcb != NULL && wtcb == stcb)
+    {
+      wtcb = (FAR struct tcb_s *)dq_next((FAR dq_entry_t *)wtcb);
+    }
+
+  return wtcb != NULL ? wtcb->sched_priority : -1;
+}
+
+/****************************************************************************
+ * Name: nxsem_requeue_holder
+ *
+ * Description:
+ *   Called when the highest priority waiter of the semaphore of a holder
+ *   changed.  Move the holder to its new place in the pi_waiters tree of
+ *   its thread, and adjust the priority of the thread accordingly.  If that
+ *   changes the priority of a thread that is itself waiting for a semaphore
+ *   with priority inheritance, then the same is done for the holders of
+ *   that semaphore, and so on along the chain of nested locks.
+ *
+ * Input Parameters:
+ *   pholder  - The holder to requeue
+ *   waitprio - The priority of the highest priority waiter of the
+ *              semaphore, or -1 if it has no waiters left
+ *   depth    - The number of holders before this one in the chain
+ *
+ ****************************************************************************/
+
+static void nxsem_requeue_holder(FAR struct semholder_s *pholder,
+                                 int waitprio, int depth)
+{
+  FAR struct tcb_s *htcb = pholder->htcb;
+  FAR sem_t *sem;
+  int hpriority;
+#ifdef CONFIG_ARCH_ADDRENV
+  FAR struct addrenv_s *oldenv;
+#endif
+
+  if (depth >= CONFIG_SEM_PI_MAXDEPTH)
+    {
+      swarn("WARNING: Priority inheritance chain deeper than %d\n",
+            CONFIG_SEM_PI_MAXDEPTH);
+      return;
+    }
+
+#ifdef CONFIG_ARCH_ADDRENV
+  /* The semaphores held by htcb live in its address environment */
+
+  if (htcb->addrenv_own)
+    {
+      addrenv_select(htcb->addrenv_own, &oldenv);
+    }
+#endif
+
+  /* Requeue the holder at the priority of the top waiter */
+
+  if (pholder->pi_prio != 0)
+    {
+      RB_REMOVE(semholder_tree_s, &htcb->pi_waiters, pholder);
+      pholder->pi_prio = 0;
+    }
+
+  if (waitprio > 0)
+    {
+      pholder->pi_prio = waitprio;
+      RB_INSERT(semholder_tree_s, &htcb->pi_waiters, pholder);
+    }
+
+  /* Then apply the priority the holder inherits now */
+
+  hpriority = nxsem_inherited_priority(htcb);
+  if (hpriority != htcb->sched_priority)
+    {
+      nxsched_set_priority(htcb, hpriority);
+
+      /* If the holder is waiting for a semaphore with priority
+       * inheritance, then it was requeued in the wait list of that
+       * semaphore and the holders of that one are next.
+       */
+
+      sem = htcb->task_state == TSTATE_WAIT_SEM ? htcb->waitobj : NULL;
+      if (sem != NULL &&
+          (sem->flags & SEM_PRIO_MASK) == SEM_PRIO_INHERIT)
+        {
+          nxsem_propagate_priority(sem, nxsem_top_waiter(sem, NULL),
+                                   depth + 1);
+        }
+    }
+
+#ifdef CONFIG_ARCH_ADDRENV
+  if (htcb->addrenv_own)
+    {
+      addrenv_restore(oldenv);
+    }
+#endif
+}
+
+/****************************************************************************
+ * Name: nxsem_propagate_priority
+ *
+ * Description:
+ *   Called when the highest priority waiter of a semaphore changed.
+ *   Requeue every holder of the semaphore.
+ *
+ * Input Parameters:
+ *   sem      - The semaphore whose waiters changed
+ *   waitprio - The priority of its highest priority waiter, or -1 if it
+ *              has no waiters left
+ *   depth    - The number of holders before these ones in the chain
+ *
+ ****************************************************************************/
+
+static void nxsem_propagate_priority(FAR sem_t *sem, int waitprio,
+                                     int depth)
+{
+#if CONFIG_SEM_PREALLOCHOLDERS > 0
+  FAR struct semholder_s *pholder;
+
+  for (pholder = sem->hhead; pholder != NULL; pholder = pholder->flink)
+    {
+      nxsem_requeue_holder(pholder, waitprio, depth);
+    }
+#else
+  if (sem->holder.htcb != NULL)
+    {
+      nxsem_requeue_holder(&sem->holder, waitprio, depth);
+    }
+#endif
+}
+#endif /* CONFIG_SEM_PI_WAITERS */
+
 /****************************************************************************
  * Name: nxsem_restore_priority
  ****************************************************************************/
@@ -396,7 +648,9 @@ static void nxsem_restore_priority(FAR struct tcb_s *htcb)
 
   if (htcb->sched_priority != hpriority)
     {
+#ifndef CONFIG_SEM_PI_WAITERS
       FAR struct semholder_s *pholder;
+#endif
 
 #ifdef CONFIG_ARCH_ADDRENV
       FAR struct addrenv_s *oldenv;
@@ -407,6 +661,13 @@ static void nxsem_restore_priority(FAR struct tcb_s *htcb)
         }
 #endif
 
+#ifdef CONFIG_SEM_PI_WAITERS
+      /* The highest priority across all the threads that are waiting for
+       * any semaphore held by htcb is at the head of its pi_waiters.
+       */
+
+      hpriority = nxsem_inherited_priority(htcb);
+#else
       /* Try to find the highest priority across all the threads that are
        * waiting for any semaphore held by htcb.
        */
@@ -423,6 +684,7 @@ static void nxsem_restore_priority(FAR struct tcb_s *htcb)
               hpriority = stcb->sched_priority;
             }
         }
+#endif
 
 #ifdef CONFIG_ARCH_ADDRENV
       if (htcb->addrenv_own)
@@ -443,6 +705,7 @@ static void nxsem_restore_priority(FAR struct tcb_s *htcb)
  * Name: nxsem_restoreholderprio
  ****************************************************************************/
 
+#if CONFIG_SEM_PREALLOCHOLDERS > 0 || !defined(CONFIG_SEM_PI_WAITERS)
 static int nxsem_restoreholderprio(FAR struct semholder_s *pholder,
                                    FAR sem_t *sem, FAR void *arg)
 {
@@ -456,11 +719,21 @@ static int nxsem_restoreholderprio(FAR struct semholder_s *pholder,
     {
       nxsem_freeholder(sem, pholder);
     }
+#ifdef CONFIG_SEM_PI_WAITERS
+  else
+    {
+      /* The holder still inherits from the remaining waiters */
+
+      nxsem_requeue_holder(pholder, nxsem_top_waiter(sem, arg), 0);
+      return 0;
+    }
+#endif
 
   nxsem_restore_priority(htcb);
 
   return 0;
 }
+#endif
 
 #if CONFIG_SEM_PREALLOCHOLDERS > 0
 
@@ -532,7 +805,7 @@ static int nxsem_restoreholderprio_self(FAR struct semholder_s *pholder,
 
 void nxsem_initialize_holders(void)
 {
-#if CONFIG_SEM_PREALLOCHOLDERS > 0
+#if CONFIG_SEM_PREALLOCHOLDERS > 0 && !defined(CONFIG_SEM_PI_WAITERS)
   int i;
 
   /* Put all of the pre-allocated holder structures into the free list */
@@ -547,6 +820,45 @@ void nxsem_initialize_holders(void)
 #endif
 }
 
+/****************************************************************************
+ * Name: nxsem_inherited_priority
+ *
+ * Description:
+ *   Return the priority a thread should run at: its base or boosted
+ *   priority, or the priority of the highest priority thread waiting for a
+ *   semaphore it holds, whichever is higher.
+ *
+ * Input Parameters:
+ *   htcb - TCB of the thread
+ *
+ * Returned Value:
+ *   The priority
+ *
+ * Assumptions:
+ *   Interrupts are disabled.  The semaphores held by htcb are accessible
+ *   in the current address environment.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SEM_PI_WAITERS
+int nxsem_inherited_priority(FAR struct tcb_s *htcb)
+{
+  FAR struct semholder_s *pholder;
+  int hpriority;
+
+  hpriority = htcb->boost_priority > htcb->base_priority ?
+              htcb->boost_priority : htcb->base_priority;
+
+  pholder = RB_MIN(semholder_tree_s, &htcb->pi_waiters);
+  if (pholder != NULL && pholder->pi_prio > hpriority)
+    {
+      hpriority = pholder->pi_prio;
+    }
+
+  return hpriority;
+}
+#endif
+
 /****************************************************************************
  * Name: nxsem_destroyholder
  *
@@ -643,6 +955,15 @@ void nxsem_add_holder_tcb(FAR struct tcb_s *htcb, FAR sem_t *sem)
 
           pholder->counts++;
         }
+
+#ifdef CONFIG_SEM_PI_WAITERS
+      /* Threads still waiting for the semaphore now wait for htcb */
+
+      if (!dq_empty(SEM_WAITLIST(sem)))
+        {
+          nxsem_requeue_holder(pholder, nxsem_top_waiter(sem, NULL), 0);
+        }
+#endif
     }
 }
 
@@ -693,7 +1014,12 @@ void nxsem_boost_priority(FAR sem_t *sem)
    * count.
    */
 
-#if CONFIG_SEM_PREALLOCHOLDERS > 0
+#if defined(CONFIG_SEM_PI_WAITERS)
+  /* rtcb is not in the wait list yet */
+
+  nxsem_propagate_priority(sem, MAX(nxsem_top_waiter(sem, NULL),
+                                    rtcb->sched_priority), 0);
+#elif CONFIG_SEM_PREALLOCHOLDERS > 0
   nxsem_foreachholder(sem, nxsem_boostholderprio, rtcb);
 #else
   nxsem_boostholderprio(&sem->holder, sem, rtcb);
@@ -884,7 +1210,11 @@ void nxsem_canceled(FAR struct tcb_s *stcb, FAR sem_t *sem)
 
   /* Adjust the priority of every holder as necessary */
 
+#ifdef CONFIG_SEM_PI_WAITERS
+  nxsem_propagate_priority(sem, nxsem_top_waiter(sem, stcb), 0);
+#else
   nxsem_foreachholder(sem, nxsem_restoreholderprio, stcb);
+#endif
 }
 
 /****************************************************************************
@@ -932,7 +1262,7 @@ void sem_enumholders(FAR sem_t *sem)
 #if defined(CONFIG_DEBUG_FEATURES) && defined(CONFIG_SEM_PHDEBUG)
 int nxsem_nfreeholders(void)
 {
-#if CONFIG_SEM_PREALLOCHOLDERS > 0
+#if CONFIG_SEM_PREALLOCHOLDERS > 0 && !defined(CONFIG_SEM_PI_WAITERS)
   FAR struct semholder_s *pholder;
   int n;
 
@@ -88,6 +88,9 @@ void nxsem_release_holder(FAR sem_t *sem);
 void nxsem_restore_baseprio(FAR struct tcb_s *stcb, FAR sem_t *sem);
 void nxsem_canceled(FAR struct tcb_s *stcb, FAR sem_t *sem);
 void nxsem_release_all(FAR struct tcb_s *stcb);
+#  ifdef CONFIG_SEM_PI_WAITERS
+int nxsem_inherited_priority(FAR struct tcb_s *htcb);
+#  endif
 #else
 #  define nxsem_initialize_holders()
 #  define nxsem_destroyholder(sem)
@@ -43,6 +43,10 @@
 #include <nuttx/cancelpt.h>
 #include <nuttx/queue.h>
 
+#ifdef CONFIG_HRTIMER
+#  include <nuttx/hrtimer.h>
+#endif
+
 #include "sched/sched.h"
 #include "signal/signal.h"
 #include "clock/clock.h"
@@ -132,6 +136,23 @@ static void nxsig_timeout(wdparm_t arg)
 #endif
 }
 
+/****************************************************************************
+ * Name: nxsig_hrtimeout
+ *
+ * Description:
+ *   The high resolution timer of nxsig_clockwait() expired.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_HRTIMER
+static uint64_t nxsig_hrtimeout(FAR struct hrtimer_s *timer,
+                                uint64_t expired)
+{
+  nxsig_timeout((wdparm_t)(uintptr_t)timer->arg);
+  return 0;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -254,8 +275,13 @@ int nxsig_clockwait(int clockid, int flags,
 {
   FAR struct tcb_s *rtcb = this_task();
   irqstate_t iflags;
+#ifdef CONFIG_HRTIMER
+  uint64_t expect = 0;
+  uint64_t stop;
+#else
   clock_t expect = 0;
   clock_t stop;
+#endif
 
   if (rqtp && (rqtp->tv_nsec < 0 || rqtp->tv_nsec >= 1000000000))
     {
@@ -300,6 +326,23 @@ int nxsig_clockwait(int clockid, int flags,
 
   if (rqtp)
     {
+#ifdef CONFIG_HRTIMER
+      /* Start the high resolution timer */
+
+      hrtimer_init(&rtcb->waithrtimer, nxsig_hrtimeout, rtcb);
+
+      if ((flags & TIMER_ABSTIME) == 0)
+        {
+          expect = hrtimer_gettime() + clock_time2nsec(rqtp);
+          hrtimer_start(&rtcb->waithrtimer, expect, HRTIMER_MODE_ABS);
+        }
+      else
+        {
+          hrtimer_start(&rtcb->waithrtimer,
+                        hrtimer_abstime2nsec(clockid, rqtp),
+                        HRTIMER_MODE_ABS);
+        }
+#else
       /* Start the watchdog timer */
 
       if ((flags & TIMER_ABSTIME) == 0)
@@ -318,6 +361,7 @@ int nxsig_clockwait(int clockid, int flags,
           wd_start_abstime(&rtcb->waitdog, rqtp,
                            nxsig_timeout, (uintptr_t)rtcb);
         }
+#endif
     }
 
   /* Remove the tcb task from the ready-to-run list. */
@@ -337,15 +381,24 @@ int nxsig_clockwait(int clockid, int flags,
 
   if (rqtp)
     {
+#ifdef CONFIG_HRTIMER
+      hrtimer_cancel(&rtcb->waithrtimer);
+      stop = hrtimer_gettime();
+#else
       wd_cancel(&rtcb->waitdog);
       stop = clock_systime_ticks();
+#endif
     }
 
   leave_critical_section(iflags);
 
   if (rqtp && rmtp && expect)
     {
+#ifdef CONFIG_HRTIMER
+      clock_nsec2time(rmtp, expect > stop ? expect - stop : 0);
+#else
       clock_ticks2time(rmtp, expect > stop ? expect - stop : 0);
+#endif
     }
 
   return 0;
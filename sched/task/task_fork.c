@@ -34,6 +34,8 @@
 #include <errno.h>
 #include <debug.h>
 
+#include <nuttx/addrenv.h>
+#include <nuttx/kmalloc.h>
 #include <nuttx/queue.h>
 
 #include "sched/sched.h"
@@ -46,6 +48,61 @@
 
 #ifdef CONFIG_ARCH_HAVE_FORK
 
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxtask_fork_addrenv
+ *
+ * Description:
+ *   Give the child a copy-on-write duplicate of the parent's address
+ *   environment.  The child runs in the parent's address environment while
+ *   nxtask_setup_fork() and up_fork() prepare it, so its stack, task info
+ *   and environment were allocated from the parent's heap.  The duplicate
+ *   keeps them; the parent's heap, which is still the current one, lets
+ *   go of them.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_ARCH_ADDRENV_COW
+static int nxtask_fork_addrenv(FAR struct task_tcb_s *child)
+{
+  FAR struct task_group_s *group = child->cmn.group;
+#ifndef CONFIG_DISABLE_ENVIRON
+  FAR char **envp;
+#endif
+  int ret;
+
+  ret = addrenv_fork(&child->cmn);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  kumm_free(child->cmn.stack_alloc_ptr);
+
+#ifdef CONFIG_MM_KERNEL_HEAP
+  group_free(group, group->tg_info);
+#endif
+
+#ifndef CONFIG_DISABLE_ENVIRON
+  envp = group->tg_envp;
+  if (envp != NULL)
+    {
+      while (*envp != NULL)
+        {
+          group_free(group, *envp++);
+        }
+
+      group_free(group, group->tg_envp);
+    }
+#endif
+
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -137,7 +194,7 @@ FAR struct task_tcb_s *nxtask_setup_fork(start_t retaddr)
 
   /* Allocate a TCB for the child task. */
 
-  child = kmm_zalloc(sizeof(struct task_tcb_s));
+  child = nxsched_alloc_tcb(sizeof(struct task_tcb_s));
   if (!child)
     {
       serr("ERROR: Failed to allocate TCB\n");
@@ -148,7 +205,10 @@ FAR struct task_tcb_s *nxtask_setup_fork(start_t retaddr)
   child->cmn.flags |= TCB_FLAG_FREE_TCB;
 
 #if defined(CONFIG_ARCH_ADDRENV)
-  /* Join the parent address environment (REVISIT: vfork() only) */
+  /* Join the parent address environment.  With CONFIG_ARCH_ADDRENV_COW,
+   * nxtask_start_fork() replaces it with a copy-on-write duplicate once
+   * the child is set up, otherwise the child shares it like after vfork().
+   */
 
   if (ttype != TCB_FLAG_TTYPE_KERNEL)
     {
@@ -312,10 +372,29 @@ errout:
 pid_t nxtask_start_fork(FAR struct task_tcb_s *child)
 {
   pid_t pid;
+#ifdef CONFIG_ARCH_ADDRENV_COW
+  int ret;
+#endif
 
   sinfo("Starting Child TCB=%p\n", child);
   DEBUGASSERT(child);
 
+#ifdef CONFIG_ARCH_ADDRENV_COW
+  /* Now that its stack is complete, detach the child from the parent's
+   * address environment.
+   */
+
+  if ((child->cmn.flags & TCB_FLAG_TTYPE_MASK) != TCB_FLAG_TTYPE_KERNEL)
+    {
+      ret = nxtask_fork_addrenv(child);
+      if (ret < 0)
+        {
+          nxtask_abort_fork(child, -ret);
+          return ERROR;
+        }
+    }
+#endif
+
   /* Get the assigned pid before we start the task */
 
   pid = child->cmn.pid;
@@ -32,6 +32,10 @@
 #include <nuttx/wdog.h>
 #include <nuttx/sched.h>
 
+#ifdef CONFIG_HRTIMER
+#  include <nuttx/hrtimer.h>
+#endif
+
 #include "semaphore/semaphore.h"
 #include "wdog/wdog.h"
 #include "mqueue/mqueue.h"
@@ -74,6 +78,10 @@ void nxtask_recover(FAR struct tcb_s *tcb)
 
   wd_recover(tcb);
 
+#ifdef CONFIG_HRTIMER
+  hrtimer_cancel_sync(&tcb->waithrtimer);
+#endif
+
   /* If the thread holds semaphore counts or is waiting for a semaphore
    *  count, then release the counts.
    */
@@ -94,4 +102,13 @@ void nxtask_recover(FAR struct tcb_s *tcb)
       DEBUGVERIFY(nxsched_stop_sporadic(tcb));
     }
 #endif
+
+#ifdef CONFIG_SCHED_DEADLINE
+  if ((tcb->flags & TCB_FLAG_POLICY_MASK) == TCB_FLAG_SCHED_DEADLINE)
+    {
+      /* Stop deadline scheduling and release its bandwidth */
+
+      DEBUGVERIFY(nxsched_stop_deadline(tcb));
+    }
+#endif
 }
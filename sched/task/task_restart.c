@@ -145,6 +145,9 @@ static void nxtask_reset_task(FAR struct tcb_s *tcb, bool remove)
 #ifdef CONFIG_PRIORITY_INHERITANCE
   tcb->base_priority = tcb->init_priority;
   tcb->boost_priority = 0;
+#  ifdef CONFIG_SEM_PI_WAITERS
+  RB_INIT(&tcb->pi_waiters);
+#  endif
 #endif
 
   /* Re-initialize the processor-specific portion of the TCB.  This will
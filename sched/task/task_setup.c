@@ -36,6 +36,7 @@
 #include <debug.h>
 
 #include <nuttx/arch.h>
+#include <nuttx/rcu.h>
 #include <nuttx/sched.h>
 #include <nuttx/signal.h>
 #include <nuttx/tls.h>
@@ -86,6 +87,7 @@ static int nxtask_assign_pid(FAR struct tcb_s *tcb)
   FAR struct tcb_s **pidhash;
   irqstate_t flags;
   pid_t next_pid;
+  int   npidhash;
   int   hash_ndx;
   void *temp;
   int   i;
@@ -127,8 +129,8 @@ retry:
         {
           /* Assign this PID to the task */
 
-          g_pidhash[hash_ndx] = tcb;
           tcb->pid = next_pid;
+          rcu_assign_pointer(g_pidhash[hash_ndx], tcb);
           g_lastpid = next_pid;
 
           leave_critical_section(flags);
@@ -167,13 +169,13 @@ retry:
       goto retry;
     }
 
-  g_npidhash *= 2;
+  npidhash = g_npidhash * 2;
 
   /* All original pid and hash_ndx are mismatch,
    * so we need to rebuild their relationship
    */
 
-  for (i = 0; i < g_npidhash / 2; i++)
+  for (i = 0; i < g_npidhash; i++)
     {
       if (g_pidhash[i] == NULL)
         {
@@ -185,15 +187,38 @@ retry:
           continue;
         }
 
-      hash_ndx = PIDHASH(g_pidhash[i]->pid);
+      hash_ndx = g_pidhash[i]->pid & (npidhash - 1);
       DEBUGASSERT(pidhash[hash_ndx] == NULL);
       pidhash[hash_ndx] = g_pidhash[i];
     }
 
-  /* Release resource for original g_pidhash, using new g_pidhash */
+  /* Release resource for original g_pidhash, using new g_pidhash.
+   * The table is published before its size and a lockless
+   * nxsched_get_tcb() reads them in the opposite order, so it never
+   * indexes past the end of the table it reads.
+   */
 
+#ifdef CONFIG_RCU
+  g_pidhash_seq++;
+  SP_DMB();
+  rcu_assign_pointer(g_pidhash, pidhash);
+  SP_DMB();
+  g_npidhash = npidhash;
+  SP_DMB();
+  g_pidhash_seq++;
+#else
   g_pidhash = pidhash;
+  g_npidhash = npidhash;
+#endif
+
   leave_critical_section(flags);
+
+#ifdef CONFIG_RCU
+  /* Wait for readers that may still be using the old table */
+
+  synchronize_rcu();
+#endif
+
   kmm_free(temp);
 
   /* Let's try every allowable pid again */
@@ -418,6 +443,9 @@ static int nxthread_setup_scheduler(FAR struct tcb_s *tcb, int priority,
       tcb->init_priority  = (uint8_t)priority;
 #ifdef CONFIG_PRIORITY_INHERITANCE
       tcb->base_priority  = (uint8_t)priority;
+#  ifdef CONFIG_SEM_PI_WAITERS
+      RB_INIT(&tcb->pi_waiters);
+#  endif
 #endif
       tcb->start          = start;
       tcb->entry.main     = (main_t)entry;
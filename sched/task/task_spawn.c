@@ -92,7 +92,7 @@ static int nxtask_spawn_create(FAR const char *name, int priority,
 
   /* Allocate a TCB for the new task. */
 
-  tcb = kmm_zalloc(sizeof(struct task_tcb_s));
+  tcb = nxsched_alloc_tcb(sizeof(struct task_tcb_s));
   if (tcb == NULL)
     {
       serr("ERROR: Failed to allocate TCB\n");
@@ -109,7 +109,7 @@ static int nxtask_spawn_create(FAR const char *name, int priority,
                     entry, argv, envp, actions);
   if (ret < OK)
     {
-      kmm_free(tcb);
+      nxsched_free_tcb(&tcb->cmn);
       return ret;
     }
 
@@ -36,6 +36,10 @@
 #include <nuttx/signal.h>
 #include <nuttx/wdog.h>
 
+#ifdef CONFIG_HRTIMER
+#  include <nuttx/hrtimer.h>
+#endif
+
 #ifndef CONFIG_DISABLE_POSIX_TIMERS
 
 /****************************************************************************
@@ -59,9 +63,15 @@ struct posix_timer_s
   uint8_t          pt_crefs;       /* Reference count */
   pid_t            pt_owner;       /* Creator of timer */
   int              pt_overrun;     /* Overrun time */
+#ifdef CONFIG_HRTIMER
+  uint64_t         pt_delay;       /* If non-zero, reload period in ns */
+  uint64_t         pt_expected;    /* Expected absolute time (ns) */
+  struct hrtimer_s pt_hrtimer;     /* The hrtimer that provides the timing */
+#else
   sclock_t         pt_delay;       /* If non-zero, used to reset repetitive timers */
   clock_t          pt_expected;    /* Expected absolute time */
   struct wdog_s    pt_wdog;        /* The watchdog that provides the timing */
+#endif
   struct sigevent  pt_event;       /* Notification information */
 #ifdef CONFIG_SIG_EVTHREAD
   struct sigwork_s pt_work;
@@ -73,7 +73,11 @@
 int timer_gettime(timer_t timerid, FAR struct itimerspec *value)
 {
   FAR struct posix_timer_s *timer = timer_gethandle(timerid);
+#ifdef CONFIG_HRTIMER
+  uint64_t now;
+#else
   sclock_t ticks;
+#endif
 
   if (!timer || !value)
     {
@@ -81,6 +85,16 @@ int timer_gettime(timer_t timerid, FAR struct itimerspec *value)
       return ERROR;
     }
 
+#ifdef CONFIG_HRTIMER
+  /* Get the time remaining before the underlying hrtimer expires */
+
+  now = hrtimer_gettime();
+  clock_nsec2time(&value->it_value,
+                  HRTIMER_ISACTIVE(&timer->pt_hrtimer) &&
+                  timer->pt_hrtimer.expired > now ?
+                  timer->pt_hrtimer.expired - now : 0);
+  clock_nsec2time(&value->it_interval, timer->pt_delay);
+#else
   /* Get the number of ticks before the underlying watchdog expires */
 
   ticks = wd_gettime(&timer->pt_wdog);
@@ -89,6 +103,7 @@ int timer_gettime(timer_t timerid, FAR struct itimerspec *value)
 
   clock_ticks2time(&value->it_value, ticks);
   clock_ticks2time(&value->it_interval, timer->pt_delay);
+#endif
   return OK;
 }
 
@@ -124,7 +124,15 @@ int timer_release(FAR struct posix_timer_s *timer)
 
   /* Cancel the underlying watchdog instance */
 
+#ifdef CONFIG_HRTIMER
+  /* timer_timeout() may be running on another CPU; wait until it is done
+   * with the timer before freeing it.
+   */
+
+  hrtimer_cancel_sync(&timer->pt_hrtimer);
+#else
   wd_cancel(&timer->pt_wdog);
+#endif
 
   /* Cancel any pending notification */
 
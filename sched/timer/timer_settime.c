@@ -44,9 +44,16 @@
  ****************************************************************************/
 
 static inline void timer_signotify(FAR struct posix_timer_s *timer);
+#ifdef CONFIG_HRTIMER
+static inline uint64_t timer_restart(FAR struct posix_timer_s *timer,
+                                     uint64_t expired);
+static uint64_t timer_timeout(FAR struct hrtimer_s *hrtimer,
+                              uint64_t expired);
+#else
 static inline void timer_restart(FAR struct posix_timer_s *timer,
                                  wdparm_t itimer);
 static void timer_timeout(wdparm_t itimer);
+#endif
 
 /****************************************************************************
  * Private Functions
@@ -98,6 +105,36 @@ static inline void timer_signotify(FAR struct posix_timer_s *timer)
  *
  ****************************************************************************/
 
+#ifdef CONFIG_HRTIMER
+static inline uint64_t timer_restart(FAR struct posix_timer_s *timer,
+                                     uint64_t expired)
+{
+  uint64_t frame = 1;
+  uint64_t now;
+
+  if (timer->pt_delay == 0)
+    {
+      return 0;
+    }
+
+  /* Same overrun accounting as the watchdog version below, in nanoseconds.
+   * The period up to the next expected time is returned to
+   * hrtimer_process() which reloads the timer relative to 'expired'.
+   */
+
+  now = hrtimer_gettime();
+  if (now >= timer->pt_expected)
+    {
+      frame = (now - timer->pt_expected + timer->pt_delay) /
+              timer->pt_delay;
+    }
+
+  timer->pt_overrun = frame - 1;
+  timer->pt_expected += frame * timer->pt_delay;
+
+  return timer->pt_expected - expired;
+}
+#else
 static inline void timer_restart(FAR struct posix_timer_s *timer,
                                  wdparm_t itimer)
 {
@@ -135,6 +172,7 @@ static inline void timer_restart(FAR struct posix_timer_s *timer,
                        timer_timeout, itimer);
     }
 }
+#endif
 
 /****************************************************************************
  * Name: timer_timeout
@@ -154,6 +192,31 @@ static inline void timer_restart(FAR struct posix_timer_s *timer,
  *
  ****************************************************************************/
 
+#ifdef CONFIG_HRTIMER
+static uint64_t timer_timeout(FAR struct hrtimer_s *hrtimer,
+                              uint64_t expired)
+{
+  FAR struct posix_timer_s *timer =
+    timer_gethandle((timer_t)hrtimer->arg);
+
+  if (timer == NULL)
+    {
+      return 0;
+    }
+
+  timer->pt_crefs++;
+  timer_signotify(timer);
+
+  /* Return the reload period only if the timer was not deleted */
+
+  if (timer_release(timer))
+    {
+      return timer_restart(timer, expired);
+    }
+
+  return 0;
+}
+#else
 static void timer_timeout(wdparm_t itimer)
 {
   FAR struct posix_timer_s *timer = timer_gethandle((timer_t)itimer);
@@ -182,6 +245,7 @@ static void timer_timeout(wdparm_t itimer)
       timer_restart(timer, itimer);
     }
 }
+#endif
 
 /****************************************************************************
  * Public Functions
@@ -256,7 +320,11 @@ int timer_settime(timer_t timerid, int flags,
                   FAR struct itimerspec *ovalue)
 {
   FAR struct posix_timer_s *timer = timer_gethandle(timerid);
+#ifdef CONFIG_HRTIMER
+  uint64_t now;
+#else
   sclock_t delay;
+#endif
   int ret = OK;
 
   /* Some sanity checks */
@@ -269,6 +337,16 @@ int timer_settime(timer_t timerid, int flags,
 
   if (ovalue)
     {
+#ifdef CONFIG_HRTIMER
+      /* Get the time remaining before the underlying hrtimer expires */
+
+      now = hrtimer_gettime();
+      clock_nsec2time(&ovalue->it_value,
+                      HRTIMER_ISACTIVE(&timer->pt_hrtimer) &&
+                      timer->pt_hrtimer.expired > now ?
+                      timer->pt_hrtimer.expired - now : 0);
+      clock_nsec2time(&ovalue->it_interval, timer->pt_delay);
+#else
       /* Get the number of ticks before the underlying watchdog expires */
 
       delay = wd_gettime(&timer->pt_wdog);
@@ -277,13 +355,18 @@ int timer_settime(timer_t timerid, int flags,
 
       clock_ticks2time(&ovalue->it_value, delay);
       clock_ticks2time(&ovalue->it_interval, timer->pt_delay);
+#endif
     }
 
   /* Disarm the timer (in case the timer was already armed when
    * timer_settime() is called).
    */
 
+#ifdef CONFIG_HRTIMER
+  hrtimer_cancel(&timer->pt_hrtimer);
+#else
   wd_cancel(&timer->pt_wdog);
+#endif
 
   /* Cancel any pending notification */
 
@@ -302,14 +385,38 @@ int timer_settime(timer_t timerid, int flags,
 
   if (value->it_interval.tv_sec > 0 || value->it_interval.tv_nsec > 0)
     {
+#ifdef CONFIG_HRTIMER
+      timer->pt_delay = clock_time2nsec(&value->it_interval);
+#else
       delay = clock_time2ticks(&value->it_interval);
       timer->pt_delay = delay;
+#endif
     }
   else
     {
       timer->pt_delay = 0;
     }
 
+#ifdef CONFIG_HRTIMER
+  /* Calculate the expiration time in nanoseconds, no rounding to ticks */
+
+  if ((flags & TIMER_ABSTIME) != 0)
+    {
+      timer->pt_expected = hrtimer_abstime2nsec(timer->pt_clock,
+                                                 &value->it_value);
+    }
+  else
+    {
+      timer->pt_expected = hrtimer_gettime() +
+                           clock_time2nsec(&value->it_value);
+    }
+
+  /* Then start the hrtimer */
+
+  hrtimer_init(&timer->pt_hrtimer, timer_timeout, timer);
+  ret = hrtimer_start(&timer->pt_hrtimer, timer->pt_expected,
+                      HRTIMER_MODE_ABS);
+#else
   /* Check if abstime is selected */
 
   if ((flags & TIMER_ABSTIME) != 0)
@@ -335,6 +442,7 @@ int timer_settime(timer_t timerid, int flags,
 
   ret = wd_start_abstick(&timer->pt_wdog, timer->pt_expected,
                          timer_timeout, (wdparm_t)timer);
+#endif
 
   if (ret < 0)
     {
@@ -38,6 +38,16 @@
 #include "sched/sched.h"
 #include "wdog/wdog.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The list.h macros declare struct list_node temporaries, the watchdog
+ * list uses the layout-compatible struct wdlist_node instead.
+ */
+
+#define list_node wdlist_node
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
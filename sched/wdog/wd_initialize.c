@@ -39,7 +39,7 @@
  * this linked list are removed and the function is called.
  */
 
-struct list_node g_wdactivelist = LIST_INITIAL_VALUE(g_wdactivelist);
+struct wdlist_node g_wdactivelist = LIST_INITIAL_VALUE(g_wdactivelist);
 
 /****************************************************************************
  * Public Functions
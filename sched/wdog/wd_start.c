@@ -47,6 +47,12 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* The list.h macros declare struct list_node temporaries, the watchdog
+ * list uses the layout-compatible struct wdlist_node instead.
+ */
+
+#define list_node wdlist_node
+
 #ifndef CONFIG_SCHED_CRITMONITOR_MAXTIME_WDOG
 #  define CONFIG_SCHED_CRITMONITOR_MAXTIME_WDOG 0
 #endif
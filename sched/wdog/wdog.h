@@ -38,14 +38,6 @@
 #include <nuttx/wdog.h>
 #include <nuttx/list.h>
 
-/****************************************************************************
- * Pre-processor Definitions
- ****************************************************************************/
-
-/* Redefine to the standard list */
-
-#define list_node wdlist_node
-
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -63,7 +55,7 @@ extern "C"
  * this linked list are removed and the function is called.
  */
 
-extern struct list_node g_wdactivelist;
+extern struct wdlist_node g_wdactivelist;
 
 /****************************************************************************
  * Public Function Prototypes
@@ -34,6 +34,7 @@
 #include <nuttx/wqueue.h>
 
 #include "sched/sched.h"
+#include "semaphore/semaphore.h"
 #include "wqueue/wqueue.h"
 
 #if defined(CONFIG_SCHED_WORKQUEUE) && defined(CONFIG_SCHED_LPWORK) && \
@@ -151,6 +152,13 @@ static void lpwork_restoreworker(pid_t wpid, uint8_t reqprio)
 
   if (wtcb->sched_priority != wtcb->base_priority)
     {
+#ifdef CONFIG_SEM_PI_WAITERS
+      /* Fall back to the base priority or to the priority inherited from
+       * the waiters of any semaphore held by wtcb.
+       */
+
+      nxsched_set_priority(wtcb, nxsem_inherited_priority(wtcb));
+#else
       FAR struct semholder_s *pholder;
       uint8_t wpriority;
 
@@ -183,6 +191,7 @@ static void lpwork_restoreworker(pid_t wpid, uint8_t reqprio)
        */
 
       nxsched_set_priority(wtcb, wpriority);
+#endif
     }
 }
 
@@ -442,6 +442,8 @@ class TaskState(Enum):
         Waiting_PagingFill = auto()
     if utils.get_symbol_value("CONFIG_SIG_SIGSTOP_ACTION"):
         Stopped = auto()
+    if utils.get_symbol_value("CONFIG_SCHED_DEADLINE"):
+        Throttled = auto()
 
 
 class Ps(gdb.Command):